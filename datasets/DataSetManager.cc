@@ -14,6 +14,15 @@
 #include "gcp/models/ModelManager.h"
 
 #include "gcp/util/JointGaussianVariate.h"
+#include "gcp/util/PerfCounters.h"
+#include "gcp/util/Profiler.h"
+#include "gcp/util/TcpChannel.h"
+
+#include <algorithm>
+
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -29,6 +38,8 @@ DataSetManager::DataSetManager()
   addModelTime_     = 0.0;
   computeChisqTime_ = 0.0;
   nDataSet_         = 0;
+  iShard_           = 0;
+  nShard_           = 1;
 
   docs_.addParameter("1d",         DataType::STRING, "Generic 1D data set");
   docs_.addParameter("uvf",        DataType::STRING, "Visibility UVF data set");
@@ -45,6 +56,8 @@ DataSetManager::DataSetManager()
  */
 DataSetManager::~DataSetManager() 
 {
+  disconnectWorkers();
+
   //------------------------------------------------------------
   // Delete any datasets that were allocated
   //------------------------------------------------------------
@@ -58,6 +71,12 @@ DataSetManager::~DataSetManager()
       diter->second = 0;
     }
   }
+
+  for(std::map<std::string, gcp::util::DataSet*>::iterator diter = remoteDataSetMap_.begin();
+      diter != remoteDataSetMap_.end(); diter++) {
+    delete diter->second;
+    diter->second = 0;
+  }
 }
 
 /**.......................................................................
@@ -185,7 +204,16 @@ DataSet* DataSetManager::getDataSet(std::string dataSetName)
   } else {
     std::map<std::string, DataSet*>::iterator dataSet = dataSetMap_.find(dataSetName);
 
-    if(dataSet == dataSetMap_.end()) {
+    if(dataSet != dataSetMap_.end())
+      return dataSet->second;
+
+    //------------------------------------------------------------
+    // Datasets belonging to other shards can still be configured
+    //------------------------------------------------------------
+
+    dataSet = remoteDataSetMap_.find(dataSetName);
+
+    if(dataSet == remoteDataSetMap_.end()) {
       ThrowColorError(std::endl << "No dataSet named: " << dataSetName << " has been initialized", "red");
     }
 
@@ -296,6 +324,7 @@ void DataSetManager::addModel(gcp::util::Model& model)
 
     if(dataSet->applies(model)) {
       if(!model.remove_) {
+	PROFILE_ZONE("DataSet::addModel", diter->first.c_str());
 	dataSet->addModel(model);
       }
     }
@@ -325,7 +354,17 @@ gcp::util::ChisqVariate DataSetManager::computeChisq()
   for(std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
       diter != dataSetMap_.end(); diter++, iDataSet++) {
     DataSet* dataSet = diter->second;
-    chisq += dataSet->computeChisq();
+    PROFILE_ZONE("DataSet::computeChisq", diter->first.c_str());
+
+    //------------------------------------------------------------
+    // A dataset with no degrees of freedom (e.g., a mosaic whose
+    // pointings are all held by other shards) contributes nothing
+    //------------------------------------------------------------
+
+    ChisqVariate dsChisq = dataSet->computeChisq();
+
+    if(dsChisq.nDof() > 0)
+      chisq += dsChisq;
   }
 
   return chisq;
@@ -342,7 +381,10 @@ gcp::util::ChisqVariate DataSetManager::computeChisq2()
   for(std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
       diter != dataSetMap_.end(); diter++, iDataSet++) {
     DataSet* dataSet = diter->second;
-    chisq += dataSet->computeChisq2();
+    ChisqVariate dsChisq = dataSet->computeChisq2();
+
+    if(dsChisq.nDof() > 0)
+      chisq += dsChisq;
   }
 
   return chisq;
@@ -402,19 +444,56 @@ Probability DataSetManager::likelihood(ModelManager& mm)
  */
 void DataSetManager::likelihood(ModelManager& mm, Probability& prob, ChisqVariate& chisq)
 {
-  addModelTimer_.start();
+  //------------------------------------------------------------
+  // Start any remote shards first, so that they work while we
+  // evaluate ours
+  //------------------------------------------------------------
+
+  if(workers_.size() > 0)
+    sendSampleToWorkers(mm);
+
+  {
+    PERF_PHASE("DataSetManager::addModel");
+
+    addModelTimer_.start();
+
+    //------------------------------------------------------------
+    // If our own evaluation fails, workers will still reply to the
+    // sample we sent them.  Read those replies before rethrowing, so
+    // that the next evaluation doesn't see them
+    //------------------------------------------------------------
+
+    try {
+      addModel(mm);
+    } catch(...) {
+      drainWorkerReplies(MSG_CHISQ);
+      throw;
+    }
 
-  addModel(mm);
+    addModelTimer_.stop();
+    addModelTime_ += addModelTimer_.deltaInSeconds();
+  }
 
-  addModelTimer_.stop();
-  addModelTime_ += addModelTimer_.deltaInSeconds();
-  computeChisqTimer_.start();
+  {
+    PERF_PHASE("DataSetManager::computeChisq");
 
-  chisq = computeChisq();
-  mm.setChisq(chisq);
+    computeChisqTimer_.start();
 
-  computeChisqTimer_.stop();
-  computeChisqTime_ += computeChisqTimer_.deltaInSeconds();
+    try {
+      chisq = computeChisq();
+    } catch(...) {
+      drainWorkerReplies(MSG_CHISQ);
+      throw;
+    }
+
+    if(workers_.size() > 0)
+      reduceWorkerChisq(chisq);
+
+    mm.setChisq(chisq);
+
+    computeChisqTimer_.stop();
+    computeChisqTime_ += computeChisqTimer_.deltaInSeconds();
+  }
 
 #if PRIOR_DEBUG
   COUT("chisq = " << chisq);
@@ -436,6 +515,41 @@ void DataSetManager::clearModel()
   }
 }
 
+/**.......................................................................
+ * Set the resolution level for all datasets, returning the coarsest
+ * level any of them applied
+ */
+unsigned DataSetManager::setResolutionLevel(unsigned level)
+{
+  unsigned applied = 0;
+
+  for(std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
+      diter != dataSetMap_.end(); diter++) {
+    DataSet* dataSet = diter->second;
+
+    unsigned dataSetLevel = dataSet->setResolutionLevel(level);
+    applied = dataSetLevel > applied ? dataSetLevel : applied;
+  }
+
+  //------------------------------------------------------------
+  // Remote shards apply the same level to their datasets
+  //------------------------------------------------------------
+
+  std::vector<std::vector<char> > payloads;
+
+  for(unsigned iWorker=0; iWorker < workers_.size(); iWorker++)
+    workers_[iWorker]->send(MSG_RESOLUTION, &level, sizeof(level));
+
+  recvWorkerReplies(MSG_RESOLUTION, payloads);
+
+  for(unsigned iWorker=0; iWorker < workers_.size(); iWorker++) {
+    unsigned workerLevel = *((unsigned*)&payloads[iWorker][0]);
+    applied = workerLevel > applied ? workerLevel : applied;
+  }
+
+  return applied;
+}
+
 /**.......................................................................
  * Clear any display models
  */
@@ -453,6 +567,35 @@ void DataSetManager::loadData(bool simulate)
 {
   initializeCommonParameters();
 
+  //------------------------------------------------------------
+  // If distributed, set aside datasets that belong to other shards.
+  // The map is ordered by name, so every process agrees on the
+  // partition.  Nested managers are kept by every shard, and
+  // partition their own datasets when they are loaded below
+  //------------------------------------------------------------
+
+  if(nShard_ > 1) {
+    unsigned iDataSet = 0;
+    std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
+
+    while(diter != dataSetMap_.end()) {
+      DataSetManager* dsm = dynamic_cast<DataSetManager*>(diter->second);
+
+      if(dsm) {
+	dsm->setShard(iShard_, nShard_);
+	++diter;
+      } else if(iDataSet++ % nShard_ != iShard_) {
+	remoteDataSetMap_[diter->first] = diter->second;
+	dataSetMap_.erase(diter++);
+      } else {
+	++diter;
+      }
+    }
+
+    COUTCOLOR("Shard " << iShard_ << " of " << nShard_ << ": loading " << dataSetMap_.size()
+	      << " of " << dataSetMap_.size() + remoteDataSetMap_.size() << " datasets", "green");
+  }
+
   for(std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
       diter != dataSetMap_.end(); diter++) {
     DataSet* dataSet = diter->second;
@@ -519,3 +662,316 @@ void DataSetManager::setObsParameter(std::string name, std::string val, std::str
     }
 }
 
+
+//=======================================================================
+// Distributed evaluation
+//=======================================================================
+
+/**.......................................................................
+ * Set which shard of the declared datasets this process will load
+ */
+void DataSetManager::setShard(unsigned iShard, unsigned nShard)
+{
+  if(nShard == 0 || iShard >= nShard)
+    ThrowError("Invalid shard: " << iShard << " of " << nShard);
+
+  iShard_ = iShard;
+  nShard_ = nShard;
+}
+
+/**.......................................................................
+ * Connect to workers listening at the passed host:port addresses, and
+ * tell each to load its shard of the datasets defined in runFile.
+ * This process becomes shard 0.  Workers load their data in parallel
+ * with us; call waitForWorkers() once our own data are loaded
+ */
+void DataSetManager::connectWorkers(std::vector<std::string>& addresses, std::string runFile)
+{
+  disconnectWorkers();
+  setShard(0, addresses.size() + 1);
+
+  char cwd[PATH_MAX];
+  if(getcwd(cwd, sizeof(cwd)) == 0)
+    ThrowSysError("getcwd()");
+
+  for(unsigned iWorker=0; iWorker < addresses.size(); iWorker++) {
+    TcpChannel* worker = new TcpChannel();
+    workers_.push_back(worker);
+
+    //------------------------------------------------------------
+    // Workers may still be starting up, so retry for a while
+    //------------------------------------------------------------
+
+    for(unsigned iTry=0; ; iTry++) {
+      try {
+	worker->connect(addresses[iWorker]);
+	break;
+      } catch(Exception& err) {
+	if(iTry == 30)
+	  throw err;
+	sleep(1);
+      }
+    }
+
+    //------------------------------------------------------------
+    // Payload is the shard index and count, then the NULL-terminated
+    // working directory and run file
+    //------------------------------------------------------------
+
+    unsigned shard[2];
+    shard[0] = iWorker + 1;
+    shard[1] = nShard_;
+
+    std::vector<char> payload(sizeof(shard));
+    memcpy(&payload[0], shard, sizeof(shard));
+    payload.insert(payload.end(), cwd, cwd + strlen(cwd) + 1);
+    payload.insert(payload.end(), runFile.c_str(), runFile.c_str() + runFile.size() + 1);
+
+    worker->send(MSG_INIT, payload);
+
+    COUTCOLOR("Connected to worker " << addresses[iWorker] << " (shard " << shard[0] << " of " << nShard_ << ")", "green");
+  }
+}
+
+/**.......................................................................
+ * Block until all workers have loaded their data
+ */
+void DataSetManager::waitForWorkers()
+{
+  std::vector<std::vector<char> > payloads;
+  recvWorkerReplies(MSG_READY, payloads);
+
+  //------------------------------------------------------------
+  // Each worker reports the positions of the nested datasets (mosaic
+  // pointings) it loaded.  Install them on our unloaded copies, so
+  // that the positions of nested managers are computed from all of
+  // their datasets
+  //------------------------------------------------------------
+
+  for(unsigned iWorker=0; iWorker < payloads.size(); iWorker++)
+    unpackPositions(payloads[iWorker]);
+}
+
+/**.......................................................................
+ * Send the positions of nested managers, once we have computed them
+ * from all of their datasets, to every worker.  Models with no
+ * absolute position take the position of the manager they are added
+ * to, so every shard must agree on it
+ */
+void DataSetManager::sendPositionsToWorkers()
+{
+  std::vector<char> payload;
+
+  for(std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
+      diter != dataSetMap_.end(); diter++) {
+    if(dynamic_cast<DataSetManager*>(diter->second))
+      packPosition(payload, diter->first, diter->second);
+  }
+
+  for(unsigned iWorker=0; iWorker < workers_.size(); iWorker++)
+    workers_[iWorker]->send(MSG_POSITION, payload);
+
+  std::vector<std::vector<char> > payloads;
+  recvWorkerReplies(MSG_POSITION, payloads);
+}
+
+/**.......................................................................
+ * Pack the positions of the datasets we loaded for any nested
+ * manager, under their qualified (manager.dataset) names
+ */
+void DataSetManager::packNestedPositions(std::vector<char>& payload)
+{
+  for(std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
+      diter != dataSetMap_.end(); diter++) {
+    DataSetManager* dsm = dynamic_cast<DataSetManager*>(diter->second);
+
+    if(dsm == 0)
+      continue;
+
+    for(std::map<std::string, gcp::util::DataSet*>::iterator niter = dsm->dataSetMap_.begin();
+	niter != dsm->dataSetMap_.end(); niter++)
+      packPosition(payload, diter->first + "." + niter->first, niter->second);
+  }
+}
+
+/**.......................................................................
+ * Append a position to a message payload, as a NULL-terminated
+ * dataset name followed by RA (hours) and DEC (degrees)
+ */
+void DataSetManager::packPosition(std::vector<char>& payload, std::string name, DataSet* dataSet)
+{
+  double pos[2];
+  pos[0] = dataSet->ra_.hours();
+  pos[1] = dataSet->dec_.degrees();
+
+  payload.insert(payload.end(), name.c_str(), name.c_str() + name.size() + 1);
+  payload.insert(payload.end(), (char*)pos, (char*)pos + sizeof(pos));
+}
+
+/**.......................................................................
+ * Set the positions of the named datasets from a message payload
+ * built by packPosition()
+ */
+void DataSetManager::unpackPositions(std::vector<char>& payload)
+{
+  unsigned iByte = 0;
+
+  while(iByte < payload.size()) {
+
+    std::vector<char>::iterator end = std::find(payload.begin() + iByte, payload.end(), '\0');
+
+    if(end == payload.end() || (unsigned)(payload.end() - end) < 1 + 2*sizeof(double))
+      ThrowError("Malformed position message");
+
+    std::string name(payload.begin() + iByte, end);
+    iByte = (end - payload.begin()) + 1;
+
+    double pos[2];
+    memcpy(pos, &payload[iByte], sizeof(pos));
+    iByte += sizeof(pos);
+
+    HourAngle ra;
+    Declination dec;
+    ra.setHours(pos[0]);
+    dec.setDegrees(pos[1]);
+
+    DataSet* dataSet = getDataSet(name);
+    dataSet->setRa(ra, true);
+    dataSet->setDec(dec, true);
+  }
+}
+
+/**.......................................................................
+ * End the session with any workers
+ */
+void DataSetManager::disconnectWorkers()
+{
+  for(unsigned iWorker=0; iWorker < workers_.size(); iWorker++) {
+    try {
+      workers_[iWorker]->send(MSG_QUIT);
+    } catch(...) {
+    }
+
+    delete workers_[iWorker];
+  }
+
+  workers_.resize(0);
+}
+
+/**.......................................................................
+ * Send the current values of all variable components (in native
+ * units) to each worker
+ */
+void DataSetManager::sendSampleToWorkers(ModelManager& mm)
+{
+  unsigned nVar = mm.variableComponents_.size();
+  std::vector<double> sample(nVar);
+
+  for(unsigned iVar=0; iVar < nVar; iVar++)
+    sample[iVar] = mm.variableComponents_[iVar]->value();
+
+  for(unsigned iWorker=0; iWorker < workers_.size(); iWorker++)
+    workers_[iWorker]->send(MSG_SAMPLE, nVar > 0 ? &sample[0] : 0, nVar * sizeof(double));
+}
+
+/**.......................................................................
+ * Collect chi-square from each worker, and combine with our own.
+ * Shards with no data contribute no degrees of freedom
+ */
+void DataSetManager::reduceWorkerChisq(ChisqVariate& chisq)
+{
+  double totalChisq = chisq.nDof() > 0 ? chisq.chisq() : 0.0;
+  double totalNdof  = chisq.nDof();
+
+  std::vector<std::vector<char> > payloads;
+  recvWorkerReplies(MSG_CHISQ, payloads);
+
+  for(unsigned iWorker=0; iWorker < workers_.size(); iWorker++) {
+    double* vals = (double*)&payloads[iWorker][0];
+
+    totalChisq += vals[0];
+    totalNdof  += vals[1];
+  }
+
+  if(totalNdof > 0)
+    chisq.setChisq(totalChisq, (unsigned)totalNdof);
+}
+
+/**.......................................................................
+ * Receive one reply from every worker.  Every reply is read even if
+ * an earlier one is an error, so that no stale reply is left queued
+ * for the next request; the first error is then thrown
+ */
+void DataSetManager::recvWorkerReplies(unsigned expected, std::vector<std::vector<char> >& payloads)
+{
+  payloads.resize(workers_.size());
+
+  std::string error;
+  bool failed = false;
+  unsigned type;
+
+  for(unsigned iWorker=0; iWorker < workers_.size(); iWorker++) {
+    try {
+      workers_[iWorker]->recv(type, payloads[iWorker]);
+      checkWorkerReply(workers_[iWorker], type, payloads[iWorker], expected);
+    } catch(Exception& err) {
+      if(!failed)
+	error = err.what();
+      failed = true;
+    }
+  }
+
+  if(failed)
+    ThrowSimpleError(error);
+}
+
+/**.......................................................................
+ * Discard one reply from every worker, after a local error
+ */
+void DataSetManager::drainWorkerReplies(unsigned expected)
+{
+  std::vector<std::vector<char> > payloads;
+
+  try {
+    recvWorkerReplies(expected, payloads);
+  } catch(...) {
+  }
+}
+
+/**.......................................................................
+ * Check a reply from a worker, throwing any error it reported
+ */
+void DataSetManager::checkWorkerReply(TcpChannel* worker, unsigned type, std::vector<char>& payload, unsigned expected)
+{
+  if(type == MSG_ERROR) {
+    std::string msg(payload.begin(), payload.end());
+    ThrowError("Worker " << worker->peer() << " reported an error: " << msg);
+  }
+
+  if(type != expected)
+    ThrowError("Unexpected message (type " << type << ") from worker " << worker->peer());
+
+  //------------------------------------------------------------
+  // Positions reported with MSG_READY are variable-length, and are
+  // checked as they are unpacked
+  //------------------------------------------------------------
+
+  if(expected == MSG_READY)
+    return;
+
+  unsigned nExpected = 0;
+
+  switch (expected) {
+  case MSG_CHISQ:
+    nExpected = 2 * sizeof(double);
+    break;
+  case MSG_RESOLUTION:
+    nExpected = sizeof(unsigned);
+    break;
+  default:
+    break;
+  }
+
+  if(payload.size() != nExpected)
+    ThrowError("Malformed message (type " << type << ") from worker " << worker->peer());
+}
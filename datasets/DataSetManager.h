@@ -14,6 +14,7 @@
  */
 #include <string>
 #include <map>
+#include <vector>
 
 #include "gcp/fftutil/DataSet.h"
 #include "gcp/datasets/DataSet2D.h"
@@ -31,6 +32,7 @@ namespace gcp {
 
   namespace util {
     class DataSet;
+    class TcpChannel;
   }
 
   namespace datasets {
@@ -93,6 +95,7 @@ namespace gcp {
 
       void clearModel();
       void clearDisplayModel();
+      virtual unsigned setResolutionLevel(unsigned level);
       virtual void loadData(bool simulate);
       virtual void checkPosition(bool override=false);
 
@@ -109,6 +112,61 @@ namespace gcp {
       virtual void setObsParameter(std::string name, std::string val, std::string units=" ");
 
       gcp::util::ParameterDocs docs_;
+
+      //------------------------------------------------------------
+      // Distributed evaluation.  Datasets are partitioned into
+      // nShard_ shards (round-robin, in name order), and this process
+      // loads only shard iShard_.  A coordinator holds shard 0, and
+      // forwards each likelihood evaluation to workers holding the
+      // remaining shards, reducing their chi-squares with its own.
+      //
+      // Nested managers (mosaics) are held by every shard, and
+      // partition their own datasets in the same way
+      //------------------------------------------------------------
+
+      enum WorkerMsg {
+	MSG_INIT = 1,   // coordinator -> worker: shard, nShard, cwd, run file
+	MSG_READY,      // worker -> coordinator: data loaded
+	MSG_SAMPLE,     // coordinator -> worker: native values of variable components
+	MSG_CHISQ,      // worker -> coordinator: chisq, nDof
+	MSG_RESOLUTION, // either way: requested/applied resolution level
+	MSG_QUIT,       // coordinator -> worker: end of session
+	MSG_ERROR,      // worker -> coordinator: error message
+	MSG_POSITION    // coordinator -> worker: positions of nested managers
+      };
+
+      void setShard(unsigned iShard, unsigned nShard);
+      void connectWorkers(std::vector<std::string>& addresses, std::string runFile);
+      void waitForWorkers();
+      void sendPositionsToWorkers();
+      void disconnectWorkers();
+
+      // Positions read from the data are exchanged between shards, so
+      // that every shard derives the same model positions.  Workers
+      // report the positions of the nested datasets they loaded with
+      // MSG_READY, and the coordinator returns the resulting positions
+      // of nested managers with MSG_POSITION
+
+      void packNestedPositions(std::vector<char>& payload);
+      void unpackPositions(std::vector<char>& payload);
+
+      unsigned iShard_;
+      unsigned nShard_;
+
+      // Datasets that were declared, but belong to another shard
+
+      std::map<std::string, gcp::util::DataSet*> remoteDataSetMap_;
+
+    private:
+
+      std::vector<gcp::util::TcpChannel*> workers_;
+
+      void sendSampleToWorkers(gcp::models::ModelManager& mm);
+      void reduceWorkerChisq(gcp::util::ChisqVariate& chisq);
+      void recvWorkerReplies(unsigned expected, std::vector<std::vector<char> >& payloads);
+      void drainWorkerReplies(unsigned expected);
+      void checkWorkerReply(gcp::util::TcpChannel* worker, unsigned type, std::vector<char>& payload, unsigned expected);
+      void packPosition(std::vector<char>& payload, std::string name, gcp::util::DataSet* dataSet);
       
     }; // End class DataSetManager
 
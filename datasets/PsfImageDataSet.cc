@@ -2,6 +2,8 @@
 
 #include "gcp/fftutil/Generic2DAngularModel.h"
 
+#include "gcp/util/Profiler.h"
+
 using namespace std;
 
 using namespace gcp::datasets;
@@ -25,12 +27,14 @@ PsfImageDataSet::PsfImageDataSet()
 
   addParameter("psf",         DataType::STRING, "Type of psf: 'realistic', 'gauss' or 'none'.  Default is 'none'");
   addParameter("dist",        DataType::STRING, "Type of error distribution: 'gauss(ian)' or 'poiss(on)'.  Will default to 'poisson' for X-ray data, 'gauss' for all others");
+  addParameter("psfcrop",     DataType::DOUBLE, "If specified, PSF convolutions are restricted to the data window plus the region over which the PSF exceeds this fraction of its peak (i.e., 1e-4)");
 
   addParameter(imp_);
 
   setParameter("errImage", "post");
 
-  psfType_ = PSF_NONE;
+  psfType_  = PSF_NONE;
+  resLevel_ = 0;
 }
 
 /**.......................................................................
@@ -173,6 +177,15 @@ void PsfImageDataSet::initFromImage(Image& image, Image& preImage)
 
   data_.resize(1);
   data_[0].initialize(this, image, preImage, ant, freqs[0]);
+
+  //------------------------------------------------------------
+  // Size the synchronizer to the number of images we manage
+  //------------------------------------------------------------
+
+  for(unsigned i=0; i < data_.size(); i++)
+    data_[i].execIndex_ = i;
+
+  synchronizer_.resize(data_.size());
 }
 
 //------------------------------------------------------------
@@ -186,15 +199,17 @@ void PsfImageDataSet::addModel(gcp::util::Model& model)
   //------------------------------------------------------------
 
   if(applies(model)) {
-    for(unsigned i=0; i < data_.size(); i++)
-      data_[i].addModel(model, dataSetType_);
+    std::vector<PsfImageData>& data = activeData();
+    for(unsigned i=0; i < data.size(); i++)
+      data[i].addModel(model, dataSetType_);
   }
 }
 
 void PsfImageDataSet::clearModel()
 {
-  for(unsigned i=0; i < data_.size(); i++)
-    data_[i].clearModel();
+  std::vector<PsfImageData>& data = activeData();
+  for(unsigned i=0; i < data.size(); i++)
+    data[i].clearModel();
 }
 
 /**.......................................................................
@@ -203,16 +218,11 @@ void PsfImageDataSet::clearModel()
 gcp::util::ChisqVariate PsfImageDataSet::computeChisq()
 {
   //------------------------------------------------------------
-  // Convolve models
+  // Convolve models and accumulate chi-squared over all images.
+  // Each image is handled as a single convolve -> chisq task
   //------------------------------------------------------------
 
-  convolveModels();
-
-  //------------------------------------------------------------
-  // Accumulate chi-squared over all frequencies
-  //------------------------------------------------------------
-
-  ChisqVariate chisq = accumulateChisq();
+  ChisqVariate chisq = executeAll(true, 1);
 
   //------------------------------------------------------------
   // Now clear models so that the next call to addModel()
@@ -234,16 +244,11 @@ gcp::util::ChisqVariate PsfImageDataSet::computeChisq()
 gcp::util::ChisqVariate PsfImageDataSet::computeChisq2()
 {
   //------------------------------------------------------------
-  // Convolve models
-  //------------------------------------------------------------
-
-  convolveModels();
-
-  //------------------------------------------------------------
-  // Accumulate chi-squared over all frequencies
+  // Convolve models and accumulate chi-squared over all images.
+  // Each image is handled as a single convolve -> chisq task
   //------------------------------------------------------------
 
-  ChisqVariate chisq = accumulateChisq2();
+  ChisqVariate chisq = executeAll(true, 2);
 
   //------------------------------------------------------------
   // Now clear models so that the next call to addModel()
@@ -264,31 +269,137 @@ gcp::util::ChisqVariate PsfImageDataSet::computeChisq2()
  */
 gcp::util::ChisqVariate PsfImageDataSet::accumulateChisq()
 {
-  ChisqVariate chisq;
-
-  for(unsigned i=0; i < data_.size(); i++)
-    chisq += data_[i].computeChisq();
-
-  return chisq;
+  return executeAll(false, 1);
 }
 
 /**.......................................................................
  * Accumulate chisq over all images
  */
 gcp::util::ChisqVariate PsfImageDataSet::accumulateChisq2()
+{
+  return executeAll(false, 2);
+}
+
+/**.......................................................................
+ * Convolve the models for all images
+ */
+void PsfImageDataSet::convolveModels()
+{
+  executeAll(true, 0);
+}
+
+/**.......................................................................
+ * Run the requested stages for every image, distributing images
+ * across the thread pool if we have one.  Each task writes its chisq
+ * into its own PsfImageData, so results are summed only after all
+ * tasks have completed
+ */
+gcp::util::ChisqVariate PsfImageDataSet::executeAll(bool convolve, unsigned chisqType)
 {
   ChisqVariate chisq;
+  std::vector<PsfImageData>& data = activeData();
 
-  for(unsigned i=0; i < data_.size(); i++)
-    chisq += data_[i].computeChisq2();
+  initWait();
+
+  for(unsigned i=0; i < data.size(); i++) {
+    PsfImageData& pid = data[i];
+
+    pid.execConvolve_ = convolve;
+    pid.execChisq_    = chisqType;
+
+    if(!pool_) {
+      pid.execute();
+    } else {
+      synchronizer_.registerPending(pid.execIndex_);
+      pool_->execute(&execImage, &pid);
+    }
+  }
+
+  waitUntilDone();
+
+  if(chisqType != 0) {
+    for(unsigned i=0; i < data.size(); i++)
+      chisq += data[i].execChisqVal_;
+  }
 
   return chisq;
 }
 
-void PsfImageDataSet::convolveModels()
+/**.......................................................................
+ * Return the images the likelihood is currently evaluated on
+ */
+std::vector<PsfImageDataSet::PsfImageData>& PsfImageDataSet::activeData()
 {
-  for(unsigned i=0; i < data_.size(); i++)
-    data_[i].convolveModel();
+  return resLevel_ > 0 ? coarseData_ : data_;
+}
+
+/**.......................................................................
+ * Switch to a coarser (level > 0) or full (level = 0) resolution
+ * likelihood.  At level L, each image is replaced by a copy binned
+ * 2^L x 2^L, and models are rendered (and convolved) on the binned
+ * grid.  The level is clamped so that binned images are at least 16
+ * pixels on a side and evenly divide the original.
+ */
+unsigned PsfImageDataSet::setResolutionLevel(unsigned level)
+{
+  for(unsigned i=0; i < data_.size(); i++) {
+    unsigned nx = data_[i].data_.xAxis().getNpix();
+    unsigned ny = data_[i].data_.yAxis().getNpix();
+
+    while(level > 0 && ((nx >> level) < 16 || (ny >> level) < 16 ||
+			nx % (1U << level) != 0 || ny % (1U << level) != 0))
+      --level;
+  }
+
+  if(level == resLevel_)
+    return level;
+
+  resLevel_ = level;
+
+  if(level > 0) {
+    coarseData_.resize(data_.size());
+    for(unsigned i=0; i < data_.size(); i++)
+      coarseData_[i].initializeCoarse(data_[i], 1U << level);
+  } else {
+    coarseData_.resize(0);
+  }
+
+  return level;
+}
+
+/**.......................................................................
+ * Static method which can be passed to a thread pool, to process a
+ * single image
+ */
+EXECUTE_FN(PsfImageDataSet::execImage)
+{
+  PsfImageData* pid = (PsfImageData*)args;
+
+  pid->execute();
+  pid->parent_->synchronizer_.registerDone(pid->execIndex_, pid->parent_->data_.size());
+}
+
+/**.......................................................................
+ * Prepare to wait for a transaction.  If not running in
+ * multi-threaded context, this is a no-op
+ */
+void PsfImageDataSet::initWait()
+{
+  if(pool_) {
+    synchronizer_.reset();
+    synchronizer_.initWait();
+  }
+}
+
+/**.......................................................................
+ * Wait until we are signalled that a transaction has completed.  If
+ * not running in multi-threaded context, this is a no-op
+ */
+void PsfImageDataSet::waitUntilDone()
+{
+  if(pool_) {
+    synchronizer_.wait();
+  }
 }
 
 void PsfImageDataSet::display()
@@ -369,6 +480,24 @@ PsfImageDataSet::PsfImageData::PsfImageData()
   excMax_        = false;
   psfType_       = PSF_NONE;
   distType_      = Distribution::DIST_GAUSS;
+
+  convXStart_    = 0;
+  convYStart_    = 0;
+  convNx_        = 0;
+  convNy_        = 0;
+  convIsCropped_ = false;
+
+  modelScale_    = 1.0;
+  modelIsScaled_ = false;
+
+  execIndex_     = 0;
+  execConvolve_  = false;
+  execChisq_     = 0;
+
+  hasPoissCache_  = false;
+  poissBgSum_     = 0.0;
+  poissLnFactSum_ = 0.0;
+  poissNPix_      = 0;
 }
 
 PsfImageDataSet::PsfImageData::~PsfImageData()
@@ -419,10 +548,7 @@ void PsfImageDataSet::PsfImageData::initialize(PsfImageDataSet* parent, Image& i
     
   if(psfType_ != PSF_NONE) {
 
-    compositeModelDft_ = compositeModel_;
-    
     initializeFromImage(primaryBeam_, data_);
-    primaryBeamDft_ = primaryBeam_;
 
     std::cout << "\rComputing primary beam...                   ";
     fflush(stdout);
@@ -433,10 +559,8 @@ void PsfImageDataSet::PsfImageData::initialize(PsfImageDataSet* parent, Image& i
       primaryBeam_    = ant.getRealisticPrimaryBeam(primaryBeam_, freq);
       
     pbSum_ = primaryBeam_.sum();
-      
-    primaryBeamDft_.initialize(primaryBeam_);
-    primaryBeamDft_.normalize(true);
-    primaryBeamDft_.computeForwardTransform();
+
+    initializeConvolution();
       
     std::cout << "\r                                             \r";
 
@@ -500,7 +624,237 @@ void PsfImageDataSet::PsfImageData::initialize(PsfImageDataSet* parent, Image& i
       lkFn2_ = pixelErrorPoiss;
     }
 
+    initializePoissCache();
+  }
+}
+
+/**.......................................................................
+ * Precompute the data-only terms of the Poisson likelihood over the
+ * data window.  Counts never change during a fit, so ln(n!) and the
+ * background terms are summed once here, and only pixels with
+ * nonzero counts are stored for the n ln(model) term.  Must be
+ * called again if data_ changes (i.e., on simulation).
+ */
+void PsfImageDataSet::PsfImageData::initializePoissCache()
+{
+  unsigned nx = data_.xAxis().getNpix();
+
+  poissInd_.resize(0);
+  poissCounts_.resize(0);
+  poissBg_.resize(0);
+  poissRunStart_.resize(0);
+  poissRunLen_.resize(0);
+
+  poissBgSum_     = 0.0;
+  poissLnFactSum_ = 0.0;
+  poissNPix_      = 0;
+  hasPoissCache_  = false;
+
+  //------------------------------------------------------------
+  // Without a fixed background we need a per-pixel background image
+  //------------------------------------------------------------
+
+  if(!hasErrorVal_ && error_.data_.size() != data_.data_.size())
+    return;
+
+  unsigned ind, n;
+  double bg;
+
+  for(unsigned iy=iYStart_; iy < nY_; iy++) {
+
+    bool inRun = false;
+
+    for(unsigned ix=iXStart_; ix < nX_; ix++) {
+
+      ind = iy * nx + ix;
+
+      if(!data_.valid_[ind]) {
+	inRun = false;
+	continue;
+      }
+
+      //------------------------------------------------------------
+      // Extend the current run of valid pixels, or start a new one
+      //------------------------------------------------------------
+
+      if(inRun) {
+	poissRunLen_[poissRunLen_.size()-1]++;
+      } else {
+	poissRunStart_.push_back(ind);
+	poissRunLen_.push_back(1);
+	inRun = true;
+      }
+
+      bg = hasErrorVal_ ? background_ : error_.data_[ind];
+      n  = data_.data_[ind] > 0.0 ? (unsigned)(data_.data_[ind]) : 0;
+
+      poissBgSum_ += bg;
+      poissNPix_++;
+
+      if(n > 0) {
+	poissInd_.push_back(ind);
+	poissCounts_.push_back((double)n);
+	poissBg_.push_back(bg);
+	poissLnFactSum_ += Sampler::lnFactrl(n);
+      }
+    }
   }
+
+  hasPoissCache_ = true;
+}
+
+/**.......................................................................
+ * Initialize this object as a binned (fac x fac) copy of a
+ * full-resolution image, for use in the coarse-to-fine likelihood
+ * schedule.
+ *
+ * Bin ic spans fine pixels [ic*fac - fac/2, ic*fac - fac/2 + fac).
+ * Coarse pixel ic is evaluated at fine pixel ic*fac, so for even fac
+ * (the only factors used) the bin center is offset from it by half a
+ * fine pixel.  An even-width bin can't be centered on a pixel without
+ * splitting edge pixels, which would break Poisson statistics, and the
+ * offset only affects the burn-in levels.
+ *
+ * Poisson counts (and backgrounds) are summed over each bin, so that
+ * the binned data are still Poisson distributed; Gaussian data are
+ * averaged, and their errors scaled accordingly.  Bins that extend
+ * past the image, or contain invalid pixels, are marked invalid.
+ */
+void PsfImageDataSet::PsfImageData::initializeCoarse(PsfImageData& fine, unsigned fac)
+{
+  parent_      = fine.parent_;
+  antenna_     = fine.antenna_;
+  frequency_   = fine.frequency_;
+  psfType_     = fine.psfType_;
+  distType_    = fine.distType_;
+
+  hasErrorVal_   = fine.hasErrorVal_;
+  hasBackground_ = fine.hasBackground_;
+  hasNoiseRms_   = fine.hasNoiseRms_;
+  thetaMinErr_   = fine.thetaMinErr_;
+
+  thetaMin_    = fine.thetaMin_;
+  thetaMax_    = fine.thetaMax_;
+  excMin_      = fine.excMin_;
+  excMax_      = fine.excMax_;
+
+  lkFn_        = fine.lkFn_;
+  lkFn2_       = fine.lkFn2_;
+  execIndex_   = fine.execIndex_;
+
+  bool poiss   = (distType_ == Distribution::DIST_POISS);
+  double fac2  = (double)fac * fac;
+
+  //------------------------------------------------------------
+  // Size the binned image to match the original angular size
+  //------------------------------------------------------------
+
+  unsigned nx  = fine.data_.xAxis().getNpix();
+  unsigned ny  = fine.data_.yAxis().getNpix();
+  unsigned nxc = nx / fac;
+  unsigned nyc = ny / fac;
+
+  data_ = fine.data_;
+  data_.xAxis().setNpix(nxc);
+  data_.yAxis().setNpix(nyc);
+  data_.resize();
+  data_.zero();
+  data_.hasData_ = true;
+
+  bool perPixelErr = !hasErrorVal_ && fine.error_.data_.size() == fine.data_.data_.size();
+
+  if(perPixelErr) {
+    error_ = data_;
+    error_.zero();
+  }
+
+  //------------------------------------------------------------
+  // Bin the data
+  //------------------------------------------------------------
+
+  for(unsigned jc=0; jc < nyc; jc++) {
+    for(unsigned ic=0; ic < nxc; ic++) {
+
+      unsigned cInd = jc * nxc + ic;
+      int ix0 = (int)(ic * fac) - (int)fac/2;
+      int iy0 = (int)(jc * fac) - (int)fac/2;
+
+      if(ix0 < 0 || iy0 < 0 || ix0 + fac > nx || iy0 + fac > ny) {
+	data_.valid_[cInd] = 0;
+	continue;
+      }
+
+      double sum = 0.0, errSum = 0.0;
+      bool valid = true;
+
+      for(unsigned iy=iy0; iy < iy0 + fac; iy++) {
+	for(unsigned ix=ix0; ix < ix0 + fac; ix++) {
+	  unsigned ind = iy * nx + ix;
+	  valid   = valid && fine.data_.valid_[ind];
+	  sum    += fine.data_.data_[ind];
+
+	  if(perPixelErr)
+	    errSum += poiss ? fine.error_.data_[ind] : fine.error_.data_[ind] * fine.error_.data_[ind];
+	}
+      }
+
+      data_.valid_[cInd] = valid;
+      data_.data_[cInd]  = poiss ? sum : sum / fac2;
+
+      if(perPixelErr)
+	error_.data_[cInd] = poiss ? errSum : sqrt(errSum) / fac2;
+    }
+  }
+
+  noiseRms_    = poiss ? fine.noiseRms_ * fac : fine.noiseRms_ / fac;
+  background_  = poiss ? fine.background_ * fac2 : fine.background_;
+  modelScale_  = poiss ? fac2 : 1.0;
+
+  //------------------------------------------------------------
+  // The data window, restricted to bins that lie entirely within
+  // it.  Bin ic starts at fine pixel ic*fac - fac/2, so it lies
+  // within [iXStart, nX) if ic*fac >= iXStart + fac/2 and
+  // ic*fac <= nX + fac/2 - fac
+  //------------------------------------------------------------
+
+  iXStart_ = (fine.iXStart_ + fac/2 + fac - 1) / fac;
+  iYStart_ = (fine.iYStart_ + fac/2 + fac - 1) / fac;
+  nX_      = (fine.nX_ + fac/2) / fac;
+  nY_      = (fine.nY_ + fac/2) / fac;
+
+  nX_ = nX_ < nxc ? nX_ : nxc;
+  nY_ = nY_ < nyc ? nY_ : nyc;
+
+  //------------------------------------------------------------
+  // Model images, and the PSF on the binned grid
+  //------------------------------------------------------------
+
+  initializeFromImage(compositeModel_, data_);
+  initializeFromImage(modelComponent_, data_);
+
+  if(parent_->hasAbsolutePosition_) {
+    data_.setRaDec(parent_->ra_, parent_->dec_);
+    modelComponent_.setRaDec(parent_->ra_, parent_->dec_);
+  }
+
+  if(psfType_ != PSF_NONE) {
+
+    initializeFromImage(primaryBeam_, data_);
+
+    if(psfType_ == PSF_GAUSS)
+      primaryBeam_ = antenna_.getGaussianPrimaryBeam(primaryBeam_, frequency_);
+    else
+      primaryBeam_ = antenna_.getRealisticPrimaryBeam(primaryBeam_, frequency_);
+
+    pbSum_ = primaryBeam_.sum();
+
+    initializeConvolution();
+  }
+
+  hasPoissCache_ = false;
+
+  if(poiss)
+    initializePoissCache();
 }
 
 /**.......................................................................
@@ -681,7 +1035,7 @@ void PsfImageDataSet::PsfImageData::assignPaddedImageIfNecessary(Image& image)
   iXStart_ = 0;
   iYStart_ = 0;
   nX_      = data_.xAxis().getNpix();
-  nY_      = data_.xAxis().getNpix();
+  nY_      = data_.yAxis().getNpix();
 
   //------------------------------------------------------------
   // If we are not using a psf, just return now, else compute the
@@ -761,7 +1115,18 @@ void PsfImageDataSet::PsfImageData::addModel(gcp::util::Model& model, unsigned t
  */
 gcp::util::ChisqVariate PsfImageDataSet::PsfImageData::computeChisq()
 {
+  //------------------------------------------------------------
+  // Without exclusion regions, the window is fixed and we can use
+  // the precomputed Poisson terms, provided the model is valid over
+  // the whole window.  Otherwise invalid model pixels must be skipped
+  // pixel by pixel
+  //------------------------------------------------------------
+
   ChisqVariate chisq;
+
+  if(hasPoissCache_ && !(excMin_ || excMax_) && computePoissChisq(chisq))
+    return chisq;
+
   double lnLk = 0.0;
   unsigned nDof=0, ind;
 
@@ -943,6 +1308,59 @@ gcp::util::ChisqVariate PsfImageDataSet::PsfImageData::computeChisq2()
   return chisq;
 }
 
+/**.......................................................................
+ * Compute the Poisson (Cash) likelihood over the data window, using
+ * the terms precomputed by initializePoissCache().  Only nonzero-count
+ * pixels need a log; the model sum over the window is a contiguous
+ * pass over each run of valid pixels.
+ *
+ * The model must be valid over the whole window.  This is checked
+ * in the same pass as the model sum, and if any pixel is invalid,
+ * we return false without touching chisq.
+ */
+bool PsfImageDataSet::PsfImageData::computePoissChisq(ChisqVariate& chisq)
+{
+  if(compositeModel_.valid_.size() != compositeModel_.data_.size())
+    return false;
+
+  const float*    model = &compositeModel_.data_[0];
+  const unsigned* valid = &compositeModel_.valid_[0];
+
+  //------------------------------------------------------------
+  // Sum of the model over the window
+  //------------------------------------------------------------
+
+  double modelSum = 0.0;
+  unsigned allValid = 1;
+
+  for(unsigned iRun=0; iRun < poissRunStart_.size(); iRun++) {
+    const float*    ptr    = model + poissRunStart_[iRun];
+    const unsigned* valPtr = valid + poissRunStart_[iRun];
+    unsigned len = poissRunLen_[iRun];
+    for(unsigned i=0; i < len; i++) {
+      modelSum += ptr[i];
+      allValid &= (valPtr[i] != 0);
+    }
+  }
+
+  if(!allValid)
+    return false;
+
+  //------------------------------------------------------------
+  // n ln(model + b), over nonzero-count pixels only
+  //------------------------------------------------------------
+
+  double nLnMu = 0.0;
+  unsigned nNz = poissInd_.size();
+  for(unsigned i=0; i < nNz; i++)
+    nLnMu += poissCounts_[i] * log(model[poissInd_[i]] + poissBg_[i]);
+
+  double lnLk = nLnMu - (modelSum + poissBgSum_) - poissLnFactSum_;
+
+  chisq.setChisq(-2*lnLk, poissNPix_);
+  return true;
+}
+
 /**.......................................................................
  * Return ln Likelihood for gaussian data with fixed error
  */
@@ -1059,6 +1477,7 @@ double PsfImageDataSet::PsfImageData::fixedErrorPoissTest(unsigned ind, unsigned
 void PsfImageDataSet::PsfImageData::clearModel()
 {
   compositeModel_.hasData_ = false;
+  modelIsScaled_ = false;
 }
 
 void PsfImageDataSet::setupForDisplay()
@@ -1137,25 +1556,267 @@ void PsfImageDataSet::PsfImageData::simulateData(double sigma)
       if(expectedCountRate > 0)
 	data_.data_[i] = Sampler::generatePoissonSample(expectedCountRate);
     }
+
+    //------------------------------------------------------------
+    // Data have changed, so recompute the cached Poisson terms
+    //------------------------------------------------------------
+
+    if(hasPoissCache_)
+      initializePoissCache();
   }
 #if 1
 #endif
 }
 
+/**.......................................................................
+ * Convolve the composite model with the PSF.
+ *
+ * The PSF transform was pre-multiplied by the centering phase and
+ * all normalization factors in initializeConvolution(), so this is
+ * just forward transform -> product -> inverse transform over the
+ * (possibly cropped) convolution region.
+ */
 void PsfImageDataSet::PsfImageData::convolveModel()
 {
   if(psfType_ == PSF_NONE)
     return;
 
-  compositeModelDft_.initialize(compositeModel_);
-  compositeModelDft_.normalize(true);
+  unsigned nx = compositeModel_.xAxis().getNpix();
+  unsigned ny = compositeModel_.yAxis().getNpix();
+
+  FftwReal*    in  = compositeModelDft_.getImageDataPtr();
+  FftwComplex* out = compositeModelDft_.getTransformDataPtr();
+  FftwComplex* psf = primaryBeamDft_.getTransformDataPtr();
+
+  //------------------------------------------------------------
+  // Load the convolution region of the model into the transform
+  // array (which is stored x-major).  The region wraps around the
+  // image edges
+  //------------------------------------------------------------
+
+  unsigned imInd, imX = convXStart_, imY;
+  for(unsigned ix=0, dftInd=0; ix < convNx_; ix++) {
+    imY   = convYStart_;
+    imInd = imY * nx + imX;
+    for(unsigned iy=0; iy < convNy_; iy++, dftInd++) {
+      in[dftInd] = compositeModel_.data_[imInd];
+
+      if(++imY == ny) {
+	imY   = 0;
+	imInd = imX;
+      } else {
+	imInd += nx;
+      }
+    }
+
+    if(++imX == nx)
+      imX = 0;
+  }
+
   compositeModelDft_.computeForwardTransform();
 
-  compositeModelDft_.complexMultiply(primaryBeamDft_, false);
-  compositeModelDft_.shift();
+  //------------------------------------------------------------
+  // Multiply by the pre-normalized PSF transform
+  //------------------------------------------------------------
+
+  unsigned nOut = convNx_ * (convNy_/2 + 1);
+  double re1, im1, re2, im2;
+
+  for(unsigned i=0; i < nOut; i++) {
+    re1 = out[i][0];
+    im1 = out[i][1];
+    re2 = psf[i][0];
+    im2 = psf[i][1];
+
+    out[i][0] = re1 * re2 - im1 * im2;
+    out[i][1] = re1 * im2 + re2 * im1;
+  }
 
   compositeModelDft_.computeInverseTransform();
-  compositeModel_ = compositeModelDft_.getImage(false) / pbSum_;
+
+  //------------------------------------------------------------
+  // Copy the result back into the model.  If the convolution was
+  // cropped, only the data window is meaningful (the margin absorbs
+  // wrap-around), so we zero everything else
+  //------------------------------------------------------------
+
+  unsigned xStart = convXStart_, xStop = convXStart_ + convNx_;
+  unsigned yStart = convYStart_, yStop = convYStart_ + convNy_;
+
+  if(convIsCropped_) {
+    compositeModel_.data_ = 0.0;
+    xStart = iXStart_;
+    xStop  = nX_;
+    yStart = iYStart_;
+    yStop  = nY_;
+  }
+
+  for(unsigned ix=xStart; ix < xStop; ix++) {
+    unsigned dftInd = ((ix + nx - convXStart_) % nx) * convNy_ + (yStart + ny - convYStart_) % ny;
+    imInd = yStart * nx + ix;
+    for(unsigned iy=yStart; iy < yStop; iy++, dftInd++, imInd += nx)
+      compositeModel_.data_[imInd] = in[dftInd];
+  }
+
+  compositeModel_.hasData_ = true;
+}
+
+/**.......................................................................
+ * Set up the convolution region and the cached PSF transform.
+ *
+ * By default the whole image is transformed.  If 'psfcrop' was
+ * specified, we transform only the smallest power-of-2 region that
+ * covers the data window plus the extent over which the PSF exceeds
+ * the requested fraction of its peak.
+ *
+ * The cached transform folds in the shift that centers the PSF, the
+ * 1/N normalization of the inverse transform, and division by the
+ * beam integral.
+ */
+void PsfImageDataSet::PsfImageData::initializeConvolution()
+{
+  unsigned nx = primaryBeam_.xAxis().getNpix();
+  unsigned ny = primaryBeam_.yAxis().getNpix();
+
+  convXStart_    = 0;
+  convYStart_    = 0;
+  convNx_        = nx;
+  convNy_        = ny;
+  convIsCropped_ = false;
+
+  if(parent_->getParameter("psfcrop", false)->data_.hasValue()) {
+
+    unsigned xMargin, yMargin;
+    getPsfSupport(parent_->getDoubleVal("psfcrop"), xMargin, yMargin);
+
+    unsigned nxWin = nX_ > iXStart_ ? nX_ - iXStart_ : 0;
+    unsigned nyWin = nY_ > iYStart_ ? nY_ - iYStart_ : 0;
+
+    unsigned nxCrop = Dft2d::nearestPowerOf2NotLessThan((double)(nxWin + 2*xMargin));
+    unsigned nyCrop = Dft2d::nearestPowerOf2NotLessThan((double)(nyWin + 2*yMargin));
+
+    if(nxCrop < nx || nyCrop < ny) {
+
+      convNx_ = nxCrop < nx ? nxCrop : nx;
+      convNy_ = nyCrop < ny ? nyCrop : ny;
+
+      //------------------------------------------------------------
+      // Center the region on the data window.  Where the window
+      // touches an image edge, the region wraps around to the
+      // opposite edge rather than being clamped inside the image,
+      // so that the cropped transform sees the same (cyclic)
+      // neighbourhood of the window as a full-image transform does
+      //------------------------------------------------------------
+
+      int xStart = (int)(iXStart_ + nX_)/2 - (int)convNx_/2;
+      int yStart = (int)(iYStart_ + nY_)/2 - (int)convNy_/2;
+
+      xStart = (xStart + (int)nx) % (int)nx;
+      yStart = (yStart + (int)ny) % (int)ny;
+
+      convXStart_    = xStart;
+      convYStart_    = yStart;
+      convIsCropped_ = true;
+
+      COUTCOLOR("Note: cropping PSF convolution to " << convNx_ << " x " << convNy_ << " of " << nx << " x " << ny << " pixels", "cyan");
+    }
+  }
+
+  //------------------------------------------------------------
+  // Load the central convNx_ x convNy_ pixels of the primary beam,
+  // and transform
+  //------------------------------------------------------------
+
+  primaryBeamDft_.resize(convNx_, convNy_);
+  compositeModelDft_.resize(convNx_, convNy_);
+  compositeModelDft_.normalize(false);
+
+  FftwReal* in   = primaryBeamDft_.getImageDataPtr();
+  unsigned xOff = nx/2 - convNx_/2;
+  unsigned yOff = ny/2 - convNy_/2;
+
+  for(unsigned ix=0, dftInd=0; ix < convNx_; ix++) {
+    for(unsigned iy=0; iy < convNy_; iy++, dftInd++)
+      in[dftInd] = primaryBeam_.data_[(iy + yOff) * nx + (ix + xOff)];
+  }
+
+  primaryBeamDft_.computeForwardTransform();
+
+  //------------------------------------------------------------
+  // Now fold in the centering shift and normalization
+  //------------------------------------------------------------
+
+  FftwComplex* out = primaryBeamDft_.getTransformDataPtr();
+  double norm = 1.0 / ((double)convNx_ * convNy_ * pbSum_);
+
+  for(unsigned iOut=0, ix=0; ix < convNx_; ix++) {
+    for(unsigned iy=0; iy <= convNy_/2; iy++, iOut++) {
+      double fac = ((ix + iy) % 2 == 0) ? norm : -norm;
+      out[iOut][0] *= fac;
+      out[iOut][1] *= fac;
+    }
+  }
+}
+
+/**.......................................................................
+ * Return the half-widths (in pixels) of the region about the image
+ * center over which the primary beam exceeds frac of its peak
+ */
+void PsfImageDataSet::PsfImageData::getPsfSupport(double frac, unsigned& xMargin, unsigned& yMargin)
+{
+  unsigned nx = primaryBeam_.xAxis().getNpix();
+  unsigned ny = primaryBeam_.yAxis().getNpix();
+
+  double peak = 0.0;
+  for(unsigned i=0; i < primaryBeam_.data_.size(); i++) {
+    double val = fabs(primaryBeam_.data_[i]);
+    peak = val > peak ? val : peak;
+  }
+
+  double thresh = frac * peak;
+  xMargin = 0;
+  yMargin = 0;
+
+  for(unsigned iy=0; iy < ny; iy++) {
+    for(unsigned ix=0; ix < nx; ix++) {
+      if(fabs(primaryBeam_.data_[iy * nx + ix]) > thresh) {
+	unsigned dx = ix > nx/2 ? ix - nx/2 : nx/2 - ix;
+	unsigned dy = iy > ny/2 ? iy - ny/2 : ny/2 - iy;
+	xMargin = dx > xMargin ? dx : xMargin;
+	yMargin = dy > yMargin ? dy : yMargin;
+      }
+    }
+  }
+
+  xMargin += 1;
+  yMargin += 1;
+}
+
+/**.......................................................................
+ * Run the stages requested by the parent for this image
+ */
+void PsfImageDataSet::PsfImageData::execute()
+{
+  PROFILE_ZONE("PsfImageData::execute", 0);
+
+  if(execConvolve_)
+    convolveModel();
+
+  //------------------------------------------------------------
+  // Scale the model once per evaluation, whether or not it was
+  // convolved here, since accumulateChisq() can follow a separate
+  // convolveModels() call
+  //------------------------------------------------------------
+
+  if(modelScale_ != 1.0 && !modelIsScaled_) {
+    compositeModel_.data_ *= (float)modelScale_;
+    modelIsScaled_ = true;
+  }
+
+  if(execChisq_ == 1)
+    execChisqVal_ = computeChisq();
+  else if(execChisq_ == 2)
+    execChisqVal_ = computeChisq2();
 }
 
 PsfImageDataSet::PsfType PsfImageDataSet::psfType(std::string type)
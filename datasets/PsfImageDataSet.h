@@ -53,6 +53,7 @@ namespace gcp {
 	void clearModel();
 	gcp::util::ChisqVariate computeChisq();
 	gcp::util::ChisqVariate computeChisq2();
+	bool computePoissChisq(gcp::util::ChisqVariate& chisq);
 
 	//------------------------------------------------------------
 	// Initialize this object from an image
@@ -60,7 +61,9 @@ namespace gcp {
 
 	void initialize(PsfImageDataSet* parent, gcp::util::Image& image, gcp::util::Image& preImage, gcp::util::Antenna& ant, gcp::util::Frequency& freq);
 	void initializeFromImage(gcp::util::Image& imageToInit, gcp::util::Image& image);
+	void initializeCoarse(PsfImageData& fine, unsigned fac);
 	void initializeErrors(gcp::util::Image& image, gcp::util::Image& preImage);
+	void initializePoissCache();
 	
 	void assignPaddedImageIfNecessary(gcp::util::Image& image);
 
@@ -70,6 +73,15 @@ namespace gcp {
 
 	void simulateData(double sigma);
 	void convolveModel();
+	void initializeConvolution();
+	void getPsfSupport(double frac, unsigned& xMargin, unsigned& yMargin);
+
+	//------------------------------------------------------------
+	// Run whichever of the convolve/chisq stages were requested
+	// (see execConvolve_ and execChisq_ below)
+	//------------------------------------------------------------
+
+	void execute();
 
 	static PSF_LK_FN(fixedErrorGauss);
 	static PSF_LK_FN(fixedErrorGaussApprox);
@@ -136,11 +148,28 @@ namespace gcp {
 	double pbSum_; 
 
 	//------------------------------------------------------------
-	// A container for holding the transform of the primary beam
+	// A container for holding the transform of the primary beam.
+	// After initializeConvolution(), the transform array holds the
+	// beam transform pre-multiplied by the centering phase and by
+	// 1/(N * pbSum_), so that convolution is a single product
+	// between forward and inverse transforms
 	//------------------------------------------------------------
 
 	gcp::util::Dft2d primaryBeamDft_;
 
+	//------------------------------------------------------------
+	// The sub-image of compositeModel_ that is transformed when
+	// convolving.  This is the whole image unless the parent's
+	// 'psfcrop' parameter restricts it to the data window plus
+	// the PSF support
+	//------------------------------------------------------------
+
+	unsigned convXStart_;
+	unsigned convYStart_;
+	unsigned convNx_;
+	unsigned convNy_;
+	bool convIsCropped_;
+
 	//------------------------------------------------------------
 	// The data for this image
 	//------------------------------------------------------------
@@ -190,12 +219,51 @@ namespace gcp {
 	PsfType psfType_;
 	gcp::util::Distribution::Type distType_;
 
+	//------------------------------------------------------------
+	// Data-only terms of the Poisson likelihood, precomputed by
+	// initializePoissCache().  The likelihood over the data window
+	// is:
+	//
+	//   lnLk = sum_nz n ln(m + b) - (sum_win m + poissBgSum_) - poissLnFactSum_
+	//
+	// where the first sum runs only over pixels with nonzero counts
+	//------------------------------------------------------------
+
+	bool hasPoissCache_;
+	std::vector<unsigned> poissInd_;    // Image indices of nonzero-count pixels
+	std::vector<double>   poissCounts_; // Counts n for those pixels
+	std::vector<double>   poissBg_;     // Background b for those pixels
+	std::vector<unsigned> poissRunStart_; // Runs of contiguous valid pixels in the window
+	std::vector<unsigned> poissRunLen_;
+	double poissBgSum_;                 // Background summed over valid window pixels
+	double poissLnFactSum_;             // sum of ln(n!) over valid window pixels
+	unsigned poissNPix_;                // Number of valid window pixels
+
 	//------------------------------------------------------------
 	// The current model offset, in radians
 	//------------------------------------------------------------
 
 	double currentXoffRad_;
 	double currentYoffRad_;
+
+	//------------------------------------------------------------
+	// Members used when this image is processed in a thread pool
+	//------------------------------------------------------------
+
+	//------------------------------------------------------------
+	// Factor by which the model is scaled, once per evaluation,
+	// before chisq is computed.  This is 1 except for coarse
+	// Poisson images, whose pixels hold the summed counts of
+	// fac x fac data pixels
+	//------------------------------------------------------------
+
+	double modelScale_;
+	bool modelIsScaled_;
+
+	unsigned execIndex_;                 // Index of this image in the parent
+	bool execConvolve_;                  // True to convolve the model
+	unsigned execChisq_;                 // 0 = none, 1 = computeChisq(), 2 = computeChisq2()
+	gcp::util::ChisqVariate execChisqVal_; // The resulting chisq
       };
 
       /**
@@ -226,6 +294,23 @@ namespace gcp {
       gcp::util::ChisqVariate accumulateChisq();
       gcp::util::ChisqVariate accumulateChisq2();
 
+      //------------------------------------------------------------
+      // Multi-thread-aware dispatch of per-image work
+      //------------------------------------------------------------
+
+      gcp::util::ChisqVariate executeAll(bool convolve, unsigned chisqType);
+      static EXECUTE_FN(execImage);
+
+      void initWait();
+      void waitUntilDone();
+
+      //------------------------------------------------------------
+      // Coarse-to-fine likelihood schedule
+      //------------------------------------------------------------
+
+      virtual unsigned setResolutionLevel(unsigned level);
+      std::vector<PsfImageData>& activeData();
+
       //------------------------------------------------------------
       // Display methods
       //------------------------------------------------------------
@@ -278,6 +363,14 @@ namespace gcp {
       std::vector<PsfImageData> data_;
       PsfType psfType_;
 
+      //------------------------------------------------------------
+      // Binned copies of data_, used in place of data_ while
+      // resLevel_ > 0
+      //------------------------------------------------------------
+
+      std::vector<PsfImageData> coarseData_;
+      unsigned resLevel_;
+
       gcp::util::ImageManager imp_;
 
     }; // End class PsfImageDataSet
@@ -0,0 +1,665 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+#include <math.h>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Constants.h"
+#include "gcp/util/Debug.h"
+#include "gcp/util/Exception.h"
+#include "gcp/util/FitsUvfReader.h"
+#include "gcp/util/Geoid.h"
+#include "gcp/util/LogStream.h"
+#include "gcp/util/ThreadPool.h"
+#include "gcp/util/Timer.h"
+
+#include "gcp/fftutil/Dft2d.h"
+#include "gcp/fftutil/FitsIoHandler.h"
+#include "gcp/fftutil/Image.h"
+#include "gcp/fftutil/ObsInfo.h"
+#include "gcp/fftutil/RunManager.h"
+
+#include "gcp/datasets/VisDataSetUvf.h"
+
+#include "gcp/models/Generic2DGaussian.h"
+#include "gcp/models/ModelManager.h"
+
+using namespace std;
+using namespace gcp::datasets;
+using namespace gcp::models;
+using namespace gcp::program;
+using namespace gcp::util;
+
+KeyTabEntry Program::keywords[] = {
+  { "dir",      ".",              "s", "Directory in which synthetic datasets and chains are written"},
+  { "out",      "bench.csv",      "s", "File to which results are written (CSV, one row per measurement)"},
+  { "tag",      "",               "s", "Label written in the first column of every row (e.g. a version string)"},
+  { "kernels",  "all",            "s", "Comma-separated list of: dft,fillimage,chisq,readdata,runmarkov,loadoutput (or 'all')"},
+  { "npix",     "64,128,256,512", "s", "Comma-separated list of grid sizes to sweep"},
+  { "nthread",  "1,2,4",          "s", "Comma-separated list of thread counts to sweep"},
+  { "nrep",     "20",             "i", "Number of timed repetitions per measurement"},
+  { "nant",     "8",              "i", "Number of antennas in the synthetic array"},
+  { "nha",      "60",             "i", "Number of 6-minute timestamps in the synthetic track"},
+  { "nfreq",    "4",              "i", "Number of IFs in the synthetic data"},
+  { "ntry",     "2000",           "i", "Number of iterations for the runmarkov benchmark"},
+  { "seed",     "1",              "i", "Seed for the synthetic noise"},
+  { END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS},
+};
+
+void Program::initializeUsage() {};
+
+//-----------------------------------------------------------------------
+// Parameters of the synthetic sky and data.  Grids are always sampled
+// at the same resolution, so that sweeping npix sweeps the field of
+// view and the number of gridded uv cells together
+//-----------------------------------------------------------------------
+
+static const double pixelArcmin_ = 0.25;
+static const double srcFluxJy_   = 0.1;
+static const double srcSigArcmin_= 1.0;
+static const double srcXArcmin_  = 0.5;
+static const double srcYArcmin_  = -0.3;
+static const double noiseJy_     = 0.05;
+
+//-----------------------------------------------------------------------
+// A local xorshift generator, so that the synthetic data are
+// bit-for-bit reproducible across platforms and library versions
+//-----------------------------------------------------------------------
+
+static unsigned int rngState_ = 1;
+
+static void seedDeviates(unsigned int seed)
+{
+  rngState_ = seed == 0 ? 1 : seed;
+}
+
+static double uniformDeviate()
+{
+  rngState_ ^= rngState_ << 13;
+  rngState_ ^= rngState_ >> 17;
+  rngState_ ^= rngState_ << 5;
+
+  return ((double)rngState_ + 0.5) / 4294967296.0;
+}
+
+static double gaussianDeviate()
+{
+  double u1 = uniformDeviate();
+  double u2 = uniformDeviate();
+
+  return sqrt(-2.0 * log(u1)) * cos(2 * M_PI * u2);
+}
+
+/**.......................................................................
+ * An accessor for the protected internals of VisDataSet, so that the
+ * per-frequency chisq can be timed without the model transform
+ */
+class BenchVisDataSet : public VisDataSetUvf {
+public:
+
+  BenchVisDataSet(ThreadPool* pool) : VisDataSetUvf(pool) {};
+
+  unsigned nFreqData() {
+    unsigned n=0;
+    for(unsigned iGroup=0; iGroup < baselineGroups_.size(); iGroup++)
+      for(unsigned iStokes=0; iStokes < baselineGroups_[iGroup].stokesData_.size(); iStokes++)
+	n += baselineGroups_[iGroup].stokesData_[iStokes].freqData_.size();
+    return n;
+  }
+};
+
+std::vector<unsigned> parseList(std::string str);
+bool doKernel(std::string kernel);
+void writeResult(std::ofstream& fout, std::string kernel, unsigned npix, unsigned nthread, unsigned n, std::vector<double>& times);
+
+unsigned generateUvfFile(std::string fileName, unsigned nAnt, unsigned nHa, unsigned nFreq);
+void generateImageFile(std::string fileName, unsigned npix);
+std::string writeRunFile(std::string dir, std::string uvfFile, unsigned npix, unsigned nThread, unsigned nTry);
+void setupModel(Generic2DGaussian& model);
+
+void benchDft2d(std::ofstream& fout, std::string dir, std::vector<unsigned>& npixs, unsigned nRep);
+void benchFillImage(std::ofstream& fout, std::vector<unsigned>& npixs, std::vector<unsigned>& nthreads, unsigned nRep);
+void benchComputeChisq(std::ofstream& fout, std::string uvfFile, std::vector<unsigned>& npixs, std::vector<unsigned>& nthreads, unsigned nRep);
+void benchReadData(std::ofstream& fout, std::string uvfFile, unsigned nRep);
+void benchRunMarkov(std::ofstream& fout, std::string dir, std::string uvfFile, std::vector<unsigned>& nthreads, unsigned nTry);
+void benchLoadOutputFile(std::ofstream& fout, std::string outFile, unsigned nRep);
+
+static std::string kernels_;
+static std::string tag_;
+
+/**.......................................................................
+ * Main -- generate synthetic datasets, then time the requested
+ * kernels over sweeps of grid size and thread count
+ */
+int Program::main()
+{
+  Debug::setLevel(Debug::DEBUGNONE);
+
+  std::string dir = Program::getStringParameter("dir");
+  kernels_        = Program::getStringParameter("kernels");
+  tag_            = Program::getStringParameter("tag");
+
+  std::vector<unsigned> npixs    = parseList(Program::getStringParameter("npix"));
+  std::vector<unsigned> nthreads = parseList(Program::getStringParameter("nthread"));
+
+  unsigned nRep  = Program::getIntegerParameter("nrep");
+  unsigned nAnt  = Program::getIntegerParameter("nant");
+  unsigned nHa   = Program::getIntegerParameter("nha");
+  unsigned nFreq = Program::getIntegerParameter("nfreq");
+  unsigned nTry  = Program::getIntegerParameter("ntry");
+
+  seedDeviates(Program::getIntegerParameter("seed"));
+
+  std::ofstream fout(Program::getStringParameter("out").c_str(), ios::out);
+
+  if(!fout) {
+    COUTCOLOR("Unable to open output file: " << Program::getStringParameter("out"), "red");
+    return 1;
+  }
+
+  fout << "tag,kernel,npix,nthread,n,nrep,min_s,median_s,mean_s" << std::endl;
+
+  try {
+
+    //------------------------------------------------------------
+    // Generate the synthetic visibility data set
+    //------------------------------------------------------------
+
+    std::string uvfFile = dir + "/benchClimax.uvf";
+    unsigned nVis = generateUvfFile(uvfFile, nAnt, nHa, nFreq);
+
+    COUT("Wrote " << nVis << " visibilities to " << uvfFile);
+
+    if(doKernel("dft"))
+      benchDft2d(fout, dir, npixs, nRep);
+
+    if(doKernel("fillimage"))
+      benchFillImage(fout, npixs, nthreads, nRep);
+
+    if(doKernel("chisq"))
+      benchComputeChisq(fout, uvfFile, npixs, nthreads, nRep);
+
+    if(doKernel("readdata"))
+      benchReadData(fout, uvfFile, nRep);
+
+    if(doKernel("runmarkov") || doKernel("loadoutput"))
+      benchRunMarkov(fout, dir, uvfFile, nthreads, nTry);
+
+    if(doKernel("loadoutput"))
+      benchLoadOutputFile(fout, dir + "/benchClimax.out", nRep);
+
+  } catch(Exception& err) {
+    COUT(err.what());
+    return 1;
+  }
+
+  return 0;
+}
+
+/**.......................................................................
+ * Parse a comma-separated list of unsigned integers
+ */
+std::vector<unsigned> parseList(std::string str)
+{
+  std::replace(str.begin(), str.end(), ',', ' ');
+
+  std::istringstream is(str);
+  std::vector<unsigned> vals;
+  unsigned val;
+
+  while(is >> val)
+    vals.push_back(val);
+
+  return vals;
+}
+
+/**.......................................................................
+ * Return true if the named kernel was requested
+ */
+bool doKernel(std::string kernel)
+{
+  if(kernels_ == "all")
+    return true;
+
+  std::string list = "," + kernels_ + ",";
+  return list.find("," + kernel + ",") != std::string::npos;
+}
+
+/**.......................................................................
+ * Write summary statistics for one measurement, to the output file
+ * and to stdout
+ */
+void writeResult(std::ofstream& fout, std::string kernel, unsigned npix, unsigned nthread, unsigned n, std::vector<double>& times)
+{
+  std::vector<double> sorted = times;
+  std::sort(sorted.begin(), sorted.end());
+
+  double mean = 0.0;
+  for(unsigned i=0; i < sorted.size(); i++)
+    mean += (sorted[i] - mean) / (i+1);
+
+  double median = sorted[sorted.size()/2];
+
+  fout << tag_ << "," << kernel << "," << npix << "," << nthread << "," << n << "," << sorted.size() << ","
+       << setprecision(6) << scientific << sorted[0] << "," << median << "," << mean << std::endl;
+
+  COUT(setw(12) << left << kernel << " npix = " << setw(5) << npix << " nthread = " << setw(3) << nthread
+       << " median = " << setprecision(3) << scientific << median << " s");
+}
+
+//-----------------------------------------------------------------------
+// Synthetic data generation
+//-----------------------------------------------------------------------
+
+/**.......................................................................
+ * Write a UVF file containing a deterministic observation of a single
+ * elliptical Gaussian source plus Gaussian noise.  Antennas lie on a
+ * spiral, so that any number of antennas gives reasonable uv
+ * coverage.  Returns the number of visibilities written
+ */
+unsigned generateUvfFile(std::string fileName, unsigned nAnt, unsigned nHa, unsigned nFreq)
+{
+  ObsInfo obs;
+
+  Lla lla;
+  lla.longitude_.setDegrees(-118);
+  lla.latitude_.setDegrees(37);
+  lla.altitude_.setMeters(2200);
+
+  obs.setArrayLocation(lla);
+  obs.setNumberOfAntennas(nAnt);
+  obs.setAntennaType(Antenna::ANT_SZA);
+
+  //------------------------------------------------------------
+  // Place antennas on a golden-angle spiral
+  //------------------------------------------------------------
+
+  for(unsigned iAnt=0; iAnt < nAnt; iAnt++) {
+    LengthTriplet enu;
+    enu.setCoordSystem(COORD_ENU);
+
+    double r     = 4.0 + 1.5 * iAnt;
+    double theta = 2.39996323 * iAnt;
+
+    enu.east_.setMeters(r * cos(theta));
+    enu.north_.setMeters(r * sin(theta));
+    enu.up_.setMeters(0.0);
+
+    obs.setAntennaLocation(enu, iAnt);
+  }
+
+  obs.setSourceName("BENCH");
+  obs.setTelescopeName("SZA");
+  obs.setInstrumentName("CLIMAX");
+
+  HourAngle ra;
+  ra.setHours(12.0);
+
+  Declination dec;
+  dec.setDegrees(30);
+
+  obs.setObsRa(ra);
+  obs.setObsDec(dec);
+  obs.setObsEquinox(2000);
+
+  //------------------------------------------------------------
+  // Centre the track on transit.  The stop HA is padded by half a
+  // step, so that exactly nHa timestamps are generated
+  //------------------------------------------------------------
+
+  HourAngle startHa, stopHa, deltaHa;
+  deltaHa.setHours(0.1);
+  startHa.setHours(-0.05 * nHa);
+  stopHa.setHours(-0.05 * nHa + 0.1 * (nHa + 0.5));
+
+  obs.setObsHa(startHa, stopHa, deltaHa);
+
+  std::vector<Frequency> freqs(nFreq), bws(nFreq);
+  for(unsigned iFreq=0; iFreq < nFreq; iFreq++) {
+    freqs[iFreq].setGHz(27.0 + iFreq * 8.0 / nFreq);
+    bws[iFreq].setMHz(500);
+  }
+
+  obs.setFrequencyInformation(freqs, bws);
+  obs.setNumberOfStokesParameters(1);
+
+  obs.initializeSimulationVisibilityArray();
+
+  //------------------------------------------------------------
+  // Use a fixed start date rather than the current time, so that the
+  // file contents do not depend on when the benchmark is run
+  //------------------------------------------------------------
+
+  obs.startJd_ = 2455197.5;
+
+  double sigRad = srcSigArcmin_ / 60 * M_PI / 180;
+  double xRad   = srcXArcmin_   / 60 * M_PI / 180;
+  double yRad   = srcYArcmin_   / 60 * M_PI / 180;
+  double wt     = 1.0 / (noiseJy_ * noiseJy_);
+
+  Geoid geoid;
+  unsigned iVisGroup = 0;
+
+  for(unsigned iHa=0; iHa < nHa; iHa++) {
+
+    HourAngle ha = startHa + (deltaHa * iHa) + (deltaHa/2);
+
+    for(unsigned iAnt1=0; iAnt1 < nAnt; iAnt1++) {
+      for(unsigned iAnt2=iAnt1+1; iAnt2 < nAnt; iAnt2++) {
+
+	LengthTriplet dxyz = obs.antennas_[iAnt2].getXyz() - obs.antennas_[iAnt1].getXyz();
+	LengthTriplet uvw  = geoid.haDecAndXyzToUvw(ha, dec, dxyz);
+
+	ObsInfo::Vis& vis = obs.visibilities_[iVisGroup++];
+
+	// Stored as negative light travel time, as VisDataSet does
+	// when simulating
+
+	vis.u_ = -uvw.u_.meters() / Constants::lightSpeed_.metersPerSec();
+	vis.v_ = -uvw.v_.meters() / Constants::lightSpeed_.metersPerSec();
+	vis.w_ = -uvw.w_.meters() / Constants::lightSpeed_.metersPerSec();
+
+	vis.baseline_ = (iAnt1+1) * 256 + (iAnt2+1);
+	vis.jd_       = obs.startJd_ + iHa * deltaHa.hours()/24;
+
+	for(unsigned iFreq=0; iFreq < nFreq; iFreq++) {
+	  double u   = uvw.u_.meters() / freqs[iFreq].meters();
+	  double v   = uvw.v_.meters() / freqs[iFreq].meters();
+	  double amp = srcFluxJy_ * exp(-2 * M_PI * M_PI * sigRad * sigRad * (u*u + v*v));
+	  double phs = -2 * M_PI * (u * xRad + v * yRad);
+
+	  vis.re_[iFreq] = amp * cos(phs) + noiseJy_ * gaussianDeviate();
+	  vis.im_[iFreq] = amp * sin(phs) + noiseJy_ * gaussianDeviate();
+	  vis.wt_[iFreq] = wt;
+	}
+      }
+    }
+  }
+
+  FitsIoHandler fitsio;
+  fitsio.setFirstTelescopeNum(1);
+  fitsio.writeUvfFile(fileName, obs);
+
+  return iVisGroup * nFreq;
+}
+
+/**.......................................................................
+ * Write a FITS image of the synthetic source plus noise
+ */
+void generateImageFile(std::string fileName, unsigned npix)
+{
+  Image image(npix, Angle(Angle::ArcMinutes(), npix * pixelArcmin_));
+
+  double sig2 = (srcSigArcmin_ * srcSigArcmin_) / (pixelArcmin_ * pixelArcmin_);
+
+  for(unsigned iy=0; iy < npix; iy++) {
+    double y = (double)iy - npix/2 - srcYArcmin_ / pixelArcmin_;
+    for(unsigned ix=0; ix < npix; ix++) {
+      double x = (double)ix - npix/2 - srcXArcmin_ / pixelArcmin_;
+      image.data_[iy * npix + ix] = srcFluxJy_ * exp(-(x*x + y*y) / (2 * sig2)) + noiseJy_ * gaussianDeviate();
+    }
+  }
+
+  image.setUnits(Unit::UNITS_JY);
+  image.setHasData(true);
+  image.writeToFitsFile(fileName);
+}
+
+/**.......................................................................
+ * Configure the Gaussian used for fillImage and chisq timing
+ */
+void setupModel(Generic2DGaussian& model)
+{
+  model.getVar("Sradio")->setVal(srcFluxJy_, "Jy");
+  model.getVar("norm")->setVal(srcFluxJy_, "Jy");
+  model.getVar("majSigma")->setVal(srcSigArcmin_, "arcmin");
+  model.getVar("axialRatio")->setVal(0.8, "");
+  model.getVar("rotang")->setVal(30.0, "degrees");
+  model.getVar("xoff")->setVal(srcXArcmin_, "arcmin");
+  model.getVar("yoff")->setVal(srcYArcmin_, "arcmin");
+}
+
+/**.......................................................................
+ * Write a run file fitting the synthetic source to the synthetic UVF
+ * file
+ */
+std::string writeRunFile(std::string dir, std::string uvfFile, unsigned npix, unsigned nThread, unsigned nTry)
+{
+  std::ostringstream os;
+  os << dir << "/benchClimax_" << nThread << ".run";
+
+  std::ofstream fout(os.str().c_str(), ios::out);
+
+  if(nThread > 1)
+    fout << "ndatathread = " << nThread << ";" << std::endl;
+
+  fout << "adddataset name=vis type=uvf;"                                        << std::endl
+       << "vis.file = " << uvfFile << ";"                                        << std::endl
+       << "vis.npix = " << npix << ";"                                           << std::endl
+       << "vis.size = " << npix * pixelArcmin_ << " arcmin;"                     << std::endl
+       << "addmodel name=src type=gauss2d;"                                      << std::endl
+       << "src.Sradio = 0:" << 10 * srcFluxJy_ << " Jy;"                         << std::endl
+       << "src.majSigma = 0.2:4 arcmin;"                                         << std::endl
+       << "src.axialRatio = 1;"                                                  << std::endl
+       << "src.rotang = 0 degrees;"                                              << std::endl
+       << "src.xoff = -2:2 arcmin;"                                              << std::endl
+       << "src.yoff = -2:2 arcmin;"                                              << std::endl
+       << "output file=" << dir << "/benchClimax.out;"                           << std::endl
+       << "ntry = " << nTry << ";"                                               << std::endl
+       << "nburn = " << nTry/5 << ";"                                            << std::endl
+       << "dev = /null;"                                                         << std::endl;
+
+  return os.str();
+}
+
+//-----------------------------------------------------------------------
+// Kernels
+//-----------------------------------------------------------------------
+
+/**.......................................................................
+ * Time forward transforms of the synthetic image.  Plans are shared
+ * through FftwPlanRegistry, so planning cost is paid before the first
+ * timed transform
+ */
+void benchDft2d(std::ofstream& fout, std::string dir, std::vector<unsigned>& npixs, unsigned nRep)
+{
+  for(unsigned iNpix=0; iNpix < npixs.size(); iNpix++) {
+    unsigned npix = npixs[iNpix];
+
+    std::ostringstream os;
+    os << dir << "/benchClimax_" << npix << ".fits";
+    generateImageFile(os.str(), npix);
+
+    Image image;
+    image.initializeFromFitsFile(os.str());
+
+    Dft2d dft(image);
+    dft.computeForwardTransform();
+
+    std::vector<double> times(nRep);
+    Timer timer;
+
+    for(unsigned iRep=0; iRep < nRep; iRep++) {
+      timer.start();
+      dft.computeForwardTransform();
+      timer.stop();
+      times[iRep] = timer.deltaInSeconds();
+    }
+
+    writeResult(fout, "dft", npix, 1, npix*npix, times);
+  }
+}
+
+/**.......................................................................
+ * Time Generic2DAngularModel::fillImage() on the radio path
+ */
+void benchFillImage(std::ofstream& fout, std::vector<unsigned>& npixs, std::vector<unsigned>& nthreads, unsigned nRep)
+{
+  Frequency freq;
+  freq.setGHz(30.0);
+
+  for(unsigned iThread=0; iThread < nthreads.size(); iThread++) {
+    unsigned nThread = nthreads[iThread];
+
+    ThreadPool* pool = 0;
+    if(nThread > 1) {
+      pool = new ThreadPool(nThread);
+      pool->spawn();
+    }
+
+    for(unsigned iNpix=0; iNpix < npixs.size(); iNpix++) {
+      unsigned npix = npixs[iNpix];
+
+      Generic2DGaussian model;
+      setupModel(model);
+      model.setThreadPool(pool);
+
+      Image image(npix, Angle(Angle::ArcMinutes(), npix * pixelArcmin_));
+
+      std::vector<double> times(nRep);
+      Timer timer;
+
+      for(unsigned iRep=0; iRep < nRep; iRep++) {
+	timer.start();
+	model.fillImage(DataSetType::DATASET_RADIO, image, &freq);
+	timer.stop();
+	times[iRep] = timer.deltaInSeconds();
+      }
+
+      writeResult(fout, "fillimage", npix, nThread, npix*npix, times);
+    }
+
+    if(pool)
+      delete pool;
+  }
+}
+
+/**.......................................................................
+ * Time VisFreqData::computeChisq(), dispatched over all frequencies of
+ * the synthetic data set by VisDataSet::accumulateChisq().  The model
+ * is installed and transformed once, outside the timed loop
+ */
+void benchComputeChisq(std::ofstream& fout, std::string uvfFile, std::vector<unsigned>& npixs, std::vector<unsigned>& nthreads, unsigned nRep)
+{
+  for(unsigned iThread=0; iThread < nthreads.size(); iThread++) {
+    unsigned nThread = nthreads[iThread];
+
+    ThreadPool* pool = 0;
+    if(nThread > 1) {
+      pool = new ThreadPool(nThread);
+      pool->spawn();
+    }
+
+    for(unsigned iNpix=0; iNpix < npixs.size(); iNpix++) {
+      unsigned npix = npixs[iNpix];
+
+      BenchVisDataSet vds(pool);
+
+      std::ostringstream npixStr, sizeStr;
+      npixStr << npix;
+      sizeStr << npix * pixelArcmin_;
+
+      vds.setName("vis");
+      vds.setParameter("file", uvfFile);
+      vds.setParameter("npix", npixStr.str());
+      vds.setParameter("size", sizeStr.str(), "arcmin");
+      vds.initializeCommonParameters();
+      vds.loadData(false);
+
+      Generic2DGaussian model;
+      setupModel(model);
+
+      vds.clearModel();
+      vds.addModel(model);
+      vds.transformModels();
+
+      std::vector<double> times(nRep);
+      Timer timer;
+
+      for(unsigned iRep=0; iRep < nRep; iRep++) {
+	timer.start();
+	vds.accumulateChisq();
+	timer.stop();
+	times[iRep] = timer.deltaInSeconds();
+      }
+
+      writeResult(fout, "chisq", npix, nThread, vds.nFreqData(), times);
+    }
+
+    if(pool)
+      delete pool;
+  }
+}
+
+/**.......................................................................
+ * Time reading every group of the synthetic UVF file
+ */
+void benchReadData(std::ofstream& fout, std::string uvfFile, unsigned nRep)
+{
+  std::vector<double> times(nRep);
+  Timer timer;
+  unsigned nGroup = 0;
+
+  for(unsigned iRep=0; iRep < nRep; iRep++) {
+    FitsUvfReader reader(uvfFile);
+    FitsUvfReader::Vis vis;
+
+    nGroup = reader.nGroup();
+
+    timer.start();
+    for(unsigned iGroup=0; iGroup < nGroup; iGroup++)
+      reader.readData(iGroup, vis);
+    timer.stop();
+
+    times[iRep] = timer.deltaInSeconds();
+  }
+
+  writeResult(fout, "readdata", 0, 1, nGroup, times);
+}
+
+/**.......................................................................
+ * Time an end-to-end Markov chain fitting the synthetic source.  Only
+ * the time spent in runMarkov() is reported, not data loading
+ */
+void benchRunMarkov(std::ofstream& fout, std::string dir, std::string uvfFile, std::vector<unsigned>& nthreads, unsigned nTry)
+{
+  unsigned npix = 128;
+
+  for(unsigned iThread=0; iThread < nthreads.size(); iThread++) {
+    unsigned nThread = nthreads[iThread];
+
+    RunManager rm;
+    rm.setRunFile(writeRunFile(dir, uvfFile, npix, nThread, nTry));
+    rm.run();
+
+    std::vector<double> times(1, rm.getMarkovRunTime());
+    writeResult(fout, "runmarkov", npix, nThread, nTry, times);
+  }
+}
+
+/**.......................................................................
+ * Time loading the chain written by the runmarkov benchmark
+ */
+void benchLoadOutputFile(std::ofstream& fout, std::string outFile, unsigned nRep)
+{
+  std::vector<double> times(nRep);
+  Timer timer;
+  unsigned nAccepted = 0;
+
+  for(unsigned iRep=0; iRep < nRep; iRep++) {
+    ModelManager mm;
+    mm.initializeForOutput("");
+
+    timer.start();
+    mm.loadOutputFile(outFile, "", 0);
+    timer.stop();
+
+    times[iRep]  = timer.deltaInSeconds();
+    nAccepted    = mm.nAccepted_;
+  }
+
+  writeResult(fout, "loadoutput", 0, 1, nAccepted, times);
+}
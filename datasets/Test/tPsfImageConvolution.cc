@@ -0,0 +1,198 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+
+#include "gcp/fftutil/Dft2d.h"
+#include "gcp/fftutil/Image.h"
+
+#include "gcp/datasets/PsfImageDataSet.h"
+
+using namespace std;
+using namespace gcp::datasets;
+using namespace gcp::program;
+using namespace gcp::util;
+
+KeyTabEntry Program::keywords[] = {
+  { "npix",     "128",              "i", "Number of pixels on a side of the image"},
+  { "sigma",    "2",                "d", "Sigma of the gaussian PSF (pixels)"},
+  { "nwin",     "32",               "i", "Number of pixels on a side of the data window"},
+  { "psfcrop",  "1e-10",            "d", "Fraction of the PSF peak passed as 'psfcrop'"},
+  { "tol",      "1e-5",             "d", "Tolerance, as a fraction of the peak"},
+  { END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS},
+};
+
+void Program::initializeUsage() {};
+
+Image referenceConvolution(Image& model, Image& psf);
+void initializeData(PsfImageDataSet::PsfImageData& data, PsfImageDataSet& parent, Image& model, Image& psf,
+		    unsigned iXStart, unsigned iYStart, unsigned nwin);
+double maxDifference(Image& image1, Image& image2, unsigned iXStart, unsigned iYStart, unsigned nwin);
+
+int Program::main()
+{
+  unsigned npix = Program::getIntegerParameter("npix");
+  unsigned nwin = Program::getIntegerParameter("nwin");
+  double sigma  = Program::getDoubleParameter("sigma");
+  double tol    = Program::getDoubleParameter("tol");
+
+  //------------------------------------------------------------
+  // A gaussian PSF, centered in the image, and a random model that
+  // covers the whole image, with bright pixels on the edges
+  //------------------------------------------------------------
+
+  Angle size;
+  size.setDegrees(1.0);
+
+  Image psf;
+  psf.createGaussianImage(npix, npix, sigma);
+  psf.setAngularSize(size);
+
+  Image model;
+  model.createUniformImage(npix, npix);
+  model.setAngularSize(size);
+
+  srand(1);
+
+  for(unsigned i=0; i < npix*npix; i++)
+    model.data_[i] = (float)rand() / RAND_MAX;
+
+  model.data_[(npix/2) * npix]            = 100.0;
+  model.data_[(npix/2) * npix + npix - 1] = 100.0;
+  model.data_[npix/2]                     = 100.0;
+
+  Image reference = referenceConvolution(model, psf);
+
+  double peak = 0.0;
+  for(unsigned i=0; i < npix*npix; i++)
+    peak = fabs(reference.data_[i]) > peak ? fabs(reference.data_[i]) : peak;
+
+  //------------------------------------------------------------
+  // Full-image convolution should match the reference everywhere,
+  // and conserve the model sum
+  //------------------------------------------------------------
+
+  PsfImageDataSet fullParent;
+  PsfImageDataSet::PsfImageData full;
+  initializeData(full, fullParent, model, psf, 0, 0, npix);
+
+  full.convolveModel();
+
+  double diff = maxDifference(full.compositeModel_, reference, 0, 0, npix);
+  double sumDiff = fabs(full.compositeModel_.sum() - model.sum()) / model.sum();
+
+  COUT("Full convolution: max difference = " << diff << " (peak = " << peak << "), fractional sum difference = " << sumDiff);
+
+  if(full.convIsCropped_)
+    ThrowError("Convolution was cropped with no 'psfcrop' parameter");
+
+  if(diff > tol * peak || sumDiff > tol)
+    ThrowError("Full convolution differs from the reference");
+
+  //------------------------------------------------------------
+  // Cropped convolution, for a window in the middle of the image,
+  // and for windows touching each edge and corner.  Wherever the
+  // window lies, it should match the reference within the window
+  //------------------------------------------------------------
+
+  unsigned starts[3] = {0, (npix - nwin)/2, npix - nwin};
+
+  for(unsigned i=0; i < 3; i++) {
+    for(unsigned j=0; j < 3; j++) {
+
+      PsfImageDataSet cropParent;
+      cropParent.setParameter("psfcrop", Program::getStringParameter("psfcrop"));
+
+      PsfImageDataSet::PsfImageData crop;
+      initializeData(crop, cropParent, model, psf, starts[i], starts[j], nwin);
+
+      if(!crop.convIsCropped_)
+	ThrowError("Convolution was not cropped for a " << nwin << " x " << nwin << " window");
+
+      crop.convolveModel();
+
+      diff = maxDifference(crop.compositeModel_, reference, starts[i], starts[j], nwin);
+
+      COUT("Window at (" << starts[i] << ", " << starts[j] << "), " << crop.convNx_ << " x " << crop.convNy_
+	   << " transform starting at (" << crop.convXStart_ << ", " << crop.convYStart_ << "): max difference = " << diff);
+
+      if(diff > tol * peak)
+	ThrowError("Cropped convolution for the window at (" << starts[i] << ", " << starts[j] << ") differs from the reference");
+    }
+  }
+
+  COUT("PSF convolution tests passed");
+
+  return 0;
+}
+
+/**.......................................................................
+ * Convolve a model with a PSF using full-image transforms, as
+ * PsfImageData did before its PSF transform was cached
+ */
+Image referenceConvolution(Image& model, Image& psf)
+{
+  Dft2d psfDft;
+  psfDft = psf;
+  psfDft.initialize(psf);
+  psfDft.normalize(true);
+  psfDft.computeForwardTransform();
+
+  Dft2d modelDft;
+  modelDft = model;
+  modelDft.initialize(model);
+  modelDft.normalize(true);
+  modelDft.computeForwardTransform();
+
+  modelDft.complexMultiply(psfDft, false);
+  modelDft.shift();
+
+  modelDft.computeInverseTransform();
+
+  return modelDft.getImage(false) / psf.sum();
+}
+
+/**.......................................................................
+ * Set up a PsfImageData with a data window of nwin x nwin pixels
+ * starting at (iXStart, iYStart), and initialize its convolution
+ */
+void initializeData(PsfImageDataSet::PsfImageData& data, PsfImageDataSet& parent, Image& model, Image& psf,
+		    unsigned iXStart, unsigned iYStart, unsigned nwin)
+{
+  data.parent_  = &parent;
+  data.psfType_ = PsfImageDataSet::PSF_GAUSS;
+
+  data.primaryBeam_ = psf;
+  data.pbSum_       = psf.sum();
+
+  data.iXStart_ = iXStart;
+  data.iYStart_ = iYStart;
+  data.nX_      = iXStart + nwin;
+  data.nY_      = iYStart + nwin;
+
+  data.initializeConvolution();
+
+  data.compositeModel_ = model;
+}
+
+/**.......................................................................
+ * Return the largest absolute difference between two images, over
+ * the window of nwin x nwin pixels starting at (iXStart, iYStart)
+ */
+double maxDifference(Image& image1, Image& image2, unsigned iXStart, unsigned iYStart, unsigned nwin)
+{
+  unsigned nx = image1.xAxis().getNpix();
+  double maxDiff = 0.0;
+
+  for(unsigned iy=iYStart; iy < iYStart + nwin; iy++) {
+    for(unsigned ix=iXStart; ix < iXStart + nwin; ix++) {
+      double diff = fabs(image1.data_[iy * nx + ix] - image2.data_[iy * nx + ix]);
+      maxDiff = diff > maxDiff ? diff : maxDiff;
+    }
+  }
+
+  return maxDiff;
+}
@@ -2,6 +2,7 @@
 
 #include "gcp/fftutil/Dft2d.h"
 #include "gcp/fftutil/FitsIoHandler.h"
+#include "gcp/fftutil/PrimaryBeamCache.h"
 
 #include "gcp/models/PtSrcModel.h"
 #include "gcp/models/Generic2DGaussian.h"
@@ -14,6 +15,8 @@
 #include "gcp/util/Exception.h"
 #include "gcp/util/FitsBinTableReader.h"
 #include "gcp/util/HourAngle.h"
+#include "gcp/util/PerfCounters.h"
+#include "gcp/util/Profiler.h"
 #include "gcp/util/RangeParser.h"
 #include "gcp/util/Sampler.h"
 #include "gcp/util/String.h"
@@ -22,6 +25,9 @@
 
 #include "cpgplot.h"
 
+#include <algorithm>
+#include <sstream>
+
 using namespace gcp::datasets;
 using namespace gcp::util;
 using namespace std;
@@ -44,6 +50,7 @@ double cct1=0.0, cct2=0.0, cct3=0.0;
 #endif
 
 Mutex VisDataSet::VisExecData::dataAccessGuard_;
+VisDataSet::ScratchImagePool VisDataSet::scratchImages_;
 
 //=======================================================================
 // Methods of VisDataSet
@@ -55,6 +62,7 @@ Mutex VisDataSet::VisExecData::dataAccessGuard_;
 VisDataSet::VisDataSet(gcp::util::ThreadPool* pool) 
 {
   pool_                      = pool;
+  sharedSky_                 = 0;
   storeDataInternally_       = false;
   releaseDataAfterReadin_    = true;
   estimateErrInMeanFromData_ = false;
@@ -78,6 +86,7 @@ VisDataSet::VisDataSet(gcp::util::ThreadPool* pool)
   usePerc_                   = true;
   percentCorrelation_        = 0.95;
   forceWt_                   = false;
+  gridKernelType_            = Dft2d::CONV_GAUSSIAN;
 
   wtSumTotal_                = 0.0;
 
@@ -87,6 +96,9 @@ VisDataSet::VisDataSet(gcp::util::ThreadPool* pool)
   xShift_.setRadians(0.0);
   yShift_.setRadians(0.0);
 
+  simNHa_                    = 0;
+  simNBaseline_              = 0;
+
   datasets_.resize(0);
 
   addParameter("perc",           DataType::DOUBLE,  "If assigned, only grid together data that are at least this correlated"); 
@@ -114,9 +126,12 @@ VisDataSet::VisDataSet(gcp::util::ThreadPool* pool)
   addParameter("cleaniter",      DataType::UINT,    "If clean=true and cleantype=delta, the number of clean iterations to perform (default is 100)");
   addParameter("cleangain",      DataType::DOUBLE,  "If clean=true and cleantype=delta, the clean gain to use when subtracting model components (default is 0.05)");
   addParameter("cleancutoff",    DataType::DOUBLE,  "If clean=true and cleantype=delta, then cleaning will stop when the maximum absolute residual reaches this value (Jy).  Default is no cutoff (0.0)");
+  addParameter("cleanminor",     DataType::UINT,    "If clean=true and cleantype=delta, the maximum number of components to subtract in the image plane before the residual visibilities are re-imaged (default is 100).  Use cleanminor = 1 to re-image after every component");
+  addParameter("cleanpatch",     DataType::UINT,    "If clean=true and cleantype=delta, the half-width (in pixels) of the dirty beam patch subtracted in the image plane.  Default (0) is to use the whole beam");
   addParameter("cleanwindow",    DataType::STRING,  "If clean=true and cleantype=delta, and no model is specified, then this sets a clean window to be searched to iteratively build up a model.  Format is: 'cleanwindow = [xmin:xmax, ymin:ymax, units]', or 'cleanwindow = [xpos +- xdelta, ypos +- ydelta, units]', where 'units' are the units in which the window is specified.  Alternately, 'cleanwindow = [tag +- delta, units]' can be used, where tag is one of: 'min', 'max' or 'abs' to set up a clean window about the minimum, maximum or absolute maximum in the image. Use 'cleanwindow += [xmin:xmax, ymin:ymax, units]' to specify more than one clean window.");
   addParameter("datauvf",        DataType::STRING,  "UVF file to output data visibilities");  
   addParameter("resuvf",         DataType::STRING,  "UVF file to output residual visibilities");  
+  addParameter("gridkernel",     DataType::STRING,  "The kernel used to convolve this dataset's visibilities onto the uv grid, when compiled with interpolated gridding, one of: 'gaussian' or 'spheroidal' (default is 'gaussian').  Model visibilities are always read out with the gaussian kernel");
   addParameter("modeluvf",       DataType::STRING,  "UVF file to output model visibilities");  
 
   remParameter("file");
@@ -131,6 +146,8 @@ VisDataSet::VisDataSet(gcp::util::ThreadPool* pool)
   setParameter("cleangain",   "0.05");
   setParameter("cleantype",   "model");
   setParameter("cleancutoff", "0.0");
+  setParameter("cleanminor",  "100");
+  setParameter("cleanpatch",  "0");
 
   dataSetType_ = DataSetType::DATASET_2D | DataSetType::DATASET_RADIO;
 
@@ -667,6 +684,10 @@ void VisDataSet::parseParameters()
     forceWt_ = getBoolVal("forcewt");
   }
 
+  if(getParameter("gridkernel", false)->data_.hasValue()) {
+    gridKernelType_ = Dft2d::parseConvolutionKernel(getStringVal("gridkernel"));
+  }
+
   if(getParameter("store", false)->data_.hasValue()) {
     bool store = getBoolVal("store");
     storeDataInternallyOnReadin(store);
@@ -1412,6 +1433,22 @@ void VisDataSet::accumulateMoments(std::string fileName, bool first, bool init,
 
   std::cout << "\rReading...100%\r                   ";
 
+  //------------------------------------------------------------
+  // Grid any visibilities that were buffered on read.  These will
+  // have been accumulated into the destination object's frequencies
+  //------------------------------------------------------------
+
+  for(unsigned iGroup=0; iGroup < vds.baselineGroups_.size(); iGroup++) {
+    VisBaselineGroup& groupData = vds.baselineGroups_[iGroup];
+
+    for(unsigned iStokes=0; iStokes < groupData.stokesData_.size(); iStokes++) {
+      VisStokesData& stokesData = groupData.stokesData_[iStokes];
+
+      for(unsigned iFreq=0; iFreq < stokesData.freqData_.size(); iFreq++)
+	stokesData.freqData_[iFreq].gridBufferedVis(first, gridKernelType_, pool_);
+    }
+  }
+
   //------------------------------------------------------------
   // If data were read in from the file, close the file now
   //------------------------------------------------------------
@@ -1482,11 +1519,16 @@ void VisDataSet::calculateErrorInMean()
 
 	//------------------------------------------------------------
 	// Now that the gridded data index array has been populated,
-	// copy it into the model component objects too
+	// copy it into the model component objects too (if they have
+	// been sized yet -- if not, this will happen when they are)
 	//------------------------------------------------------------
 
-	freqData.fourierModelComponent_.assignPopulatedIndicesFrom(freqData.griddedData_);
-	freqData.compositeFourierModelDft_.assignPopulatedIndicesFrom(freqData.griddedData_);
+	freqData.fourierModelUsesAllIndices_ = false;
+
+	if(freqData.fourierModelInitialized_) {
+	  freqData.fourierModelComponent_.assignPopulatedIndicesFrom(freqData.griddedData_);
+	  freqData.compositeFourierModelDft_.assignPopulatedIndicesFrom(freqData.griddedData_);
+	}
       }
     }
   }
@@ -1674,6 +1716,10 @@ void VisDataSet::determineUniqueBaselineGroupings(ObsInfo& obs)
 
 	freqData.execData_ = new VisExecData(this, &freqData, iGroup, iStokes, iFreq);
 
+	std::ostringstream label;
+	label << name_ << " group " << iGroup << " stokes " << iStokes << " freq " << iFreq;
+	freqData.profileLabel_ = label.str();
+
 	//------------------------------------------------------------
 	// Also calculate the estimated primary beam for this group
 	// and frequency, and store the max over all baseline groups
@@ -2001,6 +2047,14 @@ void VisDataSet::addModel(Model& model)
   }
 }
 
+/**.......................................................................
+ * Install a sky shared with the other pointings of a mosaic
+ */
+void VisDataSet::setSharedSky(MosaicSky* sky)
+{
+  sharedSky_ = sky;
+}
+
 /**.......................................................................
  * Multi-thread-aware version of addModel
  */
@@ -2008,7 +2062,7 @@ void VisDataSet::addModelMultiThread(VisFreqData& vfd, Generic2DAngularModel& mo
 				     unsigned iGroup, unsigned iStokes, unsigned iFreq)
 {
   if(!pool_) {
-    vfd.addModel(model);
+    vfd.addModel(model, sharedSky_);
   } else {
     VisExecData* ved = vfd.execData_;
     ved->initialize(&model);
@@ -2028,7 +2082,7 @@ EXECUTE_FN(VisDataSet::execAddModel)
   VisFreqData*           vfd   = ved->vfd_;
   Generic2DAngularModel* model = ved->model_;
 
-  vfd->addModel(*model);
+  vfd->addModel(*model, vds->sharedSky_);
   vds->registerDone(ved->iGroup_, ved->iStokes_, ved->iFreq_);
 }
 
@@ -2083,6 +2137,34 @@ ChisqVariate VisDataSet::computeChisq()
   return chisq;
 }
 
+/**.......................................................................
+ * Switch all frequencies to the requested resolution level (0 = full
+ * resolution), returning the coarsest level actually applied
+ */
+unsigned VisDataSet::setResolutionLevel(unsigned level)
+{
+  unsigned applied = 0;
+
+  for(unsigned iGroup=0; iGroup < baselineGroups_.size(); iGroup++) {
+    VisBaselineGroup& groupData = baselineGroups_[iGroup];
+
+    for(unsigned iStokes=0; iStokes < groupData.stokesData_.size(); iStokes++) {
+      VisStokesData& stokesData = groupData.stokesData_[iStokes];
+      
+      for(unsigned iFreq=0; iFreq < stokesData.freqData_.size(); iFreq++) {
+	VisFreqData& freqData = stokesData.freqData_[iFreq];
+
+	if(freqData.hasData()) {
+	  unsigned freqLevel = freqData.setResolutionLevel(level);
+	  applied = freqLevel > applied ? freqLevel : applied;
+	}
+      }
+    }
+  }
+
+  return applied;
+}
+
 /**.......................................................................
  * Transform models
  */
@@ -2199,10 +2281,11 @@ void VisDataSet::accumulate(VisDataSet::AccumulatorType type)
 	VisFreqData& freqData = stokesData.freqData_[iFreq];
 
 	if(freqData.hasData()) {
-	  freqData.utilityGridder_.initializeForFirstMoments();
-	  freqData.accumulate(freqData.utilityGridder_, type);
-	  freqData.utilityGridder_.shift();
-	  freqData.utilityGridder_.computeInverseTransform();
+	  UvDataGridder& gridder = freqData.getUtilityGridder();
+	  gridder.initializeForFirstMoments();
+	  freqData.accumulate(gridder, type);
+	  gridder.shift();
+	  gridder.computeInverseTransform();
 	}
       }
     }
@@ -2271,14 +2354,19 @@ void VisDataSet::accumulateBeamCorrectedImage(Image& image, Image& wtimage)
 
 	  Angle sigma(Angle::Radians(), (1.22 * wave.meters() / diameter.meters()) / sqrt(8*log(2.0)));
 
-	  Image& pb = freqData.primaryBeam_;
+	  Image& pb = freqData.primaryBeam();
 	  double wt = freqData.griddedData_.wtSumTotal_;
-	  Image currImage = freqData.utilityGridder_.getImage(false);
+	  Image incrNum = freqData.getUtilityGridder().getImage(false);
+
+	  // Weight in place, rather than building (pb * image) * wt
+	  // from temporaries
 
-	  // Zero this image beyond the specified radius
+	  incrNum.multiply(pb, wt);
 
-	  Image incrNum = (pb * currImage) * wt;
-	  Image incrDen = (pb * pb) * wt;
+	  Image incrDen = pb;
+	  incrDen.multiply(pb, wt);
+
+	  // Zero these images beyond the specified radius
 
 	  incrNum.setRaDecFft(ra_, dec_);
 	  incrDen.setRaDecFft(ra_, dec_);
@@ -2820,7 +2908,6 @@ void VisDataSet::initializeStoreParameters()
 void VisDataSet::initializeVisibilityArrays(Image& image)
 {
   UvDataGridder* max = 0;
-  UvDataGridder* planGridder = 0;
 
   for(unsigned iGroup=0; iGroup < baselineGroups_.size(); iGroup++) {
     VisBaselineGroup& group = baselineGroups_[iGroup];
@@ -2835,7 +2922,7 @@ void VisDataSet::initializeVisibilityArrays(Image& image)
 	// Resize images and dfts to match the passed image
 	//------------------------------------------------------------
 
-	freqData.resize(image, obsWasSet_, &planGridder);
+	freqData.resize(image, obsWasSet_);
 
 	UvDataGridder* curr = &freqData.griddedData_;
 
@@ -2884,7 +2971,25 @@ void VisDataSet::computePrimaryBeams()
 	freqData.generatingFakeData_ = obsWasSet_;
 
 	if(freqData.hasData()) {
-	  computePrimaryBeamMultiThread(freqData, ant1, ant2, iGroup, iStokes, iFreq);
+
+	  //------------------------------------------------------------
+	  // If an earlier Stokes parameter at this frequency will have
+	  // an identical beam, share it rather than computing a copy
+	  //------------------------------------------------------------
+
+	  freqData.unsharePrimaryBeam();
+
+	  for(unsigned iPrev=0; iPrev < iStokes; iPrev++) {
+	    VisStokesData& prevStokes = group.stokesData_[iPrev];
+
+	    if(iFreq < prevStokes.freqData_.size() && freqData.canSharePrimaryBeamWith(prevStokes.freqData_[iFreq])) {
+	      freqData.sharePrimaryBeamWith(prevStokes.freqData_[iFreq]);
+	      break;
+	    }
+	  }
+
+	  if(!freqData.sharedBeam_)
+	    computePrimaryBeamMultiThread(freqData, ant1, ant2, iGroup, iStokes, iFreq);
 
 	  std::cout << "\rComputing beams for group " << group << " frequency = " 
 		    << setw(5) << std::setprecision(2) << std::fixed << std::left << std::setfill('0') 
@@ -2901,6 +3006,24 @@ void VisDataSet::computePrimaryBeams()
   waitUntilDone();
 }
 
+/**.......................................................................
+ * Give every VisFreqData its own copy of any primary beam it shares
+ * with another Stokes parameter
+ */
+void VisDataSet::unsharePrimaryBeams()
+{
+  for(unsigned iGroup=0; iGroup < baselineGroups_.size(); iGroup++) {
+    VisBaselineGroup& group = baselineGroups_[iGroup];
+
+    for(unsigned iStokes=0; iStokes < group.stokesData_.size(); iStokes++) {
+      VisStokesData& stokesData = group.stokesData_[iStokes];
+
+      for(unsigned iFreq=0; iFreq < stokesData.freqData_.size(); iFreq++)
+	stokesData.freqData_[iFreq].unsharePrimaryBeam();
+    }
+  }
+}
+
 /**.......................................................................
  * Compute the synthesized beam for this dataset
  */
@@ -3037,8 +3160,8 @@ void VisDataSet::computePrimaryBeamMultiThread(VisFreqData& vfd, Antenna& ant1,
         if(!vfd.primaryBeam_.hasData()) {
           
           if(vfd.wtSums_[i] > 0.0) {
-            vfd.primaryBeam_  = ant1.getRealisticApertureField(vfd.primaryBeam_, vfd.frequency_, vfd.xShifts_[i], vfd.yShifts_[i]);
-            vfd.primaryBeam_ *= ant2.getRealisticApertureField(vfd.primaryBeam_, vfd.frequency_, vfd.xShifts_[i], vfd.yShifts_[i]);
+            vfd.primaryBeam_  = PrimaryBeamCache::getApertureField(ant1, vfd.primaryBeam_, vfd.frequency_, vfd.xShifts_[i], vfd.yShifts_[i]);
+            vfd.primaryBeam_ *= PrimaryBeamCache::getApertureField(ant2, vfd.primaryBeam_, vfd.frequency_, vfd.xShifts_[i], vfd.yShifts_[i]);
             wtSumTotal = vfd.wtSums_[i];
           }
 
@@ -3050,8 +3173,8 @@ void VisDataSet::computePrimaryBeamMultiThread(VisFreqData& vfd, Antenna& ant1,
           double wtCurr = vfd.wtSums_[i];
           double wtPrev = wtSumTotal;
           
-          pbCurr  = ant1.getRealisticApertureField(vfd.primaryBeam_, vfd.frequency_, vfd.xShifts_[i], vfd.yShifts_[i]);
-          pbCurr *= ant2.getRealisticApertureField(vfd.primaryBeam_, vfd.frequency_, vfd.xShifts_[i], vfd.yShifts_[i]);
+          pbCurr  = PrimaryBeamCache::getApertureField(ant1, vfd.primaryBeam_, vfd.frequency_, vfd.xShifts_[i], vfd.yShifts_[i]);
+          pbCurr *= PrimaryBeamCache::getApertureField(ant2, vfd.primaryBeam_, vfd.frequency_, vfd.xShifts_[i], vfd.yShifts_[i]);
           
           pbPrev *= wtPrev;
           pbCurr *= wtCurr;
@@ -3072,8 +3195,8 @@ void VisDataSet::computePrimaryBeamMultiThread(VisFreqData& vfd, Antenna& ant1,
       // beam sum, which can save us some time
       
     } else {
-      vfd.primaryBeam_  = ant1.getRealisticApertureField(vfd.primaryBeam_, vfd.frequency_);
-      vfd.primaryBeam_ *= ant2.getRealisticApertureField(vfd.primaryBeam_, vfd.frequency_);
+      vfd.primaryBeam_  = PrimaryBeamCache::getApertureField(ant1, vfd.primaryBeam_, vfd.frequency_);
+      vfd.primaryBeam_ *= PrimaryBeamCache::getApertureField(ant2, vfd.primaryBeam_, vfd.frequency_);
     }
 
   } else {
@@ -3121,8 +3244,8 @@ EXECUTE_FN(VisDataSet::execComputePrimaryBeam)
     for(unsigned i=0; i < vfd->wtSums_.size(); i++) {
       if(!vfd->primaryBeam_.hasData()) {
         if(vfd->wtSums_[i] > 0.0) {
-          vfd->primaryBeam_  = ant1->getRealisticApertureField(vfd->primaryBeam_, vfd->frequency_, vfd->xShifts_[i], vfd->yShifts_[i]);
-          vfd->primaryBeam_ *= ant2->getRealisticApertureField(vfd->primaryBeam_, vfd->frequency_, vfd->xShifts_[i], vfd->yShifts_[i]);
+          vfd->primaryBeam_  = PrimaryBeamCache::getApertureField(*ant1, vfd->primaryBeam_, vfd->frequency_, vfd->xShifts_[i], vfd->yShifts_[i]);
+          vfd->primaryBeam_ *= PrimaryBeamCache::getApertureField(*ant2, vfd->primaryBeam_, vfd->frequency_, vfd->xShifts_[i], vfd->yShifts_[i]);
           wtSumTotal = vfd->wtSums_[i];
         }
         
@@ -3133,8 +3256,8 @@ EXECUTE_FN(VisDataSet::execComputePrimaryBeam)
         double wtCurr = vfd->wtSums_[i];
         double wtPrev = wtSumTotal;
         
-        pbCurr  = ant1->getRealisticApertureField(vfd->primaryBeam_, vfd->frequency_, vfd->xShifts_[i], vfd->yShifts_[i]);
-        pbCurr *= ant2->getRealisticApertureField(vfd->primaryBeam_, vfd->frequency_, vfd->xShifts_[i], vfd->yShifts_[i]);
+        pbCurr  = PrimaryBeamCache::getApertureField(*ant1, vfd->primaryBeam_, vfd->frequency_, vfd->xShifts_[i], vfd->yShifts_[i]);
+        pbCurr *= PrimaryBeamCache::getApertureField(*ant2, vfd->primaryBeam_, vfd->frequency_, vfd->xShifts_[i], vfd->yShifts_[i]);
         
         pbPrev *= wtPrev;
         pbCurr *= wtCurr;
@@ -3145,8 +3268,8 @@ EXECUTE_FN(VisDataSet::execComputePrimaryBeam)
       }
     }
   } else {
-    vfd->primaryBeam_  = ant1->getRealisticApertureField(vfd->primaryBeam_, vfd->frequency_);
-    vfd->primaryBeam_ *= ant2->getRealisticApertureField(vfd->primaryBeam_, vfd->frequency_);
+    vfd->primaryBeam_  = PrimaryBeamCache::getApertureField(*ant1, vfd->primaryBeam_, vfd->frequency_);
+    vfd->primaryBeam_ *= PrimaryBeamCache::getApertureField(*ant2, vfd->primaryBeam_, vfd->frequency_);
   }
   
   vds->registerDone(ved->iGroup_, ved->iStokes_, ved->iFreq_);
@@ -3363,35 +3486,61 @@ fillSimulationVisibilityArray(ObsInfo& obs)
   // Now start simulating data
   //------------------------------------------------------------
 
-  Geoid geoid;
   unsigned iVisGroup = 0;
   Flux noiseRms0, noiseRms, reNoise, imNoise;
   Frequency bw0;
 
   obs.calculateStartJd();
 
-  //------------------------------------------------------------  
-  // Iterate over timestamps
-  //------------------------------------------------------------
-
   HourAngle startHa = obs.getStartHa();
-  HourAngle stopHa  = obs.getStopHa();
   HourAngle deltaHa = obs.getDeltaHa();
   HourAngle ha;
   Time dt;
 
-  gcp::util::Lla lla = obs.getArrayLocation();
-  Declination dec = obs.obsDec_;
-  gcp::util::PolarLengthVector azel;
-
   dt.setSeconds(deltaHa.seconds() * Constants::utSecPerSiderealSec_);
 
-  unsigned nHa = (unsigned)((stopHa - startHa) / deltaHa);
+  //------------------------------------------------------------
+  // Compute the uvw track of every baseline, then interpolate the
+  // noiseless model visibilities along those tracks.  Both steps
+  // are independent per hour angle block and per frequency, and
+  // run on the thread pool if we have one
+  //------------------------------------------------------------
+
+#ifdef SIM_TIMER_TEST
+  t4.start();
+#endif
+
+  computeSimulationTracks(obs);
+
+#ifdef SIM_TIMER_TEST
+  t4.stop();
+  t4time += t4.deltaInSeconds();
+  t5.start();
+#endif
+
+  simulateModelVisibilities();
+
+#ifdef SIM_TIMER_TEST
+  t5.stop();
+  t5time += t5.deltaInSeconds();
+#endif
+
+  //------------------------------------------------------------
+  // Now iterate over timestamps, adding noise and storing the
+  // results.  This is done serially, in the same order as the
+  // visibilities are written, so that a given random seed always
+  // produces the same noise realization
+  //------------------------------------------------------------
+
+  unsigned nHa = simNHa_;
+  unsigned nHaPerPrint = nHa > 20 ? nHa/20 : 1;
 
   for(unsigned iHa=0; iHa < nHa; iHa++) {
 
-    std::cout << "\rComputing iHa = " << iHa << " of " << nHa;
-    fflush(stdout);
+    if(iHa % nHaPerPrint == 0) {
+      std::cout << "\rComputing iHa = " << iHa << " of " << nHa;
+      fflush(stdout);
+    }
 
     //------------------------------------------------------------
     // Compute the current HA
@@ -3400,13 +3549,12 @@ fillSimulationVisibilityArray(ObsInfo& obs)
     ha = (startHa) + (deltaHa * iHa) + (deltaHa/2);
 
     //------------------------------------------------------------
-    // Compute the current Az/El.  Although this is technically
-    // different for different antennas, to speed up the calculation
-    // we just compute it for the array center and assume all antennas
-    // have the same Az/El
+    // The Az/El was computed for the array center.  Although this is
+    // technically different for different antennas, to speed up the
+    // calculation we assume all antennas have the same Az/El
     //------------------------------------------------------------
 
-    azel = geoid.geodeticLlaAndHaDecToAzEl(lla, ha, dec);
+    gcp::util::PolarLengthVector& azel = simAzEl_[iHa];
     
     //------------------------------------------------------------
     // Iterate over all baseline groups for this timestamp
@@ -3429,27 +3577,15 @@ fillSimulationVisibilityArray(ObsInfo& obs)
 	Antenna* ant2 = baseline.ant2_;
 	
 	//------------------------------------------------------------
-	// Store the XYZ coordinates of this baseline
+	// Look up the UVW coordinate that corresponds to the current
+	// HA
 	//------------------------------------------------------------
-	
-#ifdef SIM_TIMER_TEST
-	t4.start();
-#endif
 
-	LengthTriplet xyz1 = ant1->getXyz();
-	LengthTriplet xyz2 = ant2->getXyz();
-	LengthTriplet dxyz = xyz2 - xyz1;
+	double* uvw = &simUvw_[(iHa * simNBaseline_ + simGroupOffset_[iBaseGroup] + iBase) * 3];
 
-#ifdef SIM_TIMER_TEST
-	t4.stop();
-	t4time += t4.deltaInSeconds();
-#endif
-	//------------------------------------------------------------
-	// Compute the UVW coordinate that corresponds to the
-	// current HA
-	//------------------------------------------------------------
-	    
-	LengthTriplet uvw = geoid.haDecAndXyzToUvw(ha, obs.obsDec_, dxyz);
+	// Index of this point in the group's model visibility arrays
+
+	unsigned iTrack = iHa * nBaseline + iBase;
 
 	//------------------------------------------------------------
 	// Iterate over all Stokes parameters for this baseline
@@ -3489,44 +3625,14 @@ fillSimulationVisibilityArray(ObsInfo& obs)
 	  for(unsigned iFreq=0; iFreq < nFreq; iFreq++) {
 	    
 #ifdef SIM_TIMER_TEST
-	    t5.start();
+	    t6.start();
 #endif
 
 	    VisFreqData& freqData = stokesData.freqData_[iFreq];
-	    Frequency& freq = freqData.frequency_;
-	    
-	    // Convert to u and v in units of wavelength
-
-	    double u = uvw.u_.meters() / freq.meters();
-	    double v = uvw.v_.meters() / freq.meters();
-	    
-	    // Finally, interpolate the visibility
-	    
-	    double re=0.0, im=0.0;
-	    double reIp=0.0, imIp=0.0;
-	    double reFp=0.0, imFp=0.0;
-	    bool validIp=true, validFp=true, valid;
-	    
-	    //------------------------------------------------------------
-	    // Interpolate data from the composite Image and
-	    // Fourier-plane models
-	    //------------------------------------------------------------
 
-	    if(freqData.compositeImageModelDft_.hasData_) 
-	      freqData.compositeImageModelDft_.interpolateReImData(u, v, reIp, imIp, validIp);
-	    
-	    if(freqData.compositeFourierModelDft_.hasData_) 
-	      freqData.compositeFourierModelDft_.interpolateReImData(u, v, reFp, imFp, validFp);
-
-#ifdef SIM_TIMER_TEST
-	    t5.stop();
-	    t5time += t5.deltaInSeconds();
-
-	    t6.start();
-#endif
-	    re = reIp + reFp;
-	    im = imIp + imFp;
-	    valid = validIp && validFp;
+	    double re = freqData.simRe_[iTrack];
+	    double im = freqData.simIm_[iTrack];
+	    bool valid = freqData.simValid_[iTrack];
 
 	    // Now do something with it!
 	    
@@ -3536,9 +3642,9 @@ fillSimulationVisibilityArray(ObsInfo& obs)
 	    // the negative, so that when we reverse the sign on
 	    // read-in, we recover the correct UV
 
-	    vis.u_ = -uvw.u_.meters() / Constants::lightSpeed_.metersPerSec();
-	    vis.v_ = -uvw.v_.meters() / Constants::lightSpeed_.metersPerSec();
-	    vis.w_ = -uvw.w_.meters() / Constants::lightSpeed_.metersPerSec();
+	    vis.u_ = -uvw[0] / Constants::lightSpeed_.metersPerSec();
+	    vis.v_ = -uvw[1] / Constants::lightSpeed_.metersPerSec();
+	    vis.w_ = -uvw[2] / Constants::lightSpeed_.metersPerSec();
 
 	    // Install the AIPS baseline code
 
@@ -3584,22 +3690,22 @@ fillSimulationVisibilityArray(ObsInfo& obs)
 	    vis.im_[visInd] = im + imNoise.Jy();
 	    vis.wt_[visInd] = valid ? wt : 0.0;
 
-	    if(debug_) {
-	      fout << u << " " << v << " " << vis.re_[visInd] << " " << vis.im_[visInd] << " " << vis.wt_[visInd] << std::endl;
-	    }
-
 	    //------------------------------------------------------------
 	    // Accumulate the results into our containers too, so we
 	    // can display it if we want to.
 	    //------------------------------------------------------------
 
 	    {
-	      double accu  = uvw.u_.meters() / freqData.frequency_.meters();
-	      double accv  = uvw.v_.meters() / freqData.frequency_.meters();
+	      double accu  = uvw[0] / freqData.frequency_.meters();
+	      double accv  = uvw[1] / freqData.frequency_.meters();
 	      double accwt = vis.wt_[visInd] * wtScale_ * taper(accu, accv);
 	      double accre = vis.re_[visInd];
 	      double accim = vis.im_[visInd];
 
+	      if(debug_) {
+		fout << accu << " " << accv << " " << vis.re_[visInd] << " " << vis.im_[visInd] << " " << vis.wt_[visInd] << std::endl;
+	      }
+
 	      double r = sqrt(accu * accu + accv * accv);
 
 	      bool goodVis = (uvMin_ < 0.0 || r > uvMin_);
@@ -3622,6 +3728,26 @@ fillSimulationVisibilityArray(ObsInfo& obs)
     }
   }
 
+  //------------------------------------------------------------
+  // Release the model visibilities and tracks, which are no longer
+  // needed
+  //------------------------------------------------------------
+
+  for(unsigned iGroup=0; iGroup < baselineGroups_.size(); iGroup++) {
+    VisBaselineGroup& group = baselineGroups_[iGroup];
+    for(unsigned iStokes=0; iStokes < group.stokesData_.size(); iStokes++) {
+      VisStokesData& stokesData = group.stokesData_[iStokes];
+      for(unsigned iFreq=0; iFreq < stokesData.freqData_.size(); iFreq++) {
+	VisFreqData& freqData = stokesData.freqData_[iFreq];
+	std::vector<double>().swap(freqData.simRe_);
+	std::vector<double>().swap(freqData.simIm_);
+	std::vector<unsigned char>().swap(freqData.simValid_);
+      }
+    }
+  }
+
+  std::vector<double>().swap(simUvw_);
+
   //------------------------------------------------------------
   // For display of simulated data, call calculateErrorInMean, as we
   // do when reading in data, to correctly initialize populated
@@ -3653,122 +3779,349 @@ fillSimulationVisibilityArray(ObsInfo& obs)
 }
 
 /**.......................................................................
- * Fill the internal visibility array with simulated values
+ * Compute the uvw track of every baseline, and the array-center Az/El,
+ * at every simulated hour angle
  */
-void VisDataSet::
-determineUvMax(ObsInfo& obs)
+void VisDataSet::computeSimulationTracks(ObsInfo& obs)
 {
-  //------------------------------------------------------------
-  // Now start simulating data
-  //------------------------------------------------------------
-
-  Geoid geoid;
-
-  obs.calculateStartJd();
-
-  //------------------------------------------------------------  
-  // Iterate over timestamps
-  //------------------------------------------------------------
-
   HourAngle startHa = obs.getStartHa();
   HourAngle stopHa  = obs.getStopHa();
   HourAngle deltaHa = obs.getDeltaHa();
-  HourAngle ha;
-  Time dt;
-
-  dt.setSeconds(deltaHa.seconds() * Constants::utSecPerSiderealSec_);
-
-  unsigned nHa = (unsigned)((stopHa - startHa) / deltaHa);
 
-  for(unsigned iHa=0; iHa < nHa; iHa++) {
+  simNHa_ = (unsigned)((stopHa - startHa) / deltaHa);
 
-    std::cout << "\rComputing iHa = " << iHa << " of " << nHa;
-    fflush(stdout);
+  //------------------------------------------------------------
+  // Baseline separations don't change with hour angle, so store
+  // them once
+  //------------------------------------------------------------
 
-    //------------------------------------------------------------
-    // Compute the current HA
-    //------------------------------------------------------------
+  simGroupOffset_.resize(baselineGroups_.size());
+  simNBaseline_ = 0;
 
-    ha = (startHa) + (deltaHa * iHa) + (deltaHa/2);
+  for(unsigned iGroup=0; iGroup < baselineGroups_.size(); iGroup++) {
+    simGroupOffset_[iGroup] = simNBaseline_;
+    simNBaseline_ += baselineGroups_[iGroup].baselines_.size();
+  }
 
-    //------------------------------------------------------------
-    // Iterate over all baseline groups for this timestamp
-    //------------------------------------------------------------
+  simDxyz_.resize(simNBaseline_);
 
-    for(unsigned iBaseGroup=0; iBaseGroup < baselineGroups_.size(); iBaseGroup++) {
+  for(unsigned iGroup=0; iGroup < baselineGroups_.size(); iGroup++) {
+    VisBaselineGroup& group = baselineGroups_[iGroup];
+    for(unsigned iBase=0; iBase < group.baselines_.size(); iBase++) {
+      VisBaseline& baseline = group.baselines_[iBase];
+      simDxyz_[simGroupOffset_[iGroup] + iBase] = baseline.ant2_->getXyz() - baseline.ant1_->getXyz();
+    }
+  }
 
-      VisBaselineGroup& group = baselineGroups_[iBaseGroup];
-      unsigned nBaseline = group.baselines_.size();
+  simUvw_.resize(simNHa_ * simNBaseline_ * 3);
+  simAzEl_.resize(simNHa_);
 
-      //------------------------------------------------------------
-      // Iterate through all baselines of this group
-      //------------------------------------------------------------
+  //------------------------------------------------------------
+  // Split the hour angles into a few blocks per thread, so that
+  // blocks that finish early don't leave threads idle
+  //------------------------------------------------------------
 
-      for(unsigned iBase=0; iBase < nBaseline; iBase++) {
+  unsigned nBlock = pool_ ? 4 * pool_->nThread() : 1;
 
-	VisBaseline& baseline = group.baselines_[iBase];
+  if(nBlock > simNHa_)
+    nBlock = simNHa_;
 
-	Antenna* ant1 = baseline.ant1_;
-	Antenna* ant2 = baseline.ant2_;
-	
-	//------------------------------------------------------------
-	// Store the XYZ coordinates of this baseline
-	//------------------------------------------------------------
-	
-	LengthTriplet xyz1 = ant1->getXyz();
-	LengthTriplet xyz2 = ant2->getXyz();
-	LengthTriplet dxyz = xyz2 - xyz1;
+  if(nBlock == 0)
+    return;
 
-	//------------------------------------------------------------
-	// Compute the UVW coordinate that corresponds to the
-	// current HA
-	//------------------------------------------------------------
-	    
-	LengthTriplet uvw = geoid.haDecAndXyzToUvw(ha, obs.obsDec_, dxyz);
+  if(!pool_) {
+    computeSimulationTracks(obs, 0, simNHa_);
+    return;
+  }
 
-	unsigned nStokes = group.stokesData_.size();
-	
-	for(unsigned iStokes=0; iStokes < nStokes; iStokes++) {
+  std::vector<SimTrackExecData> execData(nBlock);
 
-	  VisStokesData& stokesData = group.stokesData_[iStokes];
-	  unsigned nFreq = stokesData.freqData_.size();
-      
-	  //------------------------------------------------------------
-	  // Iterate over all frequencies of this Stokes parameter
-	  //------------------------------------------------------------
-	  
-	  for(unsigned iFreq=0; iFreq < nFreq; iFreq++) {
-	    
-	    VisFreqData& freqData = stokesData.freqData_[iFreq];
-	    Frequency& freq = freqData.frequency_;
-	    
-	    // Convert to u and v in units of wavelength
+  simSynchronizer_.resize(nBlock);
+  simSynchronizer_.reset();
+  simSynchronizer_.initWait();
 
-	    double u = uvw.u_.meters() / freq.meters();
-	    double v = uvw.v_.meters() / freq.meters();
+  for(unsigned iBlock=0; iBlock < nBlock; iBlock++) {
+    SimTrackExecData& sted = execData[iBlock];
 
-	    double uAbs = fabs(u);
-	    double vAbs = fabs(v);
+    sted.vds_      = this;
+    sted.obs_      = &obs;
+    sted.iBlock_   = iBlock;
+    sted.nBlock_   = nBlock;
+    sted.iHaStart_ = (iBlock * simNHa_) / nBlock;
+    sted.iHaStop_  = ((iBlock+1) * simNHa_) / nBlock;
 
-	    freqData.uAbsMax_  = freqData.uAbsMax_  > uAbs ? freqData.uAbsMax_     : uAbs;
-	    freqData.vAbsMax_  = freqData.vAbsMax_  > vAbs ? freqData.vAbsMax_     : vAbs;
-	  }
-	}
-      }
-    }
+    simSynchronizer_.registerPending(iBlock);
+    pool_->execute(&execComputeSimulationTracks, &sted);
   }
+
+  simSynchronizer_.wait();
 }
 
 /**.......................................................................
- * Replace internal visibilities with simulated visibilities
+ * Compute uvw tracks for hour angles iHaStart to iHaStop-1
  */
-void VisDataSet::
-replaceVisibilities()
+void VisDataSet::computeSimulationTracks(ObsInfo& obs, unsigned iHaStart, unsigned iHaStop)
 {
-  unsigned nGroupsBetweenUpdates = obs_.visibilities_.size() / 10;
-  bool first = true;
-
-  Flux reNoise, imNoise;
+  Geoid geoid;
+
+  HourAngle startHa = obs.getStartHa();
+  HourAngle deltaHa = obs.getDeltaHa();
+  HourAngle ha;
+
+  gcp::util::Lla lla = obs.getArrayLocation();
+  Declination dec = obs.obsDec_;
+
+  for(unsigned iHa=iHaStart; iHa < iHaStop; iHa++) {
+
+    ha = (startHa) + (deltaHa * iHa) + (deltaHa/2);
+
+    simAzEl_[iHa] = geoid.geodeticLlaAndHaDecToAzEl(lla, ha, dec);
+
+    double* uvw = &simUvw_[iHa * simNBaseline_ * 3];
+
+    for(unsigned iBase=0; iBase < simNBaseline_; iBase++) {
+      LengthTriplet uvwTrip = geoid.haDecAndXyzToUvw(ha, dec, simDxyz_[iBase]);
+
+      *uvw++ = uvwTrip.u_.meters();
+      *uvw++ = uvwTrip.v_.meters();
+      *uvw++ = uvwTrip.w_.meters();
+    }
+  }
+}
+
+/**.......................................................................
+ * Static method which can be passed to a thread pool, to compute a
+ * single block of uvw tracks
+ */
+EXECUTE_FN(VisDataSet::execComputeSimulationTracks)
+{
+  SimTrackExecData* sted = (SimTrackExecData*)args;
+  VisDataSet* vds = sted->vds_;
+
+  vds->computeSimulationTracks(*sted->obs_, sted->iHaStart_, sted->iHaStop_);
+  vds->simSynchronizer_.registerDone(sted->iBlock_, sted->nBlock_);
+}
+
+/**.......................................................................
+ * Interpolate noiseless model visibilities along the simulated tracks,
+ * for all baseline groups, Stokes parameters and frequencies
+ */
+void VisDataSet::simulateModelVisibilities()
+{
+  initWait();
+
+  for(unsigned iGroup=0; iGroup < baselineGroups_.size(); iGroup++) {
+    VisBaselineGroup& group = baselineGroups_[iGroup];
+    
+    for(unsigned iStokes=0; iStokes < group.stokesData_.size(); iStokes++) {
+      VisStokesData& stokesData = group.stokesData_[iStokes];
+      
+      for(unsigned iFreq=0; iFreq < stokesData.freqData_.size(); iFreq++) {
+	VisFreqData& freqData = stokesData.freqData_[iFreq];
+
+	if(!pool_) {
+	  simulateModelVisibilities(freqData, iGroup);
+	} else {
+	  registerPending(iGroup, iStokes, iFreq);
+	  pool_->execute(&execSimulateModelVisibilities, freqData.execData_);
+	}
+      }
+    }
+  }
+
+  waitUntilDone();
+}
+
+/**.......................................................................
+ * Interpolate model visibilities for a single VisFreqData, for every
+ * hour angle and baseline of its group
+ */
+void VisDataSet::simulateModelVisibilities(VisFreqData& vfd, unsigned iGroup)
+{
+  unsigned nBaseline = baselineGroups_[iGroup].baselines_.size();
+  unsigned nTrack    = simNHa_ * nBaseline;
+  double lambda      = vfd.frequency_.meters();
+
+  //------------------------------------------------------------
+  // Convert this group's tracks to u and v in units of wavelength
+  //------------------------------------------------------------
+
+  std::vector<double> u(nTrack);
+  std::vector<double> v(nTrack);
+
+  for(unsigned iHa=0; iHa < simNHa_; iHa++) {
+    double* uvw = &simUvw_[(iHa * simNBaseline_ + simGroupOffset_[iGroup]) * 3];
+
+    for(unsigned iBase=0; iBase < nBaseline; iBase++, uvw += 3) {
+      u[iHa * nBaseline + iBase] = uvw[0] / lambda;
+      v[iHa * nBaseline + iBase] = uvw[1] / lambda;
+    }
+  }
+
+  //------------------------------------------------------------
+  // Interpolate data from the composite Image and Fourier-plane
+  // models, and sum them
+  //------------------------------------------------------------
+
+  vfd.simRe_.assign(nTrack, 0.0);
+  vfd.simIm_.assign(nTrack, 0.0);
+  vfd.simValid_.assign(nTrack, 1);
+
+  std::vector<double> re, im;
+  std::vector<unsigned char> valid;
+
+  if(vfd.compositeImageModelDft_.hasData_) {
+    vfd.compositeImageModelDft_.interpolateReImData(u, v, re, im, valid);
+
+    for(unsigned i=0; i < nTrack; i++) {
+      vfd.simRe_[i]    += re[i];
+      vfd.simIm_[i]    += im[i];
+      vfd.simValid_[i] &= valid[i];
+    }
+  }
+
+  if(vfd.compositeFourierModelDft_.hasData_) {
+    vfd.compositeFourierModelDft_.interpolateReImData(u, v, re, im, valid);
+
+    for(unsigned i=0; i < nTrack; i++) {
+      vfd.simRe_[i]    += re[i];
+      vfd.simIm_[i]    += im[i];
+      vfd.simValid_[i] &= valid[i];
+    }
+  }
+}
+
+/**.......................................................................
+ * Static method which can be passed to a thread pool, to interpolate
+ * model visibilities for a single VisFreqData
+ */
+EXECUTE_FN(VisDataSet::execSimulateModelVisibilities)
+{
+  VisExecData* ved = (VisExecData*)args;
+  VisDataSet*  vds = ved->vds_;
+  VisFreqData* vfd = ved->vfd_;
+
+  vds->simulateModelVisibilities(*vfd, ved->iGroup_);
+  vds->registerDone(ved->iGroup_, ved->iStokes_, ved->iFreq_);
+}
+
+/**.......................................................................
+ * Fill the internal visibility array with simulated values
+ */
+void VisDataSet::
+determineUvMax(ObsInfo& obs)
+{
+  //------------------------------------------------------------
+  // Now start simulating data
+  //------------------------------------------------------------
+
+  Geoid geoid;
+
+  obs.calculateStartJd();
+
+  //------------------------------------------------------------  
+  // Iterate over timestamps
+  //------------------------------------------------------------
+
+  HourAngle startHa = obs.getStartHa();
+  HourAngle stopHa  = obs.getStopHa();
+  HourAngle deltaHa = obs.getDeltaHa();
+  HourAngle ha;
+  Time dt;
+
+  dt.setSeconds(deltaHa.seconds() * Constants::utSecPerSiderealSec_);
+
+  unsigned nHa = (unsigned)((stopHa - startHa) / deltaHa);
+
+  for(unsigned iHa=0; iHa < nHa; iHa++) {
+
+    std::cout << "\rComputing iHa = " << iHa << " of " << nHa;
+    fflush(stdout);
+
+    //------------------------------------------------------------
+    // Compute the current HA
+    //------------------------------------------------------------
+
+    ha = (startHa) + (deltaHa * iHa) + (deltaHa/2);
+
+    //------------------------------------------------------------
+    // Iterate over all baseline groups for this timestamp
+    //------------------------------------------------------------
+
+    for(unsigned iBaseGroup=0; iBaseGroup < baselineGroups_.size(); iBaseGroup++) {
+
+      VisBaselineGroup& group = baselineGroups_[iBaseGroup];
+      unsigned nBaseline = group.baselines_.size();
+
+      //------------------------------------------------------------
+      // Iterate through all baselines of this group
+      //------------------------------------------------------------
+
+      for(unsigned iBase=0; iBase < nBaseline; iBase++) {
+
+	VisBaseline& baseline = group.baselines_[iBase];
+
+	Antenna* ant1 = baseline.ant1_;
+	Antenna* ant2 = baseline.ant2_;
+	
+	//------------------------------------------------------------
+	// Store the XYZ coordinates of this baseline
+	//------------------------------------------------------------
+	
+	LengthTriplet xyz1 = ant1->getXyz();
+	LengthTriplet xyz2 = ant2->getXyz();
+	LengthTriplet dxyz = xyz2 - xyz1;
+
+	//------------------------------------------------------------
+	// Compute the UVW coordinate that corresponds to the
+	// current HA
+	//------------------------------------------------------------
+	    
+	LengthTriplet uvw = geoid.haDecAndXyzToUvw(ha, obs.obsDec_, dxyz);
+
+	unsigned nStokes = group.stokesData_.size();
+	
+	for(unsigned iStokes=0; iStokes < nStokes; iStokes++) {
+
+	  VisStokesData& stokesData = group.stokesData_[iStokes];
+	  unsigned nFreq = stokesData.freqData_.size();
+      
+	  //------------------------------------------------------------
+	  // Iterate over all frequencies of this Stokes parameter
+	  //------------------------------------------------------------
+	  
+	  for(unsigned iFreq=0; iFreq < nFreq; iFreq++) {
+	    
+	    VisFreqData& freqData = stokesData.freqData_[iFreq];
+	    Frequency& freq = freqData.frequency_;
+	    
+	    // Convert to u and v in units of wavelength
+
+	    double u = uvw.u_.meters() / freq.meters();
+	    double v = uvw.v_.meters() / freq.meters();
+
+	    double uAbs = fabs(u);
+	    double vAbs = fabs(v);
+
+	    freqData.uAbsMax_  = freqData.uAbsMax_  > uAbs ? freqData.uAbsMax_     : uAbs;
+	    freqData.vAbsMax_  = freqData.vAbsMax_  > vAbs ? freqData.vAbsMax_     : vAbs;
+	  }
+	}
+      }
+    }
+  }
+}
+
+/**.......................................................................
+ * Replace internal visibilities with simulated visibilities
+ */
+void VisDataSet::
+replaceVisibilities()
+{
+  unsigned nGroupsBetweenUpdates = obs_.visibilities_.size() / 10;
+  bool first = true;
+
+  Flux reNoise, imNoise;
 
   //------------------------------------------------------------  
   // Iterate over all groups in the file
@@ -4067,8 +4420,6 @@ void VisDataSet::calculateSimulatedUvw()
  */
 void VisDataSet::addImage(Image& image, int iFreq, int iStokes)
 {
-  UvDataGridder* planGridder = 0;
-
   for(unsigned iGroup=0; iGroup < baselineGroups_.size(); iGroup++) {
     VisBaselineGroup& groupData = baselineGroups_[iGroup];
     
@@ -4083,7 +4434,7 @@ void VisDataSet::addImage(Image& image, int iFreq, int iStokes)
 
       for(unsigned iFreq=iFreqStart; iFreq < iFreqStop; iFreq++) {
 	VisFreqData& freqData = stokesData.freqData_[iFreq];
-	freqData.addImage(image, &planGridder);
+	freqData.addImage(image);
       }
     }
   }
@@ -4260,25 +4611,177 @@ std::ostream& gcp::datasets::operator<<(std::ostream& os, const VisDataSet::VisS
   return os;
 }
 
+//=======================================================================
+// Methods of VisDataSet::ScratchImagePool
+//=======================================================================
+
+VisDataSet::ScratchImagePool::~ScratchImagePool()
+{
+  for(unsigned i=0; i < all_.size(); i++)
+    delete all_[i];
+
+  all_.resize(0);
+  free_.resize(0);
+}
+
+/**.......................................................................
+ * Check out a scratch image.  We prefer an image whose axes already
+ * match the passed image, so that the caller doesn't have to
+ * reallocate it, but will return any free image if none matches, or
+ * allocate a new one if none is free
+ */
+Image* VisDataSet::ScratchImagePool::checkout(Image& image)
+{
+  Image* scratch = 0;
+
+  guard_.lock();
+
+  try {
+
+    for(unsigned i=0; i < free_.size(); i++) {
+      if(free_[i]->axesAreEquivalent(image)) {
+	scratch  = free_[i];
+	free_[i] = free_[free_.size()-1];
+	free_.pop_back();
+	break;
+      }
+    }
+
+    if(!scratch) {
+      if(free_.size() > 0) {
+	scratch = free_[free_.size()-1];
+	free_.pop_back();
+      } else {
+	scratch = new Image();
+	all_.push_back(scratch);
+      }
+    }
+
+  } catch(...) {
+    guard_.unlock();
+    throw;
+  }
+
+  guard_.unlock();
+
+  return scratch;
+}
+
+/**.......................................................................
+ * Return a scratch image to the pool
+ */
+void VisDataSet::ScratchImagePool::checkin(Image* image)
+{
+  guard_.lock();
+
+  try {
+    free_.push_back(image);
+  } catch(...) {
+    guard_.unlock();
+    throw;
+  }
+
+  guard_.unlock();
+}
+
 //=======================================================================
 // Methods of VisDataSet::VisFreqData
 //=======================================================================
 
+/**.......................................................................
+ * Return the utility gridder, sizing it to match the data grid if
+ * this is the first time it has been used
+ */
+UvDataGridder& VisDataSet::VisFreqData::getUtilityGridder()
+{
+  if(!utilityGridderInitialized_) {
+    Angle xSize = griddedData_.xAxis().getAngularSize();
+    Angle ySize = griddedData_.yAxis().getAngularSize();
+    utilityGridder_.initializeForVis(xSize, ySize, griddedData_.xAxis().getNpix(), griddedData_.yAxis().getNpix());
+    utilityGridderInitialized_ = true;
+  }
+
+  return utilityGridder_;
+}
+
+/**.......................................................................
+ * Size the Fourier-plane model gridders to match the data grid.  Most
+ * runs use only image-plane models, so these are not allocated until
+ * a Fourier-plane model is actually added
+ */
+void VisDataSet::VisFreqData::initializeFourierModel()
+{
+  if(fourierModelInitialized_)
+    return;
+
+  Angle xSize = griddedData_.xAxis().getAngularSize();
+  Angle ySize = griddedData_.yAxis().getAngularSize();
+  unsigned nx = griddedData_.xAxis().getNpix();
+  unsigned ny = griddedData_.yAxis().getNpix();
+
+  fourierModelComponent_.initializeForVis(xSize, ySize, nx, ny);
+  compositeFourierModelDft_.initializeForVis(xSize, ySize, nx, ny);
+
+  if(hasAbsolutePosition_)
+    fourierModelComponent_.setRaDec(ra_, dec_);
+
+  fourierModelInitialized_ = true;
+
+  if(fourierModelUsesAllIndices_) {
+    fourierModelComponent_.initializePopulatedIndicesToAll();
+    compositeFourierModelDft_.initializePopulatedIndicesToAll();
+  } else {
+    fourierModelComponent_.assignPopulatedIndicesFrom(griddedData_);
+    compositeFourierModelDft_.assignPopulatedIndicesFrom(griddedData_);
+  }
+}
+
+/**.......................................................................
+ * Populate all indices of the Fourier-plane model gridders
+ */
+void VisDataSet::VisFreqData::setFourierModelIndicesToAll()
+{
+  fourierModelUsesAllIndices_ = true;
+
+  if(fourierModelInitialized_) {
+    fourierModelComponent_.initializePopulatedIndicesToAll();
+    compositeFourierModelDft_.initializePopulatedIndicesToAll();
+  }
+}
+
+/**.......................................................................
+ * Set the absolute position of this data set
+ */
+void VisDataSet::VisFreqData::setRaDec(HourAngle& ra, Declination& dec)
+{
+  ra_  = ra;
+  dec_ = dec;
+  hasAbsolutePosition_ = true;
+
+  griddedData_.setRaDec(ra_, dec_);
+
+  if(fourierModelInitialized_)
+    fourierModelComponent_.setRaDec(ra_, dec_);
+}
+
 /**.......................................................................
  * Clear the composite model(s)
  */
 void VisDataSet::VisFreqData::clearModel()
 {
-  if(compositeImageModel_.hasData_) {
-    compositeImageModel_.zero();
-    compositeImageModel_.hasData_            = false;
+  Image& imageModel    = activeImageModel();
+  Dft2d& imageModelDft = activeImageModelDft();
 
-    compositeImageModelDft_.zero();
-    compositeImageModelDft_.hasData_         = false;
-    compositeImageModelDft_.isTransformed_   = false;
+  if(imageModel.hasData_) {
+    activeModelTiles().zero(imageModel);
+    imageModel.hasData_            = false;
+
+    imageModelDft.zero();
+    imageModelDft.hasData_         = false;
+    imageModelDft.isTransformed_   = false;
   }
 
-  if(compositeFourierModelDft_.hasData_) {
+  if(fourierModelInitialized_ && compositeFourierModelDft_.hasData_) {
     compositeFourierModelDft_.zero();
     compositeFourierModelDft_.hasData_       = false;
     compositeFourierModelDft_.isTransformed_ = false;
@@ -4288,11 +4791,11 @@ void VisDataSet::VisFreqData::clearModel()
 /**.......................................................................
  * Add a model component to the composite model
  */
-void VisDataSet::VisFreqData::addModel(Generic2DAngularModel& model)
+void VisDataSet::VisFreqData::addModel(Generic2DAngularModel& model, MosaicSky* sky)
 {
   if(hasData()) {
     if(isImagePlaneModel(model)) {
-      addImagePlaneModel(model);
+      addImagePlaneModel(model, sky);
     } else {
       addFourierPlaneModel(model);
     }
@@ -4307,6 +4810,9 @@ void VisDataSet::VisFreqData::remModel()
   unsigned dftInd;
 
   if(hasData()) {
+
+    bool hasFourierModel = fourierModelInitialized_ && compositeFourierModelDft_.hasData_;
+
     for(unsigned i=0; i < griddedData_.populatedIndices_.size(); i++) {
 
       dftInd  = griddedData_.populatedIndices_[i];
@@ -4316,8 +4822,13 @@ void VisDataSet::VisFreqData::remModel()
       // Image-plane and Fourier-plane models
       //------------------------------------------------------------
       
-      double reModel = compositeImageModelDft_.out_[dftInd][0] + compositeFourierModelDft_.out_[dftInd][0];
-      double imModel = compositeImageModelDft_.out_[dftInd][1] + compositeFourierModelDft_.out_[dftInd][1];
+      double reModel = compositeImageModelDft_.out_[dftInd][0];
+      double imModel = compositeImageModelDft_.out_[dftInd][1];
+
+      if(hasFourierModel) {
+	reModel += compositeFourierModelDft_.out_[dftInd][0];
+	imModel += compositeFourierModelDft_.out_[dftInd][1];
+      }
 
       griddedData_.out_[dftInd][0] -= reModel;
       griddedData_.out_[dftInd][1] -= imModel;
@@ -4330,92 +4841,142 @@ void VisDataSet::VisFreqData::remModel()
  */
 void VisDataSet::VisFreqData::addFourierPlaneModel(Generic2DAngularModel& model)
 {
+  //------------------------------------------------------------
+  // Size the Fourier-plane gridders if this is the first
+  // Fourier-plane model we've seen
+  //------------------------------------------------------------
+
+  initializeFourierModel();
+
   //------------------------------------------------------------
   // Load the model component into our temporary array
   //------------------------------------------------------------
   
   gcp::models::PtSrcModel::UvParams params;
-  params.beam_ = &primaryBeam_;
+  params.beam_ = &primaryBeam();
   params.freq_ = &frequency_;
   
   model.fillUvData(DataSetType::DATASET_RADIO, fourierModelComponent_, &params);
 
   //------------------------------------------------------------
-  // Now convert to Jy.  If we are fitting components in Jy/bm, we
-  // must use a single global beam width, else we would be converting
-  // to different intensity units for each VisFreqData set
-  //------------------------------------------------------------
-  
-  fourierModelComponent_.convertToJy(frequency_, estimatedGlobalSynthesizedBeam_);
-
-  //------------------------------------------------------------
-  // Finally, add it to the composite model
+  // Now convert to Jy and add it to the composite model.  If we are
+  // fitting components in Jy/bm, we must use a single global beam
+  // width, else we would be converting to different intensity units
+  // for each VisFreqData set.
+  //
+  // After the first component, the conversion is folded into the
+  // accumulation, so that each component costs a single pass
   //------------------------------------------------------------
   
   if(!compositeFourierModelDft_.hasData()) {
+    fourierModelComponent_.convertToJy(frequency_, estimatedGlobalSynthesizedBeam_);
     compositeFourierModelDft_.assignDataFrom(fourierModelComponent_);
   } else {
-    compositeFourierModelDft_ += fourierModelComponent_;
+    compositeFourierModelDft_.addScaled(fourierModelComponent_, fourierModelComponent_.nativeToJy(frequency_, estimatedGlobalSynthesizedBeam_));
   }
 }
 
 /**.......................................................................
  * Add an image-plane model to this data set
  */
-void VisDataSet::VisFreqData::addImagePlaneModel(Generic2DAngularModel& model)
+void VisDataSet::VisFreqData::addImagePlaneModel(Generic2DAngularModel& model, MosaicSky* sky)
 {
   //------------------------------------------------------------
-  // Load the model component into our temporary array
+  // Check out a scratch image to render the component into, and
+  // size it to match our composite model (at the current resolution
+  // level) if it doesn't already
   //------------------------------------------------------------
+
+  Image& imageModel      = activeImageModel();
+  DirtyTileMask& tiles   = activeModelTiles();
+  Image* component       = scratchImages_.checkout(imageModel);
+
+  try {
+
+    if(!component->axesAreEquivalent(imageModel))
+      component->initialize(imageModel);
+
+    if(hasAbsolutePosition_)
+      component->setRaDecFft(ra_, dec_);
+
+    //------------------------------------------------------------
+    // Load the model component into the scratch image.  Only the
+    // region where the component is non-negligible is filled, and
+    // pixels outside it are stale.
+    //
+    // If this component is shared with the other pointings of a
+    // mosaic, it is resampled from the common rendering instead
+    //------------------------------------------------------------
   
 #if 0
-  addmodeltimer1.start();
+    addmodeltimer1.start();
 #endif
 
-  model.fillImage(DataSetType::DATASET_RADIO, imageModelComponent_, &frequency_);
+    Image::Region region;
+
+    bool shared = sky && sky->isActive() && hasAbsolutePosition_ &&
+      sky->fillImageRegion(*component, region, frequency_);
+
+    if(!shared)
+      model.fillImageRegion(DataSetType::DATASET_RADIO, *component, region, &frequency_);
 
 #if 0
-  addmodeltimer1.stop();
-  amt1 += addmodeltimer1.deltaInSeconds();
-  addmodeltimer2.start();
+    addmodeltimer1.stop();
+    amt1 += addmodeltimer1.deltaInSeconds();
+    addmodeltimer2.start();
 #endif
 
-  //------------------------------------------------------------
-  // Now convert to Jy.  If we are fitting components in Jy/bm, we
-  // must use a single global beam width, else we would be converting
-  // to different intensity units for each VisFreqData set
-  //------------------------------------------------------------
+    //------------------------------------------------------------
+    // Now convert to Jy and add it to the composite model.  If we
+    // are fitting components in Jy/bm, we must use a single global
+    // beam width, else we would be converting to different
+    // intensity units for each VisFreqData set.
+    //
+    // The component is rendered on our own grid and position, so
+    // the conversion is folded into a single fused add over its
+    // region.  A composite with no data has been cleared, so
+    // the first component is added to zeros
+    //------------------------------------------------------------
+  
+    double jyConv = component->nativeToJy(frequency_, estimatedGlobalSynthesizedBeam_);
 
-  imageModelComponent_.convertToJy(frequency_, estimatedGlobalSynthesizedBeam_);
+    if(!imageModel.hasData()) {
+      imageModel.hasData_      = true;
+      imageModel.setUnits(Unit::UNITS_JY);
+      imageModel.frequency_    = component->frequency_;
+      imageModel.hasFrequency_ = component->hasFrequency_;
+    }
 
-  //------------------------------------------------------------
-  // Finally, add it to the composite model
-  //------------------------------------------------------------
-  
-  if(!compositeImageModel_.hasData()) {
-    compositeImageModel_.assignDataFrom(imageModelComponent_);
-  } else {
-    compositeImageModel_ += imageModelComponent_;
+    if(!region.isEmpty()) {
+      imageModel.addScaled(*component, jyConv, region);
+      tiles.mark(imageModel, region);
+    }
+
+  } catch(...) {
+    scratchImages_.checkin(component);
+    throw;
   }
+
+  scratchImages_.checkin(component);
 }
 
 /**.......................................................................
  * Simulation only: add an image to the image to be observed
  */
-void VisDataSet::VisFreqData::addImage(Image& image, UvDataGridder** planGridder)
+void VisDataSet::VisFreqData::addImage(Image& image)
 {
   // If no image has been installed, initialize containers to match
   // the new image size
 
   if(!hasImage_) {
-    resize(image, true, planGridder);
-  } else if(!primaryBeam_.axesAreEquivalent(image)) {
+    resize(image, true);
+  } else if(!primaryBeam().axesAreEquivalent(image)) {
     ThrowError("Attempt to add an Image that is a different size than the previously added image");
   }
 
-  // Initialize the temporary model component from the image
+  // Initialize a temporary model component from the image
 
-  imageModelComponent_ = image;
+  Image component = image;
 
   //------------------------------------------------------------
   // Now convert to Jy.  If we are fitting components in Jy/bm, we
@@ -4423,16 +4984,18 @@ void VisDataSet::VisFreqData::addImage(Image& image, UvDataGridder** planGridder
   // to different intensity units for each VisFreqData set
   //------------------------------------------------------------
     
-  imageModelComponent_.convertToJy(frequency_, estimatedGlobalSynthesizedBeam_);
+  component.convertToJy(frequency_, estimatedGlobalSynthesizedBeam_);
 
   // And add it to the composite model.  If no image has been added,
   // set the composite model equal to this component.  If an image has
   // already been added, add the image to what's already there.
     
   if(hasImage_)
-    compositeImageModel_ += imageModelComponent_;
+    compositeImageModel_ += component;
   else
-    compositeImageModel_.assignDataFrom(imageModelComponent_);
+    compositeImageModel_.assignDataFrom(component);
+
+  compositeModelTiles_.markAll();
 
   hasImage_ = true;
 }
@@ -4448,14 +5011,20 @@ bool VisDataSet::VisFreqData::hasImage()
  */
 void VisDataSet::VisFreqData::transformModel()
 {
-  if(hasData() && compositeImageModel_.hasData() && !compositeImageModelDft_.isTransformed_) {
+  PROFILE_ZONE("VisFreqData::transformModel", profileLabel_.c_str());
+  PERF_PHASE("VisFreqData::transformModel");
+
+  Image& imageModel    = activeImageModel();
+  Dft2d& imageModelDft = activeImageModelDft();
+
+  if(hasData() && imageModel.hasData() && !imageModelDft.isTransformed_) {
 
     //------------------------------------------------------------
     // The composite model should already be in units of Jy.  All we
     // have to do is apply the primary beam here.
     //------------------------------------------------------------
     
-    compositeImageModel_ *= primaryBeam_;
+    activeModelTiles().multiply(imageModel, resLevel_ > 0 ? coarsePrimaryBeam_ : primaryBeam());
     
 #if DO_INTERP
     //------------------------------------------------------------
@@ -4463,26 +5032,23 @@ void VisDataSet::VisFreqData::transformModel()
     // convolution in the Fourier plane
     //------------------------------------------------------------
     
-    unsigned nx = compositeImageModel_.xAxis().getNpix();
-    unsigned ny = compositeImageModel_.yAxis().getNpix();
-    
-    double sigx = (double)(nx)/(2*M_PI*Dft2d::convSigInPixels_);
-    double sigy = (double)(ny)/(2*M_PI*Dft2d::convSigInPixels_);
+    unsigned nx = imageModel.xAxis().getNpix();
+    unsigned ny = imageModel.yAxis().getNpix();
     
     Image convCorrection;
-    convCorrection.createGaussianImage(nx, ny, sigx, sigy);
-    compositeImageModel_ *= convCorrection;
+    convCorrection.createGridCorrectionImage(nx, ny, griddedData_);
+    imageModel *= convCorrection;
 #endif
 
     //------------------------------------------------------------
     // And transform the image
     //------------------------------------------------------------
     
-    compositeImageModelDft_.setInput(compositeImageModel_);
-    compositeImageModelDft_.computeForwardTransform();
-    compositeImageModelDft_.shift();
+    imageModelDft.setInput(imageModel);
+    imageModelDft.computeForwardTransform();
+    imageModelDft.shift();
 
-    compositeImageModelDft_.isTransformed_ = true;
+    imageModelDft.isTransformed_ = true;
   }
 }
 
@@ -4491,6 +5057,12 @@ void VisDataSet::VisFreqData::transformModel()
  */
 ChisqVariate VisDataSet::VisFreqData::computeChisq()
 {
+  PROFILE_ZONE("VisFreqData::computeChisq", profileLabel_.c_str());
+  PERF_PHASE("VisFreqData::computeChisq");
+
+  if(resLevel_ > 0)
+    return computeCoarseChisq();
+
   bool first = true;
 
   //------------------------------------------------------------
@@ -4505,6 +5077,8 @@ ChisqVariate VisDataSet::VisFreqData::computeChisq()
   double reData, reErr, imData, imErr, reModel, imModel;
   double reCont, imCont;
 
+  bool hasFourierModel = fourierModelInitialized_ && compositeFourierModelDft_.hasData_;
+
   for(unsigned i=0; i < griddedData_.populatedIndices_.size(); i++) {
       
 #ifdef TIMER_TEST
@@ -4517,16 +5091,21 @@ ChisqVariate VisDataSet::VisFreqData::computeChisq()
     reData  = griddedData_.out_[dftInd][0];
     imData  = griddedData_.out_[dftInd][1];
  
-    reErr   = griddedData_.errorInMean_[dftInd][0];
-    imErr   = griddedData_.errorInMean_[dftInd][1];
+    reErr   = griddedData_.populatedReErr_[i];
+    imErr   = griddedData_.populatedImErr_[i];
       
     //------------------------------------------------------------
     // The model we compare to is the sum of the composite Image-plane
     // and Fourier-plane models
     //------------------------------------------------------------
       
-    reModel = compositeImageModelDft_.out_[dftInd][0] + compositeFourierModelDft_.out_[dftInd][0];
-    imModel = compositeImageModelDft_.out_[dftInd][1] + compositeFourierModelDft_.out_[dftInd][1];
+    reModel = compositeImageModelDft_.out_[dftInd][0];
+    imModel = compositeImageModelDft_.out_[dftInd][1];
+
+    if(hasFourierModel) {
+      reModel += compositeFourierModelDft_.out_[dftInd][0];
+      imModel += compositeFourierModelDft_.out_[dftInd][1];
+    }
  
     //------------------------------------------------------------
     // Get the contribution to chisq of the real data
@@ -4542,38 +5121,203 @@ ChisqVariate VisDataSet::VisFreqData::computeChisq()
     imCont = (imData - imModel) / imErr;
     imCont *= imCont;
 
-#ifdef TIMER_TEST
-    cc1.stop();
-    cct1 += cc1.deltaInSeconds();
-    cc2.start();
-#endif
+#ifdef TIMER_TEST
+    cc1.stop();
+    cct1 += cc1.deltaInSeconds();
+    cc2.start();
+#endif
+
+    //------------------------------------------------------------
+    // And co-add both contributions to chi-square (but do this
+    // separately for each component so that chisq registers the
+    // correct number of degrees of freedom)
+    //------------------------------------------------------------
+      
+    chisq.directAdd(reCont+imCont, 2);
+
+#ifdef TIMER_TEST
+    cc2.stop();
+    cct2 += cc2.deltaInSeconds();
+    cc3.start();
+#endif
+
+#ifdef TIMER_TEST
+    chisqtest += reCont;
+    chisqtest += imCont;
+#endif
+
+#ifdef TIMER_TEST
+    cc3.stop();
+    cct3 += cc3.deltaInSeconds();
+#endif
+  }
+
+  return chisq;
+}
+
+/**.......................................................................
+ * Compute chi-square for a single frequency at a coarse resolution
+ * level, over only the uv cells retained by setResolutionLevel()
+ */
+ChisqVariate VisDataSet::VisFreqData::computeCoarseChisq()
+{
+  ChisqVariate chisq;
+
+  unsigned i, dftInd, modelInd;
+  double reCont, imCont, reModel, imModel;
+
+  bool hasImageModel   = coarseImageModel_.hasData_;
+  bool hasFourierModel = fourierModelInitialized_ && compositeFourierModelDft_.hasData_;
+
+  for(unsigned iCell=0; iCell < coarseDataInd_.size(); iCell++) {
+
+    i        = coarseDataInd_[iCell];
+    dftInd   = griddedData_.populatedIndices_[i];
+    modelInd = coarseModelInd_[iCell];
+
+    //------------------------------------------------------------
+    // Image-plane models come from the coarse transform.
+    // Fourier-plane models are evaluated directly on the data grid,
+    // so are always at full resolution
+    //------------------------------------------------------------
+
+    reModel = 0.0;
+    imModel = 0.0;
+
+    if(hasImageModel) {
+      reModel = coarseImageModelDft_.out_[modelInd][0];
+      imModel = coarseImageModelDft_.out_[modelInd][1];
+    }
+
+    if(hasFourierModel) {
+      reModel += compositeFourierModelDft_.out_[dftInd][0];
+      imModel += compositeFourierModelDft_.out_[dftInd][1];
+    }
+
+    reCont = (griddedData_.out_[dftInd][0] - reModel) / griddedData_.populatedReErr_[i];
+    imCont = (griddedData_.out_[dftInd][1] - imModel) / griddedData_.populatedImErr_[i];
+
+    chisq.directAdd(reCont*reCont + imCont*imCont, 2);
+  }
+
+  return chisq;
+}
+
+/**.......................................................................
+ * Switch this object to a coarser (level > 0) or full (level = 0)
+ * resolution likelihood.
+ *
+ * At level L, the image-plane model is rendered on a grid with 2^L
+ * fewer pixels per axis but the same angular size, so its transform
+ * has the same uv cell size as the data grid but covers only the
+ * central 1/2^L of it.  We keep only the populated cells that fall
+ * within the coarse transform, and record where each one lives in
+ * the coarse array.
+ *
+ * The level is clamped so that the coarse image is at least 16 pixels
+ * on a side.  Any partially accumulated model is discarded.
+ */
+unsigned VisDataSet::VisFreqData::setResolutionLevel(unsigned level)
+{
+  unsigned nx = compositeImageModel_.xAxis().getNpix();
+  unsigned ny = compositeImageModel_.yAxis().getNpix();
+
+  while(level > 0 && ((nx >> level) < 16 || (ny >> level) < 16))
+    --level;
+
+  if(level == resLevel_)
+    return level;
+
+  clearModel();
+  resLevel_ = level;
+  clearModel();
+
+  coarseDataInd_.resize(0);
+  coarseModelInd_.resize(0);
+
+  if(level == 0)
+    return level;
+
+  //------------------------------------------------------------
+  // Size the coarse image, and sample the primary beam onto it.
+  // Coarse pixel (ic, jc) has the same center as fine pixel
+  // (ic*fac, jc*fac)
+  //------------------------------------------------------------
+
+  unsigned fac = 1 << level;
+  unsigned nxc = nx / fac;
+  unsigned nyc = ny / fac;
+
+  Angle xSize = compositeImageModel_.xAxis().getAngularSize();
+  Angle ySize = compositeImageModel_.yAxis().getAngularSize();
+
+  coarseImageModel_.initialize(xSize, ySize, nxc, nyc);
+  coarseModelTiles_.markAll();
+  coarsePrimaryBeam_.initialize(xSize, ySize, nxc, nyc);
+
+  for(unsigned jc=0; jc < nyc; jc++)
+    for(unsigned ic=0; ic < nxc; ic++)
+      coarsePrimaryBeam_.data_[jc * nxc + ic] = primaryBeam().data_[(jc * fac) * nx + ic * fac];
 
-    //------------------------------------------------------------
-    // And co-add both contributions to chi-square (but do this
-    // separately for each component so that chisq registers the
-    // correct number of degrees of freedom)
-    //------------------------------------------------------------
-      
-    chisq.directAdd(reCont+imCont, 2);
+  coarsePrimaryBeam_.hasData_ = true;
 
-#ifdef TIMER_TEST
-    cc2.stop();
-    cct2 += cc2.deltaInSeconds();
-    cc3.start();
-#endif
+  coarseImageModelDft_.initializeForVis(xSize, ySize, nxc, nyc);
 
-#ifdef TIMER_TEST
-    chisqtest += reCont;
-    chisqtest += imCont;
-#endif
+  //------------------------------------------------------------
+  // Now map populated cells of the data grid onto the coarse
+  // transform.  The x axis of the transform is the full
+  // (wrap-around) axis, the y axis is the half axis
+  //------------------------------------------------------------
 
-#ifdef TIMER_TEST
-    cc3.stop();
-    cct3 += cc3.deltaInSeconds();
-#endif
+  unsigned nxFine   = griddedData_.nxZeroPad_;
+  unsigned nyHalf   = griddedData_.nyZeroPad_/2 + 1;
+  unsigned nxCoarse = coarseImageModelDft_.nxZeroPad_;
+  unsigned nyCoarse = coarseImageModelDft_.nyZeroPad_;
+
+  std::vector<unsigned>& populated = griddedData_.populatedIndices_;
+
+  for(unsigned i=0; i < populated.size(); i++) {
+
+    unsigned ix = populated[i] / nyHalf;
+    unsigned iy = populated[i] % nyHalf;
+
+    int kx = ix < nxFine/2 ? (int)ix : (int)ix - (int)nxFine;
+
+    if((unsigned)abs(kx) >= nxCoarse/2 || iy >= nyCoarse/2)
+      continue;
+
+    unsigned icx = kx >= 0 ? kx : kx + nxCoarse;
+
+    coarseDataInd_.push_back(i);
+    coarseModelInd_.push_back(icx * (nyCoarse/2 + 1) + iy);
   }
 
-  return chisq;
+  return level;
+}
+
+/**.......................................................................
+ * Return the image-plane model for the current resolution level
+ */
+Image& VisDataSet::VisFreqData::activeImageModel()
+{
+  return resLevel_ > 0 ? coarseImageModel_ : compositeImageModel_;
+}
+
+/**.......................................................................
+ * Return the transform of the image-plane model for the current
+ * resolution level
+ */
+Dft2d& VisDataSet::VisFreqData::activeImageModelDft()
+{
+  return resLevel_ > 0 ? coarseImageModelDft_ : compositeImageModelDft_;
+}
+
+/**.......................................................................
+ * Return the dirty-tile mask for the current resolution level
+ */
+DirtyTileMask& VisDataSet::VisFreqData::activeModelTiles()
+{
+  return resLevel_ > 0 ? coarseModelTiles_ : compositeModelTiles_;
 }
 
 /**.......................................................................
@@ -4615,15 +5359,48 @@ void VisDataSet::VisFreqData::accumulateMoments(bool first, VisDataSet::VisData&
   // destination VisFreqData object
   //------------------------------------------------------------
   
+#if DO_INTERP
+  bufU_.push_back(data.u_);
+  bufV_.push_back(data.v_);
+  bufRe_.push_back(re);
+  bufIm_.push_back(im);
+  bufWt_.push_back(data.wt_);
+#else
   if(first) {
     griddedData_.accumulateFirstMoments( data.u_, data.v_, re, im, data.wt_);
   } else {
     griddedData_.accumulateSecondMoments(data.u_, data.v_, re, im, data.wt_);
   }
+#endif
   
   accumulateVarianceStats(data);
 }
 
+/**.......................................................................
+ * Grid any visibilities buffered by accumulateMoments(), and release
+ * the buffers
+ */
+void VisDataSet::VisFreqData::gridBufferedVis(bool first, Dft2d::ConvKernelType kernel, ThreadPool* pool)
+{
+  unsigned n = bufU_.size();
+
+  griddedData_.setConvolutionKernel(kernel);
+
+  if(n > 0) {
+    if(first) {
+      griddedData_.accumulateFirstMomentsWithInterpolation(n, &bufU_[0], &bufV_[0], &bufRe_[0], &bufIm_[0], &bufWt_[0], pool);
+    } else {
+      griddedData_.accumulateSecondMomentsWithInterpolation(n, &bufU_[0], &bufV_[0], &bufRe_[0], &bufIm_[0], &bufWt_[0], pool);
+    }
+  }
+
+  std::vector<double>().swap(bufU_);
+  std::vector<double>().swap(bufV_);
+  std::vector<double>().swap(bufRe_);
+  std::vector<double>().swap(bufIm_);
+  std::vector<double>().swap(bufWt_);
+}
+
 /**.......................................................................
  * Accumulate the estimated chisq and wtsum for this VisFreqData
  * object
@@ -4689,8 +5466,8 @@ void VisDataSet::VisFreqData::mergeData(VisDataSet::VisFreqData& freq,
   double wt1 =      wtSumTotal_;
   double wt2 = freq.wtSumTotal_;
 
-  Image pb1  =      primaryBeam_*wt1;
-  Image pb2  = freq.primaryBeam_*wt2;
+  Image pb1  =      primaryBeam()*wt1;
+  Image pb2  = freq.primaryBeam()*wt2;
 
   //------------------------------------------------------------
   // If the existing images don't match, we have to recalculate the
@@ -4701,13 +5478,14 @@ void VisDataSet::VisFreqData::mergeData(VisDataSet::VisFreqData& freq,
 
     ReportSimpleColorError("Images are on different grids... recomputing for this grid", "yellow");
 
-    pb2   = group_->antennaPair_.first. getRealisticApertureField(pb1, frequency_, xShift, yShift);
-    pb2  *= group_->antennaPair_.second.getRealisticApertureField(pb1, frequency_, xShift, yShift);
+    pb2   = PrimaryBeamCache::getApertureField(group_->antennaPair_.first,  pb1, frequency_, xShift, yShift);
+    pb2  *= PrimaryBeamCache::getApertureField(group_->antennaPair_.second, pb1, frequency_, xShift, yShift);
 
     pb2 *= wt2;
   }
 
   primaryBeam_ = (pb1 + pb2) / (wt1 + wt2);
+  sharedBeam_  = 0;
 
   //------------------------------------------------------------
   // Update internal parameters of this object
@@ -4724,20 +5502,92 @@ void VisDataSet::VisFreqData::mergeData(VisDataSet::VisFreqData& freq,
 
 }
 
+/**.......................................................................
+ * Return true if the beam for this object is a weighted sum over
+ * shifted datasets
+ */
+bool VisDataSet::VisFreqData::primaryBeamIsShifted()
+{
+  for(unsigned i=0; i < xShifts_.size(); i++) {
+    if(fabs(xShifts_[i].degrees()) > 0.0 || fabs(yShifts_[i].degrees()) > 0.0)
+      return true;
+  }
+
+  return false;
+}
+
+/**.......................................................................
+ * Return true if the beam of this object would be identical to
+ * that of the passed object.  The image-model axes are compared
+ * instead of the beams', since the passed beam may still be in the
+ * course of being computed by another thread
+ */
+bool VisDataSet::VisFreqData::canSharePrimaryBeamWith(VisDataSet::VisFreqData& freq)
+{
+  return freq.hasData() && freq.sharedBeam_ == 0 &&
+    frequency_.Hz() == freq.frequency_.Hz() &&
+    !primaryBeamIsShifted() && !freq.primaryBeamIsShifted() &&
+    compositeImageModel_.axesAreEquivalent(freq.compositeImageModel_);
+}
+
+/**.......................................................................
+ * Use the beam of the passed object, releasing our own
+ */
+void VisDataSet::VisFreqData::sharePrimaryBeamWith(VisDataSet::VisFreqData& freq)
+{
+  primaryBeam_.initialize();
+  sharedBeam_ = &freq.primaryBeam_;
+}
+
+/**.......................................................................
+ * If the beam of this object is shared, replace it with a copy
+ */
+void VisDataSet::VisFreqData::unsharePrimaryBeam()
+{
+  if(sharedBeam_) {
+    primaryBeam_ = *sharedBeam_;
+    sharedBeam_  = 0;
+  }
+}
+
 void VisDataSet::VisFreqData::operator=(VisDataSet::VisFreqData& data) 
 {
   compositeImageModel_      = data.compositeImageModel_;
-
-  imageModelComponent_      = data.imageModelComponent_;
   compositeImageModelDft_   = data.compositeImageModelDft_;
+  compositeModelTiles_.markAll();
+
+  //------------------------------------------------------------
+  // Gridder assignment copies geometry only, so on-demand gridders
+  // must be re-sized before they are next used
+  //------------------------------------------------------------
 
   fourierModelComponent_    = data.fourierModelComponent_;
   compositeFourierModelDft_ = data.compositeFourierModelDft_;
 
+  fourierModelInitialized_    = false;
+  fourierModelUsesAllIndices_ = data.fourierModelUsesAllIndices_;
+
   griddedData_              = data.griddedData_;
   utilityGridder_           = data.utilityGridder_;
 
-  primaryBeam_              = data.primaryBeam_;
+  utilityGridderInitialized_  = false;
+
+  ra_                       = data.ra_;
+  dec_                      = data.dec_;
+  hasAbsolutePosition_      = data.hasAbsolutePosition_;
+
+  primaryBeam_              = data.primaryBeam();
+  sharedBeam_               = 0;
+
+  //------------------------------------------------------------
+  // Coarse-resolution state is not copied; copies start at full
+  // resolution
+  //------------------------------------------------------------
+
+  resLevel_                 = 0;
+  coarseDataInd_.resize(0);
+  coarseModelInd_.resize(0);
+
   frequency_                = data.frequency_;
   ifNo_                     = data.ifNo_;
   bandwidth_                = data.bandwidth_;
@@ -4778,11 +5628,15 @@ void VisDataSet::VisFreqData::duplicate(VisDataSet::VisFreqData& data)
 {
   operator=(data);
 
-  fourierModelComponent_.sizeToMatch(data.fourierModelComponent_);
-  compositeFourierModelDft_.sizeToMatch(data.compositeFourierModelDft_);
-
   griddedData_.duplicate(data.griddedData_);
-  utilityGridder_.sizeToMatch(data.utilityGridder_);
+
+  //------------------------------------------------------------
+  // Fourier-plane model gridders are only sized if the source had
+  // sized them; the utility gridder will be sized on first use
+  //------------------------------------------------------------
+
+  if(data.fourierModelInitialized_)
+    initializeFourierModel();
 }
 
 /**.......................................................................
@@ -4799,7 +5653,7 @@ void VisDataSet::displayPrimaryBeams()
       for(unsigned iFreq=0; iFreq < stokesData.freqData_.size(); iFreq++) {
 	VisFreqData& freqData = stokesData.freqData_[iFreq];
 
-	freqData.primaryBeam_.display();
+	freqData.primaryBeam().display();
       }
     }
   }
@@ -4865,12 +5719,14 @@ Image VisDataSet::getCleanImage(VisDataSet::AccumulatorType type)
  */
 Image VisDataSet::VisFreqData::getCleanImage(VisDataSet::AccumulatorType type)
 {
-  utilityGridder_.initializeForFirstMoments();
-  accumulate(utilityGridder_, type);
-  utilityGridder_.shift();
-  utilityGridder_.computeInverseTransform();
+  UvDataGridder& gridder = getUtilityGridder();
+
+  gridder.initializeForFirstMoments();
+  accumulate(gridder, type);
+  gridder.shift();
+  gridder.computeInverseTransform();
 
-  return utilityGridder_.getImage();
+  return gridder.getImage();
 }
 
 /**.......................................................................
@@ -4897,6 +5753,8 @@ void VisDataSet::VisFreqData::accumulateDirty(UvDataGridder& gridder, VisDataSet
   unsigned dftInd;
   double reData, imData, err, reModel, imModel, wt;
 
+  bool hasFourierModel = fourierModelInitialized_ && compositeFourierModelDft_.hasData_;
+
   for(unsigned i=0; i < griddedData_.populatedIndices_.size(); i++) {
 
     dftInd  = griddedData_.populatedIndices_[i];
@@ -4912,15 +5770,20 @@ void VisDataSet::VisFreqData::accumulateDirty(UvDataGridder& gridder, VisDataSet
     // Use real weights from the data
     //------------------------------------------------------------
 
-    err = griddedData_.errorInMean_[dftInd][0];
+    err = griddedData_.populatedReErr_[i];
     wt = 1.0/(err*err);
 
     //------------------------------------------------------------
     // Get the model component for this index
     //------------------------------------------------------------
 
-    reModel = compositeImageModelDft_.out_[dftInd][0] + compositeFourierModelDft_.out_[dftInd][0];
-    imModel = compositeImageModelDft_.out_[dftInd][1] + compositeFourierModelDft_.out_[dftInd][1];
+    reModel = compositeImageModelDft_.out_[dftInd][0];
+    imModel = compositeImageModelDft_.out_[dftInd][1];
+
+    if(hasFourierModel) {
+      reModel += compositeFourierModelDft_.out_[dftInd][0];
+      imModel += compositeFourierModelDft_.out_[dftInd][1];
+    }
 
     //------------------------------------------------------------
     // Construct a running mean of the model by co-adding this data to
@@ -4970,6 +5833,8 @@ void VisDataSet::VisFreqData::accumulateClean(gcp::util::UvDataGridder& gridder,
   double invMinSigma = 1.0/(2*M_PI*synthBeamMinSig_.radians());
 
   double u,v,ur,vr,val;
+
+  bool hasFourierModel = fourierModelInitialized_ && compositeFourierModelDft_.hasData_;
  
   for(unsigned dftInd=0; dftInd < griddedData_.nOutZeroPad_; dftInd++) {
 
@@ -4977,8 +5842,13 @@ void VisDataSet::VisFreqData::accumulateClean(gcp::util::UvDataGridder& gridder,
     // Get the model component for this index
     //------------------------------------------------------------
 
-    reModel = compositeImageModelDft_.out_[dftInd][0] + compositeFourierModelDft_.out_[dftInd][0];
-    imModel = compositeImageModelDft_.out_[dftInd][1] + compositeFourierModelDft_.out_[dftInd][1];
+    reModel = compositeImageModelDft_.out_[dftInd][0];
+    imModel = compositeImageModelDft_.out_[dftInd][1];
+
+    if(hasFourierModel) {
+      reModel += compositeFourierModelDft_.out_[dftInd][0];
+      imModel += compositeFourierModelDft_.out_[dftInd][1];
+    }
 
     //------------------------------------------------------------
     // Get the UV coordinate of this point
@@ -5051,7 +5921,7 @@ void VisDataSet::VisFreqData::transformImage()
     // have to do is apply the primary beam...
     //------------------------------------------------------------
     
-    compositeImageModel_ *= primaryBeam_;
+    compositeImageModel_ *= primaryBeam();
     
     //------------------------------------------------------------
     // We divide the image by a function that corrects for the
@@ -5061,13 +5931,8 @@ void VisDataSet::VisFreqData::transformImage()
     unsigned nx = compositeImageModel_.xAxis().getNpix();
     unsigned ny = compositeImageModel_.yAxis().getNpix();
     
-    double convSigInPixels = Dft2d::convSigInPixels_;
-
-    double sigx = (double)(nx)/(2*M_PI*convSigInPixels);
-    double sigy = (double)(ny)/(2*M_PI*convSigInPixels);
-    
     Image convCorrection;
-    convCorrection.createGaussianImage(nx, ny, sigx, sigy);
+    convCorrection.createGridCorrectionImage(nx, ny, compositeImageModelDft_);
     
     compositeImageModel_ /= convCorrection;
     
@@ -5107,7 +5972,13 @@ void VisDataSet::VisFreqData::resize(double percentCorrelation, double correlati
   Angle ySize(Angle::Radians(), (double)(ny/4) / vAbsMax_);
 
   griddedData_.initializeForVis(xSize, ySize, nx, ny);
-  utilityGridder_.initializeForVis(xSize, ySize, nx, ny);
+
+  //------------------------------------------------------------
+  // The utility gridder is only used for display, and will be sized
+  // on first use
+  //------------------------------------------------------------
+
+  utilityGridderInitialized_ = false;
 
   if(debug_) {
     COUT("Correlation percentage of: " << percentCorrelation * 100 << "% for group " << *group_
@@ -5124,47 +5995,34 @@ void VisDataSet::VisFreqData::resize(double percentCorrelation, double correlati
   // Resize the primary beam to match
 
   primaryBeam_.initialize(xSize, ySize, nx, ny);
-  imageModelComponent_.initialize(xSize, ySize, nx, ny);
+  sharedBeam_ = 0;
   compositeImageModel_.initialize(xSize, ySize, nx, ny);
 
   compositeImageModelDft_.initializeForVis(xSize, ySize, nx, ny);
 
   //------------------------------------------------------------
-  // Resize components needed for manipulating fourier-plane models
-  //------------------------------------------------------------
-
-  fourierModelComponent_.initializeForVis(xSize, ySize, nx, ny);
-  compositeFourierModelDft_.initializeForVis(xSize, ySize, nx, ny);
-
-  //------------------------------------------------------------
-  // If simulating, set populated indices to all
+  // Components needed for manipulating fourier-plane models are
+  // sized when the first Fourier-plane model is added.  If
+  // simulating, they will use all indices.
   //------------------------------------------------------------
 
-  if(isSim) {
-    fourierModelComponent_.initializePopulatedIndicesToAll();
-    compositeFourierModelDft_.initializePopulatedIndicesToAll();
-  }
+  fourierModelInitialized_    = false;
+  fourierModelUsesAllIndices_ = isSim;
 }
 
 /**.......................................................................
  * Resize images and dfts to the requested size
  */
-void VisDataSet::VisFreqData::resize(Image& image, bool isSim, UvDataGridder** planGridder)
+void VisDataSet::VisFreqData::resize(Image& image, bool isSim)
 {
   //------------------------------------------------------------
-  // First resize the data grid to match
+  // First resize the data grid to match.  Transforms of the same
+  // size share plans through the FftwPlanRegistry, so only the first
+  // resize of a given size pays for planning
   //------------------------------------------------------------
   
-  if(*planGridder == 0) {
-    griddedData_.initializeForVis(image);
-    *planGridder = &griddedData_;
-  } else {
-    griddedData_.setPlan((*planGridder)->forwardPlan_, (*planGridder)->inversePlan_);
-    griddedData_.initializeForVis(image);
-  }
-
-  utilityGridder_.setPlan((*planGridder)->forwardPlan_, (*planGridder)->inversePlan_);
-  utilityGridder_.initializeForVis(image);
+  griddedData_.initializeForVis(image);
+  utilityGridderInitialized_ = false;
 
   //------------------------------------------------------------
   // Resize components needed for manipulating image models
@@ -5173,30 +6031,18 @@ void VisDataSet::VisFreqData::resize(Image& image, bool isSim, UvDataGridder** p
   // Resize the primary beam to match
 
   primaryBeam_.initialize(image);
-  imageModelComponent_.initialize(image);
+  sharedBeam_ = 0;
   compositeImageModel_.initialize(image);
 
-  compositeImageModelDft_.setPlan((*planGridder)->forwardPlan_, (*planGridder)->inversePlan_);
   compositeImageModelDft_.initializeForVis(image);
 
   //------------------------------------------------------------
-  // Resize components needed for manipulating fourier-plane models
+  // Components needed for manipulating fourier-plane models are
+  // sized on first use
   //------------------------------------------------------------
 
-  fourierModelComponent_.setPlan((*planGridder)->forwardPlan_, (*planGridder)->inversePlan_);
-  fourierModelComponent_.initializeForVis(image);
-
-  compositeFourierModelDft_.setPlan((*planGridder)->forwardPlan_, (*planGridder)->inversePlan_);
-  compositeFourierModelDft_.initializeForVis(image);
-
-  //------------------------------------------------------------
-  // If simulating, set populated indices to all
-  //------------------------------------------------------------
-
-  if(isSim) {
-    fourierModelComponent_.initializePopulatedIndicesToAll();
-    compositeFourierModelDft_.initializePopulatedIndicesToAll();
-  }
+  fourierModelInitialized_    = false;
+  fourierModelUsesAllIndices_ = isSim;
 }
 
 //=======================================================================
@@ -5584,9 +6430,7 @@ void VisDataSet::initializePositionDependentData()
 	for(unsigned iFreq=0; iFreq < stokesData.freqData_.size(); iFreq++) {
 	  VisFreqData& freqData = stokesData.freqData_[iFreq];
 
-	  freqData.imageModelComponent_.setRaDecFft(ra_, dec_);
-	  freqData.fourierModelComponent_.setRaDec(ra_, dec_);
-	  freqData.griddedData_.setRaDec(ra_, dec_);
+	  freqData.setRaDec(ra_, dec_);
 	}
       }
     }
@@ -6378,8 +7222,7 @@ void VisDataSet::initializeForDisplay()
 	for(unsigned iFreq=0; iFreq < stokesData.freqData_.size(); iFreq++) {
 	  VisFreqData& freqData = stokesData.freqData_[iFreq];
 	  
-	  freqData.fourierModelComponent_.initializePopulatedIndicesToAll();
-	  freqData.compositeFourierModelDft_.initializePopulatedIndicesToAll();
+	  freqData.setFourierModelIndicesToAll();
 	}
       }
     }
@@ -6387,7 +7230,16 @@ void VisDataSet::initializeForDisplay()
 }
 
 /**.......................................................................
- * Perform an iterative image-plane CLEAN of the image
+ * Perform an iterative CLEAN of the image.
+ *
+ * This is a Clark CLEAN: minor cycles find the peak of the residual
+ * image within the clean windows and subtract a scaled patch of the
+ * dirty beam from it in the image plane, until the peak falls to the
+ * level of the largest beam sidelobe outside the patch, or until
+ * cleanminor components have been subtracted.  Each major cycle then
+ * removes the components found so far from the visibilities, and
+ * re-images the residuals, correcting any errors made by the
+ * image-plane approximation.
  */
 void VisDataSet::clean()
 {
@@ -6398,13 +7250,7 @@ void VisDataSet::clean()
 
   clearModel();
 
-  //------------------------------------------------------------
-  // Iterate, removing delta functions
-  //------------------------------------------------------------
-
-  double val, flux, fluxTotal = 0.0;
-  Angle xOff, yOff;
-  unsigned iMax;
+  double fluxTotal = 0.0;
   Image image;
   std::vector<Model*> deltaComponents;
 
@@ -6418,49 +7264,115 @@ void VisDataSet::clean()
 
   std::vector<gcp::util::Image::Window> windows = VisDataSet::parseWindows(getStringVal("cleanwindow"), image);
   
-  double cleanGain   = getDoubleVal("cleangain");
-  double cleanCutoff = getDoubleVal("cleancutoff");
-  unsigned cleanIter = getUintVal("cleaniter");
+  double cleanGain    = getDoubleVal("cleangain");
+  double cleanCutoff  = getDoubleVal("cleancutoff");
+  unsigned cleanIter  = getUintVal("cleaniter");
+  unsigned cleanMinor = getUintVal("cleanminor");
+  unsigned cleanPatch = getUintVal("cleanpatch");
 
   if(cleanGain > 1.0)
     ThrowSimpleColorError("CLEAN gain should be <= 1.0", "red");
 
+  if(cleanMinor == 0)
+    ThrowSimpleColorError("cleanminor must be > 0", "red");
+
 #if 1
   COUT("Cleaning with niter = " << cleanIter << " gain = " << cleanGain << " and windows: ");
   for(unsigned iWin=0; iWin < windows.size(); iWin++) 
     COUT(windows[iWin] << std::endl);
 #endif
 
+  //------------------------------------------------------------
+  // Precompute the pixels to be searched, and the dirty beam,
+  // normalized to unit peak
+  //------------------------------------------------------------
+
+  std::vector<CleanSpan> spans = getCleanSpans(image, windows);
+
+  if(spans.size() == 0)
+    ThrowSimpleColorError("No image pixels fall inside the clean windows", "red");
+
+  Image beam = getImage(ACC_BEAM);
+
+  if(beam.xAxis().getNpix() != image.xAxis().getNpix() || beam.yAxis().getNpix() != image.yAxis().getNpix())
+    ThrowError("The dirty beam and residual images have different sizes");
+
+  CleanBeamPatch patch;
+  getCleanBeamPatch(beam, cleanPatch, patch);
+
+  unsigned nx = image.xAxis().getNpix();
+
+  double xmin = image.xMin();
+  double ymin = image.yMin();
+  double xRes = image.xAxis().getAngularResolution().degrees();
+  double yRes = image.yAxis().getAngularResolution().degrees();
+
   //------------------------------------------------------------
   // Iterate, removing delta functions
   //------------------------------------------------------------
 
   unsigned ndigit = ceil(log10((double)cleanIter));
+  unsigned iIter = 0, iMax;
+  bool done = false;
+  Angle xOff, yOff;
 
-  for(unsigned i=0; i < cleanIter; i++) {
-
-    COUTCOLORNNL("\rClean iteration: " << std::setw(ndigit) << std::right << (i+1) << "/" 
-		 << cleanIter << " (" << std::right << setprecision(0) << std::fixed << (100*(double)(i+1)/cleanIter) << "%)", "green");
+  while(!done) {
 
     //------------------------------------------------------------
-    // Get the image and display prior to removal of the delta component
+    // Minor cycle.  Components are accumulated per pixel until the
+    // end of the cycle
     //------------------------------------------------------------
 
-    image = getImage(ACC_RES);
-    image.getMax(val, xOff, yOff, iMax, windows, Image::TYPE_ABS);
+    std::map<unsigned, double> components;
+    float* resPtr = &image.data_[0];
+
+    double peak      = getCleanPeak(resPtr, spans, iMax);
+    double threshold = fabs(peak) * patch.maxSidelobe_;
 
-    if(fabs(image.data_[iMax]) < cleanCutoff)
+    if(threshold < cleanCutoff)
+      threshold = cleanCutoff;
+
+    if(fabs(peak) < cleanCutoff)
       break;
 
-    flux = cleanGain*image.data_[iMax];
-    Model* model = addDeltaFunctionModel(deltaComponents, flux, xOff, yOff);
-    fluxTotal += flux;
+    for(unsigned iMinor=0; iMinor < cleanMinor && iIter < cleanIter; iMinor++, iIter++) {
+
+      if(iMinor > 0 && fabs(peak) < threshold)
+	break;
+
+      double flux = cleanGain * peak;
+      components[iMax] += flux;
+      fluxTotal += flux;
+
+      subtractBeamPatch(image, iMax, flux, patch);
+
+      peak = getCleanPeak(resPtr, spans, iMax);
+    }
+
+    COUTCOLORNNL("\rClean iteration: " << std::setw(ndigit) << std::right << iIter << "/" 
+		 << cleanIter << " (" << std::right << setprecision(0) << std::fixed << (100*(double)(iIter)/cleanIter) << "%)", "green");
+
+    done = (iIter >= cleanIter);
 
     //------------------------------------------------------------
-    // Now remove the model from the dataset
+    // Major cycle.  Remove this cycle's components from the
+    // visibilities, and re-image the residuals if we are going
+    // around again
     //------------------------------------------------------------
-    
-    addModel(*model);
+
+    for(std::map<unsigned, double>::iterator iter = components.begin(); iter != components.end(); iter++) {
+      unsigned ix = iter->first % nx;
+      unsigned iy = iter->first / nx;
+
+      xOff.setDegrees(xmin + ((double)(ix) + 0.5) * xRes);
+      yOff.setDegrees(ymin + ((double)(iy) + 0.5) * yRes);
+
+      Model* model = addDeltaFunctionModel(deltaComponents, iter->second, xOff, yOff);
+      addModel(*model);
+    }
+
+    if(!done)
+      image = getImage(ACC_RES);
   }
 
   //------------------------------------------------------------
@@ -6476,6 +7388,180 @@ void VisDataSet::clean()
   }
 }
 
+/**.......................................................................
+ * Convert clean windows to a list of contiguous runs of pixels, one
+ * or more per image row, so that the peak search can run over flat
+ * arrays.  Overlapping windows are merged
+ */
+std::vector<VisDataSet::CleanSpan> 
+VisDataSet::getCleanSpans(Image& image, std::vector<Image::Window>& windows)
+{
+  unsigned nx = image.xAxis().getNpix();
+  unsigned ny = image.yAxis().getNpix();
+
+  double xmin = image.xMin();
+  double ymin = image.yMin();
+  double xRes = image.xAxis().getAngularResolution().degrees();
+  double yRes = image.yAxis().getAngularResolution().degrees();
+
+  std::vector<bool> mask(nx*ny, false);
+
+  for(unsigned iWin=0; iWin < windows.size(); iWin++) {
+    Image::Window& win = windows[iWin];
+
+    for(unsigned iy=0; iy < ny; iy++) {
+      double yOff = ymin + ((double)(iy) + 0.5) * yRes;
+
+      if(yOff < win.yMin_.degrees() || yOff > win.yMax_.degrees())
+	continue;
+
+      for(unsigned ix=0; ix < nx; ix++) {
+	double xOff = xmin + ((double)(ix) + 0.5) * xRes;
+
+	if(xOff >= win.xMin_.degrees() && xOff <= win.xMax_.degrees())
+	  mask[iy * nx + ix] = true;
+      }
+    }
+  }
+
+  std::vector<CleanSpan> spans;
+
+  for(unsigned iy=0; iy < ny; iy++) {
+    for(unsigned ix=0; ix < nx; ix++) {
+      if(mask[iy * nx + ix]) {
+	CleanSpan span;
+	span.start_ = iy * nx + ix;
+
+	while(ix < nx && mask[iy * nx + ix])
+	  ++ix;
+
+	span.n_ = iy * nx + ix - span.start_;
+	spans.push_back(span);
+      }
+    }
+  }
+
+  return spans;
+}
+
+/**.......................................................................
+ * Extract the CLEAN beam patch from the dirty beam.  The beam is
+ * normalized to unit peak, and we record the largest absolute
+ * sidelobe outside the patch, which sets the depth to which each
+ * minor cycle can safely clean.  A half-width of 0 uses the whole
+ * beam
+ */
+void VisDataSet::getCleanBeamPatch(Image& beam, unsigned halfWidth, CleanBeamPatch& patch)
+{
+  double val;
+  Angle xOff, yOff;
+  unsigned iMax;
+
+  beam.getMax(val, xOff, yOff, iMax, Image::TYPE_POS);
+
+  if(!(val > 0.0))
+    ThrowSimpleColorError("The dirty beam has no positive peak", "red");
+
+  patch.nx_ = beam.xAxis().getNpix();
+  patch.ny_ = beam.yAxis().getNpix();
+  patch.ix0_ = iMax % patch.nx_;
+  patch.iy0_ = iMax / patch.nx_;
+
+  patch.hx_ = (halfWidth == 0 || halfWidth > patch.nx_) ? patch.nx_ : halfWidth;
+  patch.hy_ = (halfWidth == 0 || halfWidth > patch.ny_) ? patch.ny_ : halfWidth;
+
+  patch.data_.resize(patch.nx_ * patch.ny_);
+  patch.maxSidelobe_ = 0.0;
+
+  for(unsigned iy=0; iy < patch.ny_; iy++) {
+    for(unsigned ix=0; ix < patch.nx_; ix++) {
+      unsigned ind = iy * patch.nx_ + ix;
+      patch.data_[ind] = beam.data_[ind] / val;
+
+      unsigned dx = ix > patch.ix0_ ? ix - patch.ix0_ : patch.ix0_ - ix;
+      unsigned dy = iy > patch.iy0_ ? iy - patch.iy0_ : patch.iy0_ - iy;
+
+      if((dx > patch.hx_ || dy > patch.hy_) && fabs(patch.data_[ind]) > patch.maxSidelobe_)
+	patch.maxSidelobe_ = fabs(patch.data_[ind]);
+    }
+  }
+}
+
+/**.......................................................................
+ * Return the residual of largest absolute value inside the clean
+ * windows.  The maximum over each run is found first, so that the
+ * inner loop is a plain reduction, and the pixel is only located in
+ * the run that contains it
+ */
+double VisDataSet::getCleanPeak(float* data, std::vector<CleanSpan>& spans, unsigned& iMax)
+{
+  float absMax = -1.0;
+  unsigned iSpanMax = 0;
+
+  for(unsigned iSpan=0; iSpan < spans.size(); iSpan++) {
+    float* ptr = data + spans[iSpan].start_;
+    unsigned n = spans[iSpan].n_;
+    float spanMax = 0.0;
+
+    for(unsigned i=0; i < n; i++) {
+      float val = fabsf(ptr[i]);
+      spanMax = val > spanMax ? val : spanMax;
+    }
+
+    if(spanMax > absMax) {
+      absMax   = spanMax;
+      iSpanMax = iSpan;
+    }
+  }
+
+  CleanSpan& span = spans[iSpanMax];
+  iMax = span.start_;
+
+  for(unsigned i=0; i < span.n_; i++) {
+    if(fabsf(data[span.start_ + i]) == absMax) {
+      iMax = span.start_ + i;
+      break;
+    }
+  }
+
+  return data[iMax];
+}
+
+/**.......................................................................
+ * Subtract flux times the beam patch, centered on pixel iPix, from
+ * the residual image
+ */
+void VisDataSet::subtractBeamPatch(Image& image, unsigned iPix, double flux, CleanBeamPatch& patch)
+{
+  int nx = patch.nx_;
+  int ny = patch.ny_;
+  int px = iPix % nx;
+  int py = iPix / nx;
+
+  //------------------------------------------------------------
+  // Restrict to the rows and columns covered both by the patch and
+  // by the image
+  //------------------------------------------------------------
+
+  int dx = px - (int)patch.ix0_;
+  int dy = py - (int)patch.iy0_;
+
+  int xMin = std::max(std::max(0, px - (int)patch.hx_), dx);
+  int xMax = std::min(std::min(nx-1, px + (int)patch.hx_), nx-1 + dx);
+  int yMin = std::max(std::max(0, py - (int)patch.hy_), dy);
+  int yMax = std::min(std::min(ny-1, py + (int)patch.hy_), ny-1 + dy);
+
+  float scale = flux;
+
+  for(int iy=yMin; iy <= yMax; iy++) {
+    float* resPtr  = &image.data_[iy * nx];
+    float* beamPtr = &patch.data_[0] + (iy - dy) * nx - dx;
+
+    for(int ix=xMin; ix <= xMax; ix++)
+      resPtr[ix] -= scale * beamPtr[ix];
+  }
+}
+
 /**.......................................................................
  * Install a PgModel to display the synthesized beam
  */
@@ -6698,6 +7784,13 @@ std::string VisDataSet::parseFileName(std::string fileName, bool& shiftRequested
  */
 void VisDataSet::operator+=(VisDataSet& vds)
 {
+  //------------------------------------------------------------
+  // Merging forms a new beam for each frequency and Stokes
+  // parameter separately, so none can remain shared
+  //------------------------------------------------------------
+
+  unsharePrimaryBeams();
+
   //------------------------------------------------------------
   // Iterate over all VisFreqData objects in the passed datasets,
   // adding them to ours.  We don't assume that these objects
@@ -7395,7 +8488,7 @@ void VisDataSet::printReIm()
 	for(unsigned iPop=0; iPop < freqData.griddedData_.populatedIndices_.size(); iPop++) {
 	  unsigned ind = freqData.griddedData_.populatedIndices_[iPop];
 	  COUT("re = " << freqData.griddedData_.out_[ind][0] << " im = " << freqData.griddedData_.out_[ind][1] << " reerr = " 
-	       << freqData.griddedData_.errorInMean_[ind][0] << " imerr = " << freqData.griddedData_.errorInMean_[ind][1]);
+	       << freqData.griddedData_.populatedReErr_[iPop] << " imerr = " << freqData.griddedData_.populatedImErr_[iPop]);
 	}
       }
     }
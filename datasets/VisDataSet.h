@@ -16,9 +16,11 @@
 #include "gcp/datasets/DataSet2D.h"
 
 #include "gcp/fftutil/Antenna.h"
+#include "gcp/fftutil/DirtyTileMask.h"
 #include "gcp/fftutil/FitsIoHandler.h"
 #include "gcp/fftutil/Generic2DAngularModel.h"
 #include "gcp/fftutil/Image.h"
+#include "gcp/fftutil/MosaicSky.h"
 #include "gcp/fftutil/ObsInfo.h"
 #include "gcp/fftutil/Stokes.h"
 #include "gcp/fftutil/UvDataGridder.h"
@@ -209,6 +211,51 @@ namespace gcp {
 
       };
 
+      //=======================================================================
+      // Convenience struct for computing a block of hour angles of
+      // the simulated uvw tracks on a thread pool
+      //=======================================================================
+
+      struct SimTrackExecData {
+	VisDataSet* vds_;
+	gcp::util::ObsInfo* obs_;
+	unsigned iBlock_;
+	unsigned nBlock_;
+	unsigned iHaStart_;
+	unsigned iHaStop_;
+      };
+
+      //=======================================================================
+      // A pool of scratch images for rendering image-plane model
+      // components.  An image is checked out only for the duration
+      // of a single addModel() call, so at most one image per
+      // concurrently executing thread is ever allocated, rather than
+      // one per VisFreqData
+      //=======================================================================
+
+      class ScratchImagePool {
+      public:
+
+	~ScratchImagePool();
+
+	// Check out an image, preferring one whose axes already match
+	// the passed image
+
+	gcp::util::Image* checkout(gcp::util::Image& image);
+
+	// Return an image to the pool
+
+	void checkin(gcp::util::Image* image);
+
+      private:
+
+	gcp::util::Mutex guard_;
+	std::vector<gcp::util::Image*> free_;
+	std::vector<gcp::util::Image*> all_;
+      };
+
+      static ScratchImagePool scratchImages_;
+
       //=======================================================================
       // For a given type of baseline at a single Stokes parameter and
       // frequency, this struct encapsulates all timestamps and
@@ -225,13 +272,24 @@ namespace gcp {
 
 	gcp::util::Image compositeImageModel_;
 
-	// A work array to save object creation and destruction during
-	// construction of the composite Image-plane model
+	// Tiles of the composite model that components have been added
+	// to since it was last cleared.  Compact components only touch
+	// a few tiles, so clearing the model and applying the primary
+	// beam need only visit those
+
+	gcp::util::DirtyTileMask compositeModelTiles_;
 
-	gcp::util::Image imageModelComponent_;
+	// Individual image-plane model components are rendered into
+	// scratch images checked out from VisDataSet::scratchImages_
 
 	// A container for holding the transform of the composite
-	// Image-plane model
+	// Image-plane model.
+	//
+	// Unlike the component images, this is not drawn from a
+	// per-thread pool: its output array must persist from
+	// transformModel() until computeChisq() and remModel() read the
+	// model visibilities, and its input array receives the inverse
+	// transform for display
 
 	gcp::util::Dft2d compositeImageModelDft_;
 
@@ -248,6 +306,17 @@ namespace gcp {
 
 	gcp::util::UvDataGridder compositeFourierModelDft_;
 
+	// The Fourier-plane gridders are only sized when a
+	// Fourier-plane model is first added
+
+	bool fourierModelInitialized_;
+
+	// True if all indices of the Fourier-plane gridders should be
+	// populated (for simulations and clean images), rather than
+	// just those containing data
+
+	bool fourierModelUsesAllIndices_;
+
 	//------------------------------------------------------------
 	// Data handling
 	//------------------------------------------------------------
@@ -257,13 +326,48 @@ namespace gcp {
 	gcp::util::UvDataGridder griddedData_;
 
 	// A container for performing temporary operations, like
-	// gridding residuals for a single frequency
+	// gridding residuals for a single frequency.  This is only
+	// needed for display, and is sized on first use: access it via
+	// getUtilityGridder()
 
 	gcp::util::UvDataGridder utilityGridder_;
+	bool utilityGridderInitialized_;
+
+	// The absolute position of this data set, if known
+
+	gcp::util::HourAngle ra_;
+	gcp::util::Declination dec_;
+	bool hasAbsolutePosition_;
 
-	// A primary beam for this frequency and Stokes parameter
+	// A primary beam for this frequency and Stokes parameter.
+	// Unshifted beams depend only on the antennas, frequency and
+	// grid, so a later Stokes parameter of the same group can
+	// point sharedBeam_ at an earlier one's beam instead of
+	// holding its own copy.  Read the beam via primaryBeam()
 
 	gcp::util::Image primaryBeam_;
+	gcp::util::Image* sharedBeam_;
+
+	//------------------------------------------------------------
+	// Coarse-resolution likelihood, used during burn-in.  At
+	// resolution level L > 0, image-plane models are rendered on a
+	// grid with 2^L fewer pixels per axis (same angular size), and
+	// chisq is evaluated only over the populated uv cells that the
+	// coarse transform covers
+	//------------------------------------------------------------
+
+	unsigned resLevel_;
+	gcp::util::Image coarseImageModel_;
+	gcp::util::DirtyTileMask coarseModelTiles_;
+	gcp::util::Image coarsePrimaryBeam_;
+	gcp::util::Dft2d coarseImageModelDft_;
+
+	// For each retained uv cell, its index into
+	// griddedData_.populatedIndices_, and the corresponding index
+	// into the coarse transform
+
+	std::vector<unsigned> coarseDataInd_;
+	std::vector<unsigned> coarseModelInd_;
 
 	// The frequency of this data set
 
@@ -329,6 +433,15 @@ namespace gcp {
 
 	bool hasImage_;
 	bool generatingFakeData_;
+
+	// Noiseless model visibilities for every hour angle and
+	// baseline of this group, filled by
+	// simulateModelVisibilities() and released once noise has been
+	// added
+
+	std::vector<double> simRe_;
+	std::vector<double> simIm_;
+	std::vector<unsigned char> simValid_;
 	
 	//------------------------------------------------------------
 	// For multithreading
@@ -336,6 +449,10 @@ namespace gcp {
 
 	VisExecData* execData_;
 
+	// A label identifying this object in profiles
+
+	std::string profileLabel_;
+
 	//------------------------------------------------------------
 	// For convenience, a copy of the combined synthesized beam of
 	// this dataset
@@ -403,6 +520,15 @@ namespace gcp {
 	  generatingFakeData_ = false;
 
 	  execData_ = 0;
+
+	  fourierModelInitialized_    = false;
+	  fourierModelUsesAllIndices_ = false;
+	  utilityGridderInitialized_  = false;
+	  hasAbsolutePosition_        = false;
+
+	  resLevel_ = 0;
+
+	  sharedBeam_ = 0;
 	}
 
 	virtual ~VisFreqData() {
@@ -416,11 +542,23 @@ namespace gcp {
 
 	std::string formatString();
 
+	// The primary beam used for this frequency and Stokes
+	// parameter, whether owned or shared
+
+	gcp::util::Image& primaryBeam() {
+	  return sharedBeam_ ? *sharedBeam_ : primaryBeam_;
+	}
+
+	bool primaryBeamIsShifted();
+	bool canSharePrimaryBeamWith(VisFreqData& freq);
+	void sharePrimaryBeamWith(VisFreqData& freq);
+	void unsharePrimaryBeam();
+
 	// Add a model component to this data set
 
-	void addModel(gcp::util::Generic2DAngularModel& model);
+	void addModel(gcp::util::Generic2DAngularModel& model, gcp::util::MosaicSky* sky=0);
 	void remModel();
-	void addImagePlaneModel(gcp::util::Generic2DAngularModel& model);
+	void addImagePlaneModel(gcp::util::Generic2DAngularModel& model, gcp::util::MosaicSky* sky=0);
 	void addFourierPlaneModel(gcp::util::Generic2DAngularModel& model);
 
 	// Clear all model components
@@ -433,7 +571,34 @@ namespace gcp {
 
 	// Resize to match an image
 
-	void resize(gcp::util::Image& image, bool isSim, gcp::util::UvDataGridder** planGridder);
+	void resize(gcp::util::Image& image, bool isSim);
+
+	// Size gridders that are only needed on demand
+
+	gcp::util::UvDataGridder& getUtilityGridder();
+	void initializeFourierModel();
+
+	// Populate all indices of the Fourier-plane model gridders
+
+	void setFourierModelIndicesToAll();
+
+	// Set the absolute position of this data set
+
+	void setRaDec(gcp::util::HourAngle& ra, gcp::util::Declination& dec);
+
+	// Switch to a coarser (level > 0) or full (level = 0)
+	// resolution likelihood.  Returns the level actually applied
+
+	unsigned setResolutionLevel(unsigned level);
+
+	// The image-plane model (and its transform) for the current
+	// resolution level
+
+	gcp::util::Image& activeImageModel();
+	gcp::util::Dft2d& activeImageModelDft();
+	gcp::util::DirtyTileMask& activeModelTiles();
+
+	gcp::util::ChisqVariate computeCoarseChisq();
 
 	bool isImagePlaneModel(gcp::util::Generic2DAngularModel& model);
 
@@ -449,6 +614,18 @@ namespace gcp {
 	void accumulateMoments(bool first, VisDataSet::VisData& data, gcp::util::Angle& xShift, gcp::util::Angle& yShift);
 	void accumulateVarianceStats(VisDataSet::VisData& data);
 
+	// With interpolated gridding (DO_INTERP), visibilities are
+	// buffered as they are read, and gridded in a single batch
+	// once the read pass is complete
+
+	std::vector<double> bufU_;
+	std::vector<double> bufV_;
+	std::vector<double> bufRe_;
+	std::vector<double> bufIm_;
+	std::vector<double> bufWt_;
+
+	void gridBufferedVis(bool first, gcp::util::Dft2d::ConvKernelType kernel, gcp::util::ThreadPool* pool);
+
 	void storeWtSum(gcp::util::Angle& xShift, gcp::util::Angle& yShift);
 
 	//------------------------------------------------------------
@@ -464,7 +641,7 @@ namespace gcp {
 	// Simulation only
 	//------------------------------------------------------------
 
-	void addImage(gcp::util::Image& image, gcp::util::UvDataGridder** planGridder);
+	void addImage(gcp::util::Image& image);
 
 	// Return true if an image has been installed for this
 	// Frequency
@@ -706,6 +883,12 @@ namespace gcp {
 
       virtual gcp::util::ChisqVariate computeChisq();
 
+      //------------------------------------------------------------
+      // Coarse-to-fine likelihood schedule
+      //------------------------------------------------------------
+
+      virtual unsigned setResolutionLevel(unsigned level);
+
       // Install frequencies
 
       void installFrequencies(std::vector<gcp::util::Frequency>& freqs);
@@ -715,6 +898,11 @@ namespace gcp {
 
       void computePrimaryBeams();
 
+      // Give every VisFreqData its own copy of any shared primary
+      // beam, before beams are modified independently
+
+      void unsharePrimaryBeams();
+
       // Shift data if requested
 
       void shiftIfRequested();
@@ -728,6 +916,32 @@ namespace gcp {
       static gcp::util::Model* addDeltaFunctionModel(std::vector<gcp::util::Model*>& models, 
 						     double flux, gcp::util::Angle& xOff, gcp::util::Angle& yOff);
 
+      // A contiguous run of pixels to be searched by CLEAN
+
+      struct CleanSpan {
+	unsigned start_;
+	unsigned n_;
+      };
+
+      // The dirty beam, normalized to unit peak, and the region of it
+      // subtracted in each CLEAN minor cycle
+
+      struct CleanBeamPatch {
+	std::valarray<float> data_;
+	unsigned nx_;
+	unsigned ny_;
+	unsigned ix0_;      // The pixel location of the beam peak
+	unsigned iy0_;
+	unsigned hx_;       // The half-width of the patch, in pixels
+	unsigned hy_;
+	double maxSidelobe_; // The largest sidelobe outside the patch
+      };
+
+      static std::vector<CleanSpan> getCleanSpans(gcp::util::Image& image, std::vector<gcp::util::Image::Window>& windows);
+      static void getCleanBeamPatch(gcp::util::Image& beam, unsigned halfWidth, CleanBeamPatch& patch);
+      static double getCleanPeak(float* data, std::vector<CleanSpan>& spans, unsigned& iMax);
+      static void subtractBeamPatch(gcp::util::Image& image, unsigned iPix, double flux, CleanBeamPatch& patch);
+
       static std::vector<gcp::util::Image::Window> parseWindows(std::string windowSpec, gcp::util::Image& image);
 
       static std::string parseFileName(std::string fileStr, bool& shiftRequested, gcp::util::Angle& xoff, gcp::util::Angle& yoff);
@@ -753,6 +967,11 @@ namespace gcp {
       void remModel();
       void clearModel();
 
+      // Render model components shared with the other pointings of a
+      // mosaic from a common sky, rather than on our own images
+
+      void setSharedSky(gcp::util::MosaicSky* sky);
+
       void displayPrimaryBeams();
 
       //------------------------------------------------------------
@@ -942,6 +1161,11 @@ namespace gcp {
       bool reverseDisplay_;
       bool forceWt_;
 
+      // The kernel used to grid this dataset's visibilities, when
+      // interpolating
+
+      gcp::util::Dft2d::ConvKernelType gridKernelType_;
+
       double wtSumTotal_;
 
       double wtMin_;
@@ -949,6 +1173,34 @@ namespace gcp {
 
       bool shiftRequested_;
 
+      //------------------------------------------------------------
+      // Precomputed geometry for simulating visibilities.  The uvw
+      // of every baseline is computed once per hour angle, and
+      // shared by all Stokes parameters and frequencies
+      //------------------------------------------------------------
+
+      unsigned simNHa_;
+      unsigned simNBaseline_;
+
+      // The index of the first baseline of each group in the track
+      // arrays
+
+      std::vector<unsigned> simGroupOffset_;
+
+      // Baseline XYZ separations, indexed by baseline
+
+      std::vector<gcp::util::LengthTriplet> simDxyz_;
+
+      // UVW tracks (meters), indexed by (iHa * simNBaseline_ + iBase) * 3
+
+      std::vector<double> simUvw_;
+
+      // Array-center Az/El, indexed by hour angle
+
+      std::vector<gcp::util::PolarLengthVector> simAzEl_;
+
+      gcp::util::ThreadSynchronizer simSynchronizer_;
+
       //------------------------------------------------------------
       // If multiple files were specified, we are stacking data into
       // this dataset.  In this case, we will instantiate a vector of
@@ -1117,6 +1369,10 @@ namespace gcp {
 			       unsigned iGroup, unsigned iStokes, unsigned iFreq);
       static EXECUTE_FN(execAddModel);
 
+      // The sky shared with the other pointings of a mosaic, if any
+
+      gcp::util::MosaicSky* sharedSky_;
+
       // Multi-threaded version of computeChisq
 
       void computeChisqMultiThread(VisFreqData& vfd, gcp::util::ChisqVariate& chisq,
@@ -1139,6 +1395,20 @@ namespace gcp {
 					 unsigned iGroup, unsigned iStokes, unsigned iFreq);
       static EXECUTE_FN(execComputePrimaryBeam);
 
+      // Multi-threaded calculation of simulated uvw tracks, over
+      // blocks of hour angles
+
+      void computeSimulationTracks(gcp::util::ObsInfo& obs);
+      void computeSimulationTracks(gcp::util::ObsInfo& obs, unsigned iHaStart, unsigned iHaStop);
+      static EXECUTE_FN(execComputeSimulationTracks);
+
+      // Multi-threaded interpolation of model visibilities along the
+      // simulated uvw tracks, over groups, Stokes and frequencies
+
+      void simulateModelVisibilities();
+      void simulateModelVisibilities(VisFreqData& vfd, unsigned iGroup);
+      static EXECUTE_FN(execSimulateModelVisibilities);
+
       void registerDone(unsigned iGroup, unsigned iStokes, unsigned iFreq);
       void registerPending(unsigned iGroup, unsigned iStokes, unsigned iFreq);
       void waitUntilDone();
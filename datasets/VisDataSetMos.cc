@@ -51,6 +51,9 @@ VisDataSetMos::VisDataSetMos()
 
   addParameter("forcewt",        DataType::BOOL,   "If true, force weights to match the data variance (wtscale must be set to 'auto')");
   addParameter("displaybeam",    DataType::BOOL,   "If true, display the synthesized beam on read-in");
+  addParameter("sharesky",       DataType::BOOL,   "If true (the default), model components that overlap several pointings are rendered once on a sky common to all pointings, and resampled onto each pointing");
+
+  setParameter("sharesky", "true");
 
   //------------------------------------------------------------
   // Add position information for this object too
@@ -155,10 +158,39 @@ void VisDataSetMos::loadData(bool simulate)
 
   DataSetManager::loadData(simulate);
 
-  if(dataSetMap_.size() == 1) {
+  if(dataSetMap_.size() == 1 && remoteDataSetMap_.size() == 0) {
     VisDataSet* dataSet = (VisDataSet*)dataSetMap_.begin()->second;
     dataSet->insertSynthesizedBeamModelForPlots(pgManager_);
   }
+
+  initializeSharedSky();
+}
+
+/**.......................................................................
+ * Center the shared sky on the mean pointing position, covering all
+ * pointings, and install it in our datasets
+ */
+void VisDataSetMos::initializeSharedSky()
+{
+  HourAngle   raMean;
+  Declination decMean;
+
+  getMeanPosition(raMean, decMean);
+
+  std::vector<HourAngle>   ras;
+  std::vector<Declination> decs;
+
+  for(std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
+      diter != dataSetMap_.end(); diter++) {
+    VisDataSet* dataSet = (VisDataSet*)diter->second;
+
+    ras.push_back(dataSet->ra_);
+    decs.push_back(dataSet->dec_);
+
+    dataSet->setSharedSky(&sky_);
+  }
+
+  sky_.setPointings(raMean, decMean, ras, decs);
 }
 
 /**.......................................................................
@@ -508,11 +540,18 @@ void VisDataSetMos::getMeanPosition(HourAngle& raMean, Declination& decMean)
   double X,Y,Z;
   double XMean, YMean, ZMean;
 
+  std::vector<gcp::util::DataSet*> pointings = getPointingsWithPosition();
+
+  if(pointings.size() == 0) {
+    raMean  = ra_;
+    decMean = dec_;
+    return;
+  }
+
   unsigned iDataSet=0;
-  for(std::map<std::string, gcp::util::DataSet*>::iterator iter=dataSetMap_.begin(); 
-      iter != dataSetMap_.end(); iter++) {
+  for(unsigned iPoint=0; iPoint < pointings.size(); iPoint++) {
 
-    gcp::datasets::VisDataSet* visDataSet = (gcp::datasets::VisDataSet*)iter->second;
+    gcp::util::DataSet* visDataSet = pointings[iPoint];
 
     double raCurrDeg  =  visDataSet->ra_.degrees();
     double decCurrDeg = visDataSet->dec_.degrees();
@@ -661,6 +700,26 @@ void VisDataSetMos::displayIfRequested()
   }
 }
 
+/**.......................................................................
+ * Return the pointings whose positions we know: all of the ones we
+ * loaded, and any held by other shards whose positions were reported
+ * to us
+ */
+std::vector<gcp::util::DataSet*> VisDataSetMos::getPointingsWithPosition()
+{
+  std::vector<gcp::util::DataSet*> pointings;
+
+  for(std::map<std::string, gcp::util::DataSet*>::iterator iter=dataSetMap_.begin(); iter != dataSetMap_.end(); iter++)
+    pointings.push_back(iter->second);
+
+  for(std::map<std::string, gcp::util::DataSet*>::iterator iter=remoteDataSetMap_.begin(); iter != remoteDataSetMap_.end(); iter++) {
+    if(iter->second->hasAbsolutePosition_)
+      pointings.push_back(iter->second);
+  }
+
+  return pointings;
+}
+
 gcp::util::DataSet* VisDataSetMos::getDataSet(std::string name)
 {
   for(std::map<std::string, gcp::util::DataSet*>::iterator iter=dataSetMap_.begin(); iter != dataSetMap_.end(); iter++) {
@@ -670,6 +729,18 @@ gcp::util::DataSet* VisDataSetMos::getDataSet(std::string name)
       return dataSet;
   }
 
+  //------------------------------------------------------------
+  // Pointings held by other shards can still be named, e.g. to
+  // install their positions
+  //------------------------------------------------------------
+
+  for(std::map<std::string, gcp::util::DataSet*>::iterator iter=remoteDataSetMap_.begin(); iter != remoteDataSetMap_.end(); iter++) {
+    gcp::util::DataSet* dataSet = iter->second;
+
+    if(dataSet->name_ == name)
+      return dataSet;
+  }
+
   ThrowSimpleColorError("Invalid dataset name: " << name << " for dataset manager " << name_, "red");
   return 0;
 }
@@ -947,38 +1018,61 @@ void VisDataSetMos::clean()
 
 void VisDataSetMos::addModel(gcp::util::Model& model)
 {
-  //------------------------------------------------------------
-  // Check if this model has an absolute position.  If not, set it up
-  // to be the same as our center position
-  //------------------------------------------------------------
+  bool begun = false;
 
-  for(std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
-      diter != dataSetMap_.end(); diter++) {
-    DataSet* dataSet = diter->second;
+  try {
 
-    if(dataSet->applies(model)) {
+    //------------------------------------------------------------
+    // Check if this model has an absolute position.  If not, set it
+    // up to be the same as our center position
+    //------------------------------------------------------------
 
-      Generic2DAngularModel* model2d = (Generic2DAngularModel*) &model;
+    for(std::map<std::string, gcp::util::DataSet*>::iterator diter = dataSetMap_.begin();
+	diter != dataSetMap_.end(); diter++) {
+      DataSet* dataSet = diter->second;
 
-      //------------------------------------------------------------
-      // If this model has no absolute position, set its position to
-      // be our mean position
-      //------------------------------------------------------------
+      if(dataSet->applies(model)) {
 
-      model2d->checkPosition();
+	Generic2DAngularModel* model2d = (Generic2DAngularModel*) &model;
 
-      if(!model2d->hasAbsolutePosition_) {
-	model2d->setRa(ra_);
-	model2d->setDec(dec_);
-      }
+	//------------------------------------------------------------
+	// If this model has no absolute position, set its position to
+	// be our mean position
+	//------------------------------------------------------------
+
+	model2d->checkPosition();
+
+	if(!model2d->hasAbsolutePosition_) {
+	  model2d->setRa(ra_);
+	  model2d->setDec(dec_);
+	}
+
+	//------------------------------------------------------------
+	// Decide once whether this component is rendered on the
+	// shared sky.  Any renderings are made by the first pointing
+	// that needs them, and reused by the rest
+	//------------------------------------------------------------
+
+	if(!begun) {
+	  if(getBoolVal("sharesky"))
+	    sky_.begin(*model2d, DataSetType::DATASET_RADIO);
+	  begun = true;
+	}
 
-      //------------------------------------------------------------
-      // Now add the model with modified position
-      //------------------------------------------------------------
+	//------------------------------------------------------------
+	// Now add the model with modified position
+	//------------------------------------------------------------
 
-      dataSet->addModel(model);
+	dataSet->addModel(model);
+      }
     }
+
+  } catch(...) {
+    sky_.end();
+    throw;
   }
+
+  sky_.end();
 }
 
 void VisDataSetMos::checkPosition(bool override)
@@ -1027,4 +1121,11 @@ void VisDataSetMos::checkPosition(bool override)
   } else {
     setRa(raMean, false);
   }
+
+  //------------------------------------------------------------
+  // Pointing positions may have changed, so recompute the extent of
+  // the shared sky
+  //------------------------------------------------------------
+
+  initializeSharedSky();
 }
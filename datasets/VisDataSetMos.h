@@ -15,6 +15,8 @@
 #include "gcp/datasets/DataSetManager.h"
 #include "gcp/datasets/VisDataSet.h"
 
+#include "gcp/fftutil/MosaicSky.h"
+
 #include "gcp/util/String.h"
 #include "gcp/util/Declination.h"
 #include "gcp/util/HourAngle.h"
@@ -81,6 +83,16 @@ namespace gcp {
 
       void initializeDataSets(std::string fileList);
 
+    private:
+
+      // Extended model components are rendered once for all
+      // pointings on this common sky
+
+      gcp::util::MosaicSky sky_;
+
+      void initializeSharedSky();
+      std::vector<gcp::util::DataSet*> getPointingsWithPosition();
+
     }; // End class VisDataSetMos
 
   } // End namespace datasets
@@ -9,12 +9,6 @@ using namespace std;
 
 using namespace gcp::util;
 
-unsigned  Antenna::nxCached_ = 0;
-unsigned  Antenna::nyCached_ = 0;
-fftw_plan Antenna::forwardPlan_;
-fftw_plan Antenna::inversePlan_;
-bool      Antenna::planCached_ = false;
-
 /**.......................................................................
  * Constructor.
  */
@@ -330,16 +324,12 @@ Image Antenna::getRealisticApertureField(Image& image, Frequency& freq, Angle xo
  */
 Image Antenna::getGenericRealisticApertureField(Image& image, Frequency& freq, Angle xoff, Angle yoff)
 {
-  Dft2d dft;
-  bool cached = planIsCached(image);
-
   //------------------------------------------------------------
-  // If we already have a plan cached for a transform of this size,
-  // don't recompute it, but set it externally instead
+  // Plans for transforms of this size are shared through the
+  // FftwPlanRegistry, so are only computed the first time
   //------------------------------------------------------------
 
-  if(cached)
-    dft.setPlan(forwardPlan_, inversePlan_);
+  Dft2d dft;
 
   dft.zeropad(true, 4);
 
@@ -349,13 +339,6 @@ Image Antenna::getGenericRealisticApertureField(Image& image, Frequency& freq, A
   dft.xAxis().setAngularSize(image.xAxis().getAngularSize());
   dft.yAxis().setAngularSize(image.yAxis().getAngularSize());
 
-  //------------------------------------------------------------
-  // And if no plan was cached, cache it now
-  //------------------------------------------------------------
-
-  if(!cached)
-    cachePlan(image, dft.forwardPlan_, dft.inversePlan_);
-
   wave_.setFrequency(freq);
 
   // At this point, I'm considering a J0 Bessel current grading across
@@ -382,16 +365,12 @@ Image Antenna::getGenericRealisticApertureField(Image& image, Frequency& freq, A
  */
 Image Antenna::getSpecificRealisticApertureField(Image& image, Frequency& freq, Angle xoff, Angle yoff)
 {
-  Dft2d dft;
-  bool cached = planIsCached(image);
-
   //------------------------------------------------------------
-  // If we already have a plan cached for a transform of this size,
-  // don't recompute it, but set it externally instead
+  // Plans for transforms of this size are shared through the
+  // FftwPlanRegistry, so are only computed the first time
   //------------------------------------------------------------
 
-  if(cached)
-    dft.setPlan(forwardPlan_, inversePlan_);
+  Dft2d dft;
 
   dft.zeropad(true, 4);
 
@@ -401,13 +380,6 @@ Image Antenna::getSpecificRealisticApertureField(Image& image, Frequency& freq,
   dft.xAxis().setAngularSize(image.xAxis().getAngularSize());
   dft.yAxis().setAngularSize(image.yAxis().getAngularSize());
 
-  //------------------------------------------------------------
-  // And if no plan was cached, cache it now
-  //------------------------------------------------------------
-
-  if(!cached)
-    cachePlan(image, dft.forwardPlan_, dft.inversePlan_);
-
   wave_.setFrequency(freq);
 
   switch(type_) {
@@ -794,22 +766,3 @@ PolarLengthVector Antenna::getAzEl(HourAngle* ha, Declination* dec)
   lla_ = getAntennaLla();
   return geoid_.geodeticLlaAndHaDecToAzElTest(lla_, *ha, *dec);
 }
-
-void Antenna::cachePlan(Image& image, fftw_plan forwardPlan, fftw_plan inversePlan)
-{
-  nxCached_    = image.xAxis().getNpix();
-  nyCached_    = image.yAxis().getNpix();
-  forwardPlan_ = forwardPlan;
-  inversePlan_ = inversePlan;
-  planCached_  = true;
-}
-
-bool Antenna::planIsCached(Image& image)
-{
-  if(planCached_ && nxCached_ == image.xAxis().getNpix() && nyCached_ == image.yAxis().getNpix()) 
-    return true;
-  else {
-    planCached_ = false;
-    return false;
-  }
-}
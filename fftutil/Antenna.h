@@ -23,7 +23,7 @@
 
 #include <map>
 
-#include <fftw3.h>
+#include "gcp/fftutil/FftwPrecision.h"
 
 namespace gcp {
 
@@ -200,21 +200,8 @@ namespace gcp {
 
       PolarLengthVector getAzEl(HourAngle* ra, Declination* dec);
 
-      //------------------------------------------------------------
-      // Plan caching
-      //------------------------------------------------------------
-
-      bool planIsCached(Image& image);
-      void cachePlan(Image& image, fftw_plan forwardPlan, fftw_plan inversePlan);
-
     public:
 
-      static unsigned nxCached_;
-      static unsigned nyCached_;
-      static bool planCached_;
-      static fftw_plan forwardPlan_;
-      static fftw_plan inversePlan_;
-
       friend class gcp::datasets::VisDataSet;
 
       Length diameter_;
@@ -90,6 +90,17 @@ namespace gcp {
 	return computeChisq();
       }
 
+      //------------------------------------------------------------
+      // Request a coarser approximation to the likelihood (each
+      // level halves the model resolution; 0 = full resolution).
+      // Returns the level actually applied.  Datasets that don't
+      // support this always evaluate at full resolution
+      //------------------------------------------------------------
+
+      virtual unsigned setResolutionLevel(unsigned level) {
+	return 0;
+      }
+
       //------------------------------------------------------------
       // Return true if a passed model applies to this type of dataset
       //------------------------------------------------------------
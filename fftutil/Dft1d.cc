@@ -1,4 +1,5 @@
 #include "gcp/fftutil/Dft1d.h"
+#include "gcp/fftutil/FftwPlanRegistry.h"
 
 #include "gcp/util/Exception.h"
 
@@ -96,7 +97,9 @@ Dft1d::~Dft1d()
  */
 void Dft1d::computePlan(unsigned flag) 
 {
+  FftwPlanRegistry::lock();
   plan_ = fftw_plan_dft_r2c_1d(n_, in_, out_, flag);
+  FftwPlanRegistry::unlock();
 }
 
 /**.......................................................................
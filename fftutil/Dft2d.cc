@@ -1,4 +1,5 @@
 #include "gcp/fftutil/Dft2d.h"
+#include "gcp/fftutil/FftwPlanRegistry.h"
 #include "gcp/pgutil/PgUtil.h"
 
 #include <vector>
@@ -8,7 +9,11 @@ using namespace gcp::util;
 
 const double Dft2d::convSigInPixels_  = 0.594525;
 const int    Dft2d::convMaskInPixels_ = 2;
-Mutex Dft2d::planGuard_;
+const int    Dft2d::convMaxMaskInPixels_;
+
+const unsigned Dft2d::convOversamp_ = 1000;
+const std::vector<double> Dft2d::gaussianKernel_   = Dft2d::tabulateConvolutionKernel(Dft2d::CONV_GAUSSIAN);
+const std::vector<double> Dft2d::spheroidalKernel_ = Dft2d::tabulateConvolutionKernel(Dft2d::CONV_SPHEROIDAL);
 
 /**.......................................................................
  * Constructors
@@ -35,6 +40,8 @@ void Dft2d::operator=(Dft2d& dft)
 
   xAxis_ = dft.xAxis_;
   yAxis_ = dft.yAxis_;
+
+  setConvolutionKernel(dft.convKernelType_);
 }
 
 /**.......................................................................
@@ -68,11 +75,16 @@ void Dft2d::initialize()
   invPlanTmp_  = 0;
   precomputedPlan_ = false;
 
+  forwardPlan_ = 0;
+  inversePlan_ = 0;
+
   fwdPlanComputed_  = false;
   invPlanComputed_  = false;
 
   axes_ = ImageAxis::AXIS_NONE;
 
+  setConvolutionKernel(CONV_GAUSSIAN);
+
   xAxis_.setAxisType(Axis::AXIS_X);
   yAxis_.setAxisType(Axis::AXIS_Y);
 
@@ -108,22 +120,16 @@ Dft2d::Dft2d(Image& image, bool optimize)
 Dft2d::~Dft2d() 
 {
   if(in_) {
-    fftw_free(in_);
+    FFTW_CALL(free)(in_);
     in_ = 0;
   }
 
   if(out_) {
-    fftw_free(out_);
+    FFTW_CALL(free)(out_);
     out_ = 0;
   }
 
-  if(fwdPlanTmp_) {
-    fftw_destroy_plan(forwardPlan_);
-  }
-
-  if(invPlanTmp_) {
-    fftw_destroy_plan(inversePlan_);
-  }
+  // Plans belong to the FftwPlanRegistry, and are not destroyed here
 }
 
 /**.......................................................................
@@ -146,58 +152,32 @@ void Dft2d::zeropad(bool pad, unsigned fac)
 }
 
 /**.......................................................................
- * Compute a plan for this fft
+ * Get plans for this fft.  Plans are shared by all transforms of the
+ * same size, and computed only the first time a size is requested
  */
 void Dft2d::computePlan(unsigned flag) 
 {
-  planGuard_.lock();
-
   if(fwdPlanTmp_ == 0 && invPlanTmp_ == 0) {
 
-    //    COUT(pthread_self() << " Computing plans for nxZeroPad_ = " << nxZeroPad_);
-    //    COUT(pthread_self() << " Computing plans for nyZeroPad_ = " << nyZeroPad_);
-    
-    if(fwdPlanComputed_) {
-      fftw_destroy_plan(forwardPlan_);
-    }
-
-    if(invPlanComputed_) {
-      fftw_destroy_plan(inversePlan_);
-    }
-
-    forwardPlan_ = fftw_plan_dft_r2c_2d(nxZeroPad_, nyZeroPad_, in_,  out_, flag);
-    inversePlan_ = fftw_plan_dft_c2r_2d(nxZeroPad_, nyZeroPad_, out_, in_,  flag);
+    forwardPlan_ = FftwPlanRegistry::getPlan(nxZeroPad_, nyZeroPad_, FftwPlanRegistry::DIR_FORWARD, in_, out_, flag);
+    inversePlan_ = FftwPlanRegistry::getPlan(nxZeroPad_, nyZeroPad_, FftwPlanRegistry::DIR_INVERSE, in_, out_, flag);
 
     fwdPlanComputed_ = true;
     invPlanComputed_ = true;
-    
-    //    COUT(pthread_self() << " Computed " << forwardPlan_);
   }
-
-  planGuard_.unlock();
 }
 
 /**.......................................................................
- * Compute a plan for this fft
+ * Return plans for this fft
  */
-void Dft2d::computePlan(fftw_plan& fwdPlan, fftw_plan& invPlan) 
+void Dft2d::computePlan(FftwPlan& fwdPlan, FftwPlan& invPlan) 
 {
-  planGuard_.lock();
-
   unsigned flag = optimize_ ? FFTW_MEASURE : FFTW_ESTIMATE;
 
   if(fwdPlanTmp_ == 0 && invPlanTmp_ == 0) {
-
-    COUT(pthread_self() << " Pre-computing plans for nxZeroPad_ = " << nxZeroPad_);
-    COUT(pthread_self() << " Pre-computing plans for nyZeroPad_ = " << nyZeroPad_);
-    
-    fwdPlan = fftw_plan_dft_r2c_2d(nxZeroPad_, nyZeroPad_, in_,  out_, flag);
-    invPlan = fftw_plan_dft_c2r_2d(nxZeroPad_, nyZeroPad_, out_, in_,  flag);
-    
-    COUT(pthread_self() << " Computing plans for nyZeroPad_ = " << nyZeroPad_ << " ...done");
+    fwdPlan = FftwPlanRegistry::getPlan(nxZeroPad_, nyZeroPad_, FftwPlanRegistry::DIR_FORWARD, in_, out_, flag);
+    invPlan = FftwPlanRegistry::getPlan(nxZeroPad_, nyZeroPad_, FftwPlanRegistry::DIR_INVERSE, in_, out_, flag);
   }
-
-  planGuard_.unlock();
 }
 
 /**.......................................................................
@@ -277,21 +257,21 @@ void Dft2d::resize()
   yOffset_ = (yAxis_.zeropadFactor_ == 1) ? 0 : (yAxis_.zeropadFactor_/2 - 1) * ny_ + ny_/2;
 
   if(in_) {
-    fftw_free(in_);
+    FFTW_CALL(free)(in_);
     in_ = 0;
   }
 
   if(out_) {
-    fftw_free(out_);
+    FFTW_CALL(free)(out_);
     out_ = 0;
   }
 
   // Allocate arrays
 
-  if((in_ = (double*)fftw_malloc(nInZeroPad_ * sizeof(double)))==0)
+  if((in_ = (FftwReal*)FFTW_CALL(malloc)(nInZeroPad_ * sizeof(FftwReal)))==0)
     ThrowError("Couldn't allocate input data array");
 
-  if((out_ = (fftw_complex*)fftw_malloc(nOutZeroPad_ * sizeof(fftw_complex)))==0)
+  if((out_ = (FftwComplex*)FFTW_CALL(malloc)(nOutZeroPad_ * sizeof(FftwComplex)))==0)
     ThrowError("Couldn't allocate output data array");
 
   for(unsigned i=0; i < nInZeroPad_; i++)
@@ -336,36 +316,33 @@ void Dft2d::removeMean()
 /**.......................................................................
  * Compute the forward transform
  */
-void Dft2d::computeForwardTransform(fftw_plan* plan)
+void Dft2d::computeForwardTransform(FftwPlan* plan)
 {
+  //------------------------------------------------------------
+  // Plans are shared between transforms, so always execute them on
+  // this object's arrays
+  //------------------------------------------------------------
+
   if(plan) {
-    fftw_execute(*plan);
+    FFTW_CALL(execute_dft_r2c)(*plan, in_, out_);
   } else {
-    if(precomputedPlan_) {
-      fftw_execute_dft_r2c(forwardPlan_, in_, out_);
-    } else {
-      fftw_execute(forwardPlan_);
-    }
+    FFTW_CALL(execute_dft_r2c)(forwardPlan_, in_, out_);
   }
 }
 
 /**.......................................................................
  * Compute the reverse transform
  */
-void Dft2d::computeInverseTransform(fftw_plan* plan)
+void Dft2d::computeInverseTransform(FftwPlan* plan)
 {
   if(plan) {
-    fftw_execute(*plan);
+    FFTW_CALL(execute_dft_c2r)(*plan, out_, in_);
   } else {
 
     if(inversePlan_ == 0)
       ThrowError("Gridder contains no data");
 
-    if(precomputedPlan_) {
-      fftw_execute_dft_c2r(inversePlan_, out_, in_);
-    } else {
-      fftw_execute(inversePlan_);
-    }
+    FFTW_CALL(execute_dft_c2r)(inversePlan_, out_, in_);
   }
 
   normalizeTransform();
@@ -383,12 +360,12 @@ void Dft2d::normalizeTransform()
   }
 }
 
-fftw_complex* Dft2d::getTransformDataPtr()
+FftwComplex* Dft2d::getTransformDataPtr()
 {
   return out_;
 }
 
-double* Dft2d::getImageDataPtr()
+FftwReal* Dft2d::getImageDataPtr()
 {
   return in_;
 }
@@ -1064,25 +1041,60 @@ std::vector<double> Dft2d::getUVData(DataType type)
  */
 void Dft2d::interpolateReImData(double u, double v, double& re, double& im, bool& valid)
 {
-  // Get the spatial frequency resolution of the axes
+  double du, dv;
+  getSpatialFrequencyResolution(du, dv);
 
-  int nu = xAxis_.getNpix();
-  int nv = yAxis_.getNpix();
+  interpolateReImData(u, v, du, dv, re, im, valid);
+}
 
-  double du;
-  double dv;
+/**.......................................................................
+ * Interpolate a batch of uv points
+ */
+void Dft2d::interpolateReImData(std::vector<double>& u, std::vector<double>& v, 
+				std::vector<double>& re, std::vector<double>& im, std::vector<unsigned char>& valid)
+{
+  double du, dv;
+  getSpatialFrequencyResolution(du, dv);
+
+  unsigned n = u.size();
+
+  re.resize(n);
+  im.resize(n);
+  valid.resize(n);
 
+  bool isValid;
+  for(unsigned i=0; i < n; i++) {
+    interpolateReImData(u[i], v[i], du, dv, re[i], im[i], isValid);
+    valid[i] = isValid;
+  }
+}
+
+/**.......................................................................
+ * Get the spatial frequency resolution of the axes
+ */
+void Dft2d::getSpatialFrequencyResolution(double& du, double& dv)
+{
   try {
     du = xAxis_.getSpatialFrequencyResolution();
   } catch(...) {
-    du = 1.0/nu;
+    du = 1.0/xAxis_.getNpix();
   }
 
   try {
     dv = yAxis_.getSpatialFrequencyResolution();
   } catch(...) {
-    dv = 1.0/nv;
+    dv = 1.0/yAxis_.getNpix();
   }
+}
+
+/**.......................................................................
+ * Interpolate the transform at a single uv point, given the spatial
+ * frequency resolution of the axes
+ */
+void Dft2d::interpolateReImData(double u, double v, double du, double dv, double& re, double& im, bool& valid)
+{
+  int nu = xAxis_.getNpix();
+  int nv = yAxis_.getNpix();
 
   // Now initialize return values to zero
 
@@ -1091,7 +1103,8 @@ void Dft2d::interpolateReImData(double u, double v, double& re, double& im, bool
 
   valid = false;
 
-  double s2    = 2*convSigInPixels_*convSigInPixels_;
+  double reSum = 0.0;
+  double imSum = 0.0;
   double wtSum = 0.0;
 
   // Get the UV index closest to the current point
@@ -1117,16 +1130,18 @@ void Dft2d::interpolateReImData(double u, double v, double& re, double& im, bool
   // Get the UV coordinate of the nearest point
   //------------------------------------------------------------
 
-  double uVal0, vVal0, uVal, vVal;
+  double uVal0, vVal0;
   uvCoord(uInd, vInd, uVal0, vVal0);
 
-  // If we are closer than convMaskInPixels_ from the maximum spatial
-  // frequency, treat the point as invalid, since we cannot do a
-  // symmetric convolution
+  // If we are closer than the convolution mask from the maximum
+  // spatial frequency, treat the point as invalid, since we cannot do
+  // a symmetric convolution
+
+  int mask = convMaskInPixels();
 
   long int uDelt = uInd-nu/2;
   long int vDelt = vInd-nv/2;
-  if((abs(uDelt) < convMaskInPixels_) || (abs(vDelt) < convMaskInPixels_)) {
+  if((abs(uDelt) < mask) || (abs(vDelt) < mask)) {
     valid = false;
     return;
   }
@@ -1146,11 +1161,24 @@ void Dft2d::interpolateReImData(double u, double v, double& re, double& im, bool
     }
   }
 
+  //------------------------------------------------------------
+  // The kernel is separable, so look up the u and v weights once
+  // for each row and column of the mask, rather than once per pixel
+  //------------------------------------------------------------
+
+  double uWt[2*convMaxMaskInPixels_+1];
+  double vWt[2*convMaxMaskInPixels_+1];
+
+  for(int iU = -mask; iU <= mask; iU++)
+    uWt[iU + mask] = convolutionKernel((u - (uVal0 + iU * du))/du);
+
+  for(int iV = -mask; iV <= mask; iV++)
+    vWt[iV + mask] = convolutionKernel((v - (vVal0 + iV * dv))/dv);
+
   //------------------------------------------------------------
   // Now iterate over a mask of pixels centered on the nearest pixel
   //------------------------------------------------------------
 
-  bool doConj=false;
   double reVal, imVal;
 
   // If we are on the edge of the frequency range sampled by the
@@ -1158,16 +1186,11 @@ void Dft2d::interpolateReImData(double u, double v, double& re, double& im, bool
   // nv/2, getUVData() below has no way of distinguishing which
   // direction is valid to interpolate
 
-  int iUStop = (uInd == nu/2) ? 0 : convMaskInPixels_;
-  int iVStop = (vInd == nv/2) ? 0 : convMaskInPixels_;
-
-  for(int iU = -convMaskInPixels_; iU <= iUStop; iU++) {
-    for(int iV = -convMaskInPixels_; iV <= iVStop; iV++) {
-
-      // Calculate the coordinate of the center of the current pixel
+  int iUStop = (uInd == nu/2) ? 0 : mask;
+  int iVStop = (vInd == nv/2) ? 0 : mask;
 
-      uVal = uVal0 + iU * du;
-      vVal = vVal0 + iV * dv;
+  for(int iU = -mask; iU <= iUStop; iU++) {
+    for(int iV = -mask; iV <= iVStop; iV++) {
 
       // Get the UV data of the index that is (iU, iV) away from the
       // nearest point.  
@@ -1178,23 +1201,12 @@ void Dft2d::interpolateReImData(double u, double v, double& re, double& im, bool
 	continue;
       }
 
-      // Calculate the delta of the requested (u,v) point from the
-      // center of this pixel, in fractional pixels
-
-      double duPix = (u - uVal)/du;
-      double dvPix = (v - vVal)/dv;
-
       // And the weight corresponding to it
 
-      double arg = (duPix * duPix + dvPix * dvPix)/s2;
-
-      double wt = exp(-arg);
-
-      // Accumulate running means for re and im
-	
-      re += ((reVal - re) * wt) / (wtSum + wt);
-      im += ((imVal - im) * wt) / (wtSum + wt);
+      double wt = uWt[iU + mask] * vWt[iV + mask];
 
+      reSum += reVal * wt;
+      imSum += imVal * wt;
       wtSum += wt;
 
       // If any actual value went into the sum, mark it as valid
@@ -1203,6 +1215,11 @@ void Dft2d::interpolateReImData(double u, double v, double& re, double& im, bool
     }
   }
 
+  if(wtSum > 0.0) {
+    re = reSum / wtSum;
+    im = imSum / wtSum;
+  }
+
   // Finally, if we were calculating sums for the conjugate point,
   // conjugate the result
 
@@ -1210,6 +1227,134 @@ void Dft2d::interpolateReImData(double u, double v, double& re, double& im, bool
     im = -im;
 }
 
+/**.......................................................................
+ * Tabulate a 1D convolution kernel out to one pixel beyond the edge
+ * of its convolution mask (the furthest a point can lie from the
+ * center of a masked pixel)
+ */
+std::vector<double> Dft2d::tabulateConvolutionKernel(ConvKernelType type)
+{
+  int mask = type == CONV_SPHEROIDAL ? convMaxMaskInPixels_ : convMaskInPixels_;
+
+  unsigned n = (mask + 1) * convOversamp_ + 2;
+  std::vector<double> kernel(n);
+
+  double s2 = 2*convSigInPixels_*convSigInPixels_;
+
+  for(unsigned i=0; i < n; i++) {
+    double dPix = (double)(i) / convOversamp_;
+
+    if(type == CONV_SPHEROIDAL) {
+      double nu = dPix / convMaxMaskInPixels_;
+      kernel[i] = nu < 1.0 ? (1.0 - nu*nu) * spheroidal(nu) / spheroidal(0.0) : 0.0;
+    } else {
+      kernel[i] = exp(-dPix*dPix/s2);
+    }
+  }
+
+  return kernel;
+}
+
+/**.......................................................................
+ * Select the convolution kernel for this object
+ */
+void Dft2d::setConvolutionKernel(ConvKernelType type)
+{
+  convKernelType_ = type;
+  convKernel_     = type == CONV_SPHEROIDAL ? &spheroidalKernel_ : &gaussianKernel_;
+}
+
+Dft2d::ConvKernelType Dft2d::parseConvolutionKernel(std::string type)
+{
+  if(type == "gaussian") {
+    return CONV_GAUSSIAN;
+  } else if(type == "spheroidal") {
+    return CONV_SPHEROIDAL;
+  } else {
+    ThrowSimpleColorError("Unrecognized convolution kernel: '" << type << "' (should be 'gaussian' or 'spheroidal')", "red");
+  }
+
+  return CONV_GAUSSIAN;
+}
+
+/**.......................................................................
+ * Return the half-width of the convolution mask, in pixels.  The
+ * gaussian is truncated; the spheroidal mask covers its whole support
+ */
+int Dft2d::convMaskInPixels()
+{
+  return convKernelType_ == CONV_SPHEROIDAL ? convMaxMaskInPixels_ : convMaskInPixels_;
+}
+
+/**.......................................................................
+ * Return the image-plane correction for a kernel at pixel iPix of an
+ * axis of nPix pixels, normalized to unity at the center (pixel
+ * nPix/2)
+ */
+double Dft2d::gridCorrection(ConvKernelType type, int iPix, unsigned nPix)
+{
+  double x = (double)(iPix) - (double)(nPix/2);
+
+  if(type == CONV_SPHEROIDAL) {
+    double nu = fabs(x) / ((double)(nPix)/2);
+    return nu <= 1.0 ? spheroidal(nu) / spheroidal(0.0) : 0.0;
+  } else {
+    double sig = (double)(nPix)/(2*M_PI*convSigInPixels_);
+    return exp(-x*x/(2*sig*sig));
+  }
+}
+
+/**.......................................................................
+ * Rational approximation to the m = 6, alpha = 1 prolate spheroidal
+ * wave function, for 0 <= nu <= 1 (Schwab 1984)
+ */
+double Dft2d::spheroidal(double nu)
+{
+  static const double p[2][5] = {
+    {8.203343e-2, -3.644705e-1, 6.278660e-1, -5.335581e-1, 2.312756e-1},
+    {4.028559e-3, -3.697768e-2, 1.021332e-1, -1.201436e-1, 6.412774e-2}
+  };
+
+  static const double q[2][3] = {
+    {1.0000000e0, 8.212018e-1, 2.078043e-1},
+    {1.0000000e0, 9.599102e-1, 2.918724e-1}
+  };
+
+  unsigned part = nu < 0.75 ? 0 : 1;
+  double nuEnd  = nu < 0.75 ? 0.75 : 1.0;
+  double delNu2 = nu*nu - nuEnd*nuEnd;
+
+  double top = 0.0, bot = 0.0, pow = 1.0;
+
+  for(unsigned k=0; k < 5; k++) {
+    top += p[part][k] * pow;
+    if(k < 3)
+      bot += q[part][k] * pow;
+    pow *= delNu2;
+  }
+
+  return bot > 0.0 ? top / bot : 0.0;
+}
+
+/**.......................................................................
+ * Return the 1D convolution kernel for an offset of dPix pixels,
+ * linearly interpolated from the tabulated kernel
+ */
+double Dft2d::convolutionKernel(double dPix)
+{
+  double x = fabs(dPix) * convOversamp_;
+  unsigned i = (unsigned)x;
+
+  const std::vector<double>& kernel = *convKernel_;
+
+  if(i+1 >= kernel.size())
+    return 0.0;
+
+  double f = x - i;
+
+  return kernel[i] + f * (kernel[i+1] - kernel[i]);
+}
+
 /**.......................................................................
  * Return the complex value of the point at uInd + iU, vInd + iV
  */
@@ -2040,7 +2185,7 @@ void Dft2d::operator*=(double mult)
   }
 }
 
-void Dft2d::setPlan(fftw_plan forwardPlan, fftw_plan inversePlan)
+void Dft2d::setPlan(FftwPlan forwardPlan, FftwPlan inversePlan)
 {
   precomputedPlan_ = true;
   forwardPlan_ = forwardPlan;
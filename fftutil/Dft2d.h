@@ -12,7 +12,7 @@
  * 
  * @author Erik Leitch
  */
-#include <fftw3.h>
+#include "gcp/fftutil/FftwPrecision.h"
 
 #include "gcp/fftutil/Image.h"
 #include "gcp/fftutil/ImageAxis.h"
@@ -90,18 +90,18 @@ namespace gcp {
 
       // Compute the transforms
 
-      void computeForwardTransform(fftw_plan* fwdPlan=0);
-      virtual void computeInverseTransform(fftw_plan* invPlan=0);
+      void computeForwardTransform(FftwPlan* fwdPlan=0);
+      virtual void computeInverseTransform(FftwPlan* invPlan=0);
 
       // Return a pointer to the input data
 
-      double* getInputData();
+      FftwReal* getInputData();
 
       // Return a pointer to the transformed data
 
-      fftw_complex* getTransformDataPtr();
+      FftwComplex* getTransformDataPtr();
       unsigned getTransformLength();
-      double*       getImageDataPtr();
+      FftwReal*     getImageDataPtr();
       Image getImage(bool includeZeropaddedRegion=false);
 
       void removeMean();
@@ -176,6 +176,12 @@ namespace gcp {
 
       void interpolateReImData(double u, double v, double& re, double& im, bool& valid);
 
+      // Batched version of the above.  The axis resolutions are
+      // looked up once for the whole batch
+
+      void interpolateReImData(std::vector<double>& u, std::vector<double>& v, 
+			       std::vector<double>& re, std::vector<double>& im, std::vector<unsigned char>& valid);
+
       // Methods for manipulating an existing FT
 
       // Apply a gaussian taper to the low-frequency side of the
@@ -194,8 +200,6 @@ namespace gcp {
 
     public:
 
-      static Mutex planGuard_;
-
       friend class Axis;
 
       // Parameters for convolving Fourier-plane data
@@ -203,21 +207,71 @@ namespace gcp {
       static const double convSigInPixels_;
       static const int    convMaskInPixels_;
 
+      // The kernels available for convolving Fourier-plane data.
+      // The gaussian has width convSigInPixels_, and is truncated
+      // at convMaskInPixels_.  The spheroidal is the m = 6, alpha = 1
+      // prolate spheroidal wave function (Schwab 1984), which has a
+      // support of convMaxMaskInPixels_ = 3 pixels either side of
+      // center
+
+      enum ConvKernelType {
+	CONV_GAUSSIAN,
+	CONV_SPHEROIDAL
+      };
+
+      static const int convMaxMaskInPixels_ = 3;
+
+      // The 1D convolution kernels, tabulated at convOversamp_ points
+      // per pixel.  The 2D kernel is separable, so it is the product
+      // of this function evaluated for u and v.  The tables are
+      // computed once, and never modified
+
+      static const unsigned convOversamp_;
+      static const std::vector<double> gaussianKernel_;
+      static const std::vector<double> spheroidalKernel_;
+
+      static std::vector<double> tabulateConvolutionKernel(ConvKernelType type);
+
+      // The kernel this object convolves with (gaussian by default)
+
+      ConvKernelType convKernelType_;
+      const std::vector<double>* convKernel_;
+
+      double convolutionKernel(double dPix);
+      int convMaskInPixels();
+
+      // Select the convolution kernel for this object
+
+      void setConvolutionKernel(ConvKernelType type);
+
+      static ConvKernelType parseConvolutionKernel(std::string type);
+
+      // Return the image-plane correction for a kernel (its normalized
+      // Fourier transform) at pixel iPix of an nPix axis.  Images
+      // whose transforms are compared with convolved data should be
+      // multiplied by this
+
+      static double gridCorrection(ConvKernelType type, int iPix, unsigned nPix);
+
+      // The spheroidal function itself, for 0 <= nu <= 1
+
+      static double spheroidal(double nu);
+
       unsigned axes_;
-      double* in_;            // The input array to be transformed
-      fftw_complex* out_;     // The output of the transform
+      FftwReal* in_;          // The input array to be transformed
+      FftwComplex* out_;      // The output of the transform
 
-      fftw_plan forwardPlan_; // Instructions to fftw for the best forward method
+      FftwPlan forwardPlan_; // Instructions to fftw for the best forward method
       bool fwdPlanComputed_;
 
-      fftw_plan inversePlan_; // Instructions to fftw for the best inverse method
+      FftwPlan inversePlan_; // Instructions to fftw for the best inverse method
 			      // to FFT
       bool invPlanComputed_;
 
       bool precomputedPlan_;
 
-      fftw_plan* fwdPlanTmp_;
-      fftw_plan* invPlanTmp_;
+      FftwPlan* fwdPlanTmp_;
+      FftwPlan* invPlanTmp_;
 
       bool optimize_;         // True if we want fftw to perform expensive
 			      // tests to determine the optimal FFT
@@ -251,9 +305,9 @@ namespace gcp {
 
       // Compute a plan for this fft
 
-      void computePlan(fftw_plan& fwdPlan, fftw_plan& invPlan);
+      void computePlan(FftwPlan& fwdPlan, FftwPlan& invPlan);
       void computePlan(unsigned flag); 
-      void setPlan(fftw_plan forwardPlan, fftw_plan inversePlan);
+      void setPlan(FftwPlan forwardPlan, FftwPlan inversePlan);
       void normalizeTransform();
       void initialize();
 
@@ -267,6 +321,9 @@ namespace gcp {
       void getUVData(double u, double v, DataType type, double& uNearest, double& vNearest, double& val);
       void getUVData(int uInd, int iU, int vInd, int iV, double& re, double& im);
 
+      void interpolateReImData(double u, double v, double du, double dv, double& re, double& im, bool& valid);
+      void getSpatialFrequencyResolution(double& du, double& dv);
+
       // Return the uv radius of the index into the transform
       // array
 
@@ -1,4 +1,5 @@
 #include "gcp/fftutil/Dft3d.h"
+#include "gcp/fftutil/FftwPlanRegistry.h"
 #include "gcp/pgutil/PgUtil.h"
 
 #include <vector>
@@ -55,8 +56,10 @@ Dft3d::~Dft3d() {}
  */
 void Dft3d::computePlan(unsigned flag) 
 {
+  FftwPlanRegistry::lock();
   forwardPlan_ = fftw_plan_dft_r2c_3d(nx_, ny_, nz_, in_,  out_, flag);
   inversePlan_ = fftw_plan_dft_c2r_3d(nx_, ny_, nz_, out_, in_,  flag);
+  FftwPlanRegistry::unlock();
 }
 
 /**.......................................................................
@@ -0,0 +1,181 @@
+#include "gcp/fftutil/DirtyTileMask.h"
+
+#include "gcp/util/Exception.h"
+
+using namespace std;
+
+using namespace gcp::util;
+
+/**.......................................................................
+ * Constructor.
+ */
+DirtyTileMask::DirtyTileMask(unsigned tileSize)
+{
+  if(tileSize == 0)
+    ThrowError("Tile size must be > 0");
+
+  tileSize_ = tileSize;
+  nx_       = 0;
+  ny_       = 0;
+  nxTile_   = 0;
+  nyTile_   = 0;
+  allDirty_ = true;
+}
+
+/**.......................................................................
+ * Destructor.
+ */
+DirtyTileMask::~DirtyTileMask() {}
+
+/**.......................................................................
+ * Mark the tiles overlapping a region as dirty
+ */
+void DirtyTileMask::mark(Image& image, Image::Region& region)
+{
+  checkSize(image);
+
+  if(allDirty_ || region.isEmpty())
+    return;
+
+  unsigned ixTileMax = (region.ixMax_ - 1) / tileSize_;
+  unsigned iyTileMax = (region.iyMax_ - 1) / tileSize_;
+
+  for(unsigned iyTile=region.iyMin_ / tileSize_; iyTile <= iyTileMax; iyTile++)
+    for(unsigned ixTile=region.ixMin_ / tileSize_; ixTile <= ixTileMax; ixTile++)
+      dirty_[iyTile * nxTile_ + ixTile] = 1;
+}
+
+/**.......................................................................
+ * Mark all tiles as dirty
+ */
+void DirtyTileMask::markAll()
+{
+  allDirty_ = true;
+}
+
+/**.......................................................................
+ * Zero the dirty tiles of an image.  Runs of adjacent dirty tiles in
+ * the same row of tiles are zeroed as a single region
+ */
+void DirtyTileMask::zero(Image& image)
+{
+  checkSize(image);
+
+  if(allDirty_) {
+    image.zero();
+  } else {
+
+    for(unsigned iyTile=0; iyTile < nyTile_; iyTile++) {
+      for(unsigned ixTile=0; ixTile < nxTile_; ixTile++) {
+
+	if(!dirty_[iyTile * nxTile_ + ixTile])
+	  continue;
+
+	unsigned nRun = 1;
+	while(ixTile + nRun < nxTile_ && dirty_[iyTile * nxTile_ + ixTile + nRun])
+	  ++nRun;
+
+	Image::Region region = tileRegion(ixTile, iyTile, nRun);
+	image.zero(region);
+
+	ixTile += nRun - 1;
+      }
+    }
+  }
+
+  dirty_.assign(dirty_.size(), 0);
+  allDirty_ = false;
+}
+
+/**.......................................................................
+ * Multiply the dirty tiles of an image by another image
+ */
+void DirtyTileMask::multiply(Image& image, Image& mult)
+{
+  checkSize(image);
+
+  if(allDirty_) {
+    image *= mult;
+    return;
+  }
+
+  for(unsigned iyTile=0; iyTile < nyTile_; iyTile++) {
+    for(unsigned ixTile=0; ixTile < nxTile_; ixTile++) {
+
+      if(!dirty_[iyTile * nxTile_ + ixTile])
+	continue;
+
+      unsigned nRun = 1;
+      while(ixTile + nRun < nxTile_ && dirty_[iyTile * nxTile_ + ixTile + nRun])
+	++nRun;
+
+      Image::Region region = tileRegion(ixTile, iyTile, nRun);
+      image.multiply(mult, 1.0, region);
+
+      ixTile += nRun - 1;
+    }
+  }
+}
+
+/**.......................................................................
+ * Return the number of dirty tiles
+ */
+unsigned DirtyTileMask::nDirty()
+{
+  if(allDirty_)
+    return nTile();
+
+  unsigned n = 0;
+  for(unsigned i=0; i < dirty_.size(); i++)
+    n += dirty_[i];
+
+  return n;
+}
+
+unsigned DirtyTileMask::nTile()
+{
+  return nxTile_ * nyTile_;
+}
+
+/**.......................................................................
+ * If the image is not the size we were last used with, resize, and
+ * treat all tiles as dirty
+ */
+void DirtyTileMask::checkSize(Image& image)
+{
+  unsigned nx = image.xAxis().getNpix();
+  unsigned ny = image.yAxis().getNpix();
+
+  if(nx == nx_ && ny == ny_)
+    return;
+
+  nx_     = nx;
+  ny_     = ny;
+  nxTile_ = (nx + tileSize_ - 1) / tileSize_;
+  nyTile_ = (ny + tileSize_ - 1) / tileSize_;
+
+  dirty_.assign(nxTile_ * nyTile_, 0);
+  allDirty_ = true;
+}
+
+/**.......................................................................
+ * Return the pixel region covered by nxTile tiles, starting at tile
+ * (ixTile, iyTile)
+ */
+Image::Region DirtyTileMask::tileRegion(unsigned ixTile, unsigned iyTile, unsigned nxTile)
+{
+  Image::Region region;
+
+  region.ixMin_ = ixTile * tileSize_;
+  region.ixMax_ = (ixTile + nxTile) * tileSize_;
+  region.iyMin_ = iyTile * tileSize_;
+  region.iyMax_ = (iyTile + 1) * tileSize_;
+
+  if(region.ixMax_ > nx_)
+    region.ixMax_ = nx_;
+
+  if(region.iyMax_ > ny_)
+    region.iyMax_ = ny_;
+
+  return region;
+}
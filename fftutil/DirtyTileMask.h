@@ -0,0 +1,90 @@
+// $Id: $
+
+#ifndef GCP_UTIL_DIRTYTILEMASK_H
+#define GCP_UTIL_DIRTYTILEMASK_H
+
+/**
+ * @file DirtyTileMask.h
+ *
+ * Tagged: Tue Oct 20 17:52:16 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <vector>
+
+#include "gcp/fftutil/Image.h"
+
+namespace gcp {
+  namespace util {
+
+    //-----------------------------------------------------------------------
+    // Tracks which square tiles of an image may contain non-zero
+    // data, so that an image built up from compact components can be
+    // cleared, or multiplied, without visiting every pixel.
+    //
+    // The caller marks each region it writes to.  A freshly
+    // constructed (or resized) mask treats every tile as dirty, since
+    // nothing is known about the image contents.
+    //-----------------------------------------------------------------------
+
+    class DirtyTileMask {
+    public:
+
+      static const unsigned defaultTileSize_ = 32;
+
+      /**
+       * Constructor.
+       */
+      DirtyTileMask(unsigned tileSize=defaultTileSize_);
+
+      /**
+       * Destructor.
+       */
+      virtual ~DirtyTileMask();
+
+      // Mark the tiles overlapping a region (or all tiles) as dirty
+
+      void mark(Image& image, Image::Region& region);
+      void markAll();
+
+      // Zero the dirty tiles of an image, and mark them clean
+
+      void zero(Image& image);
+
+      // Multiply the dirty tiles of an image by another image of the
+      // same size.  Clean tiles are zero, so are unaffected
+
+      void multiply(Image& image, Image& mult);
+
+      // Return the number of dirty tiles, and the total number of
+      // tiles
+
+      unsigned nDirty();
+      unsigned nTile();
+
+    private:
+
+      unsigned tileSize_;
+      unsigned nx_;
+      unsigned ny_;
+      unsigned nxTile_;
+      unsigned nyTile_;
+
+      // True if we haven't been sized to an image yet, or were asked
+      // to treat the whole image as dirty
+
+      bool allDirty_;
+
+      std::vector<unsigned char> dirty_;
+
+      void checkSize(Image& image);
+      Image::Region tileRegion(unsigned ixTile, unsigned iyTile, unsigned nxTile);
+
+    }; // End class DirtyTileMask
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_DIRTYTILEMASK_H
@@ -0,0 +1,185 @@
+#include "gcp/fftutil/FftwPlanRegistry.h"
+
+#include "gcp/util/Exception.h"
+
+#include <cstdio>
+
+using namespace std;
+
+using namespace gcp::util;
+
+std::map<FftwPlanRegistry::Key, FftwPlan> FftwPlanRegistry::plans_;
+Mutex FftwPlanRegistry::guard_;
+
+/**.......................................................................
+ * Order keys lexicographically
+ */
+bool FftwPlanRegistry::Key::operator<(const Key& key) const
+{
+  if(nx_ != key.nx_)
+    return nx_ < key.nx_;
+
+  if(ny_ != key.ny_)
+    return ny_ < key.ny_;
+
+  if(dir_ != key.dir_)
+    return dir_ < key.dir_;
+
+  if(precision_ != key.precision_)
+    return precision_ < key.precision_;
+
+  if(inAlignment_ != key.inAlignment_)
+    return inAlignment_ < key.inAlignment_;
+
+  if(outAlignment_ != key.outAlignment_)
+    return outAlignment_ < key.outAlignment_;
+
+  return flag_ < key.flag_;
+}
+
+/**.......................................................................
+ * Return a shared plan for transforms of the requested size and
+ * direction, computing it if no plan yet exists
+ */
+FftwPlan FftwPlanRegistry::getPlan(unsigned nx, unsigned ny, Direction dir,
+				   FftwReal* in, FftwComplex* out, unsigned flag)
+{
+  Key key;
+
+  key.nx_           = nx;
+  key.ny_           = ny;
+  key.dir_          = dir;
+  key.precision_    = sizeof(FftwReal);
+  key.inAlignment_  = FFTW_CALL(alignment_of)(in);
+  key.outAlignment_ = FFTW_CALL(alignment_of)((FftwReal*)out);
+  key.flag_         = flag;
+
+  FftwPlan plan;
+
+  lock();
+
+  try {
+
+    std::map<Key, FftwPlan>::iterator iter = plans_.find(key);
+
+    if(iter != plans_.end()) {
+      plan = iter->second;
+    } else {
+      plan = computePlan(key, flag);
+      plans_[key] = plan;
+    }
+
+  } catch(...) {
+    unlock();
+    throw;
+  }
+
+  unlock();
+
+  return plan;
+}
+
+/**.......................................................................
+ * Compute a plan on scratch arrays with the same alignment as the
+ * arrays it will be executed on.  Note that planning with
+ * FFTW_MEASURE overwrites the arrays, which is why we don't plan on
+ * the caller's arrays.  Must be called with the planner locked
+ */
+FftwPlan FftwPlanRegistry::computePlan(Key& key, unsigned flag)
+{
+  static const unsigned pad = 64;
+
+  size_t nIn  = key.nx_ * key.ny_;
+  size_t nOut = key.nx_ * (key.ny_/2 + 1);
+
+  char* inBuf  = (char*)FFTW_CALL(malloc)(nIn  * sizeof(FftwReal)    + pad);
+  char* outBuf = (char*)FFTW_CALL(malloc)(nOut * sizeof(FftwComplex) + pad);
+
+  if(inBuf == 0 || outBuf == 0) {
+
+    if(inBuf)
+      FFTW_CALL(free)(inBuf);
+
+    if(outBuf)
+      FFTW_CALL(free)(outBuf);
+
+    ThrowError("Couldn't allocate scratch arrays for planning");
+  }
+
+  FftwReal*    in  = (FftwReal*)(inBuf + key.inAlignment_);
+  FftwComplex* out = (FftwComplex*)(outBuf + key.outAlignment_);
+
+  FftwPlan plan;
+
+  if(key.dir_ == DIR_FORWARD)
+    plan = FFTW_CALL(plan_dft_r2c_2d)(key.nx_, key.ny_, in,  out, flag);
+  else
+    plan = FFTW_CALL(plan_dft_c2r_2d)(key.nx_, key.ny_, out, in,  flag);
+
+  FFTW_CALL(free)(inBuf);
+  FFTW_CALL(free)(outBuf);
+
+  if(plan == 0)
+    ThrowError("Unable to compute a plan for a " << key.nx_ << " x " << key.ny_ << " transform");
+
+  return plan;
+}
+
+/**.......................................................................
+ * Import FFTW wisdom from a file.  Returns false if the file doesn't
+ * exist or couldn't be read
+ */
+bool FftwPlanRegistry::loadWisdom(std::string fileName)
+{
+  lock();
+  int ret = FFTW_CALL(import_wisdom_from_filename)(fileName.c_str());
+  unlock();
+
+  return ret != 0;
+}
+
+/**.......................................................................
+ * Export accumulated FFTW wisdom to a file
+ */
+bool FftwPlanRegistry::saveWisdom(std::string fileName)
+{
+  lock();
+  int ret = FFTW_CALL(export_wisdom_to_filename)(fileName.c_str());
+  unlock();
+
+  return ret != 0;
+}
+
+void FftwPlanRegistry::lock()
+{
+  guard_.lock();
+}
+
+void FftwPlanRegistry::unlock()
+{
+  guard_.unlock();
+}
+
+unsigned FftwPlanRegistry::nPlan()
+{
+  lock();
+  unsigned n = plans_.size();
+  unlock();
+
+  return n;
+}
+
+/**.......................................................................
+ * Destroy all plans, and empty the registry
+ */
+void FftwPlanRegistry::clear()
+{
+  lock();
+
+  for(std::map<Key, FftwPlan>::iterator iter = plans_.begin(); iter != plans_.end(); iter++)
+    FFTW_CALL(destroy_plan)(iter->second);
+
+  plans_.clear();
+
+  unlock();
+}
@@ -0,0 +1,100 @@
+// $Id: $
+
+#ifndef GCP_UTIL_FFTWPLANREGISTRY_H
+#define GCP_UTIL_FFTWPLANREGISTRY_H
+
+/**
+ * @file FftwPlanRegistry.h
+ *
+ * Tagged: Mon Oct 19 15:21:09 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <map>
+#include <string>
+
+#include "gcp/fftutil/FftwPrecision.h"
+
+#include "gcp/util/Mutex.h"
+
+namespace gcp {
+  namespace util {
+
+    //-----------------------------------------------------------------------
+    // A process-wide registry of 2D real<->complex FFTW plans.
+    //
+    // Plans are computed once per (nx, ny, direction, precision,
+    // alignment, planner flag) on scratch arrays, and are thereafter
+    // shared by any number of transforms of that size, which must
+    // execute them via the new-array interface
+    // (fftw_execute_dft_r2c/c2r).  Plans are owned by the registry
+    // and are never destroyed by their users.
+    //
+    // Accumulated FFTW wisdom can be saved to, and restored from, a
+    // cache file, so that FFTW_MEASURE planning is only paid once per
+    // machine.
+    //
+    // All FFTW planner calls in this process should go through
+    // lock()/unlock(), since the planner is not thread-safe.
+    //-----------------------------------------------------------------------
+
+    class FftwPlanRegistry {
+    public:
+
+      enum Direction {
+	DIR_FORWARD,
+	DIR_INVERSE,
+      };
+
+      // Return a shared plan for transforms of the requested size,
+      // suitable for the passed arrays
+
+      static FftwPlan getPlan(unsigned nx, unsigned ny, Direction dir,
+			      FftwReal* in, FftwComplex* out, unsigned flag);
+
+      // Load/save FFTW wisdom from/to a cache file
+
+      static bool loadWisdom(std::string fileName);
+      static bool saveWisdom(std::string fileName);
+
+      // Lock/unlock the FFTW planner
+
+      static void lock();
+      static void unlock();
+
+      // Return the number of distinct plans in the registry
+
+      static unsigned nPlan();
+
+      // Destroy all plans.  Must be called before FFTW's own cleanup
+      // functions, and only when no transform still holds a plan
+
+      static void clear();
+
+    private:
+
+      struct Key {
+	unsigned nx_;
+	unsigned ny_;
+	unsigned dir_;
+	unsigned precision_;
+	unsigned inAlignment_;
+	unsigned outAlignment_;
+	unsigned flag_;
+
+	bool operator<(const Key& key) const;
+      };
+
+      static FftwPlan computePlan(Key& key, unsigned flag);
+
+      static std::map<Key, FftwPlan> plans_;
+      static Mutex guard_;
+
+    }; // End class FftwPlanRegistry
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_FFTWPLANREGISTRY_H
@@ -0,0 +1,55 @@
+// $Id: $
+
+#ifndef GCP_UTIL_FFTWPRECISION_H
+#define GCP_UTIL_FFTWPRECISION_H
+
+/**
+ * @file FftwPrecision.h
+ *
+ * Tagged: Mon Oct 19 14:02:17 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <fftw3.h>
+
+#include "gcp/util/Directives.h"
+
+//-----------------------------------------------------------------------
+// Precision policy for 2D transforms.  If FFTW_SINGLE_PRECISION is set
+// in Makefile.directives, Dft2d and UvDataGridder store their data and
+// execute their transforms in single precision (fftwf), otherwise in
+// double precision (fftw).
+//
+// FFTW_CALL(name) expands to the fftw_ or fftwf_ version of a
+// function, ie, FFTW_CALL(malloc)(n) -> fftwf_malloc(n)
+//-----------------------------------------------------------------------
+
+#if DIR_FFTW_SINGLE_PRECISION
+
+#define FFTW_CALL(name) fftwf_##name
+
+namespace gcp {
+  namespace util {
+    typedef float         FftwReal;
+    typedef fftwf_complex FftwComplex;
+    typedef fftwf_plan    FftwPlan;
+  }
+}
+
+#else
+
+#define FFTW_CALL(name) fftw_##name
+
+namespace gcp {
+  namespace util {
+    typedef double        FftwReal;
+    typedef fftw_complex  FftwComplex;
+    typedef fftw_plan     FftwPlan;
+  }
+}
+
+#endif
+
+#endif // End #ifndef GCP_UTIL_FFTWPRECISION_H
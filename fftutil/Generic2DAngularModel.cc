@@ -2,7 +2,10 @@
 #include "gcp/fftutil/Image.h"
 #include "gcp/fftutil/UvDataGridder.h"
 
+#include "gcp/util/Arena.h"
 #include "gcp/util/Astrometry.h"
+#include "gcp/util/PerfCounters.h"
+#include "gcp/util/Profiler.h"
 
 using namespace std;
 using namespace gcp::util;
@@ -16,6 +19,8 @@ Timer fit1, fit2, fit3, fit4;
 double ft1=0.0, ft2=0.0, ft3=0.0, ft4=0.0;
 #endif
 
+double Generic2DAngularModel::supportTolerance_ = 1e-6;
+
 /**.......................................................................
  * Constructor.
  */
@@ -303,6 +308,22 @@ double Generic2DAngularModel::genericEnvelope(void* evalData, double xRad, doubl
   return 0.0;
 }
 
+/**.......................................................................
+ * Base-class batched envelope just calls the single-point method for
+ * each point
+ */
+void Generic2DAngularModel::envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n)
+{
+  for(unsigned i=0; i < n; i++)
+    env[i] = envelope(type, xRad[i], yRad[i]);
+}
+
+void Generic2DAngularModel::envelopes(void* evalData, unsigned type, const double* xRad, const double* yRad, double* env, unsigned n)
+{
+  for(unsigned i=0; i < n; i++)
+    env[i] = envelope(evalData, type, xRad[i], yRad[i]);
+}
+
 //=======================================================================
 // Methods to fill an image
 //=======================================================================
@@ -312,13 +333,121 @@ double Generic2DAngularModel::genericEnvelope(void* evalData, double xRad, doubl
  */
 void Generic2DAngularModel::fillImage(unsigned type, Image& image, void* params)
 {
+  PROFILE_ZONE("Generic2DAngularModel::fillImage", name_.c_str());
+  PERF_PHASE("Generic2DAngularModel::fillImage");
+
+  Image::Region region = image.getRegion();
+  fillImageWithin(type, image, region, params);
+
+#if 0
+  Image image2 = image, delta;
+  fillImageSingleThread(type, image2, region, params);
+  
+  delta = image - image2;
+  PgUtil::setInteractive(true);
+  delta.display();
+#endif
+
+}
+
+/**.......................................................................
+ * Fill only the part of an image within which this model's envelope
+ * exceeds the support tolerance
+ */
+void Generic2DAngularModel::fillImageRegion(unsigned type, Image& image, Image::Region& region, void* params)
+{
+  PROFILE_ZONE("Generic2DAngularModel::fillImageRegion", name_.c_str());
+
+  Angle radius;
+
   //------------------------------------------------------------
-  // If no thread pool exists, just call for single thread
+  // If this model can't bound its support, fill the whole image.
+  // Note that fillImage() is virtual, and some inheritors need to
+  // prepare before filling
   //------------------------------------------------------------
 
-  if(!pool_ || execData_.size() == 0) {
+  if(!getSupportRadius(type, supportTolerance_, radius)) {
+    fillImage(type, image, params);
+    region = image.getRegion();
+    return;
+  }
+
+  unsigned nx  = image.xAxis().getNpix();
+  unsigned ny  = image.yAxis().getNpix();
+
+  double dxRad = image.xAxis().getAngularResolution().radians();
+  double dyRad = image.yAxis().getAngularResolution().radians();
+
+  getAbsoluteSeparation(image);
+
+  double xOffRad = xOffset_.radians() - xSep_.radians();
+  double yOffRad = yOffset_.radians() - ySep_.radians();
+
+  //------------------------------------------------------------
+  // Pixel coordinates of the model center, and the half-width of the
+  // support in pixels.  Pad by a couple of pixels, since the
+  // single- and multi-threaded fills differ in their choice of
+  // reference pixel by up to half a pixel
+  //------------------------------------------------------------
+
+  double ixc = image.raRefPix_  + xOffRad / (dxRad * image.xAxis().getSense());
+  double iyc = image.decRefPix_ + yOffRad / (dyRad * image.yAxis().getSense());
+
+  double hx  = radius.radians() / dxRad + 2;
+  double hy  = radius.radians() / dyRad + 2;
+
+  double xMin = floor(ixc - hx), xMax = ceil(ixc + hx) + 1;
+  double yMin = floor(iyc - hy), yMax = ceil(iyc + hy) + 1;
+
+  region.ixMin_ = xMin < 0 ? 0 : (xMin > nx ? nx : (unsigned)xMin);
+  region.ixMax_ = xMax < 0 ? 0 : (xMax > nx ? nx : (unsigned)xMax);
+  region.iyMin_ = yMin < 0 ? 0 : (yMin > ny ? ny : (unsigned)yMin);
+  region.iyMax_ = yMax < 0 ? 0 : (yMax > ny ? ny : (unsigned)yMax);
+
+  fillImageWithin(type, image, region, params);
+}
+
+/**.......................................................................
+ * Base-class models can't bound their support
+ */
+bool Generic2DAngularModel::getSupportRadius(unsigned type, double tol, Angle& radius)
+{
+  return false;
+}
+
+void Generic2DAngularModel::setSupportTolerance(double tol)
+{
+  if(!(tol > 0.0 && tol < 1.0))
+    ThrowError("Support tolerance must be in (0, 1): " << tol);
+
+  supportTolerance_ = tol;
+}
+
+double Generic2DAngularModel::getSupportTolerance()
+{
+  return supportTolerance_;
+}
+
+/**.......................................................................
+ * Fill the pixels of an image within a region with this model
+ */
+void Generic2DAngularModel::fillImageWithin(unsigned type, Image& image, Image::Region& region, void* params)
+{
+  image.checkRegion(region);
+
+  //------------------------------------------------------------
+  // A component entirely off the image contributes nothing
+  //------------------------------------------------------------
+
+  if(region.isEmpty()) {
+
+    //------------------------------------------------------------
+    // If no thread pool exists, just call for single thread
+    //------------------------------------------------------------
+
+  } else if(!pool_ || execData_.size() == 0) {
 
-    fillImageSingleThread(type, image, params);
+    fillImageSingleThread(type, image, region, params);
     
     //------------------------------------------------------------
     // Else split the image into segments
@@ -326,7 +455,7 @@ void Generic2DAngularModel::fillImage(unsigned type, Image& image, void* params)
 
   } else {
 
-    unsigned nThreadExec = initializeExecData(type, image, params);
+    unsigned nThreadExec = initializeExecData(type, image, region, params);
 
     synchronizer_.reset(nThreadExec);
 
@@ -347,22 +476,12 @@ void Generic2DAngularModel::fillImage(unsigned type, Image& image, void* params)
 
   image.setHasData(true);
   image.setUnits(units_);
-
-#if 0
-  Image image2 = image, delta;
-  fillImageSingleThread(type, image2, params);
-  
-  delta = image - image2;
-  PgUtil::setInteractive(true);
-  delta.display();
-#endif
-
 }
 
 /**.......................................................................
  * Initialize all data needed for multi-threaded computation
  */
-unsigned Generic2DAngularModel::initializeExecData(unsigned type, Image& image, void* params)
+unsigned Generic2DAngularModel::initializeExecData(unsigned type, Image& image, Image::Region& region, void* params)
 {
   unsigned nx      = image.xAxis().getNpix();
   unsigned ny      = image.yAxis().getNpix();
@@ -393,18 +512,23 @@ unsigned Generic2DAngularModel::initializeExecData(unsigned type, Image& image,
   double xOffRad  = xOffset_.radians() - xSep_.radians();
   double yOffRad  = yOffset_.radians() - ySep_.radians();
 
+  //------------------------------------------------------------
+  // Split the rows of the region between threads
+  //------------------------------------------------------------
+
+  unsigned nRow          = region.iyMax_ - region.iyMin_;
   unsigned nThreadTotal  = pool_->nThread();
-  unsigned nThreadExec   = nThreadTotal > ny ? ny : nThreadTotal;
-  unsigned nRowPerThread = ny / nThreadExec;
+  unsigned nThreadExec   = nThreadTotal > nRow ? nRow : nThreadTotal;
+  unsigned nRowPerThread = nRow / nThreadExec;
   unsigned iStart, iStop;
   
   for(unsigned iThread=0; iThread < nThreadExec; iThread++) {
 
-    iStart = iThread * nRowPerThread;
+    iStart = region.iyMin_ + iThread * nRowPerThread;
     iStop  = iStart + nRowPerThread;
 
-    if(iStop > ny)
-      iStop = ny;
+    if(iStop > region.iyMax_)
+      iStop = region.iyMax_;
 
     ExecData* ed = execData_[iThread];
 
@@ -412,7 +536,9 @@ unsigned Generic2DAngularModel::initializeExecData(unsigned type, Image& image,
     ed->iSegment_ = iThread;
     ed->nSegment_ = nThreadExec;
     ed->iYStart_  = iStart;
-    ed->iYStop_   = (iThread == nThreadExec-1 && iStop < ny) ? ny : iStop; // Last thread needs to finish
+    ed->iYStop_   = (iThread == nThreadExec-1 && iStop < region.iyMax_) ? region.iyMax_ : iStop; // Last thread needs to finish
+    ed->iXStart_  = region.ixMin_;
+    ed->iXStop_   = region.ixMax_;
 
     ed->nx_       = nx;
     ed->ny_       = ny;
@@ -442,13 +568,12 @@ unsigned Generic2DAngularModel::initializeExecData(unsigned type, Image& image,
 /**.......................................................................
  * Single-threaded method to fill an image with this model
  */
-void Generic2DAngularModel::fillImageSingleThread(unsigned type, Image& image, void* params)
+void Generic2DAngularModel::fillImageSingleThread(unsigned type, Image& image, Image::Region& region, void* params)
 {
 #ifdef TIMER_TEST
   fit1.start();
 #endif
   unsigned nx      = image.xAxis().getNpix();
-  unsigned ny      = image.yAxis().getNpix();
 
   double raRefPix  = image.raRefPix_;
   double decRefPix = image.decRefPix_;
@@ -481,10 +606,20 @@ void Generic2DAngularModel::fillImageSingleThread(unsigned type, Image& image, v
 
   //  COUT("xOffset_ = " << xOffset_ << " yOffset_ = " << yOffset_ << " xOffRad = " << xOffRad << " yOffRad = " << yOffRad << " xSep = " << xSep_ << " ySep_ = " << ySep_);
 
-  double x, y, xp, yp, xpp, ypp, arg;
+  double x, y, xp, yp;
 
   //------------------------------------------------------------
-  // Now iterate over all pixels in this image
+  // Rotated coordinates and envelope values for a single row of the
+  // image.  These are per-call temporaries, so take them from this
+  // thread's arena rather than the heap
+  //------------------------------------------------------------
+
+  unsigned nxRegion = region.ixMax_ - region.ixMin_;
+
+  std::vector<double, ArenaAllocator<double> > xppRow(nxRegion), yppRow(nxRegion), envRow(nxRegion);
+
+  //------------------------------------------------------------
+  // Now iterate over all pixels in the region
   //------------------------------------------------------------
 
 #ifdef TIMER_TEST
@@ -493,50 +628,52 @@ void Generic2DAngularModel::fillImageSingleThread(unsigned type, Image& image, v
   fit2.start();
 #endif
 
-  for(int iy=0; iy < ny; iy++) {
-    for(int ix=0; ix < nx; ix++) {
+  for(unsigned iy=region.iyMin_; iy < region.iyMax_; iy++) {
 
 #ifdef TIMER_TEST
-      fit3.start();
+    fit3.start();
 #endif
 
+    y  = ((double)(iy) - decRefPix) * dyRad * ySense;
+    yp = y - yOffRad;
+
+    for(unsigned ix=region.ixMin_; ix < region.ixMax_; ix++) {
+
       // Get the coordinate of this pixel relative to the center of
       // the model image.
 
-      x = (double)(ix) - raRefPix;
-      y = (double)(iy) - decRefPix;
-
-      x *= dxRad * xSense;
-      y *= dyRad * ySense;
+      x = ((double)(ix) - raRefPix) * dxRad * xSense;
 
       // Compute its coordinate in the untranslated frame
 
       xp = x - xOffRad;
-      yp = y - yOffRad;
 
       // Compute its coordinate in the unrotated frame
 
-      xpp =   xp * cRotAng - yp * sRotAng;
-      ypp =   xp * sRotAng + yp * cRotAng;
-
-      //      COUT(&image << " rarefpix = " << raRefPix << " decrefpix = " << decRefPix << " nx = " << nx << " ny = " << ny << " ix = " << ix << " iy = " << iy << " x = " << x << " xpp = " << xpp << " y = " << y << " ypp = " << ypp);
+      xppRow[ix - region.ixMin_] = xp * cRotAng - yp * sRotAng;
+      yppRow[ix - region.ixMin_] = xp * sRotAng + yp * cRotAng;
+    }
 
 #ifdef TIMER_TEST
-      fit3.stop();
-      ft3 += fit3.deltaInSeconds();
-      fit4.start();
+    fit3.stop();
+    ft3 += fit3.deltaInSeconds();
+    fit4.start();
 #endif
 
-      // Now fill the image with the value of the model at this
-      // location
+    //------------------------------------------------------------
+    // Now evaluate the model for the whole row, and fill the image
+    //------------------------------------------------------------
+
+    envelopes(type, &xppRow[0], &yppRow[0], &envRow[0], nxRegion);
 
-      image.data_[iy * nx + ix] = prefactor * envelope(type, xpp, ypp);
+    float* row = &image.data_[iy * nx + region.ixMin_];
+    for(unsigned ix=0; ix < nxRegion; ix++)
+      row[ix] = prefactor * envRow[ix];
 
 #ifdef TIMER_TEST
-      fit4.stop();
-      ft4 += fit4.deltaInSeconds();
+    fit4.stop();
+    ft4 += fit4.deltaInSeconds();
 #endif
-    }
   }
 
 #ifdef TIMER_TEST
@@ -560,29 +697,40 @@ void Generic2DAngularModel::fillImageMultiThread(ExecData* ed)
   // Now iterate over all pixels for this thread
   //------------------------------------------------------------
 
+  unsigned nxRegion = ed->iXStop_ - ed->iXStart_;
+
+  if(ed->xppRow_.size() < nxRegion) {
+    ed->xppRow_.resize(nxRegion);
+    ed->yppRow_.resize(nxRegion);
+    ed->envRow_.resize(nxRegion);
+  }
+
   for(ed->iy_ = ed->iYStart_; ed->iy_ < ed->iYStop_; ed->iy_++) {
-    for(ed->ix_ = 0; ed->ix_ < ed->nx_; ed->ix_++) {
 
-      // Get the coordinate of the center of this pixel
+    ed->y_  = ((double)(ed->iy_) - (double)(ed->ny_)/2) * ed->dyRad_ * ed->ySense_;
+    ed->yp_ = ed->y_ - ed->yOffRad_;
 
-      ed->x_ = (double)(ed->ix_) - (double)(ed->nx_)/2;
-      ed->y_ = (double)(ed->iy_) - (double)(ed->ny_)/2;
+    for(ed->ix_ = ed->iXStart_; ed->ix_ < ed->iXStop_; ed->ix_++) {
 
-      ed->x_ *= ed->dxRad_ * ed->xSense_;
-      ed->y_ *= ed->dyRad_ * ed->ySense_;
+      // Get the coordinate of the center of this pixel
+
+      ed->x_ = ((double)(ed->ix_) - (double)(ed->nx_)/2) * ed->dxRad_ * ed->xSense_;
 
       // Compute its coordinate in the untranslated frame
 
       ed->xp_ = ed->x_ - ed->xOffRad_;
-      ed->yp_ = ed->y_ - ed->yOffRad_;
 
       // Compute its coordinate in the unrotated frame
 
-      ed->xpp_ = ed->xp_ * ed->cRotAng_ - ed->yp_ * ed->sRotAng_;
-      ed->ypp_ = ed->xp_ * ed->sRotAng_ + ed->yp_ * ed->cRotAng_;
-
-      ed->image_->data_[ed->iy_ * ed->nx_ + ed->ix_] = ed->prefactor_ * envelope(ed->evalData_, ed->type_, ed->xpp_, ed->ypp_);
+      ed->xppRow_[ed->ix_ - ed->iXStart_] = ed->xp_ * ed->cRotAng_ - ed->yp_ * ed->sRotAng_;
+      ed->yppRow_[ed->ix_ - ed->iXStart_] = ed->xp_ * ed->sRotAng_ + ed->yp_ * ed->cRotAng_;
     }
+
+    envelopes(ed->evalData_, ed->type_, &ed->xppRow_[0], &ed->yppRow_[0], &ed->envRow_[0], nxRegion);
+
+    float* row = &ed->image_->data_[ed->iy_ * ed->nx_ + ed->iXStart_];
+    for(unsigned ix=0; ix < nxRegion; ix++)
+      row[ix] = ed->prefactor_ * ed->envRow_[ix];
   }
 }
 
@@ -595,7 +743,12 @@ EXECUTE_FN(Generic2DAngularModel::execFillImageMultiThread)
   ExecData* ed = (ExecData*) args;
   Generic2DAngularModel* model = ed->model_;
 
-  model->fillImageMultiThread(ed);
+  {
+    PROFILE_ZONE("Generic2DAngularModel::fillImageSegment", model->name_.c_str());
+    PERF_PHASE("Generic2DAngularModel::fillImageSegment");
+    model->fillImageMultiThread(ed);
+  }
+
   model->synchronizer_.registerDone(ed->iSegment_, ed->nSegment_);
 }
 
@@ -1061,6 +1214,9 @@ double Generic2DAngularModel::getSzEnvelopePrefactor(Frequency* freq)
  * SZ spectrum.  We don't change units here, but just return a
  * prefactor to scale from whatever units at the current frequency to
  * the same units at the normalization frequency.
+ *
+ * Conversions are looked up in szTable_, which tabulates the Itoh
+ * expansion in Te the first time each frequency is seen.
  */
 double Generic2DAngularModel::getItohEnvelopePrefactor(Frequency* freq)
 {
@@ -1092,9 +1248,9 @@ double Generic2DAngularModel::getItohEnvelopePrefactor(Frequency* freq)
   } else if(units == "muK" || units == "mK" || units == "K") {
 
     double normConv;
-    szCalculator_.comptonYToDeltaTItoh(electronTemperature_, *freq, normTemperatureConv_);
+    szTable_.comptonYToDeltaT(electronTemperature_, *freq, normTemperatureConv_);
     normConv = normTemperatureConv_.K();
-    szCalculator_.comptonYToDeltaTItoh(electronTemperature_, normalizationFrequency_, normTemperatureConv_);
+    szTable_.comptonYToDeltaT(electronTemperature_, normalizationFrequency_, normTemperatureConv_);
     normConv /= normTemperatureConv_.K();
     return radioNormalization_.value() * normConv;
 
@@ -1107,9 +1263,9 @@ double Generic2DAngularModel::getItohEnvelopePrefactor(Frequency* freq)
   } else if(units == "Jy") {
 
     double normConv;
-    szCalculator_.comptonYToDeltaIItoh(electronTemperature_, *freq, normTemperatureConv_, normIntensityConv_);
+    szTable_.comptonYToDeltaI(electronTemperature_, *freq, normTemperatureConv_, normIntensityConv_);
     normConv = normIntensityConv_.JyPerSr();
-    szCalculator_.comptonYToDeltaIItoh(electronTemperature_, normalizationFrequency_, normTemperatureConv_, normIntensityConv_);
+    szTable_.comptonYToDeltaI(electronTemperature_, normalizationFrequency_, normTemperatureConv_, normIntensityConv_);
     normConv /= normIntensityConv_.JyPerSr();
     return radioNormalization_.value() * normConv;
 
@@ -22,6 +22,7 @@
 #include "gcp/util/Length.h"
 #include "gcp/util/SpectralType.h"
 #include "gcp/util/SzCalculator.h"
+#include "gcp/util/SzSpectrumTable.h"
 #include "gcp/util/VariableUnitQuantity.h"
 
 namespace gcp {
@@ -72,6 +73,8 @@ namespace gcp {
 	unsigned nSegment_;
 	unsigned iYStart_;
 	unsigned iYStop_;
+	unsigned iXStart_;
+	unsigned iXStop_;
 	double   prefactor_;
 	unsigned type_;
 	void*    params_;
@@ -90,6 +93,11 @@ namespace gcp {
 	double x_, y_, xp_, yp_, xpp_, ypp_, arg_;
 	int ix_, iy_;
 
+	// Rotated coordinates and envelope values for one row of
+	// pixels
+
+	std::vector<double> xppRow_, yppRow_, envRow_;
+
 	ExecData(Generic2DAngularModel* model) {
 	  initialize();
 	  model_    = model;
@@ -117,6 +125,8 @@ namespace gcp {
 	  nSegment_ = 0;
 	  iYStart_  = 0;
 	  iYStop_   = 0;
+	  iXStart_  = 0;
+	  iXStop_   = 0;
 	  evalData_ = 0;
 	  type_     = DataSetType::DATASET_UNKNOWN;
 	  params_   = 0;
@@ -217,6 +227,15 @@ namespace gcp {
       virtual double xrayImageEnvelope(void* execData, double xRad, double yRad);
       virtual double genericEnvelope(void* execData, double xRad, double yRad);
 
+      // Batched versions of the above: fill env[i] with the envelope
+      // at (xRad[i], yRad[i]), for i = 0..n-1.  The base-class
+      // versions just call the single-point methods.  Inheritors
+      // can override these to evaluate a whole row of pixels without
+      // a virtual call per pixel
+
+      virtual void envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n);
+      virtual void envelopes(void* evalData, unsigned type, const double* xRad, const double* yRad, double* env, unsigned n);
+
       // Fill an image with externally specified parameters
 
       virtual void fillImage( unsigned type,  gcp::util::Image& image,          void* params=0);
@@ -225,9 +244,28 @@ namespace gcp {
 			     std::valarray<double>& x, std::valarray<double>& y, std::valarray<double>& d, 
 			     void* params=0);
 
-      void fillImageSingleThread(unsigned type, gcp::util::Image& image, void* params);
+      // Fill only the part of an image where this model is
+      // non-negligible, returning the region that was filled in
+      // region.  Pixels outside the region are left untouched.  Models
+      // that can't bound their support fill the whole image
+
+      void fillImageRegion(unsigned type, gcp::util::Image& image, gcp::util::Image::Region& region, void* params=0);
+
+      // Inheritors that can should define this to return the radius
+      // (from the model center, in any direction) beyond which the
+      // unity-normalized envelope is below tol everywhere
+
+      virtual bool getSupportRadius(unsigned type, double tol, gcp::util::Angle& radius);
+
+      // Set (or return) the tolerance used to bound model support
+
+      static void setSupportTolerance(double tol);
+      static double getSupportTolerance();
+
+      void fillImageWithin(unsigned type, gcp::util::Image& image, gcp::util::Image::Region& region, void* params);
+      void fillImageSingleThread(unsigned type, gcp::util::Image& image, gcp::util::Image::Region& region, void* params);
       void fillImageMultiThread(ExecData* ed);
-      unsigned initializeExecData(unsigned type, Image& image, void* params);
+      unsigned initializeExecData(unsigned type, Image& image, gcp::util::Image::Region& region, void* params);
       static EXECUTE_FN(execFillImageMultiThread);
 
       void fillArraySingleThread(unsigned type, Angle& axisUnits, 
@@ -375,9 +413,12 @@ namespace gcp {
 
     private:
 
+      static double supportTolerance_;
+
       std::vector<ExecData*> execData_;
 
       SzCalculator szCalculator_;
+      SzSpectrumTable szTable_;
       Temperature normTemperatureConv_;
       Intensity normIntensityConv_;
 
@@ -373,6 +373,31 @@ void Image::createGaussianImage(unsigned nx, unsigned ny, double sigmax, double
   hasData_ = true;
 }
 
+/**.......................................................................
+ * Fill this image with the image-plane correction for the kernel dft
+ * uses to convolve Fourier-plane data (see Dft2d::gridCorrection())
+ */
+void Image::createGridCorrectionImage(unsigned nx, unsigned ny, Dft2d& dft)
+{
+  resize(nx, ny);
+
+  std::vector<double> xCorr(nx), yCorr(ny);
+
+  for(unsigned ix=0; ix < nx; ix++)
+    xCorr[ix] = Dft2d::gridCorrection(dft.convKernelType_, ix, nx);
+
+  for(unsigned iy=0; iy < ny; iy++)
+    yCorr[iy] = Dft2d::gridCorrection(dft.convKernelType_, iy, ny);
+
+  for(unsigned iy=0; iy < ny; iy++) {
+    for(unsigned ix=0; ix < nx; ix++) {
+      data_[iy * nx + ix] = xCorr[ix] * yCorr[iy];
+    }
+  }
+
+  hasData_ = true;
+}
+
 /**.......................................................................
  * Fill this image with a gaussian (sigma in Angle)
  */
@@ -1829,6 +1854,154 @@ Image Image::operator/(Image& image)
   return ret;
 }
 
+/**.......................................................................
+ * Multiply this image by a scaled image, in a single pass.  Equivalent
+ * to (*this) *= (image * scale), but without the temporary
+ */
+void Image::multiply(Image& image, double scale)
+{
+  if(!hasData_) {
+    ThrowError("This image contains no data");
+  }
+
+  if(!image.hasData_) {
+    ThrowError("That image contains no data");
+  }
+
+  if(data_.size() != image.data_.size()) {
+    ThrowError("Images are not the same size");
+  }
+
+  unsigned n = data_.size();
+  float* dst = &data_[0];
+  float* src = &image.data_[0];
+
+  for(unsigned i=0; i < n; i++)
+    dst[i] *= scale * src[i];
+}
+
+/**.......................................................................
+ * Add a scaled image to this one, in a single pass.  Validity is
+ * treated as in addWithValidation(): invalid pixels in the passed
+ * image are skipped, and valid pixels are assigned to pixels that are
+ * not yet valid in ours
+ */
+void Image::addScaled(Image& image, double scale)
+{
+  if(!hasData_ || !image.hasData_) {
+    ThrowError("Image contains no data");
+  }
+
+  if(data_.size() != image.data_.size()) {
+    ThrowError("Images are not the same size");
+  }
+
+  unsigned n = data_.size();
+  float* dst = &data_[0];
+  float* src = &image.data_[0];
+
+  for(unsigned i=0; i < n; i++) {
+    if(image.valid_[i]) {
+      if(valid_[i]) {
+	dst[i] += scale * src[i];
+      } else {
+	dst[i] = scale * src[i];
+	valid_[i] = 1;
+      }
+    }
+  }
+}
+
+/**.......................................................................
+ * Multiply pixels of this image within region by a scaled image
+ */
+void Image::multiply(Image& image, double scale, Region& region)
+{
+  if(!hasData_) {
+    ThrowError("This image contains no data");
+  }
+
+  if(!image.hasData_) {
+    ThrowError("That image contains no data");
+  }
+
+  if(data_.size() != image.data_.size()) {
+    ThrowError("Images are not the same size");
+  }
+
+  checkRegion(region);
+
+  unsigned nx = xAxis().getNpix();
+
+  for(unsigned iy=region.iyMin_; iy < region.iyMax_; iy++) {
+    float* dst = &data_[iy * nx];
+    float* src = &image.data_[iy * nx];
+
+    for(unsigned ix=region.ixMin_; ix < region.ixMax_; ix++)
+      dst[ix] *= scale * src[ix];
+  }
+}
+
+/**.......................................................................
+ * Add pixels of a scaled image within region to this one.  Validity
+ * is treated as in addScaled(Image&, double)
+ */
+void Image::addScaled(Image& image, double scale, Region& region)
+{
+  if(!hasData_ || !image.hasData_) {
+    ThrowError("Image contains no data");
+  }
+
+  if(data_.size() != image.data_.size()) {
+    ThrowError("Images are not the same size");
+  }
+
+  checkRegion(region);
+
+  unsigned nx = xAxis().getNpix();
+
+  for(unsigned iy=region.iyMin_; iy < region.iyMax_; iy++) {
+    for(unsigned ix=region.ixMin_; ix < region.ixMax_; ix++) {
+      unsigned i = iy * nx + ix;
+
+      if(image.valid_[i]) {
+	if(valid_[i]) {
+	  data_[i] += scale * image.data_[i];
+	} else {
+	  data_[i] = scale * image.data_[i];
+	  valid_[i] = 1;
+	}
+      }
+    }
+  }
+}
+
+/**.......................................................................
+ * Return the region covering the whole image
+ */
+Image::Region Image::getRegion()
+{
+  Region region;
+
+  region.ixMin_ = 0;
+  region.ixMax_ = xAxis().getNpix();
+  region.iyMin_ = 0;
+  region.iyMax_ = yAxis().getNpix();
+
+  return region;
+}
+
+/**.......................................................................
+ * Throw if a region doesn't lie within this image
+ */
+void Image::checkRegion(Region& region)
+{
+  if(region.ixMax_ > xAxis().getNpix() || region.iyMax_ > yAxis().getNpix()) {
+    ThrowError("Region [" << region.ixMin_ << ":" << region.ixMax_ << ", " 
+	       << region.iyMin_ << ":" << region.iyMax_ << ") lies outside the image");
+  }
+}
+
 /**.......................................................................
  * Convolve this image with another one
  */
@@ -2054,6 +2227,29 @@ void Image::zero()
   n_     = 0;
 }
 
+/**.......................................................................
+ * Zero pixels of this image within region
+ */
+void Image::zero(Region& region)
+{
+  checkRegion(region);
+
+  unsigned nx = xAxis().getNpix();
+  bool hasSums = wtSum_.size() == data_.size() && n_.size() == data_.size();
+
+  for(unsigned iy=region.iyMin_; iy < region.iyMax_; iy++) {
+    for(unsigned ix=region.ixMin_; ix < region.ixMax_; ix++) {
+      unsigned i = iy * nx + ix;
+      data_[i] = 0.0;
+
+      if(hasSums) {
+	wtSum_[i] = 0.0;
+	n_[i]     = 0;
+      }
+    }
+  }
+}
+
 void Image::setValue(float val)
 {
   data_  = val;
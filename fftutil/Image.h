@@ -69,6 +69,19 @@ namespace gcp {
 	friend std::ostream& operator<<(std::ostream& os, const Window& win);
       };
 
+      // A rectangular block of pixels: [ixMin_, ixMax_) x [iyMin_, iyMax_)
+
+      struct Region {
+	unsigned ixMin_;
+	unsigned ixMax_;
+	unsigned iyMin_;
+	unsigned iyMax_;
+
+	bool isEmpty() {
+	  return ixMin_ >= ixMax_ || iyMin_ >= iyMax_;
+	}
+      };
+
       struct Axis : public ImageAxis {
 
 	Image* parent_;
@@ -129,6 +142,11 @@ namespace gcp {
       void createGaussianImage(unsigned nx, unsigned ny, double sigmax, double sigmay);
       void createGaussianImage(double amp, Angle sigma, Angle xOffset=zero_, Angle yOffset=zero_);
 
+      // Fill this image with the image-plane correction for the
+      // Fourier-plane convolution kernel of the passed transform
+
+      void createGridCorrectionImage(unsigned nx, unsigned ny, Dft2d& dft);
+
       void createGaussianImageFullSpecification(double amp, 
 						Angle majSigma,      Angle minSigma, 
 						Angle rotAngle,
@@ -290,6 +308,21 @@ namespace gcp {
       Image operator*(Image& image);
       Image operator/(Image& image);
 
+      // Fused operations, evaluated in a single pass over the data,
+      // with no temporary images.  Images must be the same size
+
+      void multiply(Image& image, double scale);   // this *= scale * image
+      void addScaled(Image& image, double scale);  // this += scale * image
+
+      // Versions of the above that only touch pixels within region
+
+      void multiply(Image& image, double scale, Region& region);
+      void addScaled(Image& image, double scale, Region& region);
+
+      // Return the region covering the whole image
+
+      Region getRegion();
+
       Image getSqrt();
       void sqrt();
       void ln();
@@ -306,6 +339,7 @@ namespace gcp {
       // Zero the image (set all pixel values to zero)
 
       void zero();
+      void zero(Region& region);
       void setValue(float val);
 
       void zeroBeyondRadius(Angle radius);
@@ -424,6 +458,8 @@ namespace gcp {
       void initializeRefPixFftConvention();
       void initializeRefPixNonFftConvention();
 
+      void checkRegion(Region& region);
+
     private:
 
       ImageAxis& xImageAxis();
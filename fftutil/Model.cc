@@ -566,7 +566,7 @@ void Model::sampleSingleThreadDiagonal()
  */
 void Model::sampleSingleThreadNonDiagonal()
 {
-  currentSample_ = Sampler::generateMultiVariateGaussianSample(currentSample_, mean_, invCov_);
+  Sampler::updateMultiVariateGaussianSample(currentSample_, mean_, invCov_);
 }
 
 /**.......................................................................
@@ -3349,6 +3349,34 @@ void Model::fillMultiplicity(unsigned** dPtr)
     (*dPtr)[i] = nTimesAtThisPoint_[i];
 }
 
+/**.......................................................................
+ * Return the stored chain for the named variate, without copying
+ */
+std::vector<double>& Model::getChain(std::string varName)
+{
+  std::map<std::string, Variate*>::iterator niter = nameComponentMap_.find(varName);
+
+  if(niter == nameComponentMap_.end())
+    ThrowError("No component named: " << varName);
+
+  std::map<Variate*, std::vector<double>*>::iterator viter = acceptedValues_.find(niter->second);
+
+  if(viter == acceptedValues_.end())
+    ThrowError("No chain was stored for component: " << varName);
+
+  return *(viter->second);
+}
+
+std::vector<double>& Model::getLnLikelihoods()
+{
+  return acceptedLnLikelihoodValues_;
+}
+
+std::vector<unsigned>& Model::getMultiplicities()
+{
+  return nTimesAtThisPoint_;
+}
+
 void Model::setParameter(std::string name, std::string val, std::string units, bool external)
 {
   //------------------------------------------------------------
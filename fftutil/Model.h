@@ -414,6 +414,13 @@ namespace gcp {
       void fillLnLikelihood(double** dPtr);
       void fillMultiplicity(unsigned** dPtr);
 
+      // Direct (no-copy) access to the stored chain.  Only the first
+      // getChainLength() elements are valid
+
+      std::vector<double>& getChain(std::string varName);
+      std::vector<double>& getLnLikelihoods();
+      std::vector<unsigned>& getMultiplicities();
+
       static std::map<std::string, VarVal> staticListModel(std::string prefix, unsigned nBin, Stat stat);
       static std::vector<VarVal> staticListModelVec(std::string prefix, unsigned nBin, Stat stat);
       static std::map<std::string, double> staticListModelStrings(std::string prefix, unsigned nBin, Stat stat);
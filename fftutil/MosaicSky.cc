@@ -0,0 +1,401 @@
+#include "gcp/fftutil/MosaicSky.h"
+
+#include "gcp/util/Astrometry.h"
+#include "gcp/util/Exception.h"
+
+#include <cmath>
+
+using namespace std;
+
+using namespace gcp::util;
+
+/**.......................................................................
+ * Order keys lexicographically
+ */
+bool MosaicSky::Key::operator<(const Key& key) const
+{
+  if(freqHz_ != key.freqHz_)
+    return freqHz_ < key.freqHz_;
+
+  if(dxRad_ != key.dxRad_)
+    return dxRad_ < key.dxRad_;
+
+  if(dyRad_ != key.dyRad_)
+    return dyRad_ < key.dyRad_;
+
+  if(nx_ != key.nx_)
+    return nx_ < key.nx_;
+
+  if(ny_ != key.ny_)
+    return ny_ < key.ny_;
+
+  if(xSense_ != key.xSense_)
+    return xSense_ < key.xSense_;
+
+  return ySense_ < key.ySense_;
+}
+
+/**.......................................................................
+ * Constructor.
+ */
+MosaicSky::MosaicSky()
+{
+  maxXSepRad_    = 0.0;
+  maxYSepRad_    = 0.0;
+  minSpacingRad_ = 0.0;
+  nPointing_     = 0;
+
+  model_  = 0;
+  type_   = 0;
+  active_ = false;
+
+  pthread_cond_init(&ready_, 0);
+}
+
+/**.......................................................................
+ * Destructor.
+ */
+MosaicSky::~MosaicSky()
+{
+  end();
+  pthread_cond_destroy(&ready_);
+}
+
+/**.......................................................................
+ * Set the tangent point of the common grid, and the pointings it
+ * must cover
+ */
+void MosaicSky::setPointings(HourAngle& ra, Declination& dec, std::vector<HourAngle>& ras, std::vector<Declination>& decs)
+{
+  if(ras.size() != decs.size())
+    ThrowError("Mismatched pointing lists: " << ras.size() << " RAs and " << decs.size() << " DECs");
+
+  end();
+
+  ra_        = ra;
+  dec_       = dec;
+  nPointing_ = ras.size();
+
+  maxXSepRad_    = 0.0;
+  maxYSepRad_    = 0.0;
+  minSpacingRad_ = 0.0;
+
+  Angle xSep, ySep;
+
+  for(unsigned iPoint=0; iPoint < nPointing_; iPoint++) {
+
+    Astrometry::flatSkyApproximationSeparations(xSep, ySep, ra_, dec_, ras[iPoint], decs[iPoint]);
+
+    maxXSepRad_ = fabs(xSep.radians()) > maxXSepRad_ ? fabs(xSep.radians()) : maxXSepRad_;
+    maxYSepRad_ = fabs(ySep.radians()) > maxYSepRad_ ? fabs(ySep.radians()) : maxYSepRad_;
+
+    for(unsigned jPoint=0; jPoint < iPoint; jPoint++) {
+
+      Astrometry::flatSkyApproximationSeparations(xSep, ySep, ras[jPoint], decs[jPoint], ras[iPoint], decs[iPoint]);
+
+      double sep = sqrt(xSep.radians() * xSep.radians() + ySep.radians() * ySep.radians());
+
+      if(sep > 0.0 && (minSpacingRad_ == 0.0 || sep < minSpacingRad_))
+	minSpacingRad_ = sep;
+    }
+  }
+}
+
+/**.......................................................................
+ * Start a new model component.  A component is shared if it can't
+ * bound its support, or if its support extends at least halfway to
+ * the nearest neighbouring pointing, in which case it overlaps
+ * several pointings
+ */
+bool MosaicSky::begin(Generic2DAngularModel& model, unsigned type)
+{
+  end();
+
+  model_  = &model;
+  type_   = type;
+  active_ = false;
+
+  if(nPointing_ < 2 || minSpacingRad_ == 0.0)
+    return false;
+
+  Angle radius;
+
+  if(model.getSupportRadius(type, Generic2DAngularModel::getSupportTolerance(), radius))
+    active_ = radius.radians() >= minSpacingRad_ / 2;
+  else
+    active_ = true;
+
+  return active_;
+}
+
+/**.......................................................................
+ * Release the renderings of the current component
+ */
+void MosaicSky::end()
+{
+  guard_.lock();
+
+  for(std::map<Key, Render*>::iterator iter = renders_.begin(); iter != renders_.end(); iter++)
+    delete iter->second;
+
+  renders_.clear();
+
+  model_  = 0;
+  active_ = false;
+
+  guard_.unlock();
+}
+
+bool MosaicSky::isActive()
+{
+  return active_;
+}
+
+/**.......................................................................
+ * Fill the part of a pointing image covered by the current component
+ */
+bool MosaicSky::fillImageRegion(Image& image, Image::Region& region, Frequency& freq)
+{
+  if(!active_)
+    ThrowError("No model component is being shared");
+
+  if(!image.hasAbsolutePosition_)
+    ThrowError("A pointing image must have an absolute position to be filled from the mosaic sky");
+
+  Render* render = getRender(image, freq);
+
+  if(render == 0)
+    return false;
+
+  resample(*render, image, region);
+
+  image.setUnits(render->image_.getUnits());
+  image.frequency_    = render->image_.frequency_;
+  image.hasFrequency_ = render->image_.hasFrequency_;
+
+  return true;
+}
+
+/**.......................................................................
+ * Return the rendering for this image's geometry, computing it only
+ * if it hasn't been requested before.  Returns NULL if the common grid
+ * for this geometry would have more pixels than all of the pointing
+ * images together
+ */
+MosaicSky::Render* MosaicSky::getRender(Image& image, Frequency& freq)
+{
+  Key key;
+
+  key.freqHz_ = freq.Hz();
+  key.dxRad_  = image.xAxis().getAngularResolution().radians();
+  key.dyRad_  = image.yAxis().getAngularResolution().radians();
+  key.nx_     = image.xAxis().getNpix();
+  key.ny_     = image.yAxis().getNpix();
+  key.xSense_ = image.xAxis().getSense();
+  key.ySense_ = image.yAxis().getSense();
+
+  unsigned nx, ny;
+  getSkySize(key, nx, ny);
+
+  //------------------------------------------------------------
+  // Return the rendering if we already have it, or wait for it if
+  // another thread is computing it
+  //------------------------------------------------------------
+
+  if((double)nx * ny > (double)nPointing_ * key.nx_ * key.ny_)
+    return 0;
+
+  guard_.lock();
+
+  try {
+
+    while(true) {
+
+      std::map<Key, Render*>::iterator iter = renders_.find(key);
+
+      if(iter != renders_.end()) {
+	Render* render = iter->second;
+	guard_.unlock();
+	return render;
+      }
+
+      if(pending_.find(key) == pending_.end())
+	break;
+
+      pthread_cond_wait(&ready_, guard_.getPthreadVarPtr());
+    }
+
+    pending_.insert(key);
+
+  } catch(...) {
+    guard_.unlock();
+    throw;
+  }
+
+  guard_.unlock();
+
+  //------------------------------------------------------------
+  // Otherwise compute it, outside the lock, so that distinct
+  // renderings can be computed in parallel
+  //------------------------------------------------------------
+
+  Render* render = 0;
+
+  try {
+    render = this->render(key, image, freq);
+  } catch(...) {
+    guard_.lock();
+    pending_.erase(key);
+    pthread_cond_broadcast(&ready_);
+    guard_.unlock();
+    throw;
+  }
+
+  guard_.lock();
+
+  renders_[key] = render;
+  pending_.erase(key);
+
+  pthread_cond_broadcast(&ready_);
+  guard_.unlock();
+
+  return render;
+}
+
+/**.......................................................................
+ * Render the current component on a grid tangent at the mosaic
+ * center, with the pixel geometry of the passed image, and padded by
+ * a pointing image (plus a pixel for interpolation) on all sides
+ */
+MosaicSky::Render* MosaicSky::render(Key& key, Image& image, Frequency& freq)
+{
+  unsigned nx, ny;
+  getSkySize(key, nx, ny);
+
+  Angle xSize, ySize;
+  xSize.setRadians(nx * key.dxRad_);
+  ySize.setRadians(ny * key.dyRad_);
+
+  Render* render = new Render();
+
+  try {
+
+    Image& sky = render->image_;
+
+    sky.initialize(xSize, ySize, nx, ny);
+    sky.xAxis().setSense(key.xSense_);
+    sky.yAxis().setSense(key.ySense_);
+    sky.setRaDecFft(ra_, dec_);
+
+    model_->fillImageRegion(type_, sky, render->region_, &freq);
+
+  } catch(...) {
+    delete render;
+    throw;
+  }
+
+  return render;
+}
+
+/**.......................................................................
+ * Return the size of the common grid for a pointing geometry
+ */
+void MosaicSky::getSkySize(Key& key, unsigned& nx, unsigned& ny)
+{
+  nx = 2 * ((unsigned)ceil(maxXSepRad_ / key.dxRad_) + key.nx_/2 + 2);
+  ny = 2 * ((unsigned)ceil(maxYSepRad_ / key.dyRad_) + key.ny_/2 + 2);
+}
+
+/**.......................................................................
+ * Resample a pointing's window from a rendering.  The pointing grid
+ * and the common grid have the same pixel size and orientation, so
+ * every pixel is offset by the same (fractional) number of pixels, and
+ * the bilinear weights are the same for every pixel
+ */
+void MosaicSky::resample(Render& render, Image& image, Image::Region& region)
+{
+  Image& sky = render.image_;
+  Image::Region& skyRegion = render.region_;
+
+  int nx    = image.xAxis().getNpix();
+  int ny    = image.yAxis().getNpix();
+  int nxSky = sky.xAxis().getNpix();
+
+  //------------------------------------------------------------
+  // The position of pixel (ix, iy) of the pointing image on the
+  // common grid is (ix + xShift, iy + yShift)
+  //------------------------------------------------------------
+
+  Angle xSep, ySep;
+  Astrometry::flatSkyApproximationSeparations(xSep, ySep, sky.getRa(), sky.getDec(), image.getRa(), image.getDec());
+
+  double xShift = sky.raRefPix_  - image.raRefPix_  - xSep.radians() / (sky.xAxis().getAngularResolution().radians() * sky.xAxis().getSense());
+  double yShift = sky.decRefPix_ - image.decRefPix_ - ySep.radians() / (sky.yAxis().getAngularResolution().radians() * sky.yAxis().getSense());
+
+  int ixShift = (int)floor(xShift);
+  int iyShift = (int)floor(yShift);
+
+  double fx = xShift - ixShift;
+  double fy = yShift - iyShift;
+
+  double w00 = (1.0-fx) * (1.0-fy);
+  double w10 =      fx  * (1.0-fy);
+  double w01 = (1.0-fx) *      fy;
+  double w11 =      fx  *      fy;
+
+  //------------------------------------------------------------
+  // Pointing pixels that interpolate from at least one pixel of the
+  // rendered region
+  //------------------------------------------------------------
+
+  int ixMin = (int)skyRegion.ixMin_ - ixShift - 1;
+  int ixMax = (int)skyRegion.ixMax_ - ixShift;
+  int iyMin = (int)skyRegion.iyMin_ - iyShift - 1;
+  int iyMax = (int)skyRegion.iyMax_ - iyShift;
+
+  ixMin = ixMin < 0 ? 0 : (ixMin > nx ? nx : ixMin);
+  ixMax = ixMax < 0 ? 0 : (ixMax > nx ? nx : ixMax);
+  iyMin = iyMin < 0 ? 0 : (iyMin > ny ? ny : iyMin);
+  iyMax = iyMax < 0 ? 0 : (iyMax > ny ? ny : iyMax);
+
+  region.ixMin_ = ixMin;
+  region.ixMax_ = ixMax > ixMin ? ixMax : ixMin;
+  region.iyMin_ = iyMin;
+  region.iyMax_ = iyMax > iyMin ? iyMax : iyMin;
+
+  //------------------------------------------------------------
+  // Pixels of the common grid outside the rendered region are zero
+  //------------------------------------------------------------
+
+  for(int iy=iyMin; iy < iyMax; iy++) {
+
+    int my = iy + iyShift;
+
+    bool y0 = my   >= (int)skyRegion.iyMin_ && my   < (int)skyRegion.iyMax_;
+    bool y1 = my+1 >= (int)skyRegion.iyMin_ && my+1 < (int)skyRegion.iyMax_;
+
+    for(int ix=ixMin; ix < ixMax; ix++) {
+
+      int mx = ix + ixShift;
+
+      bool x0 = mx   >= (int)skyRegion.ixMin_ && mx   < (int)skyRegion.ixMax_;
+      bool x1 = mx+1 >= (int)skyRegion.ixMin_ && mx+1 < (int)skyRegion.ixMax_;
+
+      double val = 0.0;
+
+      if(y0 && x0)
+	val += w00 * sky.data_[my * nxSky + mx];
+
+      if(y0 && x1)
+	val += w10 * sky.data_[my * nxSky + mx + 1];
+
+      if(y1 && x0)
+	val += w01 * sky.data_[(my+1) * nxSky + mx];
+
+      if(y1 && x1)
+	val += w11 * sky.data_[(my+1) * nxSky + mx + 1];
+
+      image.data_[iy * nx + ix] = val;
+    }
+  }
+}
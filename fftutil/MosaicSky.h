@@ -0,0 +1,147 @@
+// $Id: $
+
+#ifndef GCP_UTIL_MOSAICSKY_H
+#define GCP_UTIL_MOSAICSKY_H
+
+/**
+ * @file MosaicSky.h
+ *
+ * Tagged: Wed Oct 21 10:14:45 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <map>
+#include <set>
+#include <vector>
+
+#include <pthread.h>
+
+#include "gcp/fftutil/Generic2DAngularModel.h"
+#include "gcp/fftutil/Image.h"
+
+#include "gcp/util/Angle.h"
+#include "gcp/util/Declination.h"
+#include "gcp/util/Frequency.h"
+#include "gcp/util/HourAngle.h"
+#include "gcp/util/Mutex.h"
+
+namespace gcp {
+  namespace util {
+
+    //-----------------------------------------------------------------------
+    // A shared rendering of a model component for all pointings of a
+    // mosaic.
+    //
+    // Each pointing of a mosaic renders model components on its own
+    // image, so an extended component is otherwise evaluated once per
+    // pointing (and frequency), over largely overlapping areas.
+    // Instead, the component is rendered once on a grid tangent at
+    // the mosaic center, large enough to cover every pointing, and
+    // each pointing resamples its own window from it.
+    //
+    // A rendering is made for each distinct (frequency, pixel
+    // geometry) requested, on first request.  Concurrent requests for
+    // the same rendering wait for the first to compute it, so
+    // pointings may be filled from a thread pool.
+    //
+    // Only components whose support spans a significant fraction of
+    // the pointing spacing are shared.  Compact components are
+    // cheaper to render directly, and are not smoothed by resampling.
+    // Nor is anything shared for a pointing geometry whose common grid
+    // would have more pixels than all of the pointings together, as
+    // happens for sparse or elongated layouts.
+    //-----------------------------------------------------------------------
+
+    class MosaicSky {
+    public:
+
+      /**
+       * Constructor.
+       */
+      MosaicSky();
+
+      /**
+       * Destructor.
+       */
+      virtual ~MosaicSky();
+
+      // Set the tangent point of the common grid, and the centers of
+      // the pointings it must cover
+
+      void setPointings(HourAngle& ra, Declination& dec, std::vector<HourAngle>& ras, std::vector<Declination>& decs);
+
+      // Start a new model component, discarding any renderings of the
+      // last.  Returns true if the component will be shared
+
+      bool begin(Generic2DAngularModel& model, unsigned type);
+
+      // Release the renderings of the current component
+
+      void end();
+
+      // True if the current component is being shared
+
+      bool isActive();
+
+      // Fill the part of a pointing image covered by the current
+      // component, returning the filled region.  The image must have
+      // an absolute position.  Returns false, without filling
+      // anything, if sharing is not worthwhile for this image's
+      // geometry, in which case the caller should render the
+      // component directly
+
+      bool fillImageRegion(Image& image, Image::Region& region, Frequency& freq);
+
+    private:
+
+      struct Key {
+	double   freqHz_;
+	double   dxRad_;
+	double   dyRad_;
+	unsigned nx_;
+	unsigned ny_;
+	int      xSense_;
+	int      ySense_;
+
+	bool operator<(const Key& key) const;
+      };
+
+      struct Render {
+	Image image_;
+	Image::Region region_;
+      };
+
+      HourAngle   ra_;
+      Declination dec_;
+
+      // Largest separation of any pointing from the tangent point, and
+      // the smallest separation between pointings
+
+      double maxXSepRad_;
+      double maxYSepRad_;
+      double minSpacingRad_;
+      unsigned nPointing_;
+
+      Generic2DAngularModel* model_;
+      unsigned type_;
+      bool active_;
+
+      std::map<Key, Render*> renders_;
+      std::set<Key> pending_;
+
+      Mutex guard_;
+      pthread_cond_t ready_;
+
+      Render* getRender(Image& image, Frequency& freq);
+      Render* render(Key& key, Image& image, Frequency& freq);
+      void getSkySize(Key& key, unsigned& nx, unsigned& ny);
+      void resample(Render& render, Image& image, Image::Region& region);
+
+    }; // End class MosaicSky
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_MOSAICSKY_H
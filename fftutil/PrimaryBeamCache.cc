@@ -0,0 +1,470 @@
+#include "gcp/fftutil/PrimaryBeamCache.h"
+#include "gcp/fftutil/FftwPrecision.h"
+
+#include "gcp/util/Exception.h"
+
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+using namespace gcp::util;
+
+#define BEAM_CACHE_MAGIC   "CMXBEAMC"
+#define BEAM_CACHE_VERSION 2
+
+std::map<PrimaryBeamCache::Key, Image*>       PrimaryBeamCache::fields_;
+std::map<PrimaryBeamCache::Key, const float*> PrimaryBeamCache::mapped_;
+std::set<PrimaryBeamCache::Key>               PrimaryBeamCache::pending_;
+
+void*  PrimaryBeamCache::map_      = 0;
+size_t PrimaryBeamCache::mapSize_  = 0;
+bool   PrimaryBeamCache::modified_ = false;
+
+Mutex          PrimaryBeamCache::guard_;
+pthread_cond_t PrimaryBeamCache::ready_ = PTHREAD_COND_INITIALIZER;
+
+/**.......................................................................
+ * Order keys lexicographically
+ */
+bool PrimaryBeamCache::Key::operator<(const Key& key) const
+{
+  if(type_ != key.type_)
+    return type_ < key.type_;
+
+  if(precision_ != key.precision_)
+    return precision_ < key.precision_;
+
+  if(nx_ != key.nx_)
+    return nx_ < key.nx_;
+
+  if(ny_ != key.ny_)
+    return ny_ < key.ny_;
+
+  if(diameterM_ != key.diameterM_)
+    return diameterM_ < key.diameterM_;
+
+  if(freqHz_ != key.freqHz_)
+    return freqHz_ < key.freqHz_;
+
+  if(xSizeRad_ != key.xSizeRad_)
+    return xSizeRad_ < key.xSizeRad_;
+
+  if(ySizeRad_ != key.ySizeRad_)
+    return ySizeRad_ < key.ySizeRad_;
+
+  if(xOffRad_ != key.xOffRad_)
+    return xOffRad_ < key.xOffRad_;
+
+  return yOffRad_ < key.yOffRad_;
+}
+
+/**.......................................................................
+ * Return the key for a field.  The inner (secondary) diameter used by
+ * Antenna is fixed by the antenna type, so doesn't need to be part of
+ * the key
+ */
+PrimaryBeamCache::Key PrimaryBeamCache::getKey(Antenna& ant, Image& image, Frequency& freq, Angle& xoff, Angle& yoff)
+{
+  Key key;
+
+  // Zero the padding too, since keys are written to disk
+
+  memset(&key, 0, sizeof(Key));
+
+  key.type_      = ant.type_;
+  key.precision_ = sizeof(FftwReal);
+  key.nx_        = image.xAxis().getNpix();
+  key.ny_        = image.yAxis().getNpix();
+  key.diameterM_ = ant.diameter_.meters();
+  key.freqHz_    = freq.Hz();
+  key.xSizeRad_  = image.xAxis().getAngularSize().radians();
+  key.ySizeRad_  = image.yAxis().getAngularSize().radians();
+  key.xOffRad_   = xoff.radians();
+  key.yOffRad_   = yoff.radians();
+
+  return key;
+}
+
+/**.......................................................................
+ * Return the aperture field of this antenna, computing it only if no
+ * field with the same key has been seen before
+ */
+Image PrimaryBeamCache::getApertureField(Antenna& ant, Image& image, Frequency& freq, Angle xoff, Angle yoff)
+{
+  Key key = getKey(ant, image, freq, xoff, yoff);
+
+  //------------------------------------------------------------
+  // Return the field if we already have it, or wait for it if
+  // another thread is computing it
+  //------------------------------------------------------------
+
+  guard_.lock();
+
+  try {
+
+    while(true) {
+
+      std::map<Key, Image*>::iterator iter = fields_.find(key);
+
+      if(iter != fields_.end()) {
+	Image field = *iter->second;
+	guard_.unlock();
+	return field;
+      }
+
+      std::map<Key, const float*>::iterator mapIter = mapped_.find(key);
+
+      if(mapIter != mapped_.end()) {
+	Image* field = new Image(fieldFromData(key, mapIter->second));
+	fields_[key] = field;
+	Image ret = *field;
+	guard_.unlock();
+	return ret;
+      }
+
+      if(pending_.find(key) == pending_.end())
+	break;
+
+      pthread_cond_wait(&ready_, guard_.getPthreadVarPtr());
+    }
+
+    pending_.insert(key);
+
+  } catch(...) {
+    guard_.unlock();
+    throw;
+  }
+
+  guard_.unlock();
+
+  //------------------------------------------------------------
+  // Otherwise compute it, outside the lock, so that distinct fields
+  // can be computed in parallel
+  //------------------------------------------------------------
+
+  Image field;
+
+  try {
+    field = ant.getRealisticApertureField(image, freq, xoff, yoff);
+  } catch(...) {
+    guard_.lock();
+    pending_.erase(key);
+    pthread_cond_broadcast(&ready_);
+    guard_.unlock();
+    throw;
+  }
+
+  guard_.lock();
+
+  fields_[key] = new Image(field);
+  pending_.erase(key);
+  modified_ = true;
+
+  pthread_cond_broadcast(&ready_);
+  guard_.unlock();
+
+  return field;
+}
+
+/**.......................................................................
+ * Construct a field from cached data, as Antenna would have returned
+ * it
+ */
+Image PrimaryBeamCache::fieldFromData(Key& key, const float* data)
+{
+  Image field;
+  Angle xSize, ySize;
+
+  xSize.setRadians(key.xSizeRad_);
+  ySize.setRadians(key.ySizeRad_);
+
+  field.resize(key.nx_, key.ny_);
+
+  try {
+    field.xAxis().setAngularSize(xSize);
+    field.yAxis().setAngularSize(ySize);
+  } catch(...) {
+  }
+
+  unsigned n = key.nx_ * key.ny_;
+
+  if(field.data_.size() != n)
+    field.data_.resize(n);
+
+  float min = data[0], max = data[0];
+
+  for(unsigned i=0; i < n; i++) {
+    field.data_[i] = data[i];
+    min = data[i] < min ? data[i] : min;
+    max = data[i] > max ? data[i] : max;
+  }
+
+  field.dataMin_ = min;
+  field.dataMax_ = max;
+
+  field.initializeRefPixFftConvention();
+  field.hasData_ = true;
+
+  return field;
+}
+
+/**.......................................................................
+ * Memory-map a cache file
+ */
+bool PrimaryBeamCache::load(std::string fileName)
+{
+  int fd = open(fileName.c_str(), O_RDONLY);
+
+  if(fd < 0) {
+    if(errno == ENOENT)
+      return false;
+    ThrowSysError("open(" << fileName << ")");
+  }
+
+  struct stat st;
+  if(fstat(fd, &st) < 0) {
+    close(fd);
+    ThrowSysError("fstat(" << fileName << ")");
+  }
+
+  if((size_t)st.st_size < sizeof(Header)) {
+    close(fd);
+    return false;
+  }
+
+  size_t mapSize = st.st_size;
+  void* map = mmap(0, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+
+  close(fd);
+
+  if(map == MAP_FAILED)
+    ThrowSysError("mmap(" << fileName << ")");
+
+  //------------------------------------------------------------
+  // Reject files from another version, whose entries don't fit in
+  // the file, or whose data don't match their checksums
+  //------------------------------------------------------------
+
+  Header header;
+  memcpy(&header, map, sizeof(Header));
+
+  bool valid = strncmp(header.magic_, BEAM_CACHE_MAGIC, 8) == 0 && header.version_ == BEAM_CACHE_VERSION;
+  valid = valid && mapSize >= sizeof(Header) + sizeof(FileEntry) * (size_t)header.nField_;
+
+  const FileEntry* entries = (const FileEntry*)((char*)map + sizeof(Header));
+
+  for(unsigned iField=0; valid && iField < header.nField_; iField++) {
+    const FileEntry& entry = entries[iField];
+    size_t nByte = sizeof(float) * (size_t)entry.key_.nx_ * entry.key_.ny_;
+    valid = nByte > 0 && entry.offset_ % sizeof(float) == 0 && entry.offset_ + nByte <= mapSize;
+
+    valid = valid && checksum((const float*)((char*)map + entry.offset_), (size_t)entry.key_.nx_ * entry.key_.ny_) == entry.checksum_;
+  }
+
+  if(!valid) {
+    munmap(map, mapSize);
+    return false;
+  }
+
+  //------------------------------------------------------------
+  // Replace any previous mapping.  Fields already copied from it
+  // are unaffected
+  //------------------------------------------------------------
+
+  guard_.lock();
+
+  unmap();
+
+  map_     = map;
+  mapSize_ = mapSize;
+
+  for(unsigned iField=0; iField < header.nField_; iField++) {
+    const FileEntry& entry = entries[iField];
+    mapped_[entry.key_] = (const float*)((char*)map_ + entry.offset_);
+  }
+
+  // Only fields that aren't in the file need saving
+
+  modified_ = false;
+
+  for(std::map<Key, Image*>::iterator iter = fields_.begin(); iter != fields_.end(); iter++) {
+    if(mapped_.find(iter->first) == mapped_.end())
+      modified_ = true;
+  }
+
+  guard_.unlock();
+
+  return true;
+}
+
+/**.......................................................................
+ * Write all fields (both computed and mapped) to a cache file
+ */
+bool PrimaryBeamCache::save(std::string fileName)
+{
+  guard_.lock();
+
+  if(!modified_) {
+    guard_.unlock();
+    return true;
+  }
+
+  //------------------------------------------------------------
+  // Collect the fields to write, preferring fields we hold in memory
+  //------------------------------------------------------------
+
+  std::vector<Key> keys;
+  std::vector<const float*> data;
+
+  for(std::map<Key, Image*>::iterator iter = fields_.begin(); iter != fields_.end(); iter++) {
+    keys.push_back(iter->first);
+    data.push_back(&iter->second->data_[0]);
+  }
+
+  for(std::map<Key, const float*>::iterator iter = mapped_.begin(); iter != mapped_.end(); iter++) {
+    if(fields_.find(iter->first) == fields_.end()) {
+      keys.push_back(iter->first);
+      data.push_back(iter->second);
+    }
+  }
+
+  //------------------------------------------------------------
+  // Write to a temporary file and rename it into place, so that a
+  // concurrent reader never maps a partially written file
+  //------------------------------------------------------------
+
+  std::ostringstream tmpName;
+  tmpName << fileName << "." << getpid();
+
+  FILE* fp = fopen(tmpName.str().c_str(), "wb");
+
+  if(!fp) {
+    guard_.unlock();
+    return false;
+  }
+
+  Header header;
+  memset(&header, 0, sizeof(Header));
+  strncpy(header.magic_, BEAM_CACHE_MAGIC, 8);
+  header.version_ = BEAM_CACHE_VERSION;
+  header.nField_  = keys.size();
+
+  bool ok = fwrite(&header, sizeof(Header), 1, fp) == 1;
+
+  unsigned long long offset = sizeof(Header) + sizeof(FileEntry) * keys.size();
+  offset = (offset + 7) & ~(unsigned long long)7;
+
+  for(unsigned iField=0; ok && iField < keys.size(); iField++) {
+    FileEntry entry;
+    memset(&entry, 0, sizeof(FileEntry));
+    entry.key_      = keys[iField];
+    entry.offset_   = offset;
+    entry.checksum_ = checksum(data[iField], (size_t)keys[iField].nx_ * keys[iField].ny_);
+
+    ok = fwrite(&entry, sizeof(FileEntry), 1, fp) == 1;
+    offset += sizeof(float) * (unsigned long long)keys[iField].nx_ * keys[iField].ny_;
+  }
+
+  size_t nPad = ((sizeof(Header) + sizeof(FileEntry) * keys.size() + 7) & ~(size_t)7) - (sizeof(Header) + sizeof(FileEntry) * keys.size());
+  char pad[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  ok = ok && (nPad == 0 || fwrite(pad, 1, nPad, fp) == nPad);
+
+  for(unsigned iField=0; ok && iField < keys.size(); iField++) {
+    size_t n = (size_t)keys[iField].nx_ * keys[iField].ny_;
+    ok = fwrite(data[iField], sizeof(float), n, fp) == n;
+  }
+
+  ok = (fclose(fp) == 0) && ok;
+
+  if(!ok || rename(tmpName.str().c_str(), fileName.c_str()) != 0) {
+    unlink(tmpName.str().c_str());
+    guard_.unlock();
+    return false;
+  }
+
+  modified_ = false;
+
+  guard_.unlock();
+
+  return true;
+}
+
+/**.......................................................................
+ * Return the number of distinct fields in the library
+ */
+unsigned PrimaryBeamCache::nField()
+{
+  guard_.lock();
+
+  unsigned n = fields_.size();
+
+  for(std::map<Key, const float*>::iterator iter = mapped_.begin(); iter != mapped_.end(); iter++) {
+    if(fields_.find(iter->first) == fields_.end())
+      ++n;
+  }
+
+  guard_.unlock();
+
+  return n;
+}
+
+/**.......................................................................
+ * Discard all fields, and release any mapped file
+ */
+void PrimaryBeamCache::clear()
+{
+  guard_.lock();
+
+  if(!pending_.empty()) {
+    guard_.unlock();
+    ThrowError("Can't clear the primary beam cache while fields are being computed");
+  }
+
+  for(std::map<Key, Image*>::iterator iter = fields_.begin(); iter != fields_.end(); iter++)
+    delete iter->second;
+
+  fields_.clear();
+  unmap();
+  modified_ = false;
+
+  guard_.unlock();
+}
+
+/**.......................................................................
+ * Return a 64-bit FNV-1a checksum of field data
+ */
+unsigned long long PrimaryBeamCache::checksum(const float* data, size_t n)
+{
+  const unsigned char* bytes = (const unsigned char*)data;
+  unsigned long long sum = 14695981039346656037ULL;
+
+  for(size_t i=0; i < n * sizeof(float); i++) {
+    sum ^= bytes[i];
+    sum *= 1099511628211ULL;
+  }
+
+  return sum;
+}
+
+/**.......................................................................
+ * Release any mapped file.  Must be called with the guard locked
+ */
+void PrimaryBeamCache::unmap()
+{
+  mapped_.clear();
+
+  if(map_) {
+    munmap(map_, mapSize_);
+    map_     = 0;
+    mapSize_ = 0;
+  }
+}
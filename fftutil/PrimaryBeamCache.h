@@ -0,0 +1,139 @@
+// $Id: $
+
+#ifndef GCP_UTIL_PRIMARYBEAMCACHE_H
+#define GCP_UTIL_PRIMARYBEAMCACHE_H
+
+/**
+ * @file PrimaryBeamCache.h
+ *
+ * Tagged: Tue Oct 20 14:37:02 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <map>
+#include <set>
+#include <string>
+
+#include <pthread.h>
+
+#include "gcp/fftutil/Antenna.h"
+#include "gcp/fftutil/Image.h"
+
+#include "gcp/util/Angle.h"
+#include "gcp/util/Frequency.h"
+#include "gcp/util/Mutex.h"
+
+namespace gcp {
+  namespace util {
+
+    //-----------------------------------------------------------------------
+    // A process-wide library of antenna aperture fields.
+    //
+    // Computing an aperture field means building the aperture
+    // illumination and Fourier-transforming it, but a dataset only
+    // ever needs a handful of distinct fields: one per (antenna
+    // type, diameter, frequency, image geometry, pointing offset).
+    // Fields are computed once per key and thereafter returned by
+    // copy, and primary beams are formed from their products.
+    //
+    // The library can be saved to, and restored from, a cache file,
+    // which is memory-mapped read-only when loaded, so that fields
+    // computed in one run are not recomputed in the next.
+    //
+    // Concurrent requests for the same field wait for the first to
+    // compute it, so it is safe (and efficient) to request fields
+    // from a thread pool.
+    //-----------------------------------------------------------------------
+
+    class PrimaryBeamCache {
+    public:
+
+      // Return the aperture field of this antenna at the requested
+      // frequency and offset, on the geometry of the passed image
+
+      static Image getApertureField(Antenna& ant, Image& image, Frequency& freq,
+				    Angle xoff = Angle(Angle::Degrees(), 0.0), Angle yoff = Angle(Angle::Degrees(), 0.0));
+
+      // Map fields from a cache file.  Returns false if the file
+      // doesn't exist, was written by an incompatible version, or is
+      // truncated or corrupted
+
+      static bool load(std::string fileName);
+
+      // Write all fields to a cache file, if any have been computed
+      // since the last load.  Returns false on failure
+
+      static bool save(std::string fileName);
+
+      // Return the number of distinct fields in the library
+
+      static unsigned nField();
+
+      // Discard all fields, and release any mapped file
+
+      static void clear();
+
+    private:
+
+      struct Key {
+	unsigned type_;
+	unsigned precision_;
+	unsigned nx_;
+	unsigned ny_;
+	double diameterM_;
+	double freqHz_;
+	double xSizeRad_;
+	double ySizeRad_;
+	double xOffRad_;
+	double yOffRad_;
+
+	bool operator<(const Key& key) const;
+      };
+
+      // The header written at the start of a cache file, followed
+      // by nField_ FileEntries, and then the field data
+
+      struct Header {
+	char     magic_[8];
+	unsigned version_;
+	unsigned nField_;
+      };
+
+      struct FileEntry {
+	Key key_;
+	unsigned long long offset_;   // Offset of the data from the start of the file
+	unsigned long long checksum_; // Checksum of the data
+      };
+
+      static Key getKey(Antenna& ant, Image& image, Frequency& freq, Angle& xoff, Angle& yoff);
+      static Image fieldFromData(Key& key, const float* data);
+      static void unmap();
+      static unsigned long long checksum(const float* data, size_t n);
+
+      // Fields computed (or already copied from the map) this run
+
+      static std::map<Key, Image*> fields_;
+
+      // Fields present in the mapped cache file
+
+      static std::map<Key, const float*> mapped_;
+
+      // Fields currently being computed
+
+      static std::set<Key> pending_;
+
+      static void*  map_;
+      static size_t mapSize_;
+      static bool   modified_;
+
+      static Mutex guard_;
+      static pthread_cond_t ready_;
+
+    }; // End class PrimaryBeamCache
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_PRIMARYBEAMCACHE_H
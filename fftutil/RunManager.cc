@@ -1,18 +1,28 @@
 #include "gcp/datasets/DataSet1D.h"
 
 #include "gcp/fftutil/RunManager.h"
+#include "gcp/fftutil/FftwPlanRegistry.h"
+#include "gcp/fftutil/FftwPrecision.h"
+#include "gcp/fftutil/PrimaryBeamCache.h"
 
 #include "gcp/pgutil/PgUtil.h"
 
+#include "gcp/util/Arena.h"
 #include "gcp/util/ChisqVariateGaussApprox.h"
 #include "gcp/util/GaussianVariate.h"
 #include "gcp/util/JointGaussianVariate.h"
+#include "gcp/util/PerfCounters.h"
+#include "gcp/util/Profiler.h"
 #include "gcp/util/RangeParser.h"
+#include "gcp/util/TcpChannel.h"
 
 #include "cpgplot.h"
 
 #include <stack>
 
+#include <string.h>
+#include <unistd.h>
+
 using namespace std;
 using namespace gcp::datasets;
 using namespace gcp::util;
@@ -44,6 +54,8 @@ RunManager::RunManager()
 
   nBurn_               = 1000;
   nTry_                = 10000;
+  burnLevels_          = 0;
+  resLevel_            = 0;
 
   nTimesAtThisPoint_   = 0;
 
@@ -55,6 +67,14 @@ RunManager::RunManager()
   dataPool_            = 0;
   dataCpus_.resize(0);
 
+  wisdomFile_          = "";
+  beamCacheFile_       = "";
+  parsedFile_          = "";
+  isReplica_           = false;
+  isWorker_            = false;
+  replicaPool_         = 0;
+  profileFile_         = "";
+
   pgplotDev_           = "/xs";
   nBin_                = 30;
   runType_             = 1;
@@ -109,11 +129,24 @@ RunManager::RunManager()
   docs_.addParameter("nbin",         DataType::UINT,   "The number of bins into which the data will be binned for Markov run histograms.  Use like 'nbin = 100'");
   docs_.addParameter("nburn",        DataType::UINT,   "The length of the burn-in sequence for the Markov chain.  Use like 'nburn = 3000'. The jumping distribution will be tuned during the "
 		     "burn-in period, and these samples will be discarded from any output file.");
+  docs_.addParameter("workers",      DataType::STRING, "If specified, a list of climaxWorker processes (host:port) over which datasets are partitioned.  Each worker loads and evaluates "
+		     "only its share of the datasets, and this process combines their chi-squares into a single likelihood.  Use like 'workers = node1:5555, node2:5555'");
+  docs_.addParameter("burnlevels",   DataType::UINT,   "If > 0, burn-in starts with models rendered at 2^burnlevels coarser resolution (where datasets support it), and "
+		     "steps to finer resolution each time the acceptance fraction is found to be stable.  Full resolution is always restored by the end of burn-in.  "
+		     "Use like 'burnlevels = 2'");
   docs_.addParameter("ntry",         DataType::UINT,   "The total length of the Markov chain to run.  Use like 'ntry = 10000'");
   docs_.addParameter("nmodelthread", DataType::UINT,   "The number of threads in the model pool.  Use like 'nmodelthread = 10'");
   docs_.addParameter("modelcpus",    DataType::STRING, "A list of cpus to which the model threads should be bound.  Use like 'modelcpus = 1,2,3'");
   docs_.addParameter("ndatathread",  DataType::UINT,   "The number of threads in the data pool.  Use like 'ndatathread = 10'");
   docs_.addParameter("datacpus",     DataType::STRING, "A list of cpus to which the data threads should be bound.  Use like 'datacpus = 1,2,3'");
+  docs_.addParameter("fftwwisdom",   DataType::STRING, "If specified, a file from which FFTW wisdom will be loaded on startup, and to which accumulated wisdom will be saved on exit.  "
+		     "Use like 'fftwwisdom = ~/.climax.wisdom'");
+  docs_.addParameter("beamcache",    DataType::STRING, "If specified, a file from which previously computed primary beams will be loaded on startup, and to which any new ones will be saved on exit.  "
+		     "Use like 'beamcache = ~/.climax.beams'");
+  docs_.addParameter("perfcounters", DataType::BOOL,   "If true, sample hardware performance counters (cycles, instructions, LLC misses) per likelihood phase and thread, "
+		     "and report IPC and cache-miss rates at the end of a Markov run (Linux only)");
+  docs_.addParameter("profile",      DataType::STRING, "If specified, profile the run, writing a Chrome/Perfetto trace to name.trace.json and per-zone latency histograms to name.hist.txt on exit.  "
+		     "Use like 'profile = myrun'");
   docs_.addParameter("output",       DataType::STRING, "If specified, the output file for Markov chain runs.  Use like 'output file=fileName'");
   docs_.addParameter("incburnin",    DataType::BOOL,   "If true, include burn-in samples in plots/output file (default is false)");
   docs_.addParameter("varplot",      DataType::STRING, "The type of variable plot to produce.  One of: 'hist' (default), 'line' or 'power'");
@@ -158,6 +191,21 @@ RunManager::RunManager()
  */
 RunManager::~RunManager() 
 {
+  //------------------------------------------------------------
+  // Delete any likelihood replicas first.  These share FFTW's global
+  // state with us, so they must not clean it up themselves
+  //------------------------------------------------------------
+
+  if(replicaPool_) {
+    delete replicaPool_;
+    replicaPool_ = 0;
+  }
+
+  for(unsigned i=1; i < replicas_.size(); i++)
+    delete replicas_[i];
+
+  replicas_.resize(0);
+
   if(modelPool_) {
     delete modelPool_;
     modelPool_ = 0;
@@ -168,11 +216,57 @@ RunManager::~RunManager()
     dataPool_ = 0;
   }
 
+  if(isReplica_)
+    return;
+
+  //------------------------------------------------------------
+  // Save any wisdom accumulated during this run, before FFTW discards
+  // it
+  //------------------------------------------------------------
+
+  if(!wisdomFile_.empty()) {
+    if(!FftwPlanRegistry::saveWisdom(wisdomFile_))
+      COUTCOLOR("Unable to save FFTW wisdom to file: " << wisdomFile_, "yellow");
+  }
+
   //------------------------------------------------------------
-  // Delete any persistent memory kept by FFTW under the hood
+  // Save any primary beams computed during this run
   //------------------------------------------------------------
 
+  if(!beamCacheFile_.empty()) {
+    if(!PrimaryBeamCache::save(beamCacheFile_))
+      COUTCOLOR("Unable to save primary beams to file: " << beamCacheFile_, "yellow");
+  }
+
+  //------------------------------------------------------------
+  // Write out any profiling information, now that all threads have
+  // stopped
+  //------------------------------------------------------------
+
+  if(!profileFile_.empty()) {
+    try {
+      Profiler::disable();
+      Profiler::writeChromeTrace(profileFile_ + ".trace.json");
+      Profiler::writeHistograms(profileFile_ + ".hist.txt");
+      COUTCOLOR("Wrote profile to: " << profileFile_ << ".trace.json, " << profileFile_ << ".hist.txt", "green");
+    } catch(Exception& err) {
+      COUTCOLOR("Unable to write profile: " << err.what(), "yellow");
+    }
+  }
+
+  //------------------------------------------------------------
+  // Delete any persistent memory kept by FFTW under the hood.  Shared
+  // plans must be destroyed first, else a later RunManager in this
+  // process would be handed plans that FFTW has already freed
+  //------------------------------------------------------------
+
+  FftwPlanRegistry::clear();
+
   fftw_cleanup();
+
+#if DIR_FFTW_SINGLE_PRECISION
+  fftwf_cleanup();
+#endif
 }
 
 /**.......................................................................
@@ -373,6 +467,8 @@ void RunManager::initializeThreadPools()
  */
 void RunManager::parseFile(std::string fileName)
 {
+  parsedFile_ = fileName;
+
   //------------------------------------------------------------
   // Pre-process the parameter file.  This looks for directives that
   // affect subsequent parsing, like thread-pool allocation
@@ -405,12 +501,26 @@ void RunManager::parseFile(std::string fileName)
     mm_.fillDerivedVariates();
   }
 
+  //------------------------------------------------------------
+  // If distributing, start workers loading their shards of the data
+  // before we load ours.  Workers and likelihood replicas never
+  // distribute further
+  //------------------------------------------------------------
+
+  bool distribute = workerAddresses_.size() > 0 && !isWorker_ && !isReplica_;
+
+  if(distribute)
+    dm_.connectWorkers(workerAddresses_, fileName);
+
   //------------------------------------------------------------
   // Now load any data sets that were specified
   //------------------------------------------------------------
 
   loadData();
 
+  if(distribute)
+    dm_.waitForWorkers();
+
   //------------------------------------------------------------
   // Check for position information.  This checks if ra/dec parameters
   // have been specified from an external source, and if not sets
@@ -437,6 +547,14 @@ void RunManager::parseFile(std::string fileName)
 
   dm_.checkPosition(true);
 
+  //------------------------------------------------------------
+  // Positions of mosaics are derived from pointings spread over all
+  // shards, so workers must take theirs from us
+  //------------------------------------------------------------
+
+  if(distribute)
+    dm_.sendPositionsToWorkers();
+
   //------------------------------------------------------------
   // Now call display method if any datasets should be displayed
   //------------------------------------------------------------
@@ -854,6 +972,39 @@ void RunManager::processLine(String& line)
 	  return;
 	} else if(tok.contains("ndatathread")) {
 	  return;
+	} else if(tok.contains("fftwwisdom")) {
+	  return;
+	} else if(tok.contains("beamcache")) {
+	  return;
+	} else if(tok.contains("profile")) {
+	  return;
+	} else if(tok.contains("perfcounters")) {
+	  return;
+
+	  //------------------------------------------------------------
+	  // Number of coarse resolution levels to use during burn-in
+	  //------------------------------------------------------------
+
+	} else if(tok.contains("burnlevels")) {
+	  burnLevels_ = val.toInt();
+	  return;
+
+	  //------------------------------------------------------------
+	  // Distribute datasets over worker processes
+	  //------------------------------------------------------------
+
+	} else if(tok.contains("workers")) {
+	  val.strip(' ');
+	  std::istringstream is(val.str());
+	  std::string address;
+
+	  workerAddresses_.resize(0);
+	  while(getline(is, address, ',')) {
+	    if(!address.empty())
+	      workerAddresses_.push_back(address);
+	  }
+
+	  return;
 
 	  //------------------------------------------------------------
 	  // Explicitly set nburn
@@ -1071,6 +1222,47 @@ void RunManager::preProcessLine(String& line)
     } else if(tok.contains("ndatathread")) {
       setNDataThread(val.toInt());
 
+      //------------------------------------------------------------
+      // Load FFTW wisdom before any transforms are planned
+      //------------------------------------------------------------
+
+    } else if(tok.contains("fftwwisdom")) {
+      val.strip(' ');
+      wisdomFile_ = val.str();
+
+      if(!FftwPlanRegistry::loadWisdom(wisdomFile_))
+	COUTCOLOR("No FFTW wisdom could be loaded from file: " << wisdomFile_ << " (it will be created on exit)", "yellow");
+
+      //------------------------------------------------------------
+      // Map cached primary beams before any data are read
+      //------------------------------------------------------------
+
+    } else if(tok.contains("beamcache")) {
+      val.strip(' ');
+      beamCacheFile_ = val.str();
+
+      if(!PrimaryBeamCache::load(beamCacheFile_))
+	COUTCOLOR("No primary beams could be loaded from file: " << beamCacheFile_ << " (it will be created on exit)", "yellow");
+
+      //------------------------------------------------------------
+      // Enable profiling early, so that data loading is captured too
+      //------------------------------------------------------------
+
+    } else if(tok.contains("perfcounters") && !tok.contains(".")) {
+      val.strip(' ');
+
+      if(val.toLower().str() == "true") {
+	if(!PerfCounters::enable())
+	  COUTCOLOR("Hardware performance counters are not supported on this platform", "yellow");
+      }
+
+    } else if(tok.contains("profile") && !tok.contains(".")) {
+      val.strip(' ');
+      val.expandTilde();
+      profileFile_ = val.str();
+
+      Profiler::enable();
+
     } else if(tok.contains("modelcpus")) {
       val.strip(' ');
 
@@ -2649,6 +2841,18 @@ void RunManager::runMarkov()
 
   initializeMarkovSpecificVariables();
 
+  //------------------------------------------------------------
+  // If requested, start burn-in with a coarse-resolution likelihood
+  //------------------------------------------------------------
+
+  resLevel_ = 0;
+  if(burnLevels_ > 0 && nBurn_ > 0) {
+    resLevel_ = dm_.setResolutionLevel(burnLevels_);
+
+    if(resLevel_ > 0)
+      COUTCOLOR("Starting burn-in at resolution level " << resLevel_, "cyan");
+  }
+
   //------------------------------------------------------------
   // Main loop -- perform nTry_ iterations of the MH algorithm
   //------------------------------------------------------------
@@ -2656,6 +2860,24 @@ void RunManager::runMarkov()
   COUT("");
   unsigned nTry=0;
   for(unsigned i=0; i < nTry_ && !converged; i++, nTry++) {
+
+    //------------------------------------------------------------
+    // Per-iteration temporaries are taken from thread-local arenas.
+    // Start a new iteration, so that each arena is rewound (and
+    // grown to fit, if the last iteration overflowed it) the next
+    // time its thread uses it
+    //------------------------------------------------------------
+
+    Arena::nextIteration();
+
+    //------------------------------------------------------------
+    // Burn-in is over: make sure we are sampling the full-resolution
+    // likelihood before any samples are stored.  The model is at
+    // the last accepted sample here, so re-evaluate its likelihood
+    //------------------------------------------------------------
+
+    if(i == nBurn_ && resLevel_ > 0)
+      setResolutionLevel(0, likePrev, chisq);
     
     //------------------------------------------------------------
     // If it's time to print our progress, do it now
@@ -2684,8 +2906,19 @@ void RunManager::runMarkov()
       // jumping distribution, do it now
       //------------------------------------------------------------
 
-      if(timeToTune(i))
-	tuneJumpingDistribution(i, propDensCurr, likeCurr);
+      if(timeToTune(i)) {
+
+	//------------------------------------------------------------
+	// Once acceptance is stable at a coarse level, step to the
+	// next finer one.  The likelihood of the current sample must
+	// be recomputed so that subsequent MH ratios are consistent
+	//------------------------------------------------------------
+
+	if(tuneJumpingDistribution(i, propDensCurr, likeCurr) && resLevel_ > 0) {
+	  setResolutionLevel(resLevel_ - 1, likeCurr, chisq);
+	  likePrev = likeCurr;
+	}
+      }
 
       //------------------------------------------------------------
       // Store the latest accepted sample if we are not still in the
@@ -2719,7 +2952,11 @@ void RunManager::runMarkov()
 
   mm_.storeMultiplicity(nTimesAtThisPoint_);
 
+  if(resLevel_ > 0)
+    resLevel_ = dm_.setResolutionLevel(0);
+
   overallTimer_.stop();
+  overallTime_ = overallTimer_.deltaInSeconds();
 
   unsigned nTotal = incBurnIn_ ? nTry : (nTry - nBurn_);
 
@@ -2732,6 +2969,16 @@ void RunManager::runMarkov()
   COUTCOLOR("Time spent computing chisq:             " << std::setw(5) << std::right << setprecision(1) << std::fixed << dm_.computeChisqTime_          << "s", "yellow");
   COUTCOLOR(std::endl << "Fraction accepted:                  " <<(double)(mm_.nAccepted_)/(nTotal) << std::endl, "yellow");
 
+  //------------------------------------------------------------
+  // Report hardware counters per phase, if requested
+  //------------------------------------------------------------
+
+  if(PerfCounters::enabled()) {
+    std::ostringstream os;
+    PerfCounters::report(os);
+    COUTCOLOR(std::endl << "Hardware counters:" << std::endl << os.str(), "yellow");
+  }
+
 #if 1
   dm_.debugPrint();
   mm_.debugPrint();
@@ -3696,6 +3943,15 @@ double RunManager::getLnEvidence()
   return mm_.estimateLnEvidence();
 }
 
+/**.......................................................................
+ * Return the wall-clock time (in seconds) spent in the last call to
+ * runMarkov()
+ */
+double RunManager::getMarkovRunTime()
+{
+  return overallTime_;
+}
+
 /**.......................................................................
  * Take an input value string for a variable assignment, and see if
  * the value is a symbolic name.  If so, get the value of the variable
@@ -4135,6 +4391,8 @@ void RunManager::generateNewSample()
   // Generate a new sample for all model parameters
   //------------------------------------------------------------
   
+  PROFILE_ZONE("RunManager::sample", 0);
+
   sampleTimer_.start();
 
   mm_.sample();
@@ -4195,12 +4453,16 @@ bool RunManager::acceptMetropolisHastings(unsigned i,
   //
   //------------------------------------------------------------
 
-  likeTimer_.start();
+  {
+    PROFILE_ZONE("RunManager::likelihood", 0);
+
+    likeTimer_.start();
 
-  dm_.likelihood(mm_, likeCurr, chisq);
+    dm_.likelihood(mm_, likeCurr, chisq);
 
-  likeTimer_.stop();
-  likeTime_ += likeTimer_.deltaInSeconds();
+    likeTimer_.stop();
+    likeTime_ += likeTimer_.deltaInSeconds();
+  }
 
   if(i > 0) {
 
@@ -4232,11 +4494,28 @@ bool RunManager::timeToTune(unsigned i)
 }
 
 /**.......................................................................
- * Tune the jumping distribution
+ * Switch all datasets to a new resolution level, and recompute the
+ * likelihood of the current model at that level
+ */
+void RunManager::setResolutionLevel(unsigned level, Probability& like, ChisqVariate& chisq)
+{
+  resLevel_ = dm_.setResolutionLevel(level);
+
+  COUTCOLOR(std::endl << "Switching to resolution level " << resLevel_, "cyan");
+
+  dm_.clearModel();
+  dm_.likelihood(mm_, like, chisq);
+}
+
+/**.......................................................................
+ * Tune the jumping distribution.  Returns true if the acceptance
+ * fraction was already within the target range (i.e., no tuning was
+ * needed)
  */
-void RunManager::tuneJumpingDistribution(unsigned i, Probability& propDensCurr, Probability& likeCurr)
+bool RunManager::tuneJumpingDistribution(unsigned i, Probability& propDensCurr, Probability& likeCurr)
 {
   double acceptFrac = (double)(nAcceptedSinceLastUpdate_)/nTrySinceLastUpdate_;
+  bool stable = false;
 
   //------------------------------------------------------------
   // Accepted fraction is lower than we want -- use quadratic
@@ -4267,6 +4546,8 @@ void RunManager::tuneJumpingDistribution(unsigned i, Probability& propDensCurr,
 
     } else {
 
+      PROFILE_ZONE("RunManager::tune", 0);
+
       tuneTimer_.start();
 
 #if 1
@@ -4307,11 +4588,15 @@ void RunManager::tuneJumpingDistribution(unsigned i, Probability& propDensCurr,
     Vector<double> newSigmas = currentSigmas * 2;
     mm_.setSamplingSigmas(newSigmas);
     mm_.updateSamplingSigmas();
+  } else {
+    stable = true;
   }
 
   nAcceptedSinceLastUpdate_ = 0;
   nTrySinceLastUpdate_      = 0;
   iLastUpdate_ = i;
+
+  return stable;
 }
 
 double RunManager::lnLikelihood()
@@ -4372,12 +4657,283 @@ double RunManager::lnLikelihoodUnits(Vector<double>& sample)
   return convProb_.lnValue();
 }
 
+/**.......................................................................
+ * Set the number of independent replicas over which batched
+ * likelihood evaluations are spread.  Replicas are parsed from the
+ * same file as this object, and so have their own copies of all data
+ * and models
+ */
+void RunManager::setNReplica(unsigned nReplica)
+{
+  if(nReplica == 0)
+    ThrowError("At least one replica is required");
+
+  if(nReplica == replicas_.size())
+    return;
+
+  if(nReplica > 1 && parsedFile_.empty())
+    ThrowError("A parameter file must be loaded before replicas can be created");
+
+  //------------------------------------------------------------
+  // Release any existing replicas.  Replica 0 is always us
+  //------------------------------------------------------------
+
+  if(replicaPool_) {
+    delete replicaPool_;
+    replicaPool_ = 0;
+  }
+
+  for(unsigned i=1; i < replicas_.size(); i++)
+    delete replicas_[i];
+
+  replicas_.resize(0);
+  replicas_.push_back(this);
+
+  //------------------------------------------------------------
+  // Parsing is not thread-safe, so replicas are created serially
+  //------------------------------------------------------------
+
+  for(unsigned i=1; i < nReplica; i++) {
+    RunManager* replica = new RunManager();
+    replica->isReplica_ = true;
+    replicas_.push_back(replica);
+
+    replica->parseFile(parsedFile_);
+    replica->initializeForMarkovChain();
+  }
+
+  replicaExecData_.resize(nReplica);
+  replicaSynchronizer_.resize(nReplica);
+
+  if(nReplica > 1) {
+    replicaPool_ = new ThreadPool(nReplica);
+    replicaPool_->spawn();
+  }
+}
+
+/**.......................................................................
+ * Static method which can be passed to a thread pool, to evaluate a
+ * block of samples on a single replica
+ */
+EXECUTE_FN(RunManager::execLnLikelihoodBatch)
+{
+  ReplicaExecData* red = (ReplicaExecData*)args;
+  RunManager* parent   = red->parent_;
+
+  parent->evaluateBatch(red);
+  parent->replicaSynchronizer_.registerDone(red->iReplica_, red->nActive_);
+}
+
+/**.......................................................................
+ * Evaluate a block of samples on a single replica.  Errors are
+ * recorded rather than thrown, since this may run on a pool thread
+ */
+void RunManager::evaluateBatch(ReplicaExecData* red)
+{
+  try {
+    Vector<double> sample(red->nPar_);
+
+    for(unsigned iSample=red->iStart_; iSample < red->iStart_ + red->nSample_; iSample++) {
+      double* sptr = red->samples_ + iSample * red->nPar_;
+
+      for(unsigned iPar=0; iPar < red->nPar_; iPar++)
+	sample[iPar] = sptr[iPar];
+
+      red->lnLike_[iSample] = red->replica_->lnLikelihoodUnits(sample);
+    }
+  } catch(Exception& err) {
+    red->error_ = err.what();
+  } catch(...) {
+    red->error_ = "Unknown error evaluating likelihood";
+  }
+}
+
+/**.......................................................................
+ * Calculate the log-likelihood of a batch of samples, in unit'd values
+ */
+void RunManager::lnLikelihoodUnits(unsigned nSample, unsigned nPar, double* samples, double* lnLike)
+{
+  if(nPar != mm_.variableComponents_.size())
+    ThrowError("Samples have " << nPar << " parameters, but the model has " << mm_.variableComponents_.size() << " variable components");
+
+  if(replicas_.size() == 0)
+    setNReplica(1);
+
+  unsigned nReplica = replicas_.size();
+
+  if(nReplica > nSample)
+    nReplica = nSample;
+
+  //------------------------------------------------------------
+  // Divide samples into contiguous blocks, one per replica
+  //------------------------------------------------------------
+
+  unsigned nPerReplica = nReplica > 0 ? nSample / nReplica : 0;
+  unsigned nExtra      = nReplica > 0 ? nSample % nReplica : 0;
+  unsigned iStart      = 0;
+
+  for(unsigned iReplica=0; iReplica < nReplica; iReplica++) {
+    ReplicaExecData& red = replicaExecData_[iReplica];
+
+    red.parent_   = this;
+    red.replica_  = replicas_[iReplica];
+    red.iReplica_ = iReplica;
+    red.nActive_  = nReplica;
+    red.iStart_   = iStart;
+    red.nSample_  = nPerReplica + (iReplica < nExtra ? 1 : 0);
+    red.nPar_     = nPar;
+    red.samples_  = samples;
+    red.lnLike_   = lnLike;
+    red.error_    = "";
+
+    iStart += red.nSample_;
+  }
+
+  if(!replicaPool_ || nReplica < 2) {
+    for(unsigned iReplica=0; iReplica < nReplica; iReplica++)
+      evaluateBatch(&replicaExecData_[iReplica]);
+  } else {
+
+    replicaSynchronizer_.reset();
+    replicaSynchronizer_.initWait();
+
+    for(unsigned iReplica=0; iReplica < nReplica; iReplica++)
+      replicaSynchronizer_.registerPending(iReplica);
+
+    for(unsigned iReplica=0; iReplica < nReplica; iReplica++)
+      replicaPool_->execute(&execLnLikelihoodBatch, &replicaExecData_[iReplica]);
+
+    replicaSynchronizer_.wait();
+  }
+
+  for(unsigned iReplica=0; iReplica < nReplica; iReplica++) {
+    if(!replicaExecData_[iReplica].error_.empty())
+      ThrowError(replicaExecData_[iReplica].error_);
+  }
+}
+
 void RunManager::initializeForMarkovChain()
 {
   mm_.store_ = false;
   mm_.initializeForMarkovChain(1e6, 1e6, "");
 }
 
+/**.......................................................................
+ * Act as a worker for a distributed run: wait for a coordinator to
+ * connect, load the shard of datasets it assigns us, then evaluate
+ * chi-square for each sample it sends until told to quit
+ */
+void RunManager::serveWorker(unsigned short port)
+{
+  TcpChannel channel;
+  std::vector<char> payload, positions;
+  unsigned type;
+
+  COUTCOLOR("Waiting for a coordinator on port " << port, "green");
+
+  channel.accept(port);
+
+  COUTCOLOR("Coordinator connected from " << channel.peer(), "green");
+
+  //------------------------------------------------------------
+  // The first message tells us which shard to load, and from which
+  // run file
+  //------------------------------------------------------------
+
+  channel.recv(type, payload);
+
+  if(type != DataSetManager::MSG_INIT || payload.size() < 2*sizeof(unsigned) + 2)
+    ThrowError("Expected an initialization message from the coordinator");
+
+  try {
+    unsigned* shard = (unsigned*)&payload[0];
+    const char* cwd = &payload[2*sizeof(unsigned)];
+    std::string runFile(cwd + strlen(cwd) + 1);
+
+    if(chdir(cwd) != 0)
+      ThrowSysError("Unable to change to directory " << cwd);
+
+    isWorker_ = true;
+    dm_.setShard(shard[0], shard[1]);
+
+    parseFile(runFile);
+    initializeForMarkovChain();
+
+    //------------------------------------------------------------
+    // Report the positions of any mosaic pointings we loaded, from
+    // which the coordinator computes mosaic positions
+    //------------------------------------------------------------
+
+    dm_.packNestedPositions(positions);
+
+  } catch(Exception& err) {
+    std::string msg = err.what();
+    channel.send(DataSetManager::MSG_ERROR, msg.c_str(), msg.size());
+    throw err;
+  }
+
+  channel.send(DataSetManager::MSG_READY, positions);
+
+  //------------------------------------------------------------
+  // Now serve requests
+  //------------------------------------------------------------
+
+  while(true) {
+
+    channel.recv(type, payload);
+
+    try {
+
+      switch (type) {
+      case DataSetManager::MSG_SAMPLE:
+	{
+	  unsigned nVar = payload.size() / sizeof(double);
+	  double* vals  = (double*)&payload[0];
+
+	  Vector<double> sample(nVar);
+	  for(unsigned iVar=0; iVar < nVar; iVar++)
+	    sample[iVar] = vals[iVar];
+
+	  dm_.clearModel();
+	  mm_.externalSample(sample);
+	  dm_.likelihood(mm_, convProb_, convChisq_);
+
+	  double reply[2];
+	  reply[0] = convChisq_.nDof() > 0 ? convChisq_.chisq() : 0.0;
+	  reply[1] = convChisq_.nDof();
+
+	  channel.send(DataSetManager::MSG_CHISQ, reply, sizeof(reply));
+	}
+	break;
+      case DataSetManager::MSG_RESOLUTION:
+	{
+	  if(payload.size() != sizeof(unsigned))
+	    ThrowError("Malformed resolution message");
+
+	  unsigned level = dm_.setResolutionLevel(*((unsigned*)&payload[0]));
+	  channel.send(DataSetManager::MSG_RESOLUTION, &level, sizeof(level));
+	}
+	break;
+      case DataSetManager::MSG_POSITION:
+	dm_.unpackPositions(payload);
+	channel.send(DataSetManager::MSG_POSITION);
+	break;
+      case DataSetManager::MSG_QUIT:
+	COUTCOLOR("Coordinator ended the session", "green");
+	return;
+	break;
+      default:
+	ThrowError("Unrecognized message type: " << type);
+	break;
+      }
+
+    } catch(Exception& err) {
+      std::string msg = err.what();
+      channel.send(DataSetManager::MSG_ERROR, msg.c_str(), msg.size());
+    }
+  }
+}
+
 std::vector<Variate*>& RunManager::getVariableComponents()
 {
   return mm_.variableComponents_;
@@ -4414,6 +4970,21 @@ void RunManager::fillLnLikelihood(double** dPtr)
   mm_.fillLnLikelihood(dPtr);
 }
 
+std::vector<double>& RunManager::getChain(std::string varName)
+{
+  return mm_.getChain(varName);
+}
+
+std::vector<double>& RunManager::getLnLikelihoods()
+{
+  return mm_.getLnLikelihoods();
+}
+
+std::vector<unsigned>& RunManager::getMultiplicities()
+{
+  return mm_.getMultiplicities();
+}
+
 bool RunManager::checkConvergence(unsigned i)
 {
   if(!runtoConvergence_)
@@ -21,6 +21,7 @@
 #include "gcp/util/ParameterDocs.h"
 #include "gcp/util/ParameterManager.h"
 #include "gcp/util/ThreadPool.h"
+#include "gcp/util/ThreadSynchronizer.h"
 
 namespace gcp {
   namespace util {
@@ -85,7 +86,8 @@ namespace gcp {
       bool acceptMetropolisHastings(unsigned i,
 				    Probability& propDensCurr, Probability& propDensPrev, Probability& likeCurr, Probability& likePrev, ChisqVariate& chisq);
       bool timeToTune(unsigned i);
-      void tuneJumpingDistribution(unsigned i, Probability& propDensCurr, Probability& likeCurr);
+      bool tuneJumpingDistribution(unsigned i, Probability& propDensCurr, Probability& likeCurr);
+      void setResolutionLevel(unsigned level, Probability& like, ChisqVariate& chisq);
 
       bool checkConvergence(unsigned i);
 
@@ -151,6 +153,7 @@ namespace gcp {
       void getPlotIndices(unsigned& nside, std::vector<unsigned>& ixVec, std::vector<unsigned>& iyVec);
       ChisqVariate getMinimumChisq();
       double getLnEvidence();
+      double getMarkovRunTime();
       bool is1DDataSet();
       std::vector<double> get1DResiduals();
       std::vector<double> get1DXData();
@@ -164,6 +167,12 @@ namespace gcp {
       void fillLnLikelihood(double** dPtr);
       void fillMultiplicity(unsigned** dPtr);
 
+      // Direct (no-copy) access to the stored chain
+
+      std::vector<double>& getChain(std::string varName);
+      std::vector<double>& getLnLikelihoods();
+      std::vector<unsigned>& getMultiplicities();
+
       //------------------------------------------------------------
       // External calling interface (from python)
       //------------------------------------------------------------
@@ -171,7 +180,20 @@ namespace gcp {
       double lnLikelihood();
       double lnLikelihood(Vector<double>& sample);
       double lnLikelihoodUnits(Vector<double>& sample);
+
+      // Evaluate a batch of nSample samples (row-major, nPar values
+      // per sample, in unit'd values) into lnLike, spread over
+      // however many replicas were requested by setNReplica()
+
+      void lnLikelihoodUnits(unsigned nSample, unsigned nPar, double* samples, double* lnLike);
+      void setNReplica(unsigned nReplica);
+
       void initializeForMarkovChain();
+
+      // Serve likelihood evaluations for a single coordinator, for a
+      // shard of the datasets the coordinator assigns
+
+      void serveWorker(unsigned short port);
       std::vector<Variate*>& getVariableComponents();
 
       // Convenience variables for external calling
@@ -181,8 +203,60 @@ namespace gcp {
 
     private:
 
+      //------------------------------------------------------------
+      // Batched likelihood evaluation.  Replicas are independent
+      // RunManagers parsed from the same file, each of which
+      // evaluates a contiguous block of samples on its own thread
+      //------------------------------------------------------------
+
+      struct ReplicaExecData {
+	RunManager* parent_;
+	RunManager* replica_;
+	unsigned iReplica_;
+	unsigned nActive_;
+	unsigned iStart_;
+	unsigned nSample_;
+	unsigned nPar_;
+	double* samples_;
+	double* lnLike_;
+	std::string error_;
+      };
+
+      static EXECUTE_FN(execLnLikelihoodBatch);
+      void evaluateBatch(ReplicaExecData* red);
+
+      bool isReplica_;
+
+      // Distributed evaluation
+
+      bool isWorker_;
+      std::vector<std::string> workerAddresses_;
+
+      std::vector<RunManager*> replicas_;
+      std::vector<ReplicaExecData> replicaExecData_;
+      ThreadPool* replicaPool_;
+      ThreadSynchronizer replicaSynchronizer_;
+
+      // The last file parsed, from which replicas are created
+
+      std::string parsedFile_;
+
       std::string runFile_;
 
+      // If non-empty, the file to/from which FFTW wisdom is saved/loaded
+
+      std::string wisdomFile_;
+
+      // If non-empty, the file to/from which primary beams are
+      // saved/loaded
+
+      std::string beamCacheFile_;
+
+      // If non-empty, the prefix of files to which profiling output
+      // is written on exit
+
+      std::string profileFile_;
+
       unsigned nDataThread_;
       ThreadPool* dataPool_;
 
@@ -223,6 +297,12 @@ namespace gcp {
       bool modelsInitialized_;
       unsigned nBurn_;
       unsigned nTry_;
+
+      // The number of coarse resolution levels to start burn-in at,
+      // and the current level (0 = full resolution)
+
+      unsigned burnLevels_;
+      unsigned resLevel_;
       std::string pgplotDev_;
       bool interactive_;
       unsigned nBin_;
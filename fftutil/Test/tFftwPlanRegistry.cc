@@ -0,0 +1,85 @@
+#include <iostream>
+#include <cmath>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+
+#include "gcp/fftutil/Dft2d.h"
+#include "gcp/fftutil/FftwPlanRegistry.h"
+
+using namespace std;
+using namespace gcp::util;
+using namespace gcp::program;
+
+KeyTabEntry Program::keywords[] = {
+  { "n",        "64",               "i", "Size of the test transforms"},
+  { "wisdom",   "",                 "s", "Optional wisdom file to load/save"},
+  { END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS},
+};
+
+void Program::initializeUsage() {};
+
+int Program::main()
+{
+  unsigned n         = Program::getIntegerParameter("n");
+  std::string wisdom = Program::getStringParameter("wisdom");
+
+  if(!wisdom.empty())
+    COUT("Loaded wisdom: " << FftwPlanRegistry::loadWisdom(wisdom));
+
+  //------------------------------------------------------------
+  // Two transforms of the same size should share their plans
+  //------------------------------------------------------------
+
+  Dft2d dft1(n, n, false);
+  unsigned nPlan1 = FftwPlanRegistry::nPlan();
+
+  Dft2d dft2(n, n, false);
+  unsigned nPlan2 = FftwPlanRegistry::nPlan();
+
+  COUT("Plans after first transform: " << nPlan1 << " after second: " << nPlan2);
+
+  if(nPlan2 != nPlan1)
+    ThrowError("Transforms of the same size did not share plans");
+
+  //------------------------------------------------------------
+  // A transform of a different size should add new plans
+  //------------------------------------------------------------
+
+  Dft2d dft3(2*n, n, false);
+
+  if(FftwPlanRegistry::nPlan() == nPlan2)
+    ThrowError("Transform of a different size shared an existing plan");
+
+  //------------------------------------------------------------
+  // Check that a round trip through a shared plan recovers the
+  // input
+  //------------------------------------------------------------
+
+  FftwReal* data = dft2.getImageDataPtr();
+
+  for(unsigned i=0; i < n*n; i++)
+    data[i] = (FftwReal)(i % 7);
+
+  dft2.normalize(true);
+  dft2.computeForwardTransform();
+  dft2.computeInverseTransform();
+
+  double maxDiff = 0.0;
+  for(unsigned i=0; i < n*n; i++) {
+    double diff = fabs(data[i] - (double)(i % 7));
+    if(diff > maxDiff)
+      maxDiff = diff;
+  }
+
+  COUT("Max round-trip error: " << maxDiff);
+
+  if(maxDiff > 1e-3)
+    ThrowError("Round-trip transform through a shared plan failed");
+
+  if(!wisdom.empty())
+    COUT("Saved wisdom: " << FftwPlanRegistry::saveWisdom(wisdom));
+
+  return 0;
+}
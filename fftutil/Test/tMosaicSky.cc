@@ -0,0 +1,209 @@
+#include <iostream>
+#include <cmath>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+
+#include "gcp/fftutil/DataSetType.h"
+#include "gcp/fftutil/MosaicSky.h"
+
+#include "gcp/models/Generic2DGaussian.h"
+
+using namespace std;
+using namespace gcp::util;
+using namespace gcp::models;
+using namespace gcp::program;
+
+KeyTabEntry Program::keywords[] = {
+  { "npix",     "128",              "i", "Number of pixels on a side of each pointing"},
+  { "size",     "30",               "d", "Size of each pointing image (arcmin)"},
+  { "spacing",  "10",               "d", "Spacing of a compact mosaic (arcmin)"},
+  { "sigma",    "1.5",              "d", "Sigma of a compact gaussian component (arcmin)"},
+  { "sigmawide","20",               "d", "Sigma of an extended gaussian component (arcmin)"},
+  { "xoff",     "3",                "d", "RA offset of the component from the mosaic center (arcmin)"},
+  { "yoff",     "2",                "d", "DEC offset of the component from the mosaic center (arcmin)"},
+  { "tol",      "1e-4",             "d", "Tolerance, as a fraction of the peak, in addition to the bilinear resampling error"},
+  { END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS},
+};
+
+void Program::initializeUsage() {};
+
+void offsetPosition(HourAngle& ra0, Declination& dec0, double xArcmin, double yArcmin, HourAngle& ra, Declination& dec);
+void initializePointing(Image& image, unsigned npix, Angle& size, HourAngle& ra, Declination& dec);
+void checkMosaic(std::string name, HourAngle& ra0, Declination& dec0, std::vector<HourAngle>& ras, std::vector<Declination>& decs,
+		 Angle& sigma, HourAngle& ra, Declination& dec, unsigned npix, Angle& size, double tol);
+
+int Program::main()
+{
+  unsigned npix  = Program::getIntegerParameter("npix");
+  double spacing = Program::getDoubleParameter("spacing");
+  double tol     = Program::getDoubleParameter("tol");
+
+  Angle size(Angle::ArcMinutes(),      Program::getDoubleParameter("size"));
+  Angle sigma(Angle::ArcMinutes(),     Program::getDoubleParameter("sigma"));
+  Angle sigmaWide(Angle::ArcMinutes(), Program::getDoubleParameter("sigmawide"));
+  double xoff = Program::getDoubleParameter("xoff");
+  double yoff = Program::getDoubleParameter("yoff");
+
+  HourAngle ra0;
+  Declination dec0;
+  ra0.setHours(3.0);
+  dec0.setDegrees(30.0);
+
+  //------------------------------------------------------------
+  // Components are offset from the mosaic center in both RA and DEC
+  //------------------------------------------------------------
+
+  HourAngle ra;
+  Declination dec;
+
+  offsetPosition(ra0, dec0, xoff, yoff, ra, dec);
+
+  //------------------------------------------------------------
+  // A compact 2x2 mosaic centered on (ra0, dec0)
+  //------------------------------------------------------------
+
+  std::vector<HourAngle>   ras(4);
+  std::vector<Declination> decs(4);
+
+  for(unsigned i=0; i < 4; i++)
+    offsetPosition(ra0, dec0, (i%2 == 0 ? -0.5 : 0.5) * spacing, (i/2 == 0 ? -0.5 : 0.5) * spacing, ras[i], decs[i]);
+
+  checkMosaic("2x2 mosaic, compact component", ra0, dec0, ras, decs, sigma,     ra, dec, npix, size, tol);
+  checkMosaic("2x2 mosaic, extended component", ra0, dec0, ras, decs, sigmaWide, ra, dec, npix, size, tol);
+
+  //------------------------------------------------------------
+  // A diagonal strip of pointings, stepped by different, fractional
+  // numbers of pixels in RA and DEC
+  //------------------------------------------------------------
+
+  ras.resize(3);
+  decs.resize(3);
+
+  for(unsigned i=0; i < 3; i++)
+    offsetPosition(ra0, dec0, ((double)i - 1) * 0.7 * spacing, ((double)i - 1) * 0.45 * spacing, ras[i], decs[i]);
+
+  checkMosaic("Diagonal mosaic, compact component", ra0, dec0, ras, decs, sigma,     ra, dec, npix, size, tol);
+  checkMosaic("Diagonal mosaic, extended component", ra0, dec0, ras, decs, sigmaWide, ra, dec, npix, size, tol);
+
+  //------------------------------------------------------------
+  // A sparse, elongated mosaic should decline to share, since its
+  // common grid would be larger than both pointings together
+  //------------------------------------------------------------
+
+  Generic2DGaussian model;
+
+  model.setNormalization(1.0);
+  model.setMajSigma(sigmaWide);
+  model.setAxialRatio(1.0);
+  model.setRa(ra);
+  model.setDec(dec);
+
+  ras.resize(2);
+  decs.resize(2);
+
+  offsetPosition(ra0, dec0, -2 * size.arcmin(), 0.0, ras[0], decs[0]);
+  offsetPosition(ra0, dec0,  2 * size.arcmin(), 0.0, ras[1], decs[1]);
+
+  MosaicSky sky;
+  sky.setPointings(ra0, dec0, ras, decs);
+
+  if(!sky.begin(model, DataSetType::DATASET_RADIO))
+    ThrowError("An extended component was not shared");
+
+  Frequency freq;
+  freq.setGHz(30.0);
+
+  Image sparse;
+  initializePointing(sparse, npix, size, ras[0], decs[0]);
+
+  Image::Region region;
+
+  if(sky.fillImageRegion(sparse, region, freq))
+    ThrowError("A sparse mosaic shared a component");
+
+  sky.end();
+
+  COUT("MosaicSky tests passed");
+
+  return 0;
+}
+
+/**.......................................................................
+ * Check that a gaussian component at (ra, dec) is shared by a mosaic,
+ * and that every pointing filled from the shared rendering matches a
+ * direct fill.  Pointings are resampled bilinearly from the shared
+ * grid, with an error of up to (h/sigma)^2/4 of the peak for pixel
+ * size h, so that is added to the tolerance
+ */
+void checkMosaic(std::string name, HourAngle& ra0, Declination& dec0, std::vector<HourAngle>& ras, std::vector<Declination>& decs,
+		 Angle& sigma, HourAngle& ra, Declination& dec, unsigned npix, Angle& size, double tol)
+{
+  Frequency freq;
+  freq.setGHz(30.0);
+
+  Generic2DGaussian model;
+
+  model.setNormalization(1.0);
+  model.setMajSigma(sigma);
+  model.setAxialRatio(1.0);
+  model.setRa(ra);
+  model.setDec(dec);
+
+  MosaicSky sky;
+  sky.setPointings(ra0, dec0, ras, decs);
+
+  if(!sky.begin(model, DataSetType::DATASET_RADIO))
+    ThrowError(name << ": component was not shared");
+
+  double pixPerSigma = sigma.radians() / (size.radians() / npix);
+  double bound = tol + 0.25 / (pixPerSigma * pixPerSigma);
+
+  for(unsigned iPoint=0; iPoint < ras.size(); iPoint++) {
+
+    Image shared, direct;
+    initializePointing(shared, npix, size, ras[iPoint], decs[iPoint]);
+    initializePointing(direct, npix, size, ras[iPoint], decs[iPoint]);
+
+    Image::Region sharedRegion, directRegion;
+
+    if(!sky.fillImageRegion(shared, sharedRegion, freq))
+      ThrowError(name << ": a compact mosaic declined to share a component");
+
+    model.fillImageRegion(DataSetType::DATASET_RADIO, direct, directRegion, &freq);
+
+    double peak = 0.0, maxDiff = 0.0;
+
+    for(unsigned i=0; i < npix*npix; i++) {
+      double diff = fabs(shared.data_[i] - direct.data_[i]);
+      maxDiff = diff > maxDiff ? diff : maxDiff;
+      peak    = fabs(direct.data_[i]) > peak ? fabs(direct.data_[i]) : peak;
+    }
+
+    COUT(name << ", pointing " << iPoint << ": peak = " << peak << " max difference = " << maxDiff
+	 << " (tolerance " << bound * peak << ")");
+
+    if(peak == 0.0 || maxDiff > bound * peak)
+      ThrowError(name << ": pointing " << iPoint << " filled from the shared sky differs from a direct fill");
+  }
+
+  sky.end();
+}
+
+/**.......................................................................
+ * Return the position offset by (xArcmin, yArcmin) from (ra0, dec0),
+ * in the flat-sky approximation
+ */
+void offsetPosition(HourAngle& ra0, Declination& dec0, double xArcmin, double yArcmin, HourAngle& ra, Declination& dec)
+{
+  ra.setHours(ra0.hours() + xArcmin / 60 / cos(dec0.radians()) / 15);
+  dec.setDegrees(dec0.degrees() + yArcmin / 60);
+}
+
+void initializePointing(Image& image, unsigned npix, Angle& size, HourAngle& ra, Declination& dec)
+{
+  image.initialize(size, size, npix, npix);
+  image.setRaDecFft(ra, dec);
+  image.zero();
+}
@@ -0,0 +1,200 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+
+#include "gcp/fftutil/Antenna.h"
+#include "gcp/fftutil/PrimaryBeamCache.h"
+
+using namespace std;
+using namespace gcp::util;
+using namespace gcp::program;
+
+KeyTabEntry Program::keywords[] = {
+  { "npix",     "128",                       "i", "Number of pixels on a side of each field"},
+  { "file",     "/tmp/tPrimaryBeamCache.bin", "s", "Cache file to write (removed on exit)"},
+  { END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS},
+};
+
+void Program::initializeUsage() {};
+
+std::vector<char> readFile(std::string fileName);
+void writeFile(std::string fileName, std::vector<char>& bytes, size_t nByte);
+void checkRejected(std::string fileName, std::string what);
+
+int Program::main()
+{
+  unsigned npix        = Program::getIntegerParameter("npix");
+  std::string fileName = Program::getStringParameter("file");
+  std::string badName  = fileName + ".bad";
+
+  //------------------------------------------------------------
+  // Compute a few distinct fields: two frequencies, and an offset
+  //------------------------------------------------------------
+
+  Antenna ant;
+  ant.setType(Antenna::ANT_SZA);
+
+  Image image;
+  Angle size(Angle::Degrees(), 0.5);
+
+  image.setNpix(npix);
+  image.setAngularSize(size);
+
+  std::vector<Frequency> freqs(3);
+  std::vector<Angle> xoffs(3);
+
+  freqs[0].setGHz(30.0);
+  freqs[1].setGHz(35.0);
+  freqs[2].setGHz(30.0);
+  xoffs[2].setDegrees(1e-3);
+
+  std::vector<Image> fields(freqs.size());
+
+  for(unsigned i=0; i < fields.size(); i++)
+    fields[i] = PrimaryBeamCache::getApertureField(ant, image, freqs[i], xoffs[i]);
+
+  if(PrimaryBeamCache::nField() != fields.size())
+    ThrowError("Expected " << fields.size() << " fields, but the cache holds " << PrimaryBeamCache::nField());
+
+  //------------------------------------------------------------
+  // Save, then reload into an empty cache.  Every field should come
+  // back from the file, identical to the one we computed
+  //------------------------------------------------------------
+
+  if(!PrimaryBeamCache::save(fileName))
+    ThrowError("Unable to save the cache to " << fileName);
+
+  PrimaryBeamCache::clear();
+
+  if(PrimaryBeamCache::nField() != 0)
+    ThrowError("Cache was not emptied");
+
+  if(!PrimaryBeamCache::load(fileName))
+    ThrowError("Unable to reload the cache from " << fileName);
+
+  if(PrimaryBeamCache::nField() != fields.size())
+    ThrowError("Reloaded cache holds " << PrimaryBeamCache::nField() << " fields, not " << fields.size());
+
+  for(unsigned i=0; i < fields.size(); i++) {
+
+    Image field = PrimaryBeamCache::getApertureField(ant, image, freqs[i], xoffs[i]);
+
+    if(field.data_.size() != fields[i].data_.size() ||
+       memcmp(&field.data_[0], &fields[i].data_[0], field.data_.size() * sizeof(float)) != 0)
+      ThrowError("Field " << i << " reloaded from the cache differs from the computed field");
+  }
+
+  if(PrimaryBeamCache::nField() != fields.size())
+    ThrowError("Fields were recomputed rather than read from the cache");
+
+  COUT("Round trip of " << fields.size() << " fields passed");
+
+  //------------------------------------------------------------
+  // Now damaged copies of the file.  Each should be rejected, leaving
+  // the cache empty
+  //------------------------------------------------------------
+
+  std::vector<char> bytes = readFile(fileName);
+
+  PrimaryBeamCache::clear();
+
+  if(PrimaryBeamCache::load(badName))
+    ThrowError("A missing file was loaded");
+
+  writeFile(badName, bytes, 4);
+  checkRejected(badName, "A file truncated within its header");
+
+  writeFile(badName, bytes, bytes.size() / 2);
+  checkRejected(badName, "A file truncated within its data");
+
+  writeFile(badName, bytes, bytes.size() - 1);
+  checkRejected(badName, "A file truncated by one byte");
+
+  // The file starts with an 8-character magic string, followed by
+  // the format version
+
+  std::vector<char> bad = bytes;
+  bad[0] ^= 0xff;
+  writeFile(badName, bad, bad.size());
+  checkRejected(badName, "A file with the wrong magic string");
+
+  bad = bytes;
+  unsigned version;
+  memcpy(&version, &bad[8], sizeof(unsigned));
+  ++version;
+  memcpy(&bad[8], &version, sizeof(unsigned));
+  writeFile(badName, bad, bad.size());
+  checkRejected(badName, "A file from another version");
+
+  bad = bytes;
+  bad[bad.size() - bad.size()/4] ^= 0x01;
+  writeFile(badName, bad, bad.size());
+  checkRejected(badName, "A file with corrupted field data");
+
+  unlink(badName.c_str());
+  unlink(fileName.c_str());
+
+  COUT("PrimaryBeamCache tests passed");
+
+  return 0;
+}
+
+/**.......................................................................
+ * Read a whole file
+ */
+std::vector<char> readFile(std::string fileName)
+{
+  FILE* fp = fopen(fileName.c_str(), "rb");
+
+  if(!fp)
+    ThrowSysError("fopen(" << fileName << ")");
+
+  std::vector<char> bytes;
+  char buf[4096];
+  size_t n;
+
+  while((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    bytes.insert(bytes.end(), buf, buf + n);
+
+  fclose(fp);
+
+  return bytes;
+}
+
+/**.......................................................................
+ * Write the first nByte bytes to a file
+ */
+void writeFile(std::string fileName, std::vector<char>& bytes, size_t nByte)
+{
+  FILE* fp = fopen(fileName.c_str(), "wb");
+
+  if(!fp)
+    ThrowSysError("fopen(" << fileName << ")");
+
+  bool ok = fwrite(&bytes[0], 1, nByte, fp) == nByte;
+  ok = (fclose(fp) == 0) && ok;
+
+  if(!ok)
+    ThrowError("Unable to write " << fileName);
+}
+
+/**.......................................................................
+ * Check that a damaged file is not loaded
+ */
+void checkRejected(std::string fileName, std::string what)
+{
+  if(PrimaryBeamCache::load(fileName))
+    ThrowError(what << " was loaded");
+
+  if(PrimaryBeamCache::nField() != 0)
+    ThrowError(what << " left fields in the cache");
+
+  COUT(what << " was rejected");
+}
@@ -51,7 +51,7 @@ int Program::main()
   dft.plotAbs();
 
   unsigned nDft = dft.getTransformLength();
-  fftw_complex* dftData = dft.getTransformDataPtr();
+  FftwComplex* dftData = dft.getTransformDataPtr();
 
   float uvr, uvrMin, uvrMax;
   for(unsigned iDft=0; iDft < nDft; iDft++) {
@@ -0,0 +1,184 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+#include "gcp/util/ThreadPool.h"
+
+#include "gcp/fftutil/UvDataGridder.h"
+
+using namespace std;
+using namespace gcp::util;
+using namespace gcp::program;
+
+KeyTabEntry Program::keywords[] = {
+  { "npix",     "256",              "i", "Number of pixels on a side of the grid"},
+  { "nvis",     "20000",            "i", "Number of visibilities to grid"},
+  { "nthread",  "4",                "i", "Largest number of threads to test"},
+  { "kernel",   "gaussian",         "s", "Gridding kernel: gaussian or spheroidal"},
+  { "tol",      "1e-4",             "d", "Relative tolerance for agreement"},
+  { END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS},
+};
+
+void Program::initializeUsage() {};
+
+void initializeGridder(UvDataGridder& gridder, unsigned npix, Dft2d::ConvKernelType kernel);
+double relDiff(double val1, double val2);
+double compareMoments(UvDataGridder& serial, UvDataGridder& batch, bool first);
+
+int Program::main()
+{
+  unsigned npix    = Program::getIntegerParameter("npix");
+  unsigned nvis    = Program::getIntegerParameter("nvis");
+  unsigned nthread = Program::getIntegerParameter("nthread");
+  double tol       = Program::getDoubleParameter("tol");
+
+  Dft2d::ConvKernelType kernel = Dft2d::parseConvolutionKernel(Program::getStringParameter("kernel"));
+
+  //------------------------------------------------------------
+  // Generate visibilities scattered over the inner part of the grid
+  //------------------------------------------------------------
+
+  UvDataGridder serial;
+  initializeGridder(serial, npix, kernel);
+
+  double uvMax = 0.8 * serial.xAxis().getSpatialFrequencyResolution() * npix/2;
+
+  std::vector<double> u(nvis), v(nvis), re(nvis), im(nvis), wt(nvis);
+
+  srand(1);
+
+  for(unsigned iVis=0; iVis < nvis; iVis++) {
+    u[iVis]  = uvMax * (2.0 * rand() / RAND_MAX - 1.0);
+    v[iVis]  = uvMax * (2.0 * rand() / RAND_MAX - 1.0);
+    re[iVis] = 2.0 * rand() / RAND_MAX - 1.0;
+    im[iVis] = 2.0 * rand() / RAND_MAX - 1.0;
+    wt[iVis] = 0.5 + (double)rand() / RAND_MAX;
+  }
+
+  //------------------------------------------------------------
+  // Serial reference, one visibility at a time
+  //------------------------------------------------------------
+
+  serial.initializeForFirstMoments();
+  for(unsigned iVis=0; iVis < nvis; iVis++)
+    serial.accumulateFirstMomentsWithInterpolation(u[iVis], v[iVis], re[iVis], im[iVis], wt[iVis]);
+
+  UvDataGridder serialSecond;
+  initializeGridder(serialSecond, npix, kernel);
+
+  serialSecond.initializeForFirstMoments();
+  for(unsigned iVis=0; iVis < nvis; iVis++)
+    serialSecond.accumulateFirstMomentsWithInterpolation(u[iVis], v[iVis], re[iVis], im[iVis], wt[iVis]);
+
+  serialSecond.initializeForSecondMoments();
+  for(unsigned iVis=0; iVis < nvis; iVis++)
+    serialSecond.accumulateSecondMomentsWithInterpolation(u[iVis], v[iVis], re[iVis], im[iVis], wt[iVis]);
+
+  //------------------------------------------------------------
+  // Now the batched versions, with no pool, and with pools of 2
+  // up to nthread threads
+  //------------------------------------------------------------
+
+  for(unsigned nThread=1; nThread <= nthread; nThread *= 2) {
+
+    ThreadPool* pool = 0;
+
+    if(nThread > 1) {
+      pool = new ThreadPool(nThread);
+      pool->spawn();
+    }
+
+    try {
+
+      UvDataGridder batch;
+      initializeGridder(batch, npix, kernel);
+
+      batch.initializeForFirstMoments();
+      batch.accumulateFirstMomentsWithInterpolation(nvis, &u[0], &v[0], &re[0], &im[0], &wt[0], pool);
+
+      double firstDiff = compareMoments(serial, batch, true);
+
+      batch.initializeForSecondMoments();
+      batch.accumulateSecondMomentsWithInterpolation(nvis, &u[0], &v[0], &re[0], &im[0], &wt[0], pool);
+
+      double secondDiff = compareMoments(serialSecond, batch, false);
+
+      COUT(nThread << " thread(s): max relative difference in first moments = " << firstDiff
+	   << ", second moments = " << secondDiff);
+
+      if(firstDiff > tol || secondDiff > tol)
+	ThrowError("Batched gridding with " << nThread << " thread(s) differs from serial gridding");
+
+    } catch(...) {
+      delete pool;
+      throw;
+    }
+
+    delete pool;
+  }
+
+  return 0;
+}
+
+void initializeGridder(UvDataGridder& gridder, unsigned npix, Dft2d::ConvKernelType kernel)
+{
+  gridder.xAxis().setNpix(npix);
+  gridder.yAxis().setNpix(npix);
+
+  Angle size;
+  size.setDegrees(1.0);
+
+  gridder.xAxis().setAngularSize(size);
+  gridder.yAxis().setAngularSize(size);
+
+  gridder.setConvolutionKernel(kernel);
+}
+
+/**.......................................................................
+ * Return the difference between two values, relative to the larger
+ * of them, or absolute for values smaller than unity (means can be
+ * arbitrarily close to zero)
+ */
+double relDiff(double val1, double val2)
+{
+  double norm = fabs(val1) > fabs(val2) ? fabs(val1) : fabs(val2);
+  return fabs(val1 - val2) / (norm > 1.0 ? norm : 1.0);
+}
+
+/**.......................................................................
+ * Return the largest relative difference between the moments
+ * accumulated by two gridders.  Cell counts must agree exactly
+ */
+double compareMoments(UvDataGridder& serial, UvDataGridder& batch, bool first)
+{
+  double maxDiff = 0.0;
+
+  for(unsigned dftInd=0; dftInd < serial.nOutZeroPad_; dftInd++) {
+
+    if(serial.nPt_[dftInd] != batch.nPt_[dftInd])
+      ThrowError("Cell " << dftInd << " has " << serial.nPt_[dftInd] << " serial points, but "
+		 << batch.nPt_[dftInd] << " batched points");
+
+    double diff = relDiff(serial.wtSum_[dftInd], batch.wtSum_[dftInd]);
+    maxDiff = diff > maxDiff ? diff : maxDiff;
+
+    for(unsigned i=0; i < 2; i++) {
+      if(first)
+	diff = relDiff(serial.out_[dftInd][i], batch.out_[dftInd][i]);
+      else
+	diff = relDiff(serial.errorInMean_[dftInd][i], batch.errorInMean_[dftInd][i]);
+
+      maxDiff = diff > maxDiff ? diff : maxDiff;
+    }
+
+    if(!first) {
+      diff = relDiff(serial.wt2Sum_[dftInd], batch.wt2Sum_[dftInd]);
+      maxDiff = diff > maxDiff ? diff : maxDiff;
+    }
+  }
+
+  return maxDiff;
+}
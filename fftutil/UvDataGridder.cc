@@ -40,15 +40,8 @@ void UvDataGridder::operator=(UvDataGridder& gridder)
 {
   Dft2d::operator=(gridder);
 
-  if(errorInMean_) {
-    fftw_free(errorInMean_);
-    errorInMean_ = 0;
-  }
-
-  if(store_) {
-    fftw_free(store_);
-    store_ = 0;
-  }
+  releaseErrorInMean();
+  releaseStore();
 }
 
 void UvDataGridder::sizeToMatch(UvDataGridder& gridder)
@@ -79,6 +72,8 @@ void UvDataGridder::duplicate(UvDataGridder& gridder)
   populatedIndices_ = gridder.populatedIndices_;
   populatedU_       = gridder.populatedU_;
   populatedV_       = gridder.populatedV_;
+  populatedReErr_   = gridder.populatedReErr_;
+  populatedImErr_   = gridder.populatedImErr_;
 
   errorInMeanIsValid_ = gridder.errorInMeanIsValid_;
 }
@@ -104,6 +99,22 @@ void UvDataGridder::operator+=(UvDataGridder& gridder)
   }
 }
 
+void UvDataGridder::addScaled(UvDataGridder& gridder, double scale)
+{
+  if(nOut_ != gridder.nOut_ || populatedIndices_.size() != gridder.populatedIndices_.size()) {
+    ThrowColorError("Cannot assign data from dfts of different sizes", "red");
+  }
+
+  unsigned nInd = gridder.populatedIndices_.size();
+  unsigned dftInd;
+
+  for(unsigned i=0; i < nInd; i++) {
+    dftInd = gridder.populatedIndices_[i];
+    out_[dftInd][0] += scale * gridder.out_[dftInd][0];
+    out_[dftInd][1] += scale * gridder.out_[dftInd][1];
+  }
+}
+
 void UvDataGridder::assignDataFrom(const UvDataGridder& gridder)
 {
   assignDataFrom((UvDataGridder&) gridder);
@@ -124,12 +135,28 @@ void UvDataGridder::assignDataFrom(UvDataGridder& gridder)
 
       out_[dftInd][0] = gridder.out_[dftInd][0];
       out_[dftInd][1] = gridder.out_[dftInd][1];
+    }
+
+    //------------------------------------------------------------
+    // Errors are stored sparsely, and the store only exists if it
+    // has been used
+    //------------------------------------------------------------
+
+    populatedReErr_ = gridder.populatedReErr_;
+    populatedImErr_ = gridder.populatedImErr_;
 
-      errorInMean_[dftInd][0] = gridder.errorInMean_[dftInd][0];
-      errorInMean_[dftInd][1] = gridder.errorInMean_[dftInd][1];
+    if(gridder.store_) {
 
-      store_[dftInd][0] = gridder.store_[dftInd][0];
-      store_[dftInd][1] = gridder.store_[dftInd][1];
+      if(!store_) {
+	if((store_ = (FftwComplex*)FFTW_CALL(malloc)(nOutZeroPad_ * sizeof(FftwComplex)))==0)
+	  ThrowError("Couldn't allocate store array");
+      }
+
+      for(unsigned i=0; i < nInd; i++) {
+	dftInd = gridder.populatedIndices_[i];
+	store_[dftInd][0] = gridder.store_[dftInd][0];
+	store_[dftInd][1] = gridder.store_[dftInd][1];
+      }
     }
 
     hasData_ = true;
@@ -152,17 +179,15 @@ void UvDataGridder::setPopulatedIndicesToValue(double val)
 
 UvDataGridder::~UvDataGridder() 
 {
-  if(errorInMean_) {
-    fftw_free(errorInMean_);
-    errorInMean_ = 0;
-  }
-
-  if(store_) {
-    fftw_free(store_);
-    store_ = 0;
-  }
+  releaseErrorInMean();
+  releaseStore();
 }
 
+/**.......................................................................
+ * Resize for a dft of a different size.  Note that the second-moment
+ * accumulator and the store are no longer allocated here; they are
+ * allocated only when (and if) they are needed
+ */
 void UvDataGridder::resize()
 {
   Dft2d::resize();
@@ -171,23 +196,30 @@ void UvDataGridder::resize()
   wtSum_.resize(nOutZeroPad_);
   wt2Sum_.resize(nOutZeroPad_);
 
+  releaseErrorInMean();
+  releaseStore();
+}
+
+/**.......................................................................
+ * Release the full-grid second-moment accumulator
+ */
+void UvDataGridder::releaseErrorInMean()
+{
   if(errorInMean_) {
-    fftw_free(errorInMean_);
+    FFTW_CALL(free)(errorInMean_);
     errorInMean_ = 0;
   }
+}
 
-  if((errorInMean_ = (fftw_complex*)fftw_malloc(nOutZeroPad_ * sizeof(fftw_complex)))==0) {
-    ThrowError("Couldn't allocate output data array");
-  }
-
+/**.......................................................................
+ * Release the store
+ */
+void UvDataGridder::releaseStore()
+{
   if(store_) {
-    fftw_free(store_);
+    FFTW_CALL(free)(store_);
     store_ = 0;
   }
-
-  if((store_ = (fftw_complex*)fftw_malloc(nOutZeroPad_ * sizeof(fftw_complex)))==0) {
-    ThrowError("Couldn't allocate output data array");
-  }
 }
 
 /**.......................................................................
@@ -221,6 +253,11 @@ void UvDataGridder::initializeForFirstMoments()
  */
 void UvDataGridder::initializeForSecondMoments()
 {
+  if(!errorInMean_) {
+    if((errorInMean_ = (FftwComplex*)FFTW_CALL(malloc)(nOutZeroPad_ * sizeof(FftwComplex)))==0)
+      ThrowError("Couldn't allocate second-moment array");
+  }
+
   for(unsigned i=0; i < nOutZeroPad_; i++) {
     errorInMean_[i][0] = 0.0;
     errorInMean_[i][1] = 0.0;
@@ -401,33 +438,75 @@ void UvDataGridder::accumulateFirstMoments(unsigned dftInd, double re, double im
  */
 void UvDataGridder::accumulateFirstMomentsWithInterpolation(double u, double v, double re, double im, double dataWt)
 {
+  double du, dv;
+  getGridResolution(du, dv);
+
   //------------------------------------------------------------
-  // Get the spatial frequency resolution of the axes
+  // Get the cells of the grid this visibility is convolved onto
   //------------------------------------------------------------
 
-  int nu = xAxis_.getNpix();
-  int nv = yAxis_.getNpix();
+  GridCell cells[(2*convMaxMaskInPixels_+1) * (2*convMaxMaskInPixels_+1)];
+  unsigned nCell = getGridCells(u, v, du, dv, cells);
 
-  double du;
-  double dv;
-#ifdef EMLTEST
-  static bool first = true;
-#endif
+  for(unsigned iCell=0; iCell < nCell; iCell++) {
 
+    unsigned dftInd = cells[iCell].dftInd_;
+    double imVal    = cells[iCell].conj_ ? -im : im;
+
+    //------------------------------------------------------------
+    // The combined weight is the convolution weight multiplied by
+    // the data weight
+    //------------------------------------------------------------
+
+    double wt = cells[iCell].wt_ * dataWt;
+
+    //------------------------------------------------------------
+    // Update the running mean for this pixel
+    //------------------------------------------------------------
+
+    double remean = out_[dftInd][0];
+    double immean = out_[dftInd][1];
+
+    out_[dftInd][0] += ((re    - remean) * wt / (wtSum_[dftInd] + wt));
+    out_[dftInd][1] += ((imVal - immean) * wt / (wtSum_[dftInd] + wt));
+
+    //------------------------------------------------------------
+    // Increment weight sums needed for running averages and errors
+    //------------------------------------------------------------
+      
+    nPt_[dftInd]++;
+    wtSum_[dftInd] += wt;
+    wtSumTotal_    += wt;
+  }
+}
+
+/**.......................................................................
+ * Return the spatial frequency resolution of the axes
+ */
+void UvDataGridder::getGridResolution(double& du, double& dv)
+{
   try {
     du = xAxis_.getSpatialFrequencyResolution();
   } catch(...) {
-    du = 1.0/nu;
+    du = 1.0/xAxis_.getNpix();
   }
 
   try {
     dv = yAxis_.getSpatialFrequencyResolution();
   } catch(...) {
-    dv = 1.0/nv;
+    dv = 1.0/yAxis_.getNpix();
   }
+}
 
-  double s2    = 2*convSigInPixels_*convSigInPixels_;
-  double wtSum = 0.0;
+/**.......................................................................
+ * Return the cells of the grid onto which a visibility at (u, v) is
+ * convolved, and the convolution weight for each.  Cells that fall
+ * off the grid are omitted.  Returns the number of cells
+ */
+unsigned UvDataGridder::getGridCells(double u, double v, double du, double dv, GridCell* cells)
+{
+  int nu = xAxis_.getNpix();
+  int nv = yAxis_.getNpix();
 
   //------------------------------------------------------------
   // Get the UV index closest to the current point
@@ -438,32 +517,6 @@ void UvDataGridder::accumulateFirstMomentsWithInterpolation(double u, double v,
 
   uvIndex(u, v, uInd, vInd, conjugateResult);
 
-#ifdef EMLTEST
-  if(first) {
-    int dftInd = (uInd * (nv/2+1) + vInd);
-    COUT("(2) u = " << u << " v = " << v << " re = " << re << " im = " << im << " wt = " << dataWt 
-	 << " uInd = " << uInd << " vInd = " << vInd << " dftInd = " <<  dftInd << " conj = " << conjugateResult
-	 << " nu = " << nu << " nv = " << nv << " du = " << du << " dv = " << dv);
-  }
-
-  bool print = false;
-  static int dftIndFid = -1;
-  if(fabs(u + 912.253) < 0.1) {
-    print = true;
-    fprintf(stdout, "Found min u: uu = %f vv = %f upix = %d, vpix = %d\n", u, v, uInd, vInd);
-  }
-  if(fabs(u - 1262.086) < 0.1) {
-    fprintf(stdout, "Found min u: uu = %f vv = %f upix = %d, vpix = %d\n", u, v, uInd, vInd);
-  }
-  if(fabs(v + 742.09) < 0.1) {
-    fprintf(stdout, "Found min u: uu = %f vv = %f upix = %d, vpix = %d\n", u, v, uInd, vInd);
-  }
-  if(fabs(v - 1330.95) < 0.1) {
-    fprintf(stdout, "Found min u: uu = %f vv = %f upix = %d, vpix = %d\n", u, v, uInd, vInd);
-  }
-
-#endif
-
   //------------------------------------------------------------
   // Get the UV coordinate of this nearest point
   //------------------------------------------------------------
@@ -495,130 +548,52 @@ void UvDataGridder::accumulateFirstMomentsWithInterpolation(double u, double v,
     }
   }
 
-#ifdef EMLTEST
-  if(first) {
-    COUT("uVal of closest point is: " << uVal0 << " v = " << vVal0);
-  }
-#endif
-
   //------------------------------------------------------------
-  // Now iterate over a mask of pixels centered on the nearest pixel.
+  // The kernel is separable, so look up the u and v weights once
+  // for each row and column of the mask, rather than once per cell
   //------------------------------------------------------------
 
-  double reVal, imVal;
-  double uVal, vVal;
-  unsigned dftInd;
-  for(int iU = -convMaskInPixels_; iU <= convMaskInPixels_; iU++) {
-    for(int iV = -convMaskInPixels_; iV <= convMaskInPixels_; iV++) {
-
-      //------------------------------------------------------------
-      // Get the uv coordinate of this point
-      //------------------------------------------------------------
-  
-      uVal = uVal0 + iU * du;
-      vVal = vVal0 + iV * dv;
-
-      //------------------------------------------------------------
-      // Get the dft index corresponding to this point. 
-      //------------------------------------------------------------
-
-      try {
-	dftIndex(uVal, vVal, dftInd, conjugateResult);
-	reVal = re;
-	imVal = conjugateResult ? -im : im;
-      } catch(...) {
-
-	//------------------------------------------------------------
-	// If this point lies outside of our dft grid, just ignore it
-	//------------------------------------------------------------
-
-	continue;
-      }
-
-      //------------------------------------------------------------
-      // Calculate the delta of the requested (u,v) point from the
-      // center of this pixel, in fractional pixels
-      //------------------------------------------------------------
-
-      double duPix = (u - uVal)/du;
-      double dvPix = (v - vVal)/dv;
+  int mask = convMaskInPixels();
 
-#ifdef EMLTEST
-
-      // Save the fiducial dft index
-
-      if(print && dftIndFid < 0 && iU == 0 && iV == 0)
-	dftIndFid = dftInd;
-
-      if(first) {
-	COUT("u = " << u << " v = " << v << " uVal = " << uVal << " vVal = " << vVal << " du = " << du << " dv = " << dv);
-      }      
-#endif
+  double uWt[2*convMaxMaskInPixels_+1];
+  double vWt[2*convMaxMaskInPixels_+1];
 
-      //------------------------------------------------------------
-      // And the weight corresponding to it
-      //------------------------------------------------------------
+  for(int iU = -mask; iU <= mask; iU++)
+    uWt[iU + mask] = convolutionKernel((u - (uVal0 + iU * du))/du);
 
-      double arg = (duPix * duPix + dvPix * dvPix)/s2;
+  for(int iV = -mask; iV <= mask; iV++)
+    vWt[iV + mask] = convolutionKernel((v - (vVal0 + iV * dv))/dv);
 
-      //------------------------------------------------------------
-      // The combined weight is the convolution weight multiplied by
-      // the data weight
-      //------------------------------------------------------------
+  //------------------------------------------------------------
+  // Now iterate over a mask of pixels centered on the nearest pixel
+  //------------------------------------------------------------
 
-      double wt = exp(-arg) * dataWt;
+  unsigned nCell = 0;
+  unsigned iU0, iV0;
+  bool valid;
 
-#if 0
-#ifdef EMLTEST
-      if(print || dftInd == dftIndFid) {
-	fprintf(stdout, "Adding u = %f v = %f re = %f im=%f vis->wt = %f wttotal = %f to pixel iu = %d iv = %d dftInd = %d dftIndFid = %d wtSum = %f\n",
-		u, v, reVal, imVal, dataWt, wt, iU, iV, dftInd, dftIndFid, wtSum_[dftInd]);
-      }
-#endif
-#endif
+  for(int iU = -mask; iU <= mask; iU++) {
+    for(int iV = -mask; iV <= mask; iV++) {
 
       //------------------------------------------------------------
-      // Finally, update the running mean for this pixel
+      // Get the dft index of this cell.  If this point lies outside
+      // of our dft grid, just ignore it
       //------------------------------------------------------------
 
-      double remean = out_[dftInd][0];
-      double immean = out_[dftInd][1];
+      uvIndex(uVal0 + iU * du, vVal0 + iV * dv, iU0, iV0, conjugateResult, valid);
 
-#if 1
-      out_[dftInd][0] += ((reVal - remean) * wt / (wtSum_[dftInd] + wt));
-      out_[dftInd][1] += ((imVal - immean) * wt / (wtSum_[dftInd] + wt));
-#else
-      out_[dftInd][0] += reVal * wt;
-      out_[dftInd][1] += imVal * wt;
-#endif
+      if(!valid)
+	continue;
 
-#if 0
-#ifdef EMLTEST
-      if(print || dftInd == dftIndFid) {
-	COUT("reVal = " << reVal << " imVal = " << imVal << " wt = " << wt << " remean = " << remean << " immean = " << immean << " Re = " << out_[dftInd][0] << " Im = " << out_[dftInd][1] << " wtsum = " << wtSum_[dftInd] << " dftInd = " << dftInd);
-      }
-#endif
-#endif
+      GridCell& cell = cells[nCell++];
 
-      //------------------------------------------------------------
-      // Increment weight sums needed for running averages and errors
-      //------------------------------------------------------------
-      
-      nPt_[dftInd]++;
-      wtSum_[dftInd] += wt;
-      wtSumTotal_    += wt;
+      cell.dftInd_ = iU0 * (nyZeroPad_/2+1) + iV0;
+      cell.conj_   = conjugateResult;
+      cell.wt_     = uWt[iU + mask] * vWt[iV + mask];
     }
   }
 
-#ifdef EMLTEST
-  {
-    if(first) {
-      first = false;
-      unsigned dftInd;
-      dftIndex(u, v, dftInd, conjugateResult);
-      COUT("Value of closest point is now: re = " << out_[dftInd][0] << " im = " << out_[dftInd][1] << " re = " << re << " im = " << im);    }
-  }
-#endif
+  return nCell;
 }
 
 /**.......................................................................
@@ -685,183 +660,316 @@ void UvDataGridder::accumulateSecondMoments(double u, double v, double re, doubl
  */
 void UvDataGridder::accumulateSecondMomentsWithInterpolation(double u, double v, double re, double im, double dataWt)
 {
+  double du, dv;
+  getGridResolution(du, dv);
+
   //------------------------------------------------------------
-  // Get the spatial frequency resolution of the axes
+  // Get the cells of the grid this visibility is convolved onto
   //------------------------------------------------------------
 
-  int nu = xAxis_.getNpix();
-  int nv = yAxis_.getNpix();
+  GridCell cells[(2*convMaxMaskInPixels_+1) * (2*convMaxMaskInPixels_+1)];
+  unsigned nCell = getGridCells(u, v, du, dv, cells);
 
-  double du;
-  double dv;
-#ifdef EMLTEST
-  static bool first = true;
-#endif
+  for(unsigned iCell=0; iCell < nCell; iCell++) {
 
-  try {
-    du = xAxis_.getSpatialFrequencyResolution();
-  } catch(...) {
-    du = 1.0/nu;
-  }
+    unsigned dftInd = cells[iCell].dftInd_;
+    double imVal    = cells[iCell].conj_ ? -im : im;
 
-  try {
-    dv = yAxis_.getSpatialFrequencyResolution();
-  } catch(...) {
-    dv = 1.0/nv;
-  }
+    //------------------------------------------------------------
+    // The combined weight is the convolution weight multiplied by
+    // the data weight
+    //------------------------------------------------------------
 
-  double s2    = 2*convSigInPixels_*convSigInPixels_;
-  double wtSum = 0.0;
+    double wt = cells[iCell].wt_ * dataWt;
 
-  //------------------------------------------------------------
-  // Get the UV index closest to the current point
-  //------------------------------------------------------------
+    //------------------------------------------------------------
+    // Construct the current value of (val- mean)^2
+    //------------------------------------------------------------
 
-  bool conjugateResult=false;
-  unsigned uInd, vInd;
+    double remean = out_[dftInd][0];
+    double immean = out_[dftInd][1];
 
-  uvIndex(u, v, uInd, vInd, conjugateResult);
+    double re2 = (re    - remean) * (re    - remean);
+    double im2 = (imVal - immean) * (imVal - immean);
 
-#ifdef EMLTEST
-  if(first) {
-    int dftInd = (uInd * (nv/2+1) + vInd);
-    COUT("(2) u = " << u << " v = " << v << " re = " << re << " im = " << im << " wt = " << dataWt 
-	 << " uInd = " << uInd << " vInd = " << vInd << " dftInd = " <<  dftInd << " conj = " << conjugateResult);
+    // And the running average of the second moment so far
+      
+    double re2mean =  errorInMean_[dftInd][0];
+    double im2mean =  errorInMean_[dftInd][1];
+      
+    errorInMean_[dftInd][0] += (re2 - re2mean) * wt / (wtSum_[dftInd] + wt);
+    errorInMean_[dftInd][1] += (im2 - im2mean) * wt / (wtSum_[dftInd] + wt);
+      
+    // Increment weight sums needed for running averages and errors
+      
+    nPt_[dftInd]++;
+    wtSum_[dftInd]  += wt;
+    wt2Sum_[dftInd] += wt*wt;
+    wtSumTotal_     += wt;
   }
-#endif
+}
+
+//=======================================================================
+// Batched, multi-threaded convolutional gridding
+//=======================================================================
+
+void UvDataGridder::accumulateFirstMomentsWithInterpolation(unsigned n, const double* u, const double* v, 
+							    const double* re, const double* im, const double* wt,
+							    ThreadPool* pool)
+{
+  accumulateMomentsWithInterpolation(true, n, u, v, re, im, wt, pool);
+}
+
+void UvDataGridder::accumulateSecondMomentsWithInterpolation(unsigned n, const double* u, const double* v, 
+							     const double* re, const double* im, const double* wt,
+							     ThreadPool* pool)
+{
+  accumulateMomentsWithInterpolation(false, n, u, v, re, im, wt, pool);
+}
+
+/**.......................................................................
+ * Accumulate first or second moments for a batch of visibilities.
+ *
+ * The running means of the single-visibility accumulators can't be
+ * updated from several threads at once.  Instead, each thread
+ * accumulates weighted sums for its share of the visibilities into
+ * private tiles of the grid (allocated only when touched), and the
+ * tiles are then merged into the running means, with each thread
+ * merging a disjoint range of tiles.  Second moments are taken about
+ * the means already in the grid, which are only read here
+ */
+void UvDataGridder::accumulateMomentsWithInterpolation(bool first, unsigned n, const double* u, const double* v, 
+						       const double* re, const double* im, const double* wt,
+						       ThreadPool* pool)
+{
+  if(!first && !errorInMean_)
+    ThrowError("No second-moment array has been allocated -- use initializeForSecondMoments() first");
+
+  unsigned nThread = pool ? pool->nThread() : 1;
+
+  if(nThread > n)
+    nThread = n;
 
   //------------------------------------------------------------
-  // Get the UV coordinate of this nearest point
+  // Not worth the overhead for a single thread
   //------------------------------------------------------------
 
-  double uVal0, vVal0;
-  uvCoord(uInd, vInd, uVal0, vVal0);
+  if(nThread < 2) {
+    for(unsigned i=0; i < n; i++) {
+      if(first)
+	accumulateFirstMomentsWithInterpolation(u[i], v[i], re[i], im[i], wt[i]);
+      else
+	accumulateSecondMomentsWithInterpolation(u[i], v[i], re[i], im[i], wt[i]);
+    }
+    return;
+  }
 
-  // If the closest point was in the conjugate half of the array,
-  // conjugate to make sure we do the separation calculation
-  // correectly
+  unsigned nTile = (nOutZeroPad_ + gridTileSize_ - 1) / gridTileSize_;
 
-  if(conjugateResult) {
-    uVal0 = -uVal0;
-    vVal0 = -vVal0;
-  }
+  std::vector<GridExecData*> execData(nThread);
+  ThreadSynchronizer synchronizer;
 
-  // If the maximum spatial frequency was requested, check whether we
-  // are after the negative or positive spatial frequency
+  try {
 
-  if(uInd == nu/2) {
-    if((u < 0 && uVal0 > 0) || (u > 0 && uVal0 < 0)) {
-      uVal0 = -uVal0;
+    for(unsigned iThread=0; iThread < nThread; iThread++) {
+
+      GridExecData* ged = execData[iThread] = new GridExecData();
+
+      ged->gridder_      = this;
+      ged->first_        = first;
+      ged->iThread_      = iThread;
+      ged->nThread_      = nThread;
+
+      ged->iVisStart_    = (unsigned)(((unsigned long long)n * iThread) / nThread);
+      ged->iVisStop_     = (unsigned)(((unsigned long long)n * (iThread+1)) / nThread);
+      ged->u_            = u;
+      ged->v_            = v;
+      ged->re_           = re;
+      ged->im_           = im;
+      ged->wt_           = wt;
+
+      ged->iTileStart_   = (nTile * iThread) / nThread;
+      ged->iTileStop_    = (nTile * (iThread+1)) / nThread;
+
+      ged->tiles_.resize(nTile, 0);
+      ged->allExecData_  = &execData;
+      ged->synchronizer_ = &synchronizer;
     }
-  }
 
-  if(vInd == nv/2) {
-    if((v < 0 && vVal0 > 0) || (v > 0 && vVal0 < 0)) {
-      vVal0 = -vVal0;
+    //------------------------------------------------------------
+    // Accumulate, then merge.  Each phase must complete before the
+    // next starts
+    //------------------------------------------------------------
+
+    EXECUTE_FN(*phases[2]) = {&execAccumulateTiles, &execMergeTiles};
+
+    for(unsigned iPhase=0; iPhase < 2; iPhase++) {
+
+      synchronizer.reset(nThread);
+
+      for(unsigned iThread=0; iThread < nThread; iThread++) {
+	synchronizer.registerPending(iThread);
+	pool->execute(phases[iPhase], execData[iThread]);
+      }
+
+      synchronizer.wait();
+
+      for(unsigned iThread=0; iThread < nThread; iThread++) {
+	if(!execData[iThread]->error_.empty())
+	  ThrowError(execData[iThread]->error_);
+      }
     }
+
+    for(unsigned iThread=0; iThread < nThread; iThread++)
+      wtSumTotal_ += execData[iThread]->wtSumTotal_;
+
+  } catch(...) {
+    for(unsigned iThread=0; iThread < nThread; iThread++)
+      delete execData[iThread];
+    throw;
   }
 
-  //------------------------------------------------------------
-  // Now iterate over a mask of pixels centered on the nearest pixel.
-  //------------------------------------------------------------
+  for(unsigned iThread=0; iThread < nThread; iThread++)
+    delete execData[iThread];
+}
 
-  double reVal, imVal;
-  double uVal, vVal;
-  unsigned dftInd;
+/**.......................................................................
+ * Accumulate weighted sums for this thread's visibilities into its
+ * own tiles
+ */
+void UvDataGridder::accumulateTiles(GridExecData* ged)
+{
+  double du, dv;
+  getGridResolution(du, dv);
 
-  for(int iU = -convMaskInPixels_; iU <= convMaskInPixels_; iU++) {
-    for(int iV = -convMaskInPixels_; iV <= convMaskInPixels_; iV++) {
+  GridCell cells[(2*convMaxMaskInPixels_+1) * (2*convMaxMaskInPixels_+1)];
 
-      //------------------------------------------------------------
-      // Get the uv coordinate of this point
-      //------------------------------------------------------------
-  
-      uVal = uVal0 + iU * du;
-      vVal = vVal0 + iV * dv;
+  for(unsigned iVis=ged->iVisStart_; iVis < ged->iVisStop_; iVis++) {
 
-      //------------------------------------------------------------
-      // Get the dft index corresponding to this point. 
-      //------------------------------------------------------------
+    double re = ged->re_[iVis];
+    double im = ged->im_[iVis];
 
-      try {
-	dftIndex(uVal, vVal, dftInd, conjugateResult);
-	reVal = re;
-	imVal = conjugateResult ? -im : im;
-      } catch(...) {
+    unsigned nCell = getGridCells(ged->u_[iVis], ged->v_[iVis], du, dv, cells);
 
-	//------------------------------------------------------------
-	// If this point lies outside of our dft grid, just ignore it
-	//------------------------------------------------------------
+    for(unsigned iCell=0; iCell < nCell; iCell++) {
 
-	continue;
+      unsigned dftInd = cells[iCell].dftInd_;
+      unsigned iTile  = dftInd / gridTileSize_;
+      unsigned iPix   = dftInd % gridTileSize_;
+
+      GridTile*& tile = ged->tiles_[iTile];
+
+      if(tile == 0)
+	tile = new GridTile(gridTileSize_);
+
+      double imVal = cells[iCell].conj_ ? -im : im;
+      double wt    = cells[iCell].wt_ * ged->wt_[iVis];
+
+      if(ged->first_) {
+	tile->reSum_[iPix] += wt * re;
+	tile->imSum_[iPix] += wt * imVal;
+      } else {
+	double reDiff = re    - out_[dftInd][0];
+	double imDiff = imVal - out_[dftInd][1];
+	tile->reSum_[iPix]  += wt * reDiff * reDiff;
+	tile->imSum_[iPix]  += wt * imDiff * imDiff;
+	tile->wt2Sum_[iPix] += wt * wt;
       }
 
-      //------------------------------------------------------------
-      // Calculate the delta of the requested (u,v) point from the
-      // center of this pixel, in fractional pixels
-      //------------------------------------------------------------
+      tile->wtSum_[iPix] += wt;
+      tile->nPt_[iPix]++;
 
-      double duPix = (u - uVal)/du;
-      double dvPix = (v - vVal)/dv;
+      ged->wtSumTotal_ += wt;
+    }
+  }
+}
 
-#ifdef EMLTEST
-      if(first) {
-	COUT("u = " << u << " v = " << v << " uVal = " << uVal << " vVal = " << vVal << " du = " << du << " dv = " << dv);
-      }      
-#endif
+/**.......................................................................
+ * Merge every thread's sums for this thread's range of tiles into the
+ * grid.  Threads are merged in order, so the result doesn't depend on
+ * scheduling
+ */
+void UvDataGridder::mergeTiles(GridExecData* ged)
+{
+  std::vector<GridExecData*>& all = *ged->allExecData_;
 
-      //------------------------------------------------------------
-      // And the weight corresponding to it
-      //------------------------------------------------------------
+  for(unsigned iTile=ged->iTileStart_; iTile < ged->iTileStop_; iTile++) {
 
-      double arg = (duPix * duPix + dvPix * dvPix)/s2;
+    unsigned iStart = iTile * gridTileSize_;
+    unsigned nPix   = (iStart + gridTileSize_ > nOutZeroPad_) ? nOutZeroPad_ - iStart : gridTileSize_;
 
-      //------------------------------------------------------------
-      // The combined weight is the convolution weight multiplied by
-      // the data weight
-      //------------------------------------------------------------
+    for(unsigned iThread=0; iThread < all.size(); iThread++) {
 
-      double wt = exp(-arg) * dataWt;
+      GridTile* tile = all[iThread]->tiles_[iTile];
 
-#ifdef EMLTEST
-      if(first) {
-	COUT("arg = " << arg << " dataWt = " << dataWt << " wt = " << wt);
-      }      
-#endif
+      if(tile == 0)
+	continue;
 
-      //------------------------------------------------------------
-      // Finally, update the running mean for this pixel
-      //------------------------------------------------------------
+      FftwComplex* moments = ged->first_ ? out_ : errorInMean_;
 
-      double remean = out_[dftInd][0];
-      double immean = out_[dftInd][1];
+      for(unsigned iPix=0; iPix < nPix; iPix++) {
 
-      // Construct the current value of (val- mean)^2
+	double wt = tile->wtSum_[iPix];
 
-      double re2 = (reVal - remean) * (reVal - remean);
-      double im2 = (imVal - immean) * (imVal - immean);
+	if(tile->nPt_[iPix] == 0)
+	  continue;
 
-      // And the running average of the second moment so far
-      
-      double re2mean =  errorInMean_[dftInd][0];
-      double im2mean =  errorInMean_[dftInd][1];
-      
-      errorInMean_[dftInd][0] += (re2 - re2mean) * wt / (wtSum_[dftInd] + wt);
-      errorInMean_[dftInd][1] += (im2 - im2mean) * wt / (wtSum_[dftInd] + wt);
-      
-      // Increment weight sums needed for running averages and errors
-      
-      nPt_[dftInd]++;
-      wtSum_[dftInd]  += wt;
-      wt2Sum_[dftInd] += wt*wt;
-      wtSumTotal_     += wt;
+	unsigned dftInd = iStart + iPix;
+	double wtSum    = wtSum_[dftInd] + wt;
+
+	//------------------------------------------------------------
+	// Fold the weighted sums into the running mean
+	//------------------------------------------------------------
+
+	if(wtSum > 0.0) {
+	  moments[dftInd][0] += (tile->reSum_[iPix] - moments[dftInd][0] * wt) / wtSum;
+	  moments[dftInd][1] += (tile->imSum_[iPix] - moments[dftInd][1] * wt) / wtSum;
+	}
+
+	nPt_[dftInd]    += tile->nPt_[iPix];
+	wtSum_[dftInd]   = wtSum;
+	wt2Sum_[dftInd] += tile->wt2Sum_[iPix];
+      }
     }
   }
 }
 
+EXECUTE_FN(UvDataGridder::execAccumulateTiles)
+{
+  GridExecData* ged = (GridExecData*)args;
+
+  try {
+    ged->gridder_->accumulateTiles(ged);
+  } catch(Exception& err) {
+    ged->error_ = err.what();
+  } catch(...) {
+    ged->error_ = "Unknown error while gridding";
+  }
+
+  ged->synchronizer_->registerDone(ged->iThread_, ged->nThread_);
+}
+
+EXECUTE_FN(UvDataGridder::execMergeTiles)
+{
+  GridExecData* ged = (GridExecData*)args;
+
+  try {
+    ged->gridder_->mergeTiles(ged);
+  } catch(Exception& err) {
+    ged->error_ = err.what();
+  } catch(...) {
+    ged->error_ = "Unknown error while gridding";
+  }
+
+  ged->synchronizer_->registerDone(ged->iThread_, ged->nThread_);
+}
+
 /**.......................................................................
  * Convert from moment sums to error in the mean.  Should only be
  * called after all data have been gridded into this object.
+ *
+ * Errors are stored only for populated indices, after which the
+ * full-grid second-moment accumulator is released.
  */
 void UvDataGridder::calculateErrorInMean()
 {
@@ -871,6 +979,19 @@ void UvDataGridder::calculateErrorInMean()
 
   static bool count=0;
 
+  if(estimateErrInMeanFromData_ && !errorInMean_)
+    ThrowError("No second moments have been accumulated -- use initializeForSecondMoments() first");
+
+  //------------------------------------------------------------
+  // Populated indices are rebuilt from scratch below
+  //------------------------------------------------------------
+
+  populatedIndices_.resize(0);
+  populatedU_.resize(0);
+  populatedV_.resize(0);
+  populatedReErr_.resize(0);
+  populatedImErr_.resize(0);
+
   for(unsigned i=0; i < nOutZeroPad_; i++) {
     
     if(nPt_[i] > 0) {
@@ -914,11 +1035,11 @@ void UvDataGridder::calculateErrorInMean()
 
 	if(nPt_[i] == 1) {
 	  double sigma = sqrt(1.0/wtSum_[i]);
-	  errorInMean_[i][0] = sigma;
-	  errorInMean_[i][1] = sigma;
+	  populatedReErr_.push_back(sigma);
+	  populatedImErr_.push_back(sigma);
 	} else {
-	  errorInMean_[i][0] = sqrt(prefac * errorInMean_[i][0]);
-	  errorInMean_[i][1] = sqrt(prefac * errorInMean_[i][1]);
+	  populatedReErr_.push_back(sqrt(prefac * errorInMean_[i][0]));
+	  populatedImErr_.push_back(sqrt(prefac * errorInMean_[i][1]));
 	}
 
 	//------------------------------------------------------------
@@ -927,14 +1048,16 @@ void UvDataGridder::calculateErrorInMean()
 
       } else {
 	double sigma = sqrt(1.0/(wtSum_[i]));
-	errorInMean_[i][0] = sigma;
-	errorInMean_[i][1] = sigma;
+	populatedReErr_.push_back(sigma);
+	populatedImErr_.push_back(sigma);
       }
 
     }
 
   }
 
+  releaseErrorInMean();
+
   errorInMeanIsValid_ = true;
 }
 
@@ -994,11 +1117,9 @@ double UvDataGridder::estimateMapPixelRms()
 
   double wtsum = 0.0;
   double sigma, wt;
-  unsigned ind;
 
-  for(unsigned i=0; i < populatedIndices_.size(); i++) {
-    ind = populatedIndices_[i];
-    sigma = errorInMean_[ind][0];
+  for(unsigned i=0; i < populatedReErr_.size(); i++) {
+    sigma = populatedReErr_[i];
     wt = 1.0/(sigma * sigma);
     wtsum += wt;
   }
@@ -1052,7 +1173,7 @@ void UvDataGridder::plotOccupiedUV()
  * wtSum_ array.  However, if we want to transform this data to make
  * an image, we need to re-weight the data accordingly.
  */
-void UvDataGridder::computeInverseTransform(fftw_plan* invPlan)
+void UvDataGridder::computeInverseTransform(FftwPlan* invPlan)
 {
   unsigned nInd = populatedIndices_.size();
   unsigned dftInd;
@@ -1093,7 +1214,7 @@ void UvDataGridder::renormalize()
   }
 }
 
-void UvDataGridder::computeInverseTransformNoRenorm(fftw_plan* invPlan)
+void UvDataGridder::computeInverseTransformNoRenorm(FftwPlan* invPlan)
 {
   Dft2d::computeInverseTransform(invPlan);
 }
@@ -1113,6 +1234,11 @@ void UvDataGridder::operator*=(double mult)
 
 void UvDataGridder::copyToStore()
 {
+  if(!store_) {
+    if((store_ = (FftwComplex*)FFTW_CALL(malloc)(nOutZeroPad_ * sizeof(FftwComplex)))==0)
+      ThrowError("Couldn't allocate store array");
+  }
+
   for(unsigned i=0; i < nOutZeroPad_; i++) {
     store_[i][0] = out_[i][0];
     store_[i][1] = out_[i][1];
@@ -1121,6 +1247,9 @@ void UvDataGridder::copyToStore()
 
 void UvDataGridder::copyFromStore()
 {
+  if(!store_)
+    ThrowError("Nothing has been stored -- use copyToStore() first");
+
   for(unsigned i=0; i < nOutZeroPad_; i++) {
     out_[i][0] = store_[i][0];
     out_[i][1] = store_[i][1];
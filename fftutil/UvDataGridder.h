@@ -14,6 +14,12 @@
  */
 #include "gcp/fftutil/Dft2d.h"
 
+#include "gcp/util/ThreadPool.h"
+#include "gcp/util/ThreadSynchronizer.h"
+
+#include <string>
+#include <vector>
+
 #define DO_INTERP 0
 
 namespace gcp {
@@ -40,6 +46,11 @@ namespace gcp {
       void operator+=(const UvDataGridder& gridder);
       void operator+=(UvDataGridder& gridder);
 
+      // Fused version of (*this) += (gridder * scale), in a single
+      // pass over the populated indices
+
+      void addScaled(UvDataGridder& gridder, double scale);
+
       void mergeData(UvDataGridder& gridder);
 
       virtual void operator*=(double mult);
@@ -67,6 +78,22 @@ namespace gcp {
       void accumulateSecondMoments(double u, double v, double re, double im, double wt);
       void accumulateSecondMomentsWithInterpolation(double u, double v, double re, double im, double wt);
 
+      // Batched versions of the interpolating accumulators, for n
+      // visibilities.  The result is the same as calling the
+      // single-visibility versions for each visibility in turn (to
+      // rounding).  If a thread pool is passed, visibilities are
+      // split between threads, each of which accumulates weighted
+      // sums into its own tiles of the uv grid, and the tiles are
+      // then merged into the grid in parallel
+
+      void accumulateFirstMomentsWithInterpolation(unsigned n, const double* u, const double* v, 
+						   const double* re, const double* im, const double* wt,
+						   ThreadPool* pool=0);
+
+      void accumulateSecondMomentsWithInterpolation(unsigned n, const double* u, const double* v, 
+						    const double* re, const double* im, const double* wt,
+						    ThreadPool* pool=0);
+
       // After visibilities have been added using addVis(), we will
       // have stored weighted first and second moments.  Call
       // calculateErrorInMean() to convert those moments into an error
@@ -74,6 +101,11 @@ namespace gcp {
 
       void calculateErrorInMean();
 
+      // Release any memory used only for moment accumulation
+
+      void releaseErrorInMean();
+      void releaseStore();
+
       std::vector<double> getPopulatedIndices();
 
       // Explicitly zero the data array
@@ -107,6 +139,86 @@ namespace gcp {
 
       void resize();
 
+      //------------------------------------------------------------
+      // Convolutional gridding
+      //------------------------------------------------------------
+
+      // One cell of the convolution footprint of a visibility
+
+      struct GridCell {
+	unsigned dftInd_;
+	double   wt_;
+	bool     conj_;
+      };
+
+      // Weighted sums accumulated by one thread for one tile (a
+      // contiguous range of gridTileSize_ dft indices) of the grid
+
+      struct GridTile {
+	std::vector<double>   reSum_;
+	std::vector<double>   imSum_;
+	std::vector<double>   wtSum_;
+	std::vector<double>   wt2Sum_;
+	std::vector<unsigned> nPt_;
+
+	GridTile(unsigned n) : reSum_(n, 0.0), imSum_(n, 0.0), wtSum_(n, 0.0), wt2Sum_(n, 0.0), nPt_(n, 0) {};
+      };
+
+      // The per-thread state for a batched accumulation
+
+      struct GridExecData {
+	UvDataGridder* gridder_;
+	bool first_;
+	unsigned iThread_;
+	unsigned nThread_;
+
+	// The visibilities to accumulate
+
+	unsigned iVisStart_;
+	unsigned iVisStop_;
+	const double* u_;
+	const double* v_;
+	const double* re_;
+	const double* im_;
+	const double* wt_;
+
+	// The tiles to merge
+
+	unsigned iTileStart_;
+	unsigned iTileStop_;
+
+	std::vector<GridTile*> tiles_;
+	double wtSumTotal_;
+
+	std::vector<GridExecData*>* allExecData_;
+	ThreadSynchronizer* synchronizer_;
+	std::string error_;
+
+	GridExecData() {
+	  wtSumTotal_ = 0.0;
+	};
+
+	~GridExecData() {
+	  for(unsigned i=0; i < tiles_.size(); i++)
+	    delete tiles_[i];
+	};
+      };
+
+      static const unsigned gridTileSize_ = 4096;
+
+      void getGridResolution(double& du, double& dv);
+      unsigned getGridCells(double u, double v, double du, double dv, GridCell* cells);
+
+      void accumulateMomentsWithInterpolation(bool first, unsigned n, const double* u, const double* v, 
+					      const double* re, const double* im, const double* wt,
+					      ThreadPool* pool);
+
+      void accumulateTiles(GridExecData* ged);
+      void mergeTiles(GridExecData* ged);
+
+      static EXECUTE_FN(execAccumulateTiles);
+      static EXECUTE_FN(execMergeTiles);
+
       bool estimateErrInMeanFromData_;
 
       // The number of points that enter into each point of the UV
@@ -131,13 +243,13 @@ namespace gcp {
 
       // The weighted mean of the complex visibilities
 
-      fftw_complex* mean_;
+      FftwComplex* mean_;
 
       // Overload this from the base class, for reasons explained
       // within the .cc file
 
-      void computeInverseTransform(fftw_plan* invPlan=0);
-      void computeInverseTransformNoRenorm(fftw_plan* invPlan=0);
+      void computeInverseTransform(FftwPlan* invPlan=0);
+      void computeInverseTransformNoRenorm(FftwPlan* invPlan=0);
 
       void copyFromStore();
       void copyToStore();
@@ -157,10 +269,24 @@ namespace gcp {
       std::vector<double>   populatedU_;
       std::vector<double>   populatedV_;
 
-      // The weighted error in the mean of the complex visibilities
+      // The weighted error in the mean of the real and imaginary
+      // visibilities, stored only for populated indices (i.e.,
+      // populatedReErr_[i] is the error at populatedIndices_[i])
+
+      std::vector<double>   populatedReErr_;
+      std::vector<double>   populatedImErr_;
+
+      // Full-grid accumulator for second moments.  This is only
+      // allocated while second moments are being accumulated, and is
+      // released once calculateErrorInMean() has stored the errors in
+      // sparse form
+
+      FftwComplex* errorInMean_;
+
+      // Storage for copyToStore()/copyFromStore(), allocated on first
+      // use
 
-      fftw_complex* errorInMean_;
-      fftw_complex* store_;
+      FftwComplex* store_;
 
       // True when errors have been calculated
 
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <fstream>
+#include <math.h>
+#include <signal.h>
+#include <sstream>
+
+#include "gcp/fftutil/RunManager.h"
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+#include "gcp/util/SignalTask.h"
+
+using namespace gcp::program;
+using namespace gcp::util;
+
+//------------------------------------------------------------
+// Everything else about the run (datasets, models, and which shard
+// of the datasets we own) comes from the coordinator
+//------------------------------------------------------------
+
+KeyTabEntry Program::keywords[] = {
+  { "port",           "5555",  "i", "Port on which to wait for a coordinator"},
+  {END_OF_KEYWORDS},
+};
+
+/**.......................................................................
+ * Print usage information about this program
+ */
+void Program::initializeUsage()
+{
+  std::ostringstream os;
+
+  FORMATCOLOR(os, std::endl << "This program is a likelihood worker for distributed CLIMAX runs.  Start one worker per host:port listed"
+	      << std::endl << "in the coordinator's 'workers' run-file keyword, as in "
+	      << std::endl << std::endl
+	      << "\t\t\tclimaxWorker port=5555" << std::endl
+	      << std::endl << "then run the coordinator as usual.  The worker loads its share of the datasets from the coordinator's run file"
+	      << std::endl << "(which must be readable at the same path), serves a single coordinator session, and exits." << std::endl, "green");
+
+  usage_ = os.str();
+};
+
+pthread_t mainId_;
+
+/**.......................................................................
+ * Signal handler for user interrupt
+ */
+static SIGNALTASK_HANDLER_FN(handler)
+{
+  pthread_cancel(mainId_);
+
+  COUTCOLOR(std::endl << "User interrupt received -- CLIMAX worker exiting", "red");
+
+  exit(1);
+}
+
+/**.......................................................................
+ * Main -- serve likelihood evaluations for a coordinator
+ */
+int Program::main()
+{
+  mainId_ = pthread_self();
+
+  SignalTask signalTask(true);
+  signalTask.sendInstallSignalMsg(SIGINT, handler);
+
+  try {
+
+    int port = Program::getIntegerParameter("port");
+
+    if(port <= 0 || port > 65535) {
+      COUT(usage_);
+      return 1;
+    }
+
+    RunManager rm;
+    rm.serveWorker((unsigned short)port);
+
+  } catch(Exception& err) {
+    COUT(err.what());
+    return 1;
+  }
+
+  return 0;
+}
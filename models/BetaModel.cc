@@ -94,3 +94,75 @@ double BetaModel::xrayImageEnvelope(double xRad, double yRad)
 
   return fastpow((1.0 + xRat*xRat + yRat*yRat), (1.0 - 6*beta)/2);
 }
+
+/**.......................................................................
+ * Return the radius beyond which the envelope falls below tol.  For
+ * typical values of beta this is larger than any image, in which case
+ * the caller just fills the whole image
+ */
+bool BetaModel::getSupportRadius(unsigned type, double tol, Angle& radius)
+{
+  double expon;
+
+  switch (type) {
+  case DataSetType::DATASET_RADIO:
+    expon = (1.0 - 3*beta_.value())/2;
+    break;
+  case DataSetType::DATASET_XRAY_IMAGE:
+    expon = (1.0 - 6*beta_.value())/2;
+    break;
+  default:
+    return false;
+    break;
+  }
+
+  if(!(expon < 0.0))
+    return false;
+
+  double ratio = axialRatio_.value() > 1.0 ? axialRatio_.value() : 1.0;
+  radius.setRadians(thetaCore_.radians() * ratio * sqrt(pow(tol, 1.0/expon) - 1.0));
+
+  return true;
+}
+
+/**.......................................................................
+ * Return the envelope for this model at a set of points
+ */
+void BetaModel::envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n)
+{
+  double expon;
+  bool useFastPow = useFastPow_;
+
+  switch (type) {
+  case DataSetType::DATASET_RADIO:
+    expon = (1.0 - 3*beta_.value())/2;
+    break;
+  case DataSetType::DATASET_XRAY_IMAGE:
+    expon = (1.0 - 6*beta_.value())/2;
+    useFastPow = true;
+    break;
+  default:
+    Generic2DAngularModel::envelopes(type, xRad, yRad, env, n);
+    return;
+    break;
+  }
+
+  double yThetaCoreRad = thetaCore_.radians();
+  double xThetaCoreRad = yThetaCoreRad * axialRatio_.value();
+
+  double xRat, yRat;
+
+  if(useFastPow) {
+    for(unsigned i=0; i < n; i++) {
+      xRat   = xRad[i]/xThetaCoreRad;
+      yRat   = yRad[i]/yThetaCoreRad;
+      env[i] = fastpow((1.0 + xRat*xRat + yRat*yRat), expon);
+    }
+  } else {
+    for(unsigned i=0; i < n; i++) {
+      xRat   = xRad[i]/xThetaCoreRad;
+      yRat   = yRad[i]/yThetaCoreRad;
+      env[i] = pow((1.0 + xRat*xRat + yRat*yRat), expon);
+    }
+  }
+}
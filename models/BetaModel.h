@@ -34,6 +34,8 @@ namespace gcp {
 
       double radioEnvelope(double xRad, double yRad);
       double xrayImageEnvelope(double xRad, double yRad);
+      void envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n);
+      bool getSupportRadius(unsigned type, double tol, gcp::util::Angle& radius);
       void checkSetup();
 
     private:
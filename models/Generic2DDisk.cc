@@ -32,3 +32,24 @@ double Generic2DDisk::envelope(unsigned type, double xRad, double yRad)
 
   return r2 <= rad2 ? 1.0 : 0.0;
 }
+
+/**.......................................................................
+ * Evaluate the dimensionless shape of this profile at a set of points
+ */
+void Generic2DDisk::envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n)
+{
+  double rad2 = radius_.radians();
+  rad2 *= rad2;
+
+  for(unsigned i=0; i < n; i++)
+    env[i] = (xRad[i]*xRad[i] + yRad[i]*yRad[i]) <= rad2 ? 1.0 : 0.0;
+}
+
+/**.......................................................................
+ * The disk is zero outside its radius
+ */
+bool Generic2DDisk::getSupportRadius(unsigned type, double tol, Angle& radius)
+{
+  radius = radius_;
+  return true;
+}
@@ -36,6 +36,9 @@ namespace gcp {
       virtual ~Generic2DDisk();
 
       double envelope(unsigned type, double xRad, double yRad);
+      void envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n);
+
+      bool getSupportRadius(unsigned type, double tol, gcp::util::Angle& radius);
 
       gcp::util::Angle radius_;
 
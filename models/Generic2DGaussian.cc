@@ -91,6 +91,44 @@ double Generic2DGaussian::envelope(void* evalData, unsigned type, double xRad, d
   return exp(-stack->arg_);
 }
 
+/**.......................................................................
+ * Evaluate the dimensionless shape of this profile at a set of points
+ */
+void Generic2DGaussian::envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n)
+{
+  double majSigRad = majSigma_.radians();
+  double minSigRad = majSigRad * axialRatio_.val_;
+
+  double majSig2 = majSigRad * majSigRad;
+  double minSig2 = minSigRad * minSigRad;
+
+  for(unsigned i=0; i < n; i++)
+    env[i] = exp(-0.5 * ((xRad[i] * xRad[i])/majSig2 + (yRad[i] * yRad[i])/minSig2));
+}
+
+void Generic2DGaussian::envelopes(void* evalData, unsigned type, const double* xRad, const double* yRad, double* env, unsigned n)
+{
+  Generic2DGaussianEvalData* stack = (Generic2DGaussianEvalData*)evalData;
+
+  double majSig2 = stack->majSigRad_ * stack->majSigRad_;
+  double minSig2 = stack->minSigRad_ * stack->minSigRad_;
+
+  for(unsigned i=0; i < n; i++)
+    env[i] = exp(-0.5 * ((xRad[i] * xRad[i])/majSig2 + (yRad[i] * yRad[i])/minSig2));
+}
+
+/**.......................................................................
+ * Return the radius beyond which the envelope falls below tol.  Since
+ * the minor axis can be specified larger than the major, take the
+ * larger of the two
+ */
+bool Generic2DGaussian::getSupportRadius(unsigned type, double tol, Angle& radius)
+{
+  double ratio = axialRatio_.val_ > 1.0 ? axialRatio_.val_ : 1.0;
+  radius.setRadians(majSigma_.radians() * ratio * sqrt(2 * log(1.0/tol)));
+  return true;
+}
+
 void* Generic2DGaussian::allocateEvalData()
 {
   return new Generic2DGaussianEvalData();
@@ -53,10 +53,14 @@ namespace gcp {
       void setFwhm(gcp::util::Angle fwhm);
 
       double envelope(unsigned type, double xRad, double yRad);
+      void envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n);
+
+      bool getSupportRadius(unsigned type, double tol, gcp::util::Angle& radius);
 
       // For multi-threaded execution
 
       double envelope(void* evalData, unsigned type, double xRad, double yRad);
+      void envelopes(void* evalData, unsigned type, const double* xRad, const double* yRad, double* env, unsigned n);
       void*  allocateEvalData();
       void   initializeEvalData(void* evalData);
       
@@ -210,8 +210,43 @@ void GenericRadiallySymmetric3DModel::setGslLimit(size_t limit)
  */
 void GenericRadiallySymmetric3DModel::initializeGslMembers()
 {
-  gslWork_ = 0;
-  gslWork_ = gsl_integration_workspace_alloc(gslLimit_);
+  work_ = 0;
+  work_ = new IntegrationWorkspace(this, gslLimit_);
+
+  gsl_set_error_handler(&intErrHandler);
+}
+
+/**.......................................................................
+ * Destructor.
+ */
+GenericRadiallySymmetric3DModel::~GenericRadiallySymmetric3DModel() 
+{
+  if(work_) {
+    delete work_;
+    work_ = 0;
+  }
+
+  for(unsigned iThread=0; iThread < tabulationData_.size(); iThread++) {
+    delete tabulationData_[iThread];
+  }
+
+  tabulationData_.resize(0);
+}
+
+/**.......................................................................
+ * Constructor for the per-thread integration workspace
+ */
+GenericRadiallySymmetric3DModel::IntegrationWorkspace::
+IntegrationWorkspace(GenericRadiallySymmetric3DModel* model, size_t limit)
+{
+  model_    = model;
+  gslLimit_ = limit;
+  params_   = 0;
+  type_     = DataSetType::DATASET_UNKNOWN;
+  xSky_     = 0.0;
+
+  gslWork_  = 0;
+  gslWork_  = gsl_integration_workspace_alloc(gslLimit_);
 
   if(!gslWork_) {
     ThrowError("Unable to allocate GSL workspace");
@@ -222,14 +257,12 @@ void GenericRadiallySymmetric3DModel::initializeGslMembers()
 
   gslVolumeIntegralFn_.function = &GenericRadiallySymmetric3DModel::evaluateVolumeIntegralKernel;
   gslVolumeIntegralFn_.params   = (void*)this;
-
-  gsl_set_error_handler(&intErrHandler);
 }
 
 /**.......................................................................
- * Destructor.
+ * Destructor for the per-thread integration workspace
  */
-GenericRadiallySymmetric3DModel::~GenericRadiallySymmetric3DModel() 
+GenericRadiallySymmetric3DModel::IntegrationWorkspace::~IntegrationWorkspace()
 {
   if(gslWork_) {
     gsl_integration_workspace_free(gslWork_);
@@ -237,6 +270,26 @@ GenericRadiallySymmetric3DModel::~GenericRadiallySymmetric3DModel()
   }
 }
 
+/**.......................................................................
+ * Overload base-class setThreadPool method to allocate per-thread
+ * resources needed to tabulate integrals of the radial model in
+ * parallel
+ */
+void GenericRadiallySymmetric3DModel::setThreadPool(ThreadPool* pool)
+{
+  Generic2DAngularModel::setThreadPool(pool);
+
+  for(unsigned iThread=0; iThread < tabulationData_.size(); iThread++)
+    delete tabulationData_[iThread];
+
+  tabulationData_.resize(0);
+
+  if(pool) {
+    for(unsigned iThread=0; iThread < pool->nThread(); iThread++)
+      tabulationData_.push_back(new TabulationData(this, gslLimit_));
+  }
+}
+
 /**.......................................................................
  * Single-parameter radial model to evaluate.
  */
@@ -301,38 +354,45 @@ double GenericRadiallySymmetric3DModel::radialModel(unsigned type, double x, voi
  */
 double GenericRadiallySymmetric3DModel::evaluateLineIntegralKernel(double xl, void* params)
 {
-  GenericRadiallySymmetric3DModel* model = (GenericRadiallySymmetric3DModel*)params;
+  IntegrationWorkspace* work = (IntegrationWorkspace*)params;
 
   //------------------------------------------------------------
   // Convert from line-of-sight xl to 3D x
   //------------------------------------------------------------
 
-  double x = sqrt(xl*xl + model->xSky_ * model->xSky_);
+  double x = sqrt(xl*xl + work->xSky_ * work->xSky_);
 
   //------------------------------------------------------------
   // And evaluate the radial model at this x
   //------------------------------------------------------------
 
-  return model->radialModel(model->currentIntegrationType_, x, model->params_);
+  return work->model_->radialModel(work->type_, x, work->params_);
 }
 
 double GenericRadiallySymmetric3DModel::evaluateLineIntegralKernel2(double x, void* params)
 {
-  GenericRadiallySymmetric3DModel* model = (GenericRadiallySymmetric3DModel*)params;
+  IntegrationWorkspace* work = (IntegrationWorkspace*)params;
 
   //------------------------------------------------------------
   // Convert from line-of-sight xl to 3D x
   //------------------------------------------------------------
 
-  double denom = sqrt(x * x - model->xSky_ * model->xSky_);
+  double denom = sqrt(x * x - work->xSky_ * work->xSky_);
 
   //------------------------------------------------------------
   // And evaluate the radial model at this x
   //------------------------------------------------------------
 
-  //  COUT("Evaluating kernel at x = " << x << " xSky_ = " << model->xSky_);
+  return work->model_->radialModel(work->type_, x, work->params_) * x / denom;
+}
 
-  return model->radialModel(model->currentIntegrationType_, x, model->params_) * x / denom;
+/**.......................................................................
+ * Evaluate the line integral of the 3D radial model at the specified
+ * angular radius (xSky), using the calling thread's workspace
+ */
+double GenericRadiallySymmetric3DModel::lineIntegral(unsigned type, double xSky, void* params)
+{
+  return lineIntegral(work_, type, xSky, params);
 }
 
 /**.......................................................................
@@ -340,13 +400,13 @@ double GenericRadiallySymmetric3DModel::evaluateLineIntegralKernel2(double x, vo
  * angular radius (xSky).  Integral is evaluated from -infinity to
  * +infinity using GSL adaptive integration.
  */
-double GenericRadiallySymmetric3DModel::lineIntegral(unsigned type, double xSky, void* params)
+double GenericRadiallySymmetric3DModel::lineIntegral(IntegrationWorkspace* work, unsigned type, double xSky, void* params)
 {
   double result, abserr;
 
-  params_ = params;
-  xSky_   = xSky;
-  currentIntegrationType_ = type;
+  work->params_ = params;
+  work->xSky_   = xSky;
+  work->type_   = type;
 
   //------------------------------------------------------------
   // Just integrate the model from -infty to +infty: i.e., we assume
@@ -354,7 +414,7 @@ double GenericRadiallySymmetric3DModel::lineIntegral(unsigned type, double xSky,
   // we integrate from 0 to +infty, and double the result
   //------------------------------------------------------------
 
-  gsl_integration_qagiu(&gslLineIntegralFn_, xSky_, 0, 1e-7, gslLimit_, gslWork_, &result, &abserr);
+  gsl_integration_qagiu(&work->gslLineIntegralFn_, work->xSky_, 0, 1e-7, work->gslLimit_, work->gslWork_, &result, &abserr);
 
   return 2*result;
 }
@@ -370,13 +430,22 @@ double GenericRadiallySymmetric3DModel::lineIntegral(unsigned type, double xSky,
  */
 double GenericRadiallySymmetric3DModel::evaluateVolumeIntegralKernel(double x, void* params)
 {
-  GenericRadiallySymmetric3DModel* model = (GenericRadiallySymmetric3DModel*)params;
+  IntegrationWorkspace* work = (IntegrationWorkspace*)params;
 
   //------------------------------------------------------------
   // And evaluate the radial model at this x
   //------------------------------------------------------------
 
-  return 4 * M_PI * model->radialModel(model->currentIntegrationType_, x, model->params_) * x * x;
+  return 4 * M_PI * work->model_->radialModel(work->type_, x, work->params_) * x * x;
+}
+
+/**.......................................................................
+ * Evaluate the volume integral of the 3D radial model at the
+ * specified angular radius, using the calling thread's workspace
+ */
+double GenericRadiallySymmetric3DModel::volumeIntegral(unsigned type, double xSky, void* params)
+{
+  return volumeIntegral(work_, type, xSky, params);
 }
 
 /**.......................................................................
@@ -384,18 +453,18 @@ double GenericRadiallySymmetric3DModel::evaluateVolumeIntegralKernel(double x, v
  * specified angular radius.  Integral is evaluated from 0 to xSky
  * using GSL adaptive integration.
  */
-double GenericRadiallySymmetric3DModel::volumeIntegral(unsigned type, double xSky, void* params)
+double GenericRadiallySymmetric3DModel::volumeIntegral(IntegrationWorkspace* work, unsigned type, double xSky, void* params)
 {
   double result, abserr;
 
-  params_ = params;
-  currentIntegrationType_ = type;
+  work->params_ = params;
+  work->type_   = type;
 
   //------------------------------------------------------------
   // Just integrate the model from 0 to xSky = theta/theta_c
   //------------------------------------------------------------
 
-  gsl_integration_qag(&gslVolumeIntegralFn_, 1e-9, xSky, 0, 1e-7, gslLimit_, 6, gslWork_, &result, &abserr);
+  gsl_integration_qag(&work->gslVolumeIntegralFn_, 1e-9, xSky, 0, 1e-7, work->gslLimit_, 6, work->gslWork_, &result, &abserr);
 
   return result;
 }
@@ -471,6 +540,49 @@ double GenericRadiallySymmetric3DModel::genericEnvelope(double xRad, double yRad
   return interpolateLineIntegral(DataSetType::DATASET_GENERIC, xSky);
 }
 
+/**.......................................................................
+ * Return the value of the envelope at a set of angular points on the
+ * sky.  This is equivalent to calling the single-point envelope for
+ * each point, but looks up the interpolation table once per call
+ */
+void GenericRadiallySymmetric3DModel::envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n)
+{
+  switch (type) {
+  case DataSetType::DATASET_RADIO:
+  case DataSetType::DATASET_XRAY_IMAGE:
+  case DataSetType::DATASET_GENERIC:
+    break;
+  default:
+    Generic2DAngularModel::envelopes(type, xRad, yRad, env, n);
+    return;
+    break;
+  }
+
+  const double* vals = &interpolatedLineIntegral_[type][0];
+  double thetaCoreRad = thetaCore_.radians();
+  double delta        = deltaInterp_;
+  unsigned iMax       = nInterp_ - 2;
+
+  for(unsigned i=0; i < n; i++) {
+
+    double xSky = sqrt(xRad[i] * xRad[i] + yRad[i] * yRad[i]) / thetaCoreRad;
+
+    //------------------------------------------------------------
+    // Center the three-point stencil on the nearest node, protecting
+    // against values off the ends of our array, exactly as
+    // interpolateLineIntegral() does
+    //------------------------------------------------------------
+
+    unsigned iNear = (unsigned)(xSky / delta);
+    iNear = iNear < 1 ? 1 : (iNear > iMax ? iMax : iNear);
+
+    env[i] = QuadraticInterpolator::directEval((iNear-1) * delta, vals[iNear-1],
+					       (iNear)   * delta, vals[iNear],
+					       (iNear+1) * delta, vals[iNear+1],
+					       xSky);
+  }
+}
+
 /**.......................................................................
  * Overload the base-class method to set a flag whenever a new sample
  * has just been generated.
@@ -481,6 +593,15 @@ void GenericRadiallySymmetric3DModel::sample()
 
   for(std::map<unsigned, bool>::iterator iter=newSample_.begin(); iter != newSample_.end(); iter++)
     iter->second = true;
+
+  //------------------------------------------------------------
+  // Tables that are recomputed for each sample are no longer valid
+  //------------------------------------------------------------
+
+  for(std::map<unsigned, bool>::iterator iter=tabulationIsCurrent_.begin(); iter != tabulationIsCurrent_.end(); iter++) {
+    if(needsRecomputing_[iter->first])
+      iter->second = false;
+  }
 }
 
 /**.......................................................................
@@ -726,154 +847,240 @@ calculateInterpolationValuesForAllScaleRadii(unsigned type, Image& image)
 void GenericRadiallySymmetric3DModel::
 calculateInterpolationValues(unsigned type)
 {
+  //------------------------------------------------------------
+  // If another type with an identical kernel has already been
+  // tabulated on this grid, just use its values
+  //------------------------------------------------------------
+
+  if(copyInterpolationValuesFromCoincidentType(type))
+    return;
+
   if(nInterp_ != interpolatedLineIntegral_[type].size()) {
     interpolatedLineIntegral_[type].resize(nInterp_);
     arealIntegral_[type].resize(nInterp_);
   }
   
-  double x;
+  lineIntegralNormalization_[type].val_ = lineIntegral(type, xLim_);
+
+  tabulateIntegrals(type, true, false);
+  calculateArealIntegral(type);
+
+  registerTabulation(type);
+}
+
+/**.......................................................................
+ * Use the current nInterp_ and deltaInterp_ to compute interpolation
+ * values for the passed type
+ */
+void GenericRadiallySymmetric3DModel::
+calculateAllInterpolationValues(unsigned type)
+{
+  if(nInterp_ != interpolatedLineIntegral_[type].size()) {
+    interpolatedLineIntegral_[type].resize(nInterp_);
+    arealIntegral_[type].resize(nInterp_);
+  }
 
+  if(nInterp_ != volumeIntegral_[type].size()) {
+    volumeIntegral_[type].resize(nInterp_);
+  }
+  
   lineIntegralNormalization_[type].val_ = lineIntegral(type, xLim_);
 
-  //  COUT("nInterp_ = " << nInterp_ << " deltaInterp_ = " << deltaInterp_ << " norm = " << lineIntegralNormalization_[type].val_ << " AV = " << lineIntegral(type, 0.03));
+  tabulateIntegrals(type, true, true);
+  calculateArealIntegral(type);
 
-  for(unsigned i=0; i < nInterp_; i++) {
-    x = i * deltaInterp_;
+  registerTabulation(type);
+}
 
-    //------------------------------------------------------------
-    // Get the line integral at the specified point
-    //------------------------------------------------------------
+/**.......................................................................
+ * Use the current nInterp_ and deltaInterp_ to compute interpolation
+ * values for the passed type
+ */
+void GenericRadiallySymmetric3DModel::
+calculateVolumeInterpolationValues(unsigned type)
+{
+  if(nInterp_ != volumeIntegral_[type].size()) {
+    volumeIntegral_[type].resize(nInterp_);
+  }
 
-    if(x <= xLim_) {
-      interpolatedLineIntegral_[type][i] = 1.0;
-    } else {
-      interpolatedLineIntegral_[type][i] = lineIntegral(type, x) / lineIntegralNormalization_[type].val_;
-    }
+  tabulateIntegrals(type, false, true);
+}
+
+/**.......................................................................
+ * Tabulate the line and/or volume integrals of the radial model on
+ * the current (nInterp_, deltaInterp_) grid.  If we have a thread
+ * pool, and the radial model can be evaluated concurrently, the grid
+ * is split into contiguous segments, one per thread, each of which is
+ * integrated using that thread's own GSL workspace.
+ */
+void GenericRadiallySymmetric3DModel::tabulateIntegrals(unsigned type, bool line, bool volume)
+{
+  std::vector<double>* lineVals   = line   ? &interpolatedLineIntegral_[type] : 0;
+  std::vector<double>* volumeVals = volume ? &volumeIntegral_[type]           : 0;
+  double norm = lineIntegralNormalization_[type].val_;
+
+  unsigned nThreadTotal = tabulationData_.size();
+
+  //------------------------------------------------------------
+  // If no thread pool exists, just tabulate in this thread
+  //------------------------------------------------------------
+
+  if(!pool_ || nThreadTotal == 0 || !radialModelIsThreadSafe()) {
+
+    TabulationData td(this, 0);
+    td.type_       = type;
+    td.lineVals_   = lineVals;
+    td.volumeVals_ = volumeVals;
+    td.norm_       = norm;
+    td.iStart_     = 0;
+    td.iStop_      = nInterp_;
+
+    tabulateIntegrals(&td);
 
     //------------------------------------------------------------
-    // Since the profiles for this class by definition don't depend on
-    // angle (but only radius), we can calculate the areal integration
-    // of this function at the same time by performing a simple line
-    // integral of the function we've just evaluated.
-    //
-    // Given f(r), we want the integral:
-    //
-    //                / x
-    //          1     |
-    // F(x) = ------  |  f(r) 2pi*r dr
-    //        pi*x^2  |
-    //                / 0
-    //
+    // Else split the grid into segments
     //------------------------------------------------------------
 
-    if(i == 0) {
+  } else {
 
-      //------------------------------------------------------------
-      //  Integral at zero radius is zero
-      //------------------------------------------------------------
+    unsigned nThreadExec   = nThreadTotal > nInterp_ ? nInterp_ : nThreadTotal;
+    unsigned nPerThread    = nInterp_ / nThreadExec;
+    unsigned iStart, iStop;
 
-      arealIntegral_[type][i] = 0.0;
+    synchronizer_.reset(nThreadExec);
 
-    } else {
+    for(unsigned iThread=0; iThread < nThreadExec; iThread++) {
 
-      //------------------------------------------------------------
-      // Take the value of the function at the midpoint
-      //------------------------------------------------------------
+      iStart = iThread * nPerThread;
+      iStop  = iStart + nPerThread;
 
-      unsigned i2 = i;
-      unsigned i1 = i-1;
-      x -= deltaInterp_/2;
-      
-      //------------------------------------------------------------
-      // For the current value of i, we take f(r) * 2*pi*r * dr, with r a
-      // the midpoint of the last two samples
-      //------------------------------------------------------------
+      TabulationData* td = tabulationData_[iThread];
+
+      td->type_       = type;
+      td->lineVals_   = lineVals;
+      td->volumeVals_ = volumeVals;
+      td->norm_       = norm;
+      td->iStart_     = iStart;
+      td->iStop_      = (iThread == nThreadExec-1) ? nInterp_ : iStop; // Last thread needs to finish
+      td->iSegment_   = iThread;
+      td->nSegment_   = nThreadExec;
+      td->error_      = "";
 
-      double val = (interpolatedLineIntegral_[type][i2] + interpolatedLineIntegral_[type][i1])/2 * 2 * M_PI * x * deltaInterp_;
-      arealIntegral_[type][i] = val + arealIntegral_[type][i-1];
+      synchronizer_.registerPending(iThread);
+      pool_->execute(&execTabulateIntegrals, td);
     }
-  }
 
-  //------------------------------------------------------------
-  // Now we normalize the integral by the area at each radius
-  //------------------------------------------------------------
+    synchronizer_.wait();
 
-  for(unsigned i=0; i < nInterp_; i++) {
-    x = i * deltaInterp_;
-    arealIntegral_[type][i] = arealIntegral_[type][i]/(M_PI*x*x);
+    //------------------------------------------------------------
+    // Rethrow any errors encountered in the worker threads
+    //------------------------------------------------------------
+
+    for(unsigned iThread=0; iThread < nThreadExec; iThread++) {
+      if(!tabulationData_[iThread]->error_.empty()) {
+	ThrowError(tabulationData_[iThread]->error_);
+      }
+    }
   }
 }
 
 /**.......................................................................
- * Use the current nInterp_ and deltaInterp_ to compute interpolation
- * values for the passed type
+ * Tabulate integrals for the segment of the grid described by the
+ * passed TabulationData.  If td has no workspace of its own (the
+ * single-threaded case), the calling thread's workspace is used.
  */
-void GenericRadiallySymmetric3DModel::
-calculateAllInterpolationValues(unsigned type)
+void GenericRadiallySymmetric3DModel::tabulateIntegrals(TabulationData* td)
 {
-  if(nInterp_ != interpolatedLineIntegral_[type].size()) {
-    interpolatedLineIntegral_[type].resize(nInterp_);
-    arealIntegral_[type].resize(nInterp_);
-    volumeIntegral_[type].resize(nInterp_);
-  }
-  
+  IntegrationWorkspace* work = td->work_ ? td->work_ : work_;
   double x;
-  lineIntegralNormalization_[type].val_ = lineIntegral(type, xLim_);
 
-  for(unsigned i=0; i < nInterp_; i++) {
+  for(unsigned i=td->iStart_; i < td->iStop_; i++) {
     x = i * deltaInterp_;
 
     //------------------------------------------------------------
-    // Get the line and volume integrals at the specified point
+    // Get the line integral at the specified point
     //------------------------------------------------------------
 
-    if(x <= xLim_) {
-      interpolatedLineIntegral_[type][i] = 1.0;
-    } else {
-      interpolatedLineIntegral_[type][i] = lineIntegral(type, x) / lineIntegralNormalization_[type].val_;
+    if(td->lineVals_) {
+      if(x <= xLim_) {
+	(*td->lineVals_)[i] = 1.0;
+      } else {
+	(*td->lineVals_)[i] = lineIntegral(work, td->type_, x) / td->norm_;
+      }
     }
 
-    volumeIntegral_[type][i]           = volumeIntegral(type, x);
-
     //------------------------------------------------------------
-    // Since the profiles for this class by definition don't depend on
-    // angle (but only radius), we can calculate the areal integration
-    // of this function at the same time by performing a simple line
-    // integral of the function we've just evaluated.  
-    //
-    // Given f(r), we want the integral:
-    //
-    //          1     /x
-    // F(x) = ------  |  f(r) 2pi*r dr
-    //        pi*x^2  /0
-    //
+    // Get the volume integral at the specified point
     //------------------------------------------------------------
 
+    if(td->volumeVals_) {
+      (*td->volumeVals_)[i] = volumeIntegral(work, td->type_, x);
+    }
+  }
+}
+
+/**.......................................................................
+ * Method called by worker threads to execute their portion of the
+ * tabulation
+ */
+EXECUTE_FN(GenericRadiallySymmetric3DModel::execTabulateIntegrals)
+{
+  TabulationData* td = (TabulationData*) args;
+  GenericRadiallySymmetric3DModel* model = td->model_;
+
+  try {
+    model->tabulateIntegrals(td);
+  } catch(Exception& err) {
+    td->error_ = err.what();
+  } catch(...) {
+    td->error_ = "Unknown error while tabulating integrals";
+  }
+
+  model->synchronizer_.registerDone(td->iSegment_, td->nSegment_);
+}
+
+/**.......................................................................
+ * Since the profiles for this class by definition don't depend on
+ * angle (but only radius), we can calculate the areal integration of
+ * the line integral by performing a simple integral of the values
+ * we've just tabulated.
+ *
+ * Given f(r), we want the integral:
+ *
+ *                / x
+ *          1     |
+ * F(x) = ------  |  f(r) 2pi*r dr
+ *        pi*x^2  |
+ *                / 0
+ *
+ */
+void GenericRadiallySymmetric3DModel::calculateArealIntegral(unsigned type)
+{
+  std::vector<double>& lineVals   = interpolatedLineIntegral_[type];
+  std::vector<double>& arealVals  = arealIntegral_[type];
+  double x;
+
+  for(unsigned i=0; i < nInterp_; i++) {
+
     if(i == 0) {
 
       //------------------------------------------------------------
       //  Integral at zero radius is zero
       //------------------------------------------------------------
 
-      arealIntegral_[type][i] = 0.0;
+      arealVals[i] = 0.0;
 
     } else {
 
-      //------------------------------------------------------------
-      // Take the value of the function at the midpoint
-      //------------------------------------------------------------
-
-      unsigned i2 = i;
-      unsigned i1 = i-1;
-      x -= deltaInterp_/2;
-      
       //------------------------------------------------------------
       // For the current value of i, we take f(r) * 2*pi*r * dr, with r a
       // the midpoint of the last two samples
       //------------------------------------------------------------
 
-      double val = (interpolatedLineIntegral_[type][i2] + interpolatedLineIntegral_[type][i1])/2 * 2 * M_PI * x * deltaInterp_;
-      arealIntegral_[type][i] = val + arealIntegral_[type][i-1];
+      x = i * deltaInterp_ - deltaInterp_/2;
+
+      double val = (lineVals[i] + lineVals[i-1])/2 * 2 * M_PI * x * deltaInterp_;
+      arealVals[i] = val + arealVals[i-1];
     }
   }
 
@@ -883,32 +1090,51 @@ calculateAllInterpolationValues(unsigned type)
 
   for(unsigned i=0; i < nInterp_; i++) {
     x = i * deltaInterp_;
-    arealIntegral_[type][i] = arealIntegral_[type][i]/(M_PI*x*x);
+    arealVals[i] = arealVals[i]/(M_PI*x*x);
   }
 }
 
 /**.......................................................................
- * Use the current nInterp_ and deltaInterp_ to compute interpolation
- * values for the passed type
+ * If another type whose kernel coincides with this one has already
+ * been tabulated for the current sample, on the current grid, copy
+ * its values instead of recomputing them.  Returns true if values
+ * were copied.
  */
-void GenericRadiallySymmetric3DModel::
-calculateVolumeInterpolationValues(unsigned type)
+bool GenericRadiallySymmetric3DModel::copyInterpolationValuesFromCoincidentType(unsigned type)
 {
-  if(nInterp_ != volumeIntegral_[type].size()) {
-    volumeIntegral_[type].resize(nInterp_);
-  }
-  
-  double x;
+  for(std::map<unsigned, bool>::iterator iter=tabulationIsCurrent_.begin(); iter != tabulationIsCurrent_.end(); iter++) {
 
-  for(unsigned i=0; i < nInterp_; i++) {
-    x = i * deltaInterp_;
+    unsigned srcType = iter->first;
 
-    //------------------------------------------------------------
-    // Get the line and volume integrals at the specified point
-    //------------------------------------------------------------
+    if(srcType == type || !iter->second)
+      continue;
+
+    if(tabulatedNInterp_[srcType] != nInterp_ || tabulatedDeltaInterp_[srcType] != deltaInterp_)
+      continue;
 
-    volumeIntegral_[type][i]           = volumeIntegral(type, x);
+    if(!kernelsCoincide(type, srcType))
+      continue;
+
+    interpolatedLineIntegral_[type] = interpolatedLineIntegral_[srcType];
+    arealIntegral_[type]            = arealIntegral_[srcType];
+    lineIntegralNormalization_[type].val_ = lineIntegralNormalization_[srcType].val_;
+
+    registerTabulation(type);
+
+    return true;
   }
+
+  return false;
+}
+
+/**.......................................................................
+ * Record the grid on which the passed type was just tabulated
+ */
+void GenericRadiallySymmetric3DModel::registerTabulation(unsigned type)
+{
+  tabulatedNInterp_[type]     = nInterp_;
+  tabulatedDeltaInterp_[type] = deltaInterp_;
+  tabulationIsCurrent_[type]  = true;
 }
 
 /**.......................................................................
@@ -1044,6 +1270,26 @@ double GenericRadiallySymmetric3DModel::interpolateVolumeIntegral(unsigned type,
   return ret;
 }
 
+/**.......................................................................
+ * Return true if radialModel() can be safely evaluated from multiple
+ * threads.  Inheritors whose radialModel() modifies members should
+ * override this to return false.
+ */
+bool GenericRadiallySymmetric3DModel::radialModelIsThreadSafe()
+{
+  return true;
+}
+
+/**.......................................................................
+ * Return true if radialModel() evaluates the same kernel for both
+ * types.  By default, we assume kernels only coincide for identical
+ * types.
+ */
+bool GenericRadiallySymmetric3DModel::kernelsCoincide(unsigned type1, unsigned type2)
+{
+  return type1 == type2;
+}
+
 /**.......................................................................
  * Return true if the shape parameters of the radial model are constant
  */
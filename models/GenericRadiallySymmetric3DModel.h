@@ -27,6 +27,82 @@ namespace gcp {
     class GenericRadiallySymmetric3DModel : public ClusterModel {
     public:
 
+      //------------------------------------------------------------
+      // Per-thread state needed to evaluate the line and volume
+      // integrals.  Each thread that integrates the radial model owns
+      // one of these, so that integrations can proceed concurrently
+      //------------------------------------------------------------
+
+      class IntegrationWorkspace {
+      public:
+
+	IntegrationWorkspace(GenericRadiallySymmetric3DModel* model, size_t limit);
+	~IntegrationWorkspace();
+
+	GenericRadiallySymmetric3DModel* model_;
+
+	gsl_integration_workspace* gslWork_;
+	size_t gslLimit_;
+
+	gsl_function gslLineIntegralFn_;
+	gsl_function gslVolumeIntegralFn_;
+
+	void* params_;
+	unsigned type_;
+
+	// The (dimensionless) cylindrical radius at which to evaluate
+	// the line integral, ie., xSky_ = theta_sky / theta_c
+
+	double xSky_;
+      };
+
+      //------------------------------------------------------------
+      // Per-thread data used when tabulating integrals of the radial
+      // model in a thread pool
+      //------------------------------------------------------------
+
+      class TabulationData {
+      public:
+
+	// If limit is zero, no workspace is allocated, and the
+	// model's own workspace will be used for integration
+
+	TabulationData(GenericRadiallySymmetric3DModel* model, size_t limit) {
+	  model_      = model;
+	  work_       = limit > 0 ? new IntegrationWorkspace(model, limit) : 0;
+	  type_       = gcp::util::DataSetType::DATASET_UNKNOWN;
+	  lineVals_   = 0;
+	  volumeVals_ = 0;
+	  norm_       = 1.0;
+	  iStart_     = 0;
+	  iStop_      = 0;
+	  iSegment_   = 0;
+	  nSegment_   = 0;
+	};
+
+	~TabulationData() {
+	  if(work_) {
+	    delete work_;
+	    work_ = 0;
+	  }
+	};
+
+	GenericRadiallySymmetric3DModel* model_;
+	IntegrationWorkspace* work_;
+
+	unsigned type_;
+	std::vector<double>* lineVals_;
+	std::vector<double>* volumeVals_;
+	double norm_;
+
+	unsigned iStart_;
+	unsigned iStop_;
+	unsigned iSegment_;
+	unsigned nSegment_;
+
+	std::string error_;
+      };
+
       /**
        * Constructor.
        */
@@ -53,6 +129,17 @@ namespace gcp {
 
       virtual bool shapeParametersAreFixed();
 
+      // True if radialModel() can be called concurrently from
+      // multiple threads (ie, it doesn't modify any members)
+
+      virtual bool radialModelIsThreadSafe();
+
+      // True if radialModel() evaluates the same kernel for both
+      // types, in which case tabulated line integrals can be shared
+      // between them
+
+      virtual bool kernelsCoincide(unsigned type1, unsigned type2);
+
       //------------------------------------------------------------
       // End virtual interface
       //------------------------------------------------------------
@@ -63,17 +150,30 @@ namespace gcp {
       double lineIntegral(unsigned type, double xSky, void* params=0);
       double volumeIntegral(unsigned type, double xSky, void* params=0);
 
+      double lineIntegral(IntegrationWorkspace* work, unsigned type, double xSky, void* params=0);
+      double volumeIntegral(IntegrationWorkspace* work, unsigned type, double xSky, void* params=0);
+
       // Overloaded envelope functions from the Generic2DAngularModel base-class
 
       double genericEnvelope(double xRad, double yRad);
       double radioEnvelope(double xRad, double yRad);
       double xrayImageEnvelope(double xRad, double yRad);
 
+      // Batched envelope, evaluating a row of pixels with a single
+      // lookup of the interpolation table
+
+      void envelopes(unsigned type, const double* xRad, const double* yRad, double* env, unsigned n);
+
       // Overloaded sample() function from the base-class.  Sets a
       // flag whenever a new sample is generated
 
       void sample();
 
+      // Overloaded setThreadPool() function from the base-class.
+      // Allocates per-thread integration resources
+
+      void setThreadPool(gcp::util::ThreadPool* pool);
+
       // Overloaded fillImage() function from the base-class.
       // Interpolates the line integral the first time it's called after a new
       // sample is generated.
@@ -209,6 +309,28 @@ namespace gcp {
       virtual void calculateAllInterpolationValues(unsigned type);
       virtual void calculateVolumeInterpolationValues(unsigned type);
 
+      //------------------------------------------------------------
+      // Tabulate the line and/or volume integrals on the current
+      // grid, splitting the grid across the thread pool if we have
+      // one
+      //------------------------------------------------------------
+
+      void tabulateIntegrals(unsigned type, bool line, bool volume);
+      void tabulateIntegrals(TabulationData* td);
+      static EXECUTE_FN(execTabulateIntegrals);
+
+      // Compute the areal integral from the tabulated line integral
+
+      void calculateArealIntegral(unsigned type);
+
+      //------------------------------------------------------------
+      // Methods for sharing tabulated values between types whose
+      // kernels coincide
+      //------------------------------------------------------------
+
+      bool copyInterpolationValuesFromCoincidentType(unsigned type);
+      void registerTabulation(unsigned type);
+
       //------------------------------------------------------------
       // Evaluate the kernel of the line and volume integrals at the
       // specified x = theta/thetaCore_
@@ -226,24 +348,15 @@ namespace gcp {
       void pressure(gcp::util::Pressure& pressure);
 
       //------------------------------------------------------------
-      // Parameters needed to pass to the GSL integration routines
+      // Parameters needed to pass to the GSL integration routines.
+      // work_ is used by the calling thread; tabulationData_ holds
+      // one workspace per thread in our pool
       //------------------------------------------------------------
 
-      gsl_integration_workspace* gslWork_;
       size_t gslLimit_;
+      IntegrationWorkspace* work_;
 
-      gsl_function gslLineIntegralFn_;
-      gsl_function gslVolumeIntegralFn_;
-
-      void* params_;
-      unsigned currentIntegrationType_;
-
-      //------------------------------------------------------------
-      // The (dimensionless) cylindrical radius at which to evaluate
-      // the line integral, ie., xSky_ = theta_sky / theta_c
-      //------------------------------------------------------------
-
-      double xSky_;
+      std::vector<TabulationData*> tabulationData_;
 
       static GSL_HANDLER_FN(intErrHandler);
 
@@ -266,6 +379,15 @@ namespace gcp {
       double   deltaInterp_;
       unsigned nInterp_;
 
+      //------------------------------------------------------------
+      // The grid on which each type was last tabulated, and whether
+      // that tabulation is valid for the current sample
+      //------------------------------------------------------------
+
+      std::map<unsigned, double>   tabulatedDeltaInterp_;
+      std::map<unsigned, unsigned> tabulatedNInterp_;
+      std::map<unsigned, bool>     tabulationIsCurrent_;
+
       gcp::util::QuadraticInterpolatorNormal quadInterp_;
 
     }; // End class GenericRadiallySymmetric3DModel
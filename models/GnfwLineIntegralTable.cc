@@ -0,0 +1,642 @@
+#include "gcp/models/GnfwLineIntegralTable.h"
+
+#include "gcp/util/Exception.h"
+#include "gcp/util/Integrator.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+using namespace gcp::models;
+using namespace gcp::util;
+
+#define GNFW_TABLE_MAGIC   "CMXGNFWT"
+#define GNFW_TABLE_VERSION 1
+
+std::map<std::string, GnfwLineIntegralTable*> GnfwLineIntegralTable::tables_;
+Mutex GnfwLineIntegralTable::tablesGuard_;
+
+/**.......................................................................
+ * Constructor.
+ */
+GnfwLineIntegralTable::GnfwLineIntegralTable()
+{
+  memset(&header_, 0, sizeof(Header));
+
+  lnxMin_  = 0.0;
+  dlnx_    = 0.0;
+  interp_  = INTERP_CUBIC;
+
+  map_     = 0;
+  mapSize_ = 0;
+
+  lnNorm_  = 0;
+  lnRatio_ = 0;
+}
+
+/**.......................................................................
+ * Destructor.
+ */
+GnfwLineIntegralTable::~GnfwLineIntegralTable()
+{
+  unload();
+}
+
+/**.......................................................................
+ * Return the table loaded from the named file, loading it if this is
+ * the first request for it
+ */
+GnfwLineIntegralTable* GnfwLineIntegralTable::getTable(std::string fileName)
+{
+  GnfwLineIntegralTable* table = 0;
+
+  tablesGuard_.lock();
+
+  try {
+
+    std::map<std::string, GnfwLineIntegralTable*>::iterator iter = tables_.find(fileName);
+
+    if(iter != tables_.end()) {
+      table = iter->second;
+    } else {
+      table = new GnfwLineIntegralTable();
+      table->load(fileName);
+      tables_[fileName] = table;
+    }
+
+  } catch(...) {
+
+    if(table && tables_.find(fileName) == tables_.end())
+      delete table;
+
+    tablesGuard_.unlock();
+    throw;
+  }
+
+  tablesGuard_.unlock();
+
+  return table;
+}
+
+//=======================================================================
+// Building tables
+//=======================================================================
+
+/**.......................................................................
+ * Build the table on the requested grid
+ */
+void GnfwLineIntegralTable::build(Axis x, Axis alpha, Axis beta, Axis gamma)
+{
+  if(x.n_ < 2 || x.min_ <= 0.0 || x.max_ <= x.min_)
+    ThrowSimpleColorError("x axis must have at least two points, with 0 < xmin < xmax", "red");
+
+  if(alpha.n_ < 1 || beta.n_ < 1 || gamma.n_ < 1)
+    ThrowSimpleColorError("Parameter axes must have at least one point", "red");
+
+  if(alpha.min_ <= 0.0)
+    ThrowSimpleColorError("alpha must be positive everywhere in the table", "red");
+
+  //------------------------------------------------------------
+  // The line integral at x = 0 diverges for g >= 1, and the integral
+  // to infinity diverges for b <= 1
+  //------------------------------------------------------------
+
+  if(gamma.max_ >= 1.0)
+    ThrowSimpleColorError("gamma must be < 1 everywhere in the table", "red");
+
+  if(beta.min_ <= 1.0 || beta.min_ <= gamma.max_)
+    ThrowSimpleColorError("beta must be > 1 and > gamma everywhere in the table", "red");
+
+  unload();
+
+  x_     = x;
+  alpha_ = alpha;
+  beta_  = beta;
+  gamma_ = gamma;
+
+  strncpy(header_.magic_, GNFW_TABLE_MAGIC, 8);
+  header_.version_   = GNFW_TABLE_VERSION;
+  header_.nX_        = x.n_;
+  header_.xMin_      = x.min_;
+  header_.xMax_      = x.max_;
+  header_.nAlpha_    = alpha.n_;
+  header_.alphaMin_  = alpha.min_;
+  header_.alphaMax_  = alpha.max_;
+  header_.nBeta_     = beta.n_;
+  header_.betaMin_   = beta.min_;
+  header_.betaMax_   = beta.max_;
+  header_.nGamma_    = gamma.n_;
+  header_.gammaMin_  = gamma.min_;
+  header_.gammaMax_  = gamma.max_;
+  header_.maxRelErr_ = 0.0;
+
+  unsigned nPar = alpha.n_ * beta.n_ * gamma.n_;
+  buf_.resize(nPar * (1 + x.n_));
+  setPointers();
+
+  double* lnNorm  = &buf_[0];
+  double* lnRatio = &buf_[nPar];
+
+  for(unsigned iA=0; iA < alpha.n_; iA++) {
+    for(unsigned iB=0; iB < beta.n_; iB++) {
+      for(unsigned iG=0; iG < gamma.n_; iG++) {
+
+	double a = alpha.val(iA);
+	double b = beta.val(iB);
+	double g = gamma.val(iG);
+
+	unsigned iPar = (iA * beta.n_ + iB) * gamma.n_ + iG;
+	double norm   = lineIntegral(0.0, a, b, g);
+
+	lnNorm[iPar] = log(norm);
+
+	double* row = lnRatio + iPar * x.n_;
+	for(unsigned iX=0; iX < x.n_; iX++)
+	  row[iX] = log(lineIntegral(exp(lnxMin_ + iX * dlnx_), a, b, g) / norm);
+      }
+    }
+  }
+
+  header_.maxRelErr_ = estimateMaxRelErr();
+}
+
+/**.......................................................................
+ * Build the table, doubling the grid density until the measured
+ * interpolation error is below tol, or maxIter iterations have been
+ * performed
+ */
+void GnfwLineIntegralTable::buildToTolerance(Axis x, Axis alpha, Axis beta, Axis gamma,
+					    double tol, unsigned maxIter)
+{
+  for(unsigned iIter=0; iIter < maxIter; iIter++) {
+
+    build(x, alpha, beta, gamma);
+
+    COUTCOLOR("Iteration " << iIter << ": grid " << x.n_ << " x " << alpha.n_ << " x " << beta.n_ << " x " << gamma.n_
+	      << " has max relative error " << header_.maxRelErr_, "green");
+
+    if(header_.maxRelErr_ <= tol)
+      return;
+
+    x.n_ = 2*x.n_ - 1;
+
+    if(alpha.n_ > 1)
+      alpha.n_ = 2*alpha.n_ - 1;
+
+    if(beta.n_ > 1)
+      beta.n_ = 2*beta.n_ - 1;
+
+    if(gamma.n_ > 1)
+      gamma.n_ = 2*gamma.n_ - 1;
+  }
+
+  COUTCOLOR("Warning: table did not reach the requested tolerance of " << tol
+	    << " in " << maxIter << " iterations", "yellow");
+}
+
+/**.......................................................................
+ * Estimate the maximum relative error of the interpolated profile, by
+ * comparing against direct quadrature at the center of every
+ * parameter-space cell, for a range of x in each cell
+ */
+double GnfwLineIntegralTable::estimateMaxRelErr()
+{
+  unsigned nA = alpha_.n_ > 1 ? alpha_.n_-1 : 1;
+  unsigned nB = beta_.n_  > 1 ? beta_.n_-1  : 1;
+  unsigned nG = gamma_.n_ > 1 ? gamma_.n_-1 : 1;
+
+  //------------------------------------------------------------
+  // Check at most 16 x values per cell, at the midpoints of x cells
+  //------------------------------------------------------------
+
+  unsigned xStride = (x_.n_-1) / 16;
+  if(xStride < 1)
+    xStride = 1;
+
+  double maxErr = 0.0, err;
+
+  for(unsigned iA=0; iA < nA; iA++) {
+    for(unsigned iB=0; iB < nB; iB++) {
+      for(unsigned iG=0; iG < nG; iG++) {
+
+	double a = alpha_.n_ > 1 ? alpha_.val(iA) + alpha_.delta()/2 : alpha_.min_;
+	double b = beta_.n_  > 1 ? beta_.val(iB)  + beta_.delta()/2  : beta_.min_;
+	double g = gamma_.n_ > 1 ? gamma_.val(iG) + gamma_.delta()/2 : gamma_.min_;
+
+	double norm = lineIntegral(0.0, a, b, g);
+
+	err = fabs(normalization(a, b, g) - norm) / norm;
+	maxErr = err > maxErr ? err : maxErr;
+
+	for(unsigned iX=0; iX < x_.n_-1; iX += xStride) {
+	  double x    = exp(lnxMin_ + (iX + 0.5) * dlnx_);
+	  double rat  = lineIntegral(x, a, b, g) / norm;
+
+	  err = fabs(ratio(x, a, b, g) - rat) / rat;
+	  maxErr = err > maxErr ? err : maxErr;
+	}
+      }
+    }
+  }
+
+  return maxErr;
+}
+
+/**.......................................................................
+ * Write the table to a file
+ */
+void GnfwLineIntegralTable::write(std::string fileName)
+{
+  if(!lnNorm_)
+    ThrowError("No table has been built");
+
+  FILE* fp = fopen(fileName.c_str(), "wb");
+
+  if(!fp) {
+    ThrowSysError("fopen(" << fileName << ")");
+  }
+
+  unsigned nPar = header_.nAlpha_ * header_.nBeta_ * header_.nGamma_;
+  size_t nVal   = nPar * (1 + header_.nX_);
+
+  bool ok = fwrite(&header_, sizeof(Header), 1, fp) == 1;
+  ok = ok && (fwrite(lnNorm_, sizeof(double), nVal, fp) == nVal);
+
+  fclose(fp);
+
+  if(!ok)
+    ThrowError("Error writing table to " << fileName);
+}
+
+//=======================================================================
+// Loading tables
+//=======================================================================
+
+/**.......................................................................
+ * Memory-map a table from a file
+ */
+void GnfwLineIntegralTable::load(std::string fileName)
+{
+  unload();
+
+  int fd = open(fileName.c_str(), O_RDONLY);
+
+  if(fd < 0) {
+    ThrowSysError("open(" << fileName << ")");
+  }
+
+  struct stat st;
+  if(fstat(fd, &st) < 0) {
+    close(fd);
+    ThrowSysError("fstat(" << fileName << ")");
+  }
+
+  if((size_t)st.st_size < sizeof(Header)) {
+    close(fd);
+    ThrowSimpleColorError(fileName << " is too small to be a GNFW line-integral table", "red");
+  }
+
+  mapSize_ = st.st_size;
+  map_     = mmap(0, mapSize_, PROT_READ, MAP_SHARED, fd, 0);
+
+  close(fd);
+
+  if(map_ == MAP_FAILED) {
+    map_ = 0;
+    ThrowSysError("mmap(" << fileName << ")");
+  }
+
+  memcpy(&header_, map_, sizeof(Header));
+
+  if(strncmp(header_.magic_, GNFW_TABLE_MAGIC, 8) != 0 || header_.version_ != GNFW_TABLE_VERSION) {
+    unload();
+    ThrowSimpleColorError(fileName << " is not a (version " << GNFW_TABLE_VERSION << ") GNFW line-integral table", "red");
+  }
+
+  //------------------------------------------------------------
+  // A degenerate x axis would leave a zero (or NaN) log spacing, so
+  // reject it here rather than interpolate nonsense
+  //------------------------------------------------------------
+
+  if(header_.nX_ < 2 || !(header_.xMin_ > 0.0) || !(header_.xMax_ > header_.xMin_)) {
+    unload();
+    ThrowSimpleColorError(fileName << " has a degenerate x axis (need at least two points, with 0 < xmin < xmax)", "red");
+  }
+
+  if(header_.nAlpha_ < 1 || header_.nBeta_ < 1 || header_.nGamma_ < 1) {
+    unload();
+    ThrowSimpleColorError(fileName << " has an empty parameter axis", "red");
+  }
+
+  unsigned nPar = header_.nAlpha_ * header_.nBeta_ * header_.nGamma_;
+
+  if(mapSize_ != sizeof(Header) + sizeof(double) * nPar * (1 + header_.nX_)) {
+    unload();
+    ThrowSimpleColorError(fileName << " is truncated or corrupt", "red");
+  }
+
+  x_     = Axis(header_.nX_,     header_.xMin_,     header_.xMax_);
+  alpha_ = Axis(header_.nAlpha_, header_.alphaMin_, header_.alphaMax_);
+  beta_  = Axis(header_.nBeta_,  header_.betaMin_,  header_.betaMax_);
+  gamma_ = Axis(header_.nGamma_, header_.gammaMin_, header_.gammaMax_);
+
+  setPointers();
+}
+
+/**.......................................................................
+ * Release any resources associated with this table
+ */
+void GnfwLineIntegralTable::unload()
+{
+  if(map_) {
+    munmap(map_, mapSize_);
+    map_     = 0;
+    mapSize_ = 0;
+  }
+
+  buf_.resize(0);
+
+  lnNorm_  = 0;
+  lnRatio_ = 0;
+}
+
+/**.......................................................................
+ * Set up pointers to the normalization and ratio arrays, and the
+ * derived x-axis parameters
+ */
+void GnfwLineIntegralTable::setPointers()
+{
+  unsigned nPar = alpha_.n_ * beta_.n_ * gamma_.n_;
+
+  const double* base = 0;
+
+  if(map_) {
+    base = (const double*)((const char*)map_ + sizeof(Header));
+  } else if(buf_.size() > 0) {
+    base = &buf_[0];
+  }
+
+  lnNorm_  = base;
+  lnRatio_ = base ? base + nPar : 0;
+
+  lnxMin_  = log(x_.min_);
+  dlnx_    = (log(x_.max_) - lnxMin_) / (x_.n_ - 1);
+}
+
+//=======================================================================
+// Querying tables
+//=======================================================================
+
+void GnfwLineIntegralTable::setInterpolation(Interpolation interp)
+{
+  interp_ = interp;
+}
+
+double GnfwLineIntegralTable::maxRelErr()
+{
+  return header_.maxRelErr_;
+}
+
+/**.......................................................................
+ * Return true if the requested shape parameters lie within this
+ * table
+ */
+bool GnfwLineIntegralTable::contains(double alpha, double beta, double gamma)
+{
+  unsigned i0;
+  double w;
+
+  return lnNorm_ &&
+    locate(alpha_, alpha, i0, w) &&
+    locate(beta_,  beta,  i0, w) &&
+    locate(gamma_, gamma, i0, w);
+}
+
+/**.......................................................................
+ * Locate the lower bracketing node and the fractional weight of the
+ * upper node for a value on a linearly-sampled axis
+ */
+bool GnfwLineIntegralTable::locate(Axis& axis, double val, unsigned& i0, double& w)
+{
+  static const double eps = 1e-9;
+
+  if(axis.n_ == 1) {
+    i0 = 0;
+    w  = 0.0;
+    return fabs(val - axis.min_) <= eps * (fabs(axis.min_) > 1.0 ? fabs(axis.min_) : 1.0);
+  }
+
+  double t = (val - axis.min_) / axis.delta();
+
+  if(t < -eps || t > (axis.n_-1) + eps)
+    return false;
+
+  if(t < 0.0)
+    t = 0.0;
+
+  i0 = (unsigned)t;
+
+  if(i0 > axis.n_-2)
+    i0 = axis.n_-2;
+
+  w = t - i0;
+
+  return true;
+}
+
+/**.......................................................................
+ * Compute the parameter indices and weights of the 8 nodes that
+ * bracket the requested point in parameter space
+ */
+void GnfwLineIntegralTable::cornerWeights(double alpha, double beta, double gamma,
+					  unsigned* offsets, double* weights)
+{
+  unsigned iA, iB, iG;
+  double   wA, wB, wG;
+
+  if(!(locate(alpha_, alpha, iA, wA) && locate(beta_, beta, iB, wB) && locate(gamma_, gamma, iG, wG)))
+    ThrowError("Parameters (" << alpha << ", " << beta << ", " << gamma << ") lie outside of the table");
+
+  unsigned iA1 = alpha_.n_ > 1 ? iA+1 : iA;
+  unsigned iB1 = beta_.n_  > 1 ? iB+1 : iB;
+  unsigned iG1 = gamma_.n_ > 1 ? iG+1 : iG;
+
+  unsigned ia[2] = {iA, iA1};
+  unsigned ib[2] = {iB, iB1};
+  unsigned ig[2] = {iG, iG1};
+
+  double wa[2] = {1.0-wA, wA};
+  double wb[2] = {1.0-wB, wB};
+  double wg[2] = {1.0-wG, wG};
+
+  unsigned iCorner = 0;
+  for(unsigned a=0; a < 2; a++) {
+    for(unsigned b=0; b < 2; b++) {
+      for(unsigned g=0; g < 2; g++) {
+	offsets[iCorner] = (ia[a] * beta_.n_ + ib[b]) * gamma_.n_ + ig[g];
+	weights[iCorner] = wa[a] * wb[b] * wg[g];
+	++iCorner;
+      }
+    }
+  }
+}
+
+/**.......................................................................
+ * Interpolate ln(L(x)/L(0)) along x for a single parameter node.
+ *
+ * Below xMin, we interpolate linearly in x between L(0)/L(0) = 1 and
+ * the first tabulated point.  Above xMax, we extrapolate the
+ * power-law tail from the last two points.
+ */
+double GnfwLineIntegralTable::interpolateX(const double* row, double x)
+{
+  unsigned n = x_.n_;
+
+  if(x <= 0.0)
+    return 0.0;
+
+  if(x < x_.min_)
+    return log(1.0 + (exp(row[0]) - 1.0) * x / x_.min_);
+
+  double t = (log(x) - lnxMin_) / dlnx_;
+
+  if(t >= n-1)
+    return row[n-1] + (t - (n-1)) * (row[n-1] - row[n-2]);
+
+  unsigned i = (unsigned)t;
+  double   f = t - i;
+
+  //------------------------------------------------------------
+  // Catmull-Rom cubic, where we have neighbors on both sides
+  //------------------------------------------------------------
+
+  if(interp_ == INTERP_CUBIC && i > 0 && i+2 < n) {
+
+    double p0 = row[i-1], p1 = row[i], p2 = row[i+1], p3 = row[i+2];
+
+    return p1 + 0.5 * f * (p2 - p0 + f * (2.0*p0 - 5.0*p1 + 4.0*p2 - p3 + f * (3.0*(p1 - p2) + p3 - p0)));
+  }
+
+  return row[i] + f * (row[i+1] - row[i]);
+}
+
+/**.......................................................................
+ * Return L(0) for the requested parameters
+ */
+double GnfwLineIntegralTable::normalization(double alpha, double beta, double gamma)
+{
+  unsigned offsets[8];
+  double   weights[8];
+
+  cornerWeights(alpha, beta, gamma, offsets, weights);
+
+  double lnNorm = 0.0;
+  for(unsigned iCorner=0; iCorner < 8; iCorner++)
+    lnNorm += weights[iCorner] * lnNorm_[offsets[iCorner]];
+
+  return exp(lnNorm);
+}
+
+/**.......................................................................
+ * Return L(x)/L(0) for the requested parameters
+ */
+double GnfwLineIntegralTable::ratio(double x, double alpha, double beta, double gamma)
+{
+  unsigned offsets[8];
+  double   weights[8];
+
+  cornerWeights(alpha, beta, gamma, offsets, weights);
+
+  double lnRatio = 0.0;
+  for(unsigned iCorner=0; iCorner < 8; iCorner++)
+    lnRatio += weights[iCorner] * interpolateX(lnRatio_ + offsets[iCorner] * x_.n_, x);
+
+  return exp(lnRatio);
+}
+
+/**.......................................................................
+ * Fill an array of L(x)/L(0) on a uniform grid in x
+ */
+void GnfwLineIntegralTable::fill(double alpha, double beta, double gamma,
+				 double dx, unsigned n, std::vector<double>& vals, double& norm)
+{
+  unsigned offsets[8];
+  double   weights[8];
+  const double* rows[8];
+
+  cornerWeights(alpha, beta, gamma, offsets, weights);
+
+  //------------------------------------------------------------
+  // Drop corners with zero weight (ie, exactly on a node, or a
+  // degenerate axis)
+  //------------------------------------------------------------
+
+  unsigned nCorner = 0;
+  double lnNorm = 0.0;
+
+  for(unsigned iCorner=0; iCorner < 8; iCorner++) {
+    if(weights[iCorner] > 0.0) {
+      lnNorm += weights[iCorner] * lnNorm_[offsets[iCorner]];
+      weights[nCorner] = weights[iCorner];
+      rows[nCorner]    = lnRatio_ + offsets[iCorner] * x_.n_;
+      ++nCorner;
+    }
+  }
+
+  norm = exp(lnNorm);
+
+  if(vals.size() != n)
+    vals.resize(n);
+
+  for(unsigned i=0; i < n; i++) {
+
+    double x = i * dx;
+    double lnRatio = 0.0;
+
+    for(unsigned iCorner=0; iCorner < nCorner; iCorner++)
+      lnRatio += weights[iCorner] * interpolateX(rows[iCorner], x);
+
+    vals[i] = exp(lnRatio);
+  }
+}
+
+//=======================================================================
+// Direct evaluation
+//=======================================================================
+
+/**.......................................................................
+ * Kernel of the line integral, after substituting r = sqrt(l^2 +
+ * x^2), as in GenericRadiallySymmetric3DModel
+ */
+double GnfwLineIntegralTable::lineIntegralKernel(double r, void* params)
+{
+  KernelParams* kp = (KernelParams*)params;
+
+  double p = pow(r, -kp->gamma_) * pow(1.0 + pow(r, kp->alpha_), -(kp->beta_ - kp->gamma_)/kp->alpha_);
+
+  return p * r / sqrt(r*r - kp->x_*kp->x_);
+}
+
+/**.......................................................................
+ * Evaluate the line integral by quadrature
+ */
+double GnfwLineIntegralTable::lineIntegral(double x, double alpha, double beta, double gamma)
+{
+  Integrator integrator;
+  KernelParams kp;
+
+  kp.x_     = x;
+  kp.alpha_ = alpha;
+  kp.beta_  = beta;
+  kp.gamma_ = gamma;
+
+  return 2 * integrator.integrateFromLowlimToInfty(&lineIntegralKernel, &kp, x);
+}
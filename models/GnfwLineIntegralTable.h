@@ -0,0 +1,221 @@
+// $Id: $
+
+#ifndef GCP_MODELS_GNFWLINEINTEGRALTABLE_H
+#define GCP_MODELS_GNFWLINEINTEGRALTABLE_H
+
+/**
+ * @file GnfwLineIntegralTable.h
+ *
+ * Tagged: Mon Oct 19 10:12:41 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gcp/util/Mutex.h"
+
+namespace gcp {
+  namespace models {
+
+    //-----------------------------------------------------------------------
+    // A precomputed table of the dimensionless projected GNFW profile:
+    //
+    //                  / +infty
+    // L(x; a, b, g) = |        p(sqrt(l^2 + x^2)) dl
+    //                 / -infty
+    //
+    // with p(r) = r^-g * (1 + r^a)^(-(b-g)/a), tabulated on a grid
+    // of (x, a, b, g).  We store ln(L(0)) for each parameter node,
+    // and ln(L(x)/L(0)) for each (x, parameter) node.  x is sampled
+    // logarithmically, the shape parameters linearly.
+    //
+    // Tables are built offline (see climaxGnfwTable) and written to a
+    // binary file, which is memory-mapped read-only when loaded, so
+    // that any number of models (and processes) can share one copy.
+    //-----------------------------------------------------------------------
+
+    class GnfwLineIntegralTable {
+    public:
+
+      enum Interpolation {
+	INTERP_LINEAR, // Multilinear in (ln x, a, b, g)
+	INTERP_CUBIC,  // Cubic in ln x, multilinear in (a, b, g)
+      };
+
+      // A grid axis
+
+      struct Axis {
+	unsigned n_;
+	double min_;
+	double max_;
+
+	Axis() {
+	  n_   = 0;
+	  min_ = 0.0;
+	  max_ = 0.0;
+	};
+
+	Axis(unsigned n, double min, double max) {
+	  n_   = n;
+	  min_ = min;
+	  max_ = max;
+	};
+
+	double delta() {
+	  return n_ > 1 ? (max_ - min_) / (n_ - 1) : 0.0;
+	};
+
+	double val(unsigned i) {
+	  return min_ + i * delta();
+	};
+      };
+
+      // The header written at the start of a table file
+
+      struct Header {
+	char     magic_[8];
+	unsigned version_;
+	unsigned nX_, nAlpha_, nBeta_, nGamma_;
+	double   xMin_, xMax_;
+	double   alphaMin_, alphaMax_;
+	double   betaMin_,  betaMax_;
+	double   gammaMin_, gammaMax_;
+	double   maxRelErr_;
+      };
+
+      /**
+       * Constructor.
+       */
+      GnfwLineIntegralTable();
+
+      /**
+       * Destructor.
+       */
+      virtual ~GnfwLineIntegralTable();
+
+      //------------------------------------------------------------
+      // Return a table loaded from the named file.  Tables are
+      // loaded once per process and shared by all callers
+      //------------------------------------------------------------
+
+      static GnfwLineIntegralTable* getTable(std::string fileName);
+
+      //------------------------------------------------------------
+      // Methods for building and writing tables
+      //------------------------------------------------------------
+
+      void build(Axis x, Axis alpha, Axis beta, Axis gamma);
+      void buildToTolerance(Axis x, Axis alpha, Axis beta, Axis gamma, double tol, unsigned maxIter);
+      double estimateMaxRelErr();
+      void write(std::string fileName);
+
+      //------------------------------------------------------------
+      // Methods for loading tables
+      //------------------------------------------------------------
+
+      void load(std::string fileName);
+      void unload();
+
+      //------------------------------------------------------------
+      // Methods for querying tables
+      //------------------------------------------------------------
+
+      // True if the passed shape parameters lie within the table
+
+      bool contains(double alpha, double beta, double gamma);
+
+      // The maximum relative interpolation error measured when the
+      // table was built
+
+      double maxRelErr();
+
+      // Return L(0) for the passed parameters
+
+      double normalization(double alpha, double beta, double gamma);
+
+      // Return L(x)/L(0) for the passed parameters
+
+      double ratio(double x, double alpha, double beta, double gamma);
+
+      // Fill vals[i] with L(i*dx)/L(0), i = 0..n-1, and norm with
+      // L(0).  The parameter-space weights are computed once for all
+      // x
+
+      void fill(double alpha, double beta, double gamma,
+		double dx, unsigned n, std::vector<double>& vals, double& norm);
+
+      void setInterpolation(Interpolation interp);
+
+      //------------------------------------------------------------
+      // Direct evaluation by quadrature, used to build the table and
+      // to check its accuracy
+      //------------------------------------------------------------
+
+      static double lineIntegral(double x, double alpha, double beta, double gamma);
+
+    private:
+
+      // Parameters passed to the integration kernel
+
+      struct KernelParams {
+	double x_;
+	double alpha_;
+	double beta_;
+	double gamma_;
+      };
+
+      static double lineIntegralKernel(double r, void* params);
+
+      // Locate the lower grid node and weight for a value on a
+      // linear parameter axis.  Returns false if out of range
+
+      bool locate(Axis& axis, double val, unsigned& i0, double& w);
+
+      // Interpolate ln(L(x)/L(0)) along x for the row starting at
+      // the passed pointer
+
+      double interpolateX(const double* row, double x);
+
+      // Compute the 8 corner offsets and weights for a point in
+      // parameter space
+
+      void cornerWeights(double alpha, double beta, double gamma,
+			 unsigned* offsets, double* weights);
+
+      void setPointers();
+
+      Header header_;
+      Axis x_, alpha_, beta_, gamma_;
+      double lnxMin_, dlnx_;
+
+      Interpolation interp_;
+
+      // Storage for built tables
+
+      std::vector<double> buf_;
+
+      // Storage for loaded tables
+
+      void*  map_;
+      size_t mapSize_;
+
+      // Pointers into either buf_ or map_
+
+      const double* lnNorm_;
+      const double* lnRatio_;
+
+      // Shared tables, indexed by file name
+
+      static std::map<std::string, GnfwLineIntegralTable*> tables_;
+      static gcp::util::Mutex tablesGuard_;
+
+    }; // End class GnfwLineIntegralTable
+
+  } // End namespace models
+} // End namespace gcp
+
+#endif // End #ifndef GCP_MODELS_GNFWLINEINTEGRALTABLE_H
@@ -15,7 +15,12 @@ using namespace gcp::util;
  */
 GnfwModel::GnfwModel() 
 {
+  lineIntegralTable_ = 0;
+
   initialize();
+
+  addParameter("lineIntegralTable",    DataType::STRING, "A file of precomputed line integrals (see climaxGnfwTable).  If specified, line integrals are interpolated from this table instead of integrated, for shape parameters that lie within it");
+  addParameter("lineIntegralTableTol", DataType::DOUBLE, "The maximum relative interpolation error to accept from lineIntegralTable (defaults to 1e-3)");
 }
 
 /**.......................................................................
@@ -326,6 +331,27 @@ void GnfwModel::checkSetup()
   checkVar("beta");
   checkVar("gamma");
 
+  //------------------------------------------------------------
+  // If a table of line integrals was specified, load it now, and
+  // check that it is accurate enough to use
+  //------------------------------------------------------------
+
+  if(getParameter("lineIntegralTable", false)->data_.hasValue()) {
+
+    if(!radialModelIsGnfw())
+      ThrowSimpleColorError(std::endl << name_ << ".lineIntegralTable can't be used with this model, since its radial profile is not a pure GNFW profile", "red");
+
+    lineIntegralTable_ = GnfwLineIntegralTable::getTable(getStringVal("lineIntegralTable"));
+
+    double tol = 1e-3;
+    if(getParameter("lineIntegralTableTol", false)->data_.hasValue())
+      tol = getDoubleVal("lineIntegralTableTol");
+
+    if(lineIntegralTable_->maxRelErr() > tol)
+      ThrowSimpleColorError(std::endl << "The maximum relative error of " << getStringVal("lineIntegralTable") << " (" << lineIntegralTable_->maxRelErr() 
+			    << ") exceeds " << name_ << ".lineIntegralTableTol (" << tol << ")", "red");
+  }
+
   //------------------------------------------------------------
   // Finally, perform any additional base-class checks
   //------------------------------------------------------------
@@ -396,6 +422,71 @@ bool GnfwModel::shapeParametersAreFixed()
     thetaCore_.prior().getType() != Distribution::DIST_UNSPEC;
 }
 
+/**.......................................................................
+ * Generic datasets are fit with the radio kernel, so line integrals
+ * tabulated for either can be shared
+ */
+bool GnfwModel::kernelsCoincide(unsigned type1, unsigned type2)
+{
+  unsigned radioTypes = DataSetType::DATASET_RADIO | DataSetType::DATASET_GENERIC;
+
+  return (type1 == type2) || ((type1 & radioTypes) && (type2 & radioTypes));
+}
+
+/**.......................................................................
+ * For the GNFW family, the radio (and generic) kernel is itself a
+ * GNFW profile with exponents (a, g + f*(b-g), g), and the X-ray
+ * kernel is a GNFW profile with exponents (a, 2g + 2f*(b-g), 2g)
+ */
+void GnfwModel::getEffectiveShapeParameters(unsigned type, double& alpha, double& beta, double& gamma)
+{
+  double scale = (type == DataSetType::DATASET_XRAY_IMAGE) ? 2.0 : 1.0;
+
+  alpha = alpha_.val_;
+  gamma = scale * gamma_.val_;
+  beta  = gamma + scale * fac_.val_ * (beta_.val_ - gamma_.val_);
+}
+
+bool GnfwModel::radialModelIsGnfw()
+{
+  return true;
+}
+
+/**.......................................................................
+ * Calculate interpolation values for the current grid.  If a table
+ * of line integrals was specified, and the current shape parameters
+ * lie within it, we interpolate from the table.  Otherwise we fall
+ * back to integrating the kernel
+ */
+void GnfwModel::calculateInterpolationValues(unsigned type)
+{
+  double alpha, beta, gamma;
+
+  if(lineIntegralTable_) {
+
+    getEffectiveShapeParameters(type, alpha, beta, gamma);
+
+    if(lineIntegralTable_->contains(alpha, beta, gamma)) {
+
+      if(copyInterpolationValuesFromCoincidentType(type))
+	return;
+
+      if(nInterp_ != arealIntegral_[type].size())
+	arealIntegral_[type].resize(nInterp_);
+
+      lineIntegralTable_->fill(alpha, beta, gamma, deltaInterp_, nInterp_,
+			       interpolatedLineIntegral_[type], lineIntegralNormalization_[type].val_);
+
+      calculateArealIntegral(type);
+      registerTabulation(type);
+
+      return;
+    }
+  }
+
+  GenericRadiallySymmetric3DModel::calculateInterpolationValues(type);
+}
+
 /**.......................................................................
  * The relation between my x and Gnfw x is:
  *
@@ -13,6 +13,7 @@
  * @author Erik Leitch
  */
 #include "gcp/models/GenericRadiallySymmetric3DModel.h"
+#include "gcp/models/GnfwLineIntegralTable.h"
 
 //-----------------------------------------------------------------------
 // Generalized form of the pressure model from Nagai et al 2007, ApJ
@@ -50,6 +51,30 @@ namespace gcp {
 
       bool shapeParametersAreFixed();
 
+      //------------------------------------------------------------
+      // Return true if radio and generic kernels are the same
+      //------------------------------------------------------------
+
+      bool kernelsCoincide(unsigned type1, unsigned type2);
+
+      //------------------------------------------------------------
+      // Methods for interpolating line integrals from a precomputed
+      // table, if one was specified
+      //------------------------------------------------------------
+
+      using GenericRadiallySymmetric3DModel::calculateInterpolationValues;
+      void calculateInterpolationValues(unsigned type);
+
+      // Return the exponents of the GNFW profile that the radial
+      // kernel for the passed type reduces to
+
+      void getEffectiveShapeParameters(unsigned type, double& alpha, double& beta, double& gamma);
+
+      // Return true if the radial models are pure GNFW profiles, and
+      // can therefore be interpolated from a table
+
+      virtual bool radialModelIsGnfw();
+
       void checkSetup();
 
       double gnfwX(double x);
@@ -134,6 +159,12 @@ namespace gcp {
       gcp::util::VariableUnitQuantity volumeIntegralFactorR500_;
       gcp::util::Mass scaleFactorMassT500_;
 
+      //------------------------------------------------------------
+      // An optional table of precomputed line integrals
+      //------------------------------------------------------------
+
+      GnfwLineIntegralTable* lineIntegralTable_;
+
     }; // End class GnfwModel
 
   } // End namespace models
@@ -213,3 +213,22 @@ double ModArnaudModel::radialXrayModel(double x, void* params)
 
   return rat/(xg * pow(1.0 + xa, bga));
 }
+
+/**.......................................................................
+ * radialRadioModel() and radialXrayModel() switch the GNFW shape
+ * parameters depending on radius, so they must not be called
+ * concurrently
+ */
+bool ModArnaudModel::radialModelIsThreadSafe()
+{
+  return false;
+}
+
+/**.......................................................................
+ * The radial models modify the GNFW profile with radius, so they
+ * can't be interpolated from a GNFW table
+ */
+bool ModArnaudModel::radialModelIsGnfw()
+{
+  return false;
+}
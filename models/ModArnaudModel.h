@@ -51,6 +51,15 @@ namespace gcp {
       virtual double radialRadioModel(double r, void* params);
       virtual double radialXrayModel(double r, void* params);
 
+      // The radial models reset shape parameters on the fly, so they
+      // can't be evaluated concurrently
+
+      bool radialModelIsThreadSafe();
+
+      // The radial models are not pure GNFW profiles
+
+      bool radialModelIsGnfw();
+
       gcp::util::VariableUnitQuantity rfrac_;
 
       double radioRat_;
@@ -151,6 +151,17 @@ double PowerlawProfile::radialModel(unsigned type, double x, void* params)
   }
 }
 
+/**.......................................................................
+ * Generic datasets are fit with the radio kernel, so line integrals
+ * tabulated for either can be shared
+ */
+bool PowerlawProfile::kernelsCoincide(unsigned type1, unsigned type2)
+{
+  unsigned radioTypes = DataSetType::DATASET_RADIO | DataSetType::DATASET_GENERIC;
+
+  return (type1 == type2) || ((type1 & radioTypes) && (type2 & radioTypes));
+}
+
 double PowerlawProfile::radialRadioModelEml(double x, void* params)
 {
   unsigned iLow=0, iHigh=0;
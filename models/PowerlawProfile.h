@@ -30,6 +30,7 @@ namespace gcp {
       // Define different types of radial models
 
       double radialModel(unsigned type, double r, void* params);
+      bool kernelsCoincide(unsigned type1, unsigned type2);
 #if 0
       virtual double radialRadioModelAM(double r, void* params);
 #endif
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <iomanip>
+
+#include <cmath>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+
+#include "gcp/models/GnfwLineIntegralTable.h"
+
+using namespace std;
+using namespace gcp::models;
+using namespace gcp::program;
+using namespace gcp::util;
+
+KeyTabEntry Program::keywords[] = {
+  { "file",   "/tmp/tGnfwLineIntegralTable.dat", "s", "Table file to write and reload"},
+  { "alpha",  "1.05", "d", "alpha to test"},
+  { "beta",   "5.49", "d", "beta to test"},
+  { "gamma",  "0.31", "d", "gamma to test"},
+  { "tol",    "1e-2", "d", "Maximum relative error to accept"},
+  { END_OF_KEYWORDS}
+};
+
+void Program::initializeUsage() {};
+
+//-----------------------------------------------------------------------
+// Build a small table, write it out, memory-map it back in, and
+// compare interpolated line integrals against direct quadrature
+//-----------------------------------------------------------------------
+
+int Program::main()
+{
+  std::string file = Program::getStringParameter("file");
+  double alpha     = Program::getDoubleParameter("alpha");
+  double beta      = Program::getDoubleParameter("beta");
+  double gamma     = Program::getDoubleParameter("gamma");
+  double tol       = Program::getDoubleParameter("tol");
+
+  GnfwLineIntegralTable built;
+
+  built.build(GnfwLineIntegralTable::Axis(81, 1e-2, 1e2),
+	      GnfwLineIntegralTable::Axis(9,  0.8,  1.6),
+	      GnfwLineIntegralTable::Axis(9,  4.5,  6.5),
+	      GnfwLineIntegralTable::Axis(13, 0.0,  0.6));
+
+  COUT("Table max relative error = " << built.maxRelErr());
+
+  built.write(file);
+
+  GnfwLineIntegralTable* table = GnfwLineIntegralTable::getTable(file);
+
+  if(!table->contains(alpha, beta, gamma))
+    ThrowError("Table doesn't contain the test parameters");
+
+  unsigned n = 100;
+  double dx  = 0.05;
+  double norm;
+  std::vector<double> vals;
+
+  table->fill(alpha, beta, gamma, dx, n, vals, norm);
+
+  double directNorm = GnfwLineIntegralTable::lineIntegral(0.0, alpha, beta, gamma);
+  double maxErr = fabs(norm - directNorm) / directNorm;
+
+  for(unsigned i=0; i < n; i++) {
+    double direct = GnfwLineIntegralTable::lineIntegral(i*dx, alpha, beta, gamma) / directNorm;
+    double err = fabs(vals[i] - direct) / direct;
+    maxErr = err > maxErr ? err : maxErr;
+  }
+
+  COUT("Max relative error at (" << alpha << ", " << beta << ", " << gamma << ") = " << maxErr);
+
+  if(maxErr > tol)
+    ThrowError("Interpolated line integrals exceed the requested tolerance");
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <iomanip>
+
+#include <cmath>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+#include "gcp/util/ThreadPool.h"
+#include "gcp/util/Timer.h"
+
+#include "gcp/fftutil/Image.h"
+
+#include "gcp/models/Nagai07Model.h"
+
+using namespace std;
+using namespace gcp::models;
+using namespace gcp::program;
+using namespace gcp::util;
+
+KeyTabEntry Program::keywords[] = {
+  { "nthread",  "4",   "i", "Number of threads to use for the parallel tabulation"},
+  { "npix",     "512", "i", "Number of pixels in the image"},
+  { "tc",       "2",   "d", "thetaCore (arcminutes)"},
+  { END_OF_KEYWORDS}
+};
+
+void Program::initializeUsage() {};
+
+//-----------------------------------------------------------------------
+// Compare line integrals tabulated serially with those tabulated
+// across a thread pool, and check that radio and generic tables are
+// shared for the GNFW family
+//-----------------------------------------------------------------------
+
+int Program::main()
+{
+  unsigned nThread = Program::getIntegerParameter("nthread");
+  unsigned npix    = Program::getIntegerParameter("npix");
+  double   tc      = Program::getDoubleParameter("tc");
+
+  Angle size;
+  size.setDegrees(1.0);
+  Image image(npix, size);
+
+  Nagai07Model serial;
+  Nagai07Model parallel;
+
+  serial.getVar("thetaCore")->setVal(tc, "'");
+  parallel.getVar("thetaCore")->setVal(tc, "'");
+
+  ThreadPool pool(nThread);
+  pool.spawn();
+  parallel.setThreadPool(&pool);
+
+  Timer timer;
+
+  timer.start();
+  serial.calculateInterpolationValuesForCurrentScaleRadius(DataSetType::DATASET_RADIO, image);
+  timer.stop();
+  COUT("Serial tabulation of " << serial.nInterp_ << " points took:   " << timer.deltaInSeconds() << " s");
+
+  timer.start();
+  parallel.calculateInterpolationValuesForCurrentScaleRadius(DataSetType::DATASET_RADIO, image);
+  timer.stop();
+  COUT("Parallel tabulation of " << parallel.nInterp_ << " points took: " << timer.deltaInSeconds() << " s");
+
+  std::vector<double>& s = serial.interpolatedLineIntegral_[DataSetType::DATASET_RADIO];
+  std::vector<double>& p = parallel.interpolatedLineIntegral_[DataSetType::DATASET_RADIO];
+
+  double maxDiff = 0.0;
+  for(unsigned i=0; i < s.size(); i++) {
+    double diff = fabs(s[i] - p[i]);
+    maxDiff = diff > maxDiff ? diff : maxDiff;
+  }
+
+  COUT("Max difference between serial and parallel tables: " << maxDiff);
+
+  if(maxDiff > 0.0)
+    ThrowError("Serial and parallel tabulations differ");
+
+  // The generic table should now be copied from the radio table
+
+  timer.start();
+  parallel.calculateInterpolationValuesForCurrentScaleRadius(DataSetType::DATASET_GENERIC, image);
+  timer.stop();
+  COUT("Shared generic tabulation took: " << timer.deltaInSeconds() << " s");
+
+  if(parallel.interpolatedLineIntegral_[DataSetType::DATASET_GENERIC] != p)
+    ThrowError("Generic table was not shared with the radio table");
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include <iostream>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+
+#include "gcp/models/GnfwLineIntegralTable.h"
+
+using namespace std;
+using namespace gcp::models;
+using namespace gcp::program;
+using namespace gcp::util;
+
+void Program::initializeUsage() {};
+
+KeyTabEntry Program::keywords[] = {
+  { "file",     "",     "s", "Output table file"},
+  { "nx",       "61",   "i", "Initial number of (logarithmically-spaced) x points"},
+  { "xmin",     "1e-3", "d", "Minimum x"},
+  { "xmax",     "1e3",  "d", "Maximum x"},
+  { "nalpha",   "6",    "i", "Initial number of alpha points"},
+  { "alphamin", "0.5",  "d", "Minimum alpha"},
+  { "alphamax", "3.0",  "d", "Maximum alpha"},
+  { "nbeta",    "6",    "i", "Initial number of beta points"},
+  { "betamin",  "2.0",  "d", "Minimum beta"},
+  { "betamax",  "12.0", "d", "Maximum beta"},
+  { "ngamma",   "4",    "i", "Initial number of gamma points"},
+  { "gammamin", "0.0",  "d", "Minimum gamma"},
+  { "gammamax", "0.9",  "d", "Maximum gamma"},
+  { "tol",      "1e-3", "d", "Maximum relative interpolation error"},
+  { "maxiter",  "4",    "i", "Maximum number of grid refinements"},
+  { END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS},
+};
+
+//-----------------------------------------------------------------------
+// Build a table of GNFW line integrals for use with the
+// lineIntegralTable parameter of GNFW-family models.
+//
+// Note that the exponents are those of the kernel actually
+// integrated, so that for X-ray data, the table must extend to twice
+// the gamma and beta values of the pressure profile
+//-----------------------------------------------------------------------
+
+int Program::main()
+{
+  if(!Program::hasValue("file"))
+    ThrowSimpleColorError("You must specify an output file", "red");
+
+  GnfwLineIntegralTable::Axis x(Program::getIntegerParameter("nx"),
+				Program::getDoubleParameter("xmin"),
+				Program::getDoubleParameter("xmax"));
+
+  GnfwLineIntegralTable::Axis alpha(Program::getIntegerParameter("nalpha"),
+				    Program::getDoubleParameter("alphamin"),
+				    Program::getDoubleParameter("alphamax"));
+
+  GnfwLineIntegralTable::Axis beta(Program::getIntegerParameter("nbeta"),
+				   Program::getDoubleParameter("betamin"),
+				   Program::getDoubleParameter("betamax"));
+
+  GnfwLineIntegralTable::Axis gamma(Program::getIntegerParameter("ngamma"),
+				    Program::getDoubleParameter("gammamin"),
+				    Program::getDoubleParameter("gammamax"));
+
+  GnfwLineIntegralTable table;
+
+  table.buildToTolerance(x, alpha, beta, gamma,
+			 Program::getDoubleParameter("tol"),
+			 Program::getIntegerParameter("maxiter"));
+
+  table.write(Program::getStringParameter("file"));
+
+  COUTCOLOR("Wrote " << Program::getStringParameter("file") << " (max relative error = " << table.maxRelErr() << ")", "green");
+
+  return 0;
+}
@@ -379,6 +379,34 @@ std::vector<npy_intp> PyHandler::getNumPyInds(std::vector<int>& dims)
 
   return npyInds;
 }
+
+/**.......................................................................
+ * Return a read-only array that views the passed data without copying
+ * it.  If base is non-zero, the view holds a reference to it
+ */
+PyObject* PyHandler::getNumPyView(std::vector<int> dims, gcp::util::DataType::Type dataType, void* data, PyObject* base)
+{
+  int type = numpyTypeOf(dataType);
+
+  std::vector<npy_intp> npyDims(dims.size());
+  for(unsigned iDim=0; iDim < dims.size(); iDim++)
+    npyDims[iDim] = dims[iDim];
+
+  PyObject* obj = PyArray_SimpleNewFromData(dims.size(), &npyDims[0], type, data);
+
+  if(obj == 0) {
+    ThrowError("Unable to create array view");
+  }
+
+  ((PyArrayObject*)obj)->flags &= ~NPY_WRITEABLE;
+
+  if(base != 0) {
+    Py_INCREF(base);
+    ((PyArrayObject*)obj)->base = base;
+  }
+
+  return obj;
+}
 #endif
 
 PyObject* PyHandler::getArray(unsigned len, DataType::Type type, char** data)
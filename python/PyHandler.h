@@ -89,6 +89,11 @@ namespace gcp {
       static PyObject* getNumPyArray(std::vector<int> dims, gcp::util::DataType::Type dataType, char** data=0);
       static PyObject* getNumPyArray(unsigned len, gcp::util::DataType::Type dataType, char** data=0);
       static std::vector<npy_intp> getNumPyInds(std::vector<int>& dims);
+
+      // Return a read-only array that views (rather than copies)
+      // data.  base is kept alive for as long as the view exists
+
+      static PyObject* getNumPyView(std::vector<int> dims, gcp::util::DataType::Type dataType, void* data, PyObject* base);
 #endif
 
     }; // End class PyHandler
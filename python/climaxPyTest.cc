@@ -878,7 +878,8 @@ static PyObject* newRunManager(PyObject* self, PyObject* args)
  */
 static PyObject* delRunManager(PyObject* self, PyObject* args)
 {
-  gcp::util::RunManager* rm = new RunManager();
+  PyObject* obj  = PyParser::getArrayItem(args, 0);
+  RunManager* rm = (RunManager*)PyCObject_AsVoidPtr(obj);
   delete rm;
   rm = 0;
   return args;
@@ -1034,6 +1035,233 @@ static PyObject* lnLikelihood(PyObject* self, PyObject* args)
   }
 }
 
+/**.......................................................................
+ * SPYDOC
+ *
+ * Return the log likelihoods of a batch of parameter vectors
+ * 
+ * Use like: 
+ * 
+ *    lnlike = climaxPyTest.lnLikelihoodBatch(rm, arr, nreplica)
+ *
+ * Where:
+ *
+ *    rm       -  is the run manager previously allocated by newRunManager()
+ * 
+ *    arr      -  is a 2D numpy double array of shape (nwalker, npar), each row
+ *                specified in the order and units returned by getVariableComponents()
+ *
+ *    nreplica -  (optional) the number of independent copies of the datasets and 
+ *                models over which the batch is evaluated in parallel (default 1).
+ *                Each replica holds its own copy of the data, so memory scales with nreplica
+ *
+ * Context:
+ *
+ *    After a parameter file has been loaded into the run manager, this 
+ *    function returns a 1D numpy array of the log likelihoods of each row of arr.
+ *    The Python interpreter lock is released during evaluation
+ *
+ * EPYDOC
+ */
+static PyObject* lnLikelihoodBatch(PyObject* self, PyObject* args)
+{
+  try {
+    PyObject* obj  = PyParser::getArrayItem(args, 0);
+    RunManager* rm = (RunManager*)PyCObject_AsVoidPtr(obj);
+
+    unsigned nReplica = 1;
+    if(PyParser::getSize(args) > 2) {
+      PyParser replicaParser(PyParser::getArrayItem(args, 2));
+      nReplica = replicaParser.getUintVal();
+    }
+
+    rm->setNReplica(nReplica);
+
+#if DIR_HAVE_NUMPY
+
+    //------------------------------------------------------------
+    // Get a C-contiguous double view of the input (this only copies
+    // if the input isn't one already)
+    //------------------------------------------------------------
+
+    PyObject* arr = PyArray_ContiguousFromObject(PyParser::getArrayItem(args, 1), PyArray_DOUBLE, 2, 2);
+
+    if(arr == 0)
+      ThrowError("Samples must be a 2D array of shape (nwalker, npar)");
+
+    unsigned nSample = PyParser::getNumpyLength(arr, 0);
+    unsigned nPar    = PyParser::getNumpyLength(arr, 1);
+    double* samples  = PyParser::getNumpyDoublePtr(arr, true);
+
+    char* cPtr = 0;
+    PyObject* ret  = getArray(nSample, DataType::DOUBLE, &cPtr);
+    double* lnLike = (double*)cPtr;
+
+    std::string error;
+
+    Py_BEGIN_ALLOW_THREADS
+    try {
+      rm->lnLikelihoodUnits(nSample, nPar, samples, lnLike);
+    } catch(Exception& err) {
+      error = err.what();
+    }
+    Py_END_ALLOW_THREADS
+
+    Py_DECREF(arr);
+
+    if(!error.empty()) {
+      Py_DECREF(ret);
+      ThrowError(error);
+    }
+
+    return ret;
+#else
+    ThrowError("Numpy environment is not defined");
+#endif
+
+  } catch(Exception& err) {
+    COUT(err.what());
+    PyObject* obj = Py_BuildValue("f", 0.0);
+    return obj;
+  }
+}
+
+/**.......................................................................
+ * SPYDOC
+ *
+ * Run a Markov chain in a previously allocated run manager
+ * 
+ * Use like: 
+ * 
+ *    climaxPyTest.runChain(rm, runFile)
+ *
+ * Where:
+ *
+ *    rm      -  is the run manager previously allocated by newRunManager()
+ *
+ *    runFile -  is the text file controlling the Markov chain run
+ *
+ * Context:
+ *
+ *    Unlike getChain(), the run manager (and the chain it stores) persists
+ *    after this call, so that the chain can be accessed without copying
+ *    through getChainView().  The Python interpreter lock is released
+ *    while the chain runs
+ *
+ * EPYDOC
+ */
+static PyObject* runChain(PyObject* self, PyObject* args)
+{
+  try {
+    PyObject* obj  = PyParser::getArrayItem(args, 0);
+    RunManager* rm = (RunManager*)PyCObject_AsVoidPtr(obj);
+
+    PyParser fileParser(PyParser::getArrayItem(args, 1));
+    std::string runFile = fileParser.getString();
+
+    std::string error;
+
+    Py_BEGIN_ALLOW_THREADS
+    try {
+      rm->setRunFile(runFile);
+      rm->run();
+    } catch(Exception& err) {
+      error = err.what();
+    }
+    Py_END_ALLOW_THREADS
+
+    if(!error.empty())
+      ThrowError(error);
+
+    return Py_BuildValue("i", rm->getChainLength());
+
+  } catch(Exception& err) {
+    COUTCOLOR(err.what(), "red");
+    PyObject* obj = Py_BuildValue("i", 0);
+    return obj;
+  }
+}
+
+/**.......................................................................
+ * SPYDOC
+ *
+ * Return the stored Markov chain as read-only numpy arrays, without copying
+ * 
+ * Use like: 
+ * 
+ *    dict = climaxPyTest.getChainView(rm)
+ *
+ * Where:
+ *
+ *    rm   -  is the run manager previously used by runChain()
+ *
+ *    dict -  is a dictionary of 1D arrays, one for each variable component,
+ *            plus lnLikelihood and multiplicity
+ *
+ * Context:
+ *
+ *    The arrays view memory owned by the run manager.  They remain valid
+ *    until the run manager is deleted with delRunManager() or used for 
+ *    another run; copy them (arr.copy()) if they need to outlive it
+ *
+ * EPYDOC
+ */
+static PyObject* getChainView(PyObject* self, PyObject* args)
+{
+  PyObject* ret = 0;
+
+  try {
+    PyObject* obj  = PyParser::getArrayItem(args, 0);
+    RunManager* rm = (RunManager*)PyCObject_AsVoidPtr(obj);
+
+#if DIR_HAVE_NUMPY
+    std::vector<int> dims(1);
+    dims[0] = rm->getChainLength();
+
+    ret = PyDict_New();
+
+    std::map<std::string, Model::VarVal> valueMap = rm->listModel();
+
+    for(std::map<std::string, Model::VarVal>::iterator iter=valueMap.begin(); iter != valueMap.end(); iter++) {
+      if(iter->second.isFixed_)
+	continue;
+
+      std::vector<double>& chain = rm->getChain(iter->first);
+
+      if(chain.size() < (unsigned)dims[0])
+	ThrowError("Chain for " << iter->first << " is shorter than the chain length");
+
+      PyObject* view = PyHandler::getNumPyView(dims, DataType::DOUBLE, chain.size() > 0 ? &chain[0] : 0, obj);
+      PyDict_SetItemString(ret, iter->first.c_str(), view);
+      Py_DECREF(view);
+    }
+
+    std::vector<double>& lnLike = rm->getLnLikelihoods();
+    std::vector<unsigned>& mult = rm->getMultiplicities();
+
+    if(lnLike.size() < (unsigned)dims[0] || mult.size() < (unsigned)dims[0])
+      ThrowError("Likelihood or multiplicity arrays are shorter than the chain length");
+
+    PyObject* view = PyHandler::getNumPyView(dims, DataType::DOUBLE, lnLike.size() > 0 ? &lnLike[0] : 0, obj);
+    PyDict_SetItemString(ret, "lnLikelihood", view);
+    Py_DECREF(view);
+
+    view = PyHandler::getNumPyView(dims, DataType::UINT, mult.size() > 0 ? &mult[0] : 0, obj);
+    PyDict_SetItemString(ret, "multiplicity", view);
+    Py_DECREF(view);
+#else
+    ThrowError("Numpy environment is not defined");
+#endif
+
+  } catch(Exception& err) {
+    COUTCOLOR(err.what(), "red");
+    Py_XDECREF(ret);
+    ret = PyDict_New();
+  }
+
+  return ret;
+}
+
 static PyObject* pgplotTest(PyObject* self, PyObject* args)
 {
   cpgslct(1);
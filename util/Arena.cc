@@ -0,0 +1,196 @@
+#include "gcp/util/Arena.h"
+#include "gcp/util/Exception.h"
+
+#include <cstdlib>
+
+using namespace std;
+
+using namespace gcp::util;
+
+unsigned          Arena::iterationCount_ = 0;
+Mutex             Arena::iterationGuard_;
+pthread_key_t     Arena::key_;
+pthread_once_t    Arena::keyOnce_ = PTHREAD_ONCE_INIT;
+
+/**.......................................................................
+ * Constructor.
+ */
+Arena::Arena(size_t blockSize)
+{
+  blockSize_ = blockSize;
+  iBlock_    = 0;
+  offset_    = 0;
+  nLive_     = 0;
+  iteration_ = iterationCount();
+}
+
+/**.......................................................................
+ * Destructor.
+ */
+Arena::~Arena()
+{
+  freeBlocks();
+}
+
+/**.......................................................................
+ * Allocate memory from this arena
+ */
+void* Arena::allocate(size_t nByte)
+{
+  nByte = (nByte + 15) & ~((size_t)15);
+
+  //------------------------------------------------------------
+  // Move on to the next block that can hold this allocation,
+  // adding a new one if none can
+  //------------------------------------------------------------
+
+  while(iBlock_ < blocks_.size() && offset_ + nByte > blocks_[iBlock_].size_) {
+    ++iBlock_;
+    offset_ = 0;
+  }
+
+  if(iBlock_ == blocks_.size()) {
+    Block block;
+    block.size_ = nByte > blockSize_ ? nByte : blockSize_;
+
+    if((block.data_ = (char*)malloc(block.size_)) == 0)
+      ThrowSysError("malloc");
+
+    blocks_.push_back(block);
+    offset_ = 0;
+  }
+
+  void* ptr = blocks_[iBlock_].data_ + offset_;
+  offset_ += nByte;
+  ++nLive_;
+
+  return ptr;
+}
+
+/**.......................................................................
+ * Release memory.  When nothing is outstanding, rewind to the start
+ * of the first block
+ */
+void Arena::deallocate(void* ptr)
+{
+  if(ptr == 0)
+    return;
+
+  if(nLive_ > 0 && --nLive_ == 0)
+    rewind();
+}
+
+/**.......................................................................
+ * Rewind the arena.  If we needed more than one block, replace them
+ * with a single block big enough to hold them all
+ */
+void Arena::reset()
+{
+  if(nLive_ > 0)
+    ThrowError("Attempt to reset an arena with " << nLive_ << " outstanding allocations");
+
+  if(blocks_.size() > 1) {
+    Block block;
+    block.size_ = capacity();
+
+    freeBlocks();
+
+    if((block.data_ = (char*)malloc(block.size_)) == 0)
+      ThrowSysError("malloc");
+
+    blocks_.push_back(block);
+  }
+
+  rewind();
+}
+
+void Arena::rewind()
+{
+  iBlock_ = 0;
+  offset_ = 0;
+}
+
+void Arena::freeBlocks()
+{
+  for(unsigned i=0; i < blocks_.size(); i++)
+    free(blocks_[i].data_);
+
+  blocks_.resize(0);
+}
+
+/**.......................................................................
+ * Return the total size of all blocks in this arena
+ */
+size_t Arena::capacity()
+{
+  size_t size = 0;
+
+  for(unsigned i=0; i < blocks_.size(); i++)
+    size += blocks_[i].size_;
+
+  return size;
+}
+
+/**.......................................................................
+ * Mark the start of a new iteration
+ */
+void Arena::nextIteration()
+{
+  iterationGuard_.lock();
+  ++iterationCount_;
+  iterationGuard_.unlock();
+}
+
+/**.......................................................................
+ * Return the current iteration.  Workers read this while the thread
+ * driving the chain may be advancing it
+ */
+unsigned Arena::iterationCount()
+{
+  iterationGuard_.lock();
+  unsigned iteration = iterationCount_;
+  iterationGuard_.unlock();
+
+  return iteration;
+}
+
+/**.......................................................................
+ * Return the calling thread's arena, creating it on first use, and
+ * resetting it if a new iteration has started since we last saw it
+ */
+Arena& Arena::threadArena()
+{
+  pthread_once(&keyOnce_, &createKey);
+
+  Arena* arena = (Arena*)pthread_getspecific(key_);
+
+  if(arena == 0) {
+    arena = new Arena();
+    pthread_setspecific(key_, arena);
+  }
+
+  //------------------------------------------------------------
+  // Temporaries from the last iteration should all have been
+  // released by now, but if one hasn't, leave the arena alone
+  // rather than hand out memory that is still in use
+  //------------------------------------------------------------
+
+  unsigned iteration = iterationCount();
+
+  if(arena->iteration_ != iteration && arena->nLive_ == 0) {
+    arena->reset();
+    arena->iteration_ = iteration;
+  }
+
+  return *arena;
+}
+
+void Arena::createKey()
+{
+  pthread_key_create(&key_, &deleteArena);
+}
+
+void Arena::deleteArena(void* arena)
+{
+  delete (Arena*)arena;
+}
@@ -0,0 +1,193 @@
+// $Id: $
+
+#ifndef GCP_UTIL_ARENA_H
+#define GCP_UTIL_ARENA_H
+
+/**
+ * @file Arena.h
+ *
+ * Tagged: Tue Oct 20 09:12:48 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include <pthread.h>
+
+#include "gcp/util/Mutex.h"
+
+namespace gcp {
+  namespace util {
+
+    //-----------------------------------------------------------------------
+    // A monotonic (bump-pointer) allocator for short-lived
+    // temporaries.
+    //
+    // Memory is handed out from a list of blocks and is never freed
+    // individually.  Instead, the arena rewinds to the start of its
+    // first block whenever the last outstanding allocation is
+    // released, and at the start of each iteration (see
+    // nextIteration()).  At an iteration boundary, any overflow
+    // blocks are coalesced into a single block large enough for
+    // everything the previous iteration needed, so that once the
+    // working set has been seen, allocation costs no calls to malloc.
+    //
+    // Each thread has its own arena (threadArena()), so no locking
+    // is needed, except to read the iteration count, which is shared.
+    //-----------------------------------------------------------------------
+
+    class Arena {
+    public:
+
+      static const size_t defaultBlockSize_ = 64 * 1024;
+
+      /**
+       * Constructor.
+       */
+      Arena(size_t blockSize=defaultBlockSize_);
+
+      /**
+       * Destructor.
+       */
+      virtual ~Arena();
+
+      // Allocate (16-byte aligned) memory from this arena
+
+      void* allocate(size_t nByte);
+
+      // Release memory.  This only decrements the count of
+      // outstanding allocations
+
+      void deallocate(void* ptr);
+
+      // Rewind the arena, coalescing any overflow blocks.  This must
+      // only be called when no allocations are outstanding
+
+      void reset();
+
+      size_t capacity();
+      unsigned nBlock() {
+	return blocks_.size();
+      }
+
+      // Return the arena belonging to the calling thread
+
+      static Arena& threadArena();
+
+      // Mark the start of a new iteration.  Each thread's arena is
+      // reset the next time that thread requests it
+
+      static void nextIteration();
+
+    private:
+
+      struct Block {
+	char* data_;
+	size_t size_;
+      };
+
+      std::vector<Block> blocks_;
+
+      size_t blockSize_;
+      unsigned iBlock_;   // The block we are currently allocating from
+      size_t offset_;     // The offset of the next free byte in it
+      unsigned nLive_;    // The number of outstanding allocations
+      unsigned iteration_;
+
+      static unsigned iterationCount_;
+      static Mutex iterationGuard_;
+      static pthread_key_t key_;
+      static pthread_once_t keyOnce_;
+
+      static unsigned iterationCount();
+      static void createKey();
+      static void deleteArena(void* arena);
+
+      void rewind();
+      void freeBlocks();
+
+    }; // End class Arena
+
+    //-----------------------------------------------------------------------
+    // An STL allocator that allocates from an Arena, for containers
+    // of per-iteration temporaries, e.g.:
+    //
+    //   std::vector<double, ArenaAllocator<double> > buf(n);
+    //
+    // Containers must not outlive the iteration in which they were
+    // created
+    //-----------------------------------------------------------------------
+
+    template<class T>
+      class ArenaAllocator {
+      public:
+
+      typedef T         value_type;
+      typedef T*        pointer;
+      typedef const T*  const_pointer;
+      typedef T&        reference;
+      typedef const T&  const_reference;
+      typedef size_t    size_type;
+      typedef ptrdiff_t difference_type;
+
+      template<class U>
+	struct rebind {
+	  typedef ArenaAllocator<U> other;
+	};
+
+      ArenaAllocator() throw() : arena_(&Arena::threadArena()) {}
+      ArenaAllocator(Arena& arena) throw() : arena_(&arena) {}
+      ArenaAllocator(const ArenaAllocator& alloc) throw() : arena_(alloc.arena_) {}
+
+      template<class U>
+	ArenaAllocator(const ArenaAllocator<U>& alloc) throw() : arena_(alloc.arena_) {}
+
+      pointer address(reference x) const {
+	return &x;
+      }
+
+      const_pointer address(const_reference x) const {
+	return &x;
+      }
+
+      pointer allocate(size_type n, const void* hint=0) {
+	return (pointer)arena_->allocate(n * sizeof(T));
+      }
+
+      void deallocate(pointer p, size_type n) {
+	arena_->deallocate(p);
+      }
+
+      size_type max_size() const throw() {
+	return ((size_t)-1) / sizeof(T);
+      }
+
+      void construct(pointer p, const T& val) {
+	new((void*)p) T(val);
+      }
+
+      void destroy(pointer p) {
+	p->~T();
+      }
+
+      Arena* arena_;
+    };
+
+    template<class T, class U>
+      bool operator==(const ArenaAllocator<T>& a1, const ArenaAllocator<U>& a2) {
+      return a1.arena_ == a2.arena_;
+    }
+
+    template<class T, class U>
+      bool operator!=(const ArenaAllocator<T>& a1, const ArenaAllocator<U>& a2) {
+      return a1.arena_ != a2.arena_;
+    }
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_ARENA_H
@@ -11,6 +11,12 @@ using namespace gcp::util;
 
 const double Cosmology::eps_ = 1e-12;
 
+// Initial node spacing of distance tables, in ln(1+z), and the
+// largest ln(1+z) we will tabulate to
+
+const double Cosmology::tableDx0_  = 0.05;
+const double Cosmology::tableXMax_ = log(1.0 + 1e4);
+
 /**.......................................................................
  * Constructor.
  */
@@ -28,6 +34,9 @@ Cosmology::Cosmology()
   setParameter("omegaL", "0.7");
 
   initializeGslMembers();
+
+  table_.valid_ = false;
+  tableTol_     = 1e-8;
 }
 
 /**.......................................................................
@@ -245,13 +254,7 @@ Length Cosmology::comovingDistance()
 
 Length Cosmology::comovingDistance(double z)
 {
-  double result, abserr;
-
-  gsl_integration_qags(&gslComovingFn_, 0, z, 
-		       gslEpsAbs_, gslEpsRel_, gslLimit_, 
-		       gslWork_, &result, &abserr);
-
-  return hubbleDistance() * result;
+  return hubbleDistance() * distanceIntegral(z, true);
 }
 
 /**.......................................................................
@@ -321,14 +324,242 @@ Length Cosmology::lightTravelDistance()
 }
 
 Length Cosmology::lightTravelDistance(double z)
+{
+  return hubbleDistance() * distanceIntegral(z, false);
+}
+
+/**.......................................................................
+ * Set the relative tolerance of tabulated distances.  A tolerance <= 0
+ * disables tabulation
+ */
+void Cosmology::setDistanceTableTolerance(double relTol)
+{
+  distanceGuard_.lock();
+
+  tableTol_     = relTol;
+  table_.valid_ = false;
+
+  distanceGuard_.unlock();
+}
+
+/**.......................................................................
+ * Return the dimensionless comoving (or light-travel) distance
+ * integral to redshift z, from the table if we can, or by direct
+ * integration if not
+ */
+double Cosmology::distanceIntegral(double z, bool comoving)
+{
+  double result;
+
+  distanceGuard_.lock();
+
+  try {
+
+    double x = log(1.0 + z);
+
+    if(tableTol_ <= 0.0 || z < 0.0 || x > tableXMax_) {
+      result = integrateDirectly(z, comoving);
+    } else {
+
+      //------------------------------------------------------------
+      // The integrals depend only on omegaM and omegaL (H0 just
+      // scales the Hubble distance), so only rebuild if these have
+      // changed, or we need to extend the table to higher z
+      //------------------------------------------------------------
+
+      bool sameCosmology = table_.valid_ && table_.omegaM_ == omegaM_ && table_.omegaL_ == omegaL_;
+      double xTableMax   = table_.valid_ ? (table_.comoving_.size()-1) * table_.dx_ : 0.0;
+
+      if(!sameCosmology || x > xTableMax) {
+
+	double xMax = 1.5 * x;
+
+	if(xMax < log(2.0))
+	  xMax = log(2.0);
+
+	if(sameCosmology && xMax < 2 * xTableMax)
+	  xMax = 2 * xTableMax;
+
+	if(xMax > tableXMax_)
+	  xMax = tableXMax_;
+
+	table_.omegaM_ = omegaM_;
+	table_.omegaL_ = omegaL_;
+
+	buildDistanceTable(xMax);
+      }
+
+      if(comoving)
+	result = interpolate(table_.comoving_, table_.comovingDeriv_, x);
+      else
+	result = interpolate(table_.lightTravel_, table_.lightTravelDeriv_, x);
+    }
+
+  } catch(...) {
+    table_.valid_ = false;
+    distanceGuard_.unlock();
+    throw;
+  }
+
+  distanceGuard_.unlock();
+
+  return result;
+}
+
+/**.......................................................................
+ * Integrate the comoving (or light-travel) distance kernel directly
+ */
+double Cosmology::integrateDirectly(double z, bool comoving)
 {
   double result, abserr;
 
-  gsl_integration_qags(&gslLightTravelFn_, 0, z, 
+  gsl_integration_qags(comoving ? &gslComovingFn_ : &gslLightTravelFn_, 0, z, 
 		       gslEpsAbs_, gslEpsRel_, gslLimit_, 
 		       gslWork_, &result, &abserr);
 
-  return hubbleDistance() * result;
+  return result;
+}
+
+/**.......................................................................
+ * Build a table out to xMax = ln(1+zMax), halving the node spacing
+ * until the interpolation error is within tolerance
+ */
+void Cosmology::buildDistanceTable(double xMax)
+{
+  double dx = tableDx0_;
+
+  fillDistanceTable(xMax, dx);
+
+  while(tableError() > tableTol_ && dx > 1e-4) {
+    dx /= 2;
+    fillDistanceTable(xMax, dx);
+  }
+
+  table_.valid_ = true;
+}
+
+/**.......................................................................
+ * Fill the table at nodes spaced by dx in ln(1+z)
+ */
+void Cosmology::fillDistanceTable(double xMax, double dx)
+{
+  unsigned n = (unsigned)ceil(xMax / dx) + 1;
+
+  table_.dx_ = dx;
+
+  table_.comoving_.resize(n);
+  table_.comovingDeriv_.resize(n);
+  table_.lightTravel_.resize(n);
+  table_.lightTravelDeriv_.resize(n);
+
+  table_.comoving_[0]    = 0.0;
+  table_.lightTravel_[0] = 0.0;
+
+  integrandsAtX(0.0, table_.comovingDeriv_[0], table_.lightTravelDeriv_[0]);
+
+  double comoving, lightTravel;
+
+  for(unsigned i=1; i < n; i++) {
+
+    integrateInterval((i-1) * dx, i * dx, comoving, lightTravel);
+
+    table_.comoving_[i]    = table_.comoving_[i-1]    + comoving;
+    table_.lightTravel_[i] = table_.lightTravel_[i-1] + lightTravel;
+
+    integrandsAtX(i * dx, table_.comovingDeriv_[i], table_.lightTravelDeriv_[i]);
+  }
+}
+
+/**.......................................................................
+ * Return the maximum relative error of the interpolated integrals, at
+ * the midpoints between nodes
+ */
+double Cosmology::tableError()
+{
+  double dx = table_.dx_;
+  double maxErr = 0.0, err;
+  double comoving, lightTravel;
+
+  for(unsigned i=0; i < table_.comoving_.size()-1; i++) {
+
+    double x = (i + 0.5) * dx;
+
+    integrateInterval(i * dx, x, comoving, lightTravel);
+
+    comoving    += table_.comoving_[i];
+    lightTravel += table_.lightTravel_[i];
+
+    err = fabs(interpolate(table_.comoving_, table_.comovingDeriv_, x) - comoving) / comoving;
+    maxErr = err > maxErr ? err : maxErr;
+
+    err = fabs(interpolate(table_.lightTravel_, table_.lightTravelDeriv_, x) - lightTravel) / lightTravel;
+    maxErr = err > maxErr ? err : maxErr;
+  }
+
+  return maxErr;
+}
+
+/**.......................................................................
+ * Cubic Hermite interpolation of a tabulated function of x
+ */
+double Cosmology::interpolate(std::vector<double>& val, std::vector<double>& deriv, double x)
+{
+  double dx = table_.dx_;
+  unsigned i = (unsigned)(x / dx);
+
+  if(i > val.size()-2)
+    i = val.size()-2;
+
+  double t  = (x - i * dx) / dx;
+  double t2 = t * t;
+  double t3 = t2 * t;
+
+  return (2*t3 - 3*t2 + 1) * val[i] + (t3 - 2*t2 + t) * dx * deriv[i] 
+    + (3*t2 - 2*t3) * val[i+1] + (t3 - t2) * dx * deriv[i+1];
+}
+
+/**.......................................................................
+ * Return the derivatives with respect to x = ln(1+z) of the comoving
+ * and light-travel integrals, for the tabulated cosmology
+ */
+void Cosmology::integrandsAtX(double x, double& comoving, double& lightTravel)
+{
+  double z1 = exp(x);
+  double ok = 1.0 - (table_.omegaM_ + table_.omegaL_);
+  double e  = sqrt(((table_.omegaM_ * z1) + ok) * z1 * z1 + table_.omegaL_);
+
+  // dz = (1+z) dx
+
+  comoving    = z1 / e;
+  lightTravel = 1.0 / e;
+}
+
+/**.......................................................................
+ * Integrate both kernels between x1 and x2, with 5-point
+ * Gauss-Legendre quadrature.  The integrands are smooth in x, and
+ * intervals are small, so this is accurate to well below any table
+ * tolerance we would use
+ */
+void Cosmology::integrateInterval(double x1, double x2, double& comoving, double& lightTravel)
+{
+  static const double abscissa[5] = {0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640};
+  static const double weight[5]   = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891};
+
+  double half = (x2 - x1) / 2;
+  double mid  = (x2 + x1) / 2;
+  double c, l;
+
+  comoving    = 0.0;
+  lightTravel = 0.0;
+
+  for(unsigned i=0; i < 5; i++) {
+    integrandsAtX(mid + half * abscissa[i], c, l);
+    comoving    += weight[i] * c;
+    lightTravel += weight[i] * l;
+  }
+
+  comoving    *= half;
+  lightTravel *= half;
 }
 
 /**.......................................................................
@@ -15,10 +15,13 @@
 #include "gcp/util/Density.h"
 #include "gcp/util/HubbleConstant.h"
 #include "gcp/util/Length.h"
+#include "gcp/util/Mutex.h"
 #include "gcp/util/ParameterManager.h"
 
 #include "gsl/gsl_integration.h"
 
+#include <vector>
+
 namespace gcp {
   namespace util {
 
@@ -88,6 +91,14 @@ namespace gcp {
       Density criticalDensity();
       Density criticalDensity(double z);
 
+      // Distance integrals are tabulated for the current omegaM and
+      // omegaL, and reused until either changes.  The table is
+      // refined until interpolation errors are below relTol.  Set
+      // relTol <= 0 to disable tabulation, and integrate every
+      // distance directly
+
+      void setDistanceTableTolerance(double relTol);
+
       void setParameter(std::string name, std::string val, std::string units=" ", bool external=true);
 
       void checkParameter(std::string par);
@@ -127,6 +138,45 @@ namespace gcp {
 
       static double evaluateComovingDistanceKernel(double z, void* params=0);
       static double evaluateLightTravelDistanceKernel(double z, void* params=0);
+
+      //------------------------------------------------------------
+      // Tabulated distance integrals.  The dimensionless comoving
+      // and light-travel integrals (in units of the Hubble distance)
+      // are stored at nodes evenly spaced in x = ln(1+z), with their
+      // derivatives, which the integrands give exactly, so that we
+      // can use cubic Hermite interpolation between nodes
+      //------------------------------------------------------------
+
+      struct DistanceTable {
+	bool valid_;
+	double omegaM_;
+	double omegaL_;
+	double dx_;
+	std::vector<double> comoving_;
+	std::vector<double> comovingDeriv_;
+	std::vector<double> lightTravel_;
+	std::vector<double> lightTravelDeriv_;
+      };
+
+      DistanceTable table_;
+      double tableTol_;
+
+      // Guards the table and the GSL workspace, so that distances can
+      // be requested from multiple threads
+
+      Mutex distanceGuard_;
+
+      static const double tableDx0_;
+      static const double tableXMax_;
+
+      double distanceIntegral(double z, bool comoving);
+      double integrateDirectly(double z, bool comoving);
+      void buildDistanceTable(double xMax);
+      void fillDistanceTable(double xMax, double dx);
+      double tableError();
+      double interpolate(std::vector<double>& val, std::vector<double>& deriv, double x);
+      void integrandsAtX(double x, double& comoving, double& lightTravel);
+      void integrateInterval(double x1, double x2, double& comoving, double& lightTravel);
       
     }; // End class Cosmology
 
@@ -37,4 +37,6 @@
  
 #define DIR_HAVE_NUMPY (HAVE_NUMPY)
 
+#define DIR_FFTW_SINGLE_PRECISION (FFTW_SINGLE_PRECISION)
+
 #endif // End #ifndef GCP_UTIL_DIRECTIVES_H
@@ -0,0 +1,432 @@
+#include "gcp/util/PerfCounters.h"
+#include "gcp/util/Exception.h"
+#include "gcp/util/Profiler.h"
+
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#if MAC_OSX == 0
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace std;
+
+using namespace gcp::util;
+
+volatile bool                                PerfCounters::enabled_ = false;
+std::vector<PerfCounters::ThreadCounters*>   PerfCounters::threads_;
+Mutex                                        PerfCounters::guard_;
+pthread_key_t                                PerfCounters::key_;
+pthread_once_t                               PerfCounters::keyOnce_ = PTHREAD_ONCE_INIT;
+__thread PerfCounters::ThreadCounters*       PerfCounters::counters_ = 0;
+
+static const char* counterNames[PerfCounters::NCOUNTER] = {
+  "cycles", "instructions", "LLC references", "LLC misses", "LLC load misses"
+};
+
+/**.......................................................................
+ * Constructor.
+ */
+PerfCounters::Counts::Counts()
+{
+  nCall_       = 0;
+  ns_          = 0;
+  timeEnabled_ = 0;
+  timeRunning_ = 0;
+
+  for(unsigned i=0; i < NCOUNTER; i++)
+    val_[i] = 0;
+}
+
+/**.......................................................................
+ * Accumulate counts
+ */
+void PerfCounters::Counts::operator+=(const Counts& counts)
+{
+  nCall_       += counts.nCall_;
+  ns_          += counts.ns_;
+  timeEnabled_ += counts.timeEnabled_;
+  timeRunning_ += counts.timeRunning_;
+
+  for(unsigned i=0; i < NCOUNTER; i++)
+    val_[i] += counts.val_[i];
+}
+
+/**.......................................................................
+ * Return a count, corrected for the fraction of time the group was
+ * actually counting
+ */
+double PerfCounters::Counts::scaled(Counter counter) const
+{
+  if(timeRunning_ == 0)
+    return 0.0;
+
+  return (double)val_[counter] * (double)timeEnabled_ / (double)timeRunning_;
+}
+
+/**.......................................................................
+ * Enable counting
+ */
+bool PerfCounters::enable()
+{
+#if MAC_OSX == 0
+  enabled_ = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**.......................................................................
+ * Disable counting.  Phases that are already open will still be
+ * accumulated when they close
+ */
+void PerfCounters::disable()
+{
+  enabled_ = false;
+}
+
+/**.......................................................................
+ * Discard accumulated counts
+ */
+void PerfCounters::reset()
+{
+  guard_.lock();
+
+  for(unsigned iThread=0; iThread < threads_.size(); iThread++) {
+    ThreadCounters* tc = threads_[iThread];
+    for(unsigned iPhase=0; iPhase < tc->counts_.size(); iPhase++)
+      tc->counts_[iPhase] = Counts();
+  }
+
+  guard_.unlock();
+}
+
+/**.......................................................................
+ * Register counters for the calling thread
+ */
+PerfCounters::ThreadCounters* PerfCounters::registerThread()
+{
+  ThreadCounters* tc = new ThreadCounters();
+
+  openCounters(tc);
+
+  guard_.lock();
+  tc->id_ = threads_.size();
+  threads_.push_back(tc);
+  guard_.unlock();
+
+  //------------------------------------------------------------
+  // Arrange for the counters to be closed when this thread exits
+  //------------------------------------------------------------
+
+  pthread_once(&keyOnce_, &createKey);
+  pthread_setspecific(key_, tc);
+
+  return tc;
+}
+
+void PerfCounters::createKey()
+{
+  pthread_key_create(&key_, &closeCounters);
+}
+
+/**.......................................................................
+ * Close the counter group of an exiting thread.  Its accumulated
+ * counts are kept until the next report
+ */
+void PerfCounters::closeCounters(void* arg)
+{
+  ThreadCounters* tc = (ThreadCounters*)arg;
+
+  guard_.lock();
+
+  tc->ok_     = false;
+  tc->leader_ = -1;
+
+  for(unsigned i=0; i < NCOUNTER; i++) {
+    if(tc->fd_[i] >= 0) {
+      close(tc->fd_[i]);
+      tc->fd_[i] = -1;
+    }
+  }
+
+  guard_.unlock();
+}
+
+#if MAC_OSX == 0
+/**.......................................................................
+ * Open a single counter for the calling thread
+ */
+static int openCounter(unsigned type, unsigned long long config, int groupFd)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  attr.size           = sizeof(attr);
+  attr.type           = type;
+  attr.config         = config;
+  attr.disabled       = groupFd < 0 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+#endif
+
+/**.......................................................................
+ * Open the counter group for the calling thread.  Cycles lead the
+ * group; any other counter that cannot be opened is left out
+ */
+void PerfCounters::openCounters(ThreadCounters* tc)
+{
+  tc->ok_     = false;
+  tc->leader_ = -1;
+  tc->nOpen_  = 0;
+
+  for(unsigned i=0; i < NCOUNTER; i++)
+    tc->fd_[i] = -1;
+
+#if MAC_OSX == 0
+  unsigned type[NCOUNTER] = {
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HW_CACHE
+  };
+
+  unsigned long long config[NCOUNTER] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_REFERENCES,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+  };
+
+  tc->leader_ = openCounter(type[CYCLES], config[CYCLES], -1);
+
+  if(tc->leader_ < 0) {
+    COUTCOLOR("Unable to open hardware counters for this thread: " << strerror(errno)
+	      << " (check /proc/sys/kernel/perf_event_paranoid)", "yellow");
+    return;
+  }
+
+  tc->fd_[CYCLES] = tc->leader_;
+  tc->index_[tc->nOpen_++] = CYCLES;
+
+  for(unsigned i=CYCLES+1; i < NCOUNTER; i++) {
+    tc->fd_[i] = openCounter(type[i], config[i], tc->leader_);
+
+    if(tc->fd_[i] >= 0)
+      tc->index_[tc->nOpen_++] = i;
+  }
+
+  ioctl(tc->leader_, PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+  ioctl(tc->leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+  tc->ok_ = true;
+#endif
+}
+
+/**.......................................................................
+ * Read the whole counter group in one call
+ */
+bool PerfCounters::readCounters(ThreadCounters* tc, unsigned long long* val,
+				unsigned long long& timeEnabled, unsigned long long& timeRunning)
+{
+  if(!tc->ok_)
+    return false;
+
+  // nr, time_enabled, time_running, then one value per counter
+
+  unsigned long long buf[3 + NCOUNTER];
+
+  ssize_t nExpected = (3 + tc->nOpen_) * sizeof(unsigned long long);
+
+  if(read(tc->leader_, buf, sizeof(buf)) != nExpected)
+    return false;
+
+  timeEnabled = buf[1];
+  timeRunning = buf[2];
+
+  for(unsigned i=0; i < NCOUNTER; i++)
+    val[i] = 0;
+
+  for(unsigned i=0; i < tc->nOpen_; i++)
+    val[tc->index_[i]] = buf[3+i];
+
+  return true;
+}
+
+/**.......................................................................
+ * Enter a phase
+ */
+void PerfCounters::start(Phase& phase)
+{
+  if(counters_ == 0)
+    counters_ = registerThread();
+
+  if(!readCounters(counters_, phase.val_, phase.timeEnabled_, phase.timeRunning_)) {
+    phase.name_ = 0;
+    return;
+  }
+
+  phase.ns_ = Profiler::now();
+}
+
+/**.......................................................................
+ * Leave a phase, accumulating the counter deltas into this thread's
+ * entry for it
+ */
+void PerfCounters::stop(Phase& phase)
+{
+  unsigned long long ns = Profiler::now();
+  unsigned long long val[NCOUNTER];
+  unsigned long long timeEnabled, timeRunning;
+
+  ThreadCounters* tc = counters_;
+
+  if(!readCounters(tc, val, timeEnabled, timeRunning))
+    return;
+
+  //------------------------------------------------------------
+  // Phases are few, so a linear search on the name pointer is
+  // cheaper than anything cleverer
+  //------------------------------------------------------------
+
+  unsigned iPhase = 0;
+  for(iPhase=0; iPhase < tc->names_.size(); iPhase++) {
+    if(tc->names_[iPhase] == phase.name_)
+      break;
+  }
+
+  if(iPhase == tc->names_.size()) {
+    guard_.lock();
+    tc->names_.push_back(phase.name_);
+    tc->counts_.push_back(Counts());
+    guard_.unlock();
+  }
+
+  Counts& counts = tc->counts_[iPhase];
+
+  counts.nCall_       += 1;
+  counts.ns_          += ns - phase.ns_;
+  counts.timeEnabled_ += timeEnabled - phase.timeEnabled_;
+  counts.timeRunning_ += timeRunning - phase.timeRunning_;
+
+  for(unsigned i=0; i < NCOUNTER; i++)
+    counts.val_[i] += val[i] - phase.val_[i];
+}
+
+/**.......................................................................
+ * Print a single row of the report
+ */
+void PerfCounters::printRow(std::ostream& os, std::string name, std::string thread, const Counts& counts)
+{
+  double cycles  = counts.scaled(CYCLES);
+  double instr   = counts.scaled(INSTRUCTIONS);
+  double refs    = counts.scaled(LLC_REFS);
+  double misses  = counts.scaled(LLC_MISSES);
+  double loads   = counts.scaled(LLC_LOAD_MISSES);
+  double seconds = (double)counts.ns_ / 1e9;
+
+  //------------------------------------------------------------
+  // LLC misses are each (at least) one 64-byte line fetched from
+  // memory, which gives a lower bound on DRAM traffic.  Load misses
+  // are reported separately, since the difference is mostly
+  // store and prefetch traffic
+  //------------------------------------------------------------
+
+  os << std::left  << std::setw(32) << name
+     << std::setw(8)  << thread << std::right
+     << std::setw(10) << counts.nCall_
+     << std::setw(10) << std::setprecision(3) << seconds
+     << std::setw(10) << std::setprecision(3) << cycles / 1e9
+     << std::setw(8)  << std::setprecision(2) << (cycles > 0 ? instr / cycles : 0.0)
+     << std::setw(10) << std::setprecision(2) << (refs > 0 ? 100 * misses / refs : 0.0)
+     << std::setw(8)  << std::setprecision(2) << (instr > 0 ? 1000 * misses / instr : 0.0)
+     << std::setw(8)  << std::setprecision(2) << (instr > 0 ? 1000 * loads / instr : 0.0)
+     << std::setw(10) << std::setprecision(2) << (seconds > 0 ? 64 * misses / seconds / 1e9 : 0.0)
+     << std::endl;
+}
+
+/**.......................................................................
+ * Print the accumulated counts, first summed over threads for each
+ * phase, then broken down by thread.  Should be called while no
+ * instrumented code is running
+ */
+void PerfCounters::report(std::ostream& os)
+{
+  guard_.lock();
+
+  std::map<std::string, Counts> totals;
+  std::map<std::string, std::vector<std::pair<unsigned, Counts> > > perThread;
+
+  bool have[NCOUNTER];
+  for(unsigned i=0; i < NCOUNTER; i++)
+    have[i] = false;
+
+  for(unsigned iThread=0; iThread < threads_.size(); iThread++) {
+    ThreadCounters* tc = threads_[iThread];
+
+    for(unsigned i=0; i < tc->nOpen_; i++)
+      have[tc->index_[i]] = true;
+
+    for(unsigned iPhase=0; iPhase < tc->names_.size(); iPhase++) {
+      totals[tc->names_[iPhase]] += tc->counts_[iPhase];
+      perThread[tc->names_[iPhase]].push_back(std::pair<unsigned, Counts>(tc->id_, tc->counts_[iPhase]));
+    }
+  }
+
+  guard_.unlock();
+
+  if(totals.size() == 0) {
+    os << "No hardware counter data was recorded" << std::endl;
+    return;
+  }
+
+  std::ostringstream missing;
+  for(unsigned i=0; i < NCOUNTER; i++) {
+    if(!have[i])
+      missing << (missing.str().empty() ? "" : ", ") << counterNames[i];
+  }
+
+  if(!missing.str().empty())
+    os << "Unavailable counters (reported as 0): " << missing.str() << std::endl;
+
+  os << std::fixed
+     << std::left  << std::setw(32) << "phase"
+     << std::setw(8)  << "thread" << std::right
+     << std::setw(10) << "calls"
+     << std::setw(10) << "time(s)"
+     << std::setw(10) << "Gcycles"
+     << std::setw(8)  << "IPC"
+     << std::setw(10) << "LLCmiss%"
+     << std::setw(8)  << "MPKI"
+     << std::setw(8)  << "LdMPKI"
+     << std::setw(10) << "GB/s(est)" << std::endl;
+
+  for(std::map<std::string, Counts>::iterator iter=totals.begin(); iter != totals.end(); iter++) {
+
+    printRow(os, iter->first, "all", iter->second);
+
+    std::vector<std::pair<unsigned, Counts> >& threads = perThread[iter->first];
+
+    if(threads.size() > 1) {
+      for(unsigned i=0; i < threads.size(); i++) {
+	std::ostringstream thread;
+	thread << threads[i].first;
+	printRow(os, "", thread.str(), threads[i].second);
+      }
+    }
+  }
+}
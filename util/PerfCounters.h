@@ -0,0 +1,159 @@
+// $Id: $
+
+#ifndef GCP_UTIL_PERFCOUNTERS_H
+#define GCP_UTIL_PERFCOUNTERS_H
+
+/**
+ * @file PerfCounters.h
+ *
+ * Tagged: Mon Oct 19 17:20:13 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+#include "gcp/util/Directives.h"
+#include "gcp/util/Mutex.h"
+
+//-----------------------------------------------------------------------
+// Declare a scoped counter phase.  Hardware counters for the calling
+// thread are accumulated from this point to the end of the enclosing
+// block.  name must be a string literal (phases are keyed by pointer)
+//-----------------------------------------------------------------------
+
+#define PERF_PHASE(name) gcp::util::PerfCounters::Phase perfPhase_(name)
+
+namespace gcp {
+  namespace util {
+
+    //-----------------------------------------------------------------------
+    // Per-thread, per-phase hardware performance counters, read via
+    // the Linux perf_event_open() interface.
+    //
+    // Each thread opens its own counter group (user-space only) the
+    // first time it enters a phase while counting is enabled.  A phase
+    // costs one read() of the group on entry and one on exit; when
+    // counting is disabled (the default), it costs a single flag test.
+    //
+    // Counters the kernel or hardware does not provide (for example
+    // under a hypervisor) are simply reported as unavailable.  A
+    // thread's counters are closed when it exits, but its counts are
+    // kept for the report.  If the kernel multiplexes the group,
+    // counts are scaled by the fraction of time the group was
+    // actually scheduled.
+    //-----------------------------------------------------------------------
+
+    class PerfCounters {
+    public:
+
+      enum Counter {
+	CYCLES,
+	INSTRUCTIONS,
+	LLC_REFS,
+	LLC_MISSES,
+	LLC_LOAD_MISSES,
+	NCOUNTER
+      };
+
+      struct Counts {
+	unsigned long long nCall_;
+	unsigned long long ns_;
+	unsigned long long timeEnabled_;
+	unsigned long long timeRunning_;
+	unsigned long long val_[NCOUNTER];
+
+	Counts();
+	void operator+=(const Counts& counts);
+	double scaled(Counter counter) const;
+      };
+
+      class Phase {
+      public:
+
+	inline Phase(const char* name) {
+	  name_ = enabled_ ? name : 0;
+
+	  if(name_)
+	    start(*this);
+	}
+
+	inline ~Phase() {
+	  if(name_)
+	    stop(*this);
+	}
+
+      private:
+
+	friend class PerfCounters;
+
+	const char* name_;
+	unsigned long long ns_;
+	unsigned long long timeEnabled_;
+	unsigned long long timeRunning_;
+	unsigned long long val_[NCOUNTER];
+      };
+
+      // Enable/disable counting.  enable() returns false if counters
+      // are not supported on this platform
+
+      static bool enable();
+      static void disable();
+
+      static inline bool enabled() {
+	return enabled_;
+      }
+
+      // Discard accumulated counts
+
+      static void reset();
+
+      // Print per-phase (summed over threads) and per-thread IPC,
+      // cache-miss rates and bandwidth estimates
+
+      static void report(std::ostream& os);
+
+    private:
+
+      struct ThreadCounters {
+	unsigned id_;
+	bool ok_;
+	int leader_;
+	int fd_[NCOUNTER];
+	unsigned nOpen_;
+	unsigned index_[NCOUNTER];  // Counter for each slot in a group read
+	std::vector<const char*> names_;
+	std::vector<Counts> counts_;
+      };
+
+      static void start(Phase& phase);
+      static void stop(Phase& phase);
+
+      static ThreadCounters* registerThread();
+      static void openCounters(ThreadCounters* tc);
+      static void closeCounters(void* tc);
+      static void createKey();
+      static bool readCounters(ThreadCounters* tc, unsigned long long* val,
+			       unsigned long long& timeEnabled, unsigned long long& timeRunning);
+
+      static void printRow(std::ostream& os, std::string name, std::string thread, const Counts& counts);
+
+      static volatile bool enabled_;
+      static std::vector<ThreadCounters*> threads_;
+      static Mutex guard_;
+      static pthread_key_t key_;
+      static pthread_once_t keyOnce_;
+
+      static __thread ThreadCounters* counters_;
+
+    }; // End class PerfCounters
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_PERFCOUNTERS_H
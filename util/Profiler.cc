@@ -0,0 +1,335 @@
+#include "gcp/util/Profiler.h"
+
+#include "gcp/util/Exception.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include <sys/time.h>
+#include <time.h>
+
+using namespace std;
+
+using namespace gcp::util;
+
+volatile bool                          Profiler::enabled_ = false;
+unsigned                               Profiler::nEventPerThread_ = 65536;
+std::vector<Profiler::ThreadBuffer*>   Profiler::buffers_;
+Mutex                                  Profiler::guard_;
+__thread Profiler::ThreadBuffer*       Profiler::buffer_ = 0;
+
+/**.......................................................................
+ * Enable recording
+ */
+void Profiler::enable(unsigned nEventPerThread)
+{
+  if(nEventPerThread == 0)
+    ThrowError("Profiler buffers must hold at least one event");
+
+  guard_.lock();
+  nEventPerThread_ = nEventPerThread;
+  guard_.unlock();
+
+  enabled_ = true;
+}
+
+/**.......................................................................
+ * Disable recording.  Zones that are already open will still be
+ * recorded when they close
+ */
+void Profiler::disable()
+{
+  enabled_ = false;
+}
+
+/**.......................................................................
+ * Discard all recorded events
+ */
+void Profiler::reset()
+{
+  guard_.lock();
+
+  for(unsigned i=0; i < buffers_.size(); i++)
+    buffers_[i]->nWritten_ = 0;
+
+  guard_.unlock();
+}
+
+/**.......................................................................
+ * Return the current time in ns
+ */
+unsigned long long Profiler::now()
+{
+#if HAVE_RT
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return (unsigned long long)tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+#endif
+}
+
+/**.......................................................................
+ * Register a buffer for the calling thread
+ */
+Profiler::ThreadBuffer* Profiler::registerThread()
+{
+  ThreadBuffer* buffer = new ThreadBuffer();
+
+  guard_.lock();
+
+  buffer->id_       = buffers_.size();
+  buffer->nWritten_ = 0;
+  buffer->events_.resize(nEventPerThread_);
+
+  buffers_.push_back(buffer);
+
+  guard_.unlock();
+
+  return buffer;
+}
+
+/**.......................................................................
+ * Record a single event into the calling thread's ring buffer
+ */
+void Profiler::record(const char* name, const char* label,
+		      unsigned long long start, unsigned long long stop)
+{
+  if(buffer_ == 0)
+    buffer_ = registerThread();
+
+  ThreadBuffer* buffer = buffer_;
+  Event& event = buffer->events_[buffer->nWritten_ % buffer->events_.size()];
+
+  event.name_     = name;
+  event.label_    = label;
+  event.start_    = start;
+  event.duration_ = stop - start;
+
+  ++buffer->nWritten_;
+}
+
+/**.......................................................................
+ * Collect the events from all thread buffers, oldest first within
+ * each buffer
+ */
+void Profiler::collect(std::vector<Event>& events, std::vector<unsigned>& ids)
+{
+  events.clear();
+  ids.clear();
+
+  guard_.lock();
+
+  for(unsigned iBuf=0; iBuf < buffers_.size(); iBuf++) {
+    ThreadBuffer* buffer = buffers_[iBuf];
+
+    unsigned long long nEvent = buffer->events_.size();
+    unsigned long long nValid = buffer->nWritten_ < nEvent ? buffer->nWritten_ : nEvent;
+    unsigned long long first  = buffer->nWritten_ - nValid;
+
+    for(unsigned long long i=first; i < buffer->nWritten_; i++) {
+      events.push_back(buffer->events_[i % nEvent]);
+      ids.push_back(buffer->id_);
+    }
+  }
+
+  guard_.unlock();
+}
+
+/**.......................................................................
+ * Write a string as a JSON string literal
+ */
+static void writeJsonString(std::ostream& os, const char* str)
+{
+  os << '"';
+
+  for(const char* cptr = str; cptr && *cptr; cptr++) {
+    switch (*cptr) {
+    case '"':
+      os << "\\\"";
+      break;
+    case '\\':
+      os << "\\\\";
+      break;
+    default:
+      if((unsigned char)*cptr >= 0x20)
+	os << *cptr;
+      break;
+    }
+  }
+
+  os << '"';
+}
+
+/**.......................................................................
+ * Write recorded events as complete ('X') events in Chrome trace
+ * format.  Timestamps are in microseconds from the earliest event
+ */
+void Profiler::writeChromeTrace(std::string fileName)
+{
+  std::vector<Event> events;
+  std::vector<unsigned> ids;
+
+  collect(events, ids);
+
+  std::ofstream fout(fileName.c_str(), ios::out);
+
+  if(!fout)
+    ThrowError("Unable to open trace file: " << fileName);
+
+  unsigned long long t0 = 0;
+  for(unsigned i=0; i < events.size(); i++) {
+    if(i == 0 || events[i].start_ < t0)
+      t0 = events[i].start_;
+  }
+
+  unsigned nThread = 0;
+  for(unsigned i=0; i < ids.size(); i++)
+    nThread = ids[i] + 1 > nThread ? ids[i] + 1 : nThread;
+
+  fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+
+  //------------------------------------------------------------
+  // Name each thread track
+  //------------------------------------------------------------
+
+  for(unsigned iThread=0; iThread < nThread; iThread++) {
+    fout << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << iThread
+	 << ",\"args\":{\"name\":\"thread " << iThread << "\"}}," << std::endl;
+  }
+
+  fout << std::fixed << std::setprecision(3);
+
+  for(unsigned i=0; i < events.size(); i++) {
+    Event& event = events[i];
+
+    fout << "{\"name\":";
+    writeJsonString(fout, event.name_);
+
+    if(event.label_) {
+      fout << ",\"cat\":";
+      writeJsonString(fout, event.label_);
+    }
+
+    fout << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ids[i]
+	 << ",\"ts\":"  << (double)(event.start_ - t0) / 1000
+	 << ",\"dur\":" << (double)(event.duration_)   / 1000
+	 << "}" << (i+1 < events.size() ? "," : "") << std::endl;
+  }
+
+  fout << "]}" << std::endl;
+}
+
+/**.......................................................................
+ * Write per-zone latency statistics to a file
+ */
+void Profiler::writeHistograms(std::string fileName)
+{
+  std::ofstream fout(fileName.c_str(), ios::out);
+
+  if(!fout)
+    ThrowError("Unable to open histogram file: " << fileName);
+
+  writeHistograms(fout);
+}
+
+/**.......................................................................
+ * Write per-zone latency statistics, and a histogram of latencies in
+ * power-of-two microsecond bins.  Zones are keyed by name and label,
+ * so that each dataset or model component gets its own entry
+ */
+void Profiler::writeHistograms(std::ostream& os)
+{
+  std::vector<Event> events;
+  std::vector<unsigned> ids;
+
+  collect(events, ids);
+
+  std::map<std::string, std::vector<unsigned long long> > zones;
+
+  for(unsigned i=0; i < events.size(); i++) {
+    std::string key(events[i].name_);
+
+    if(events[i].label_)
+      key += std::string(" [") + events[i].label_ + "]";
+
+    zones[key].push_back(events[i].duration_);
+  }
+
+  os << std::left << std::setw(48) << "zone" << std::right
+     << std::setw(10) << "count"
+     << std::setw(12) << "total(ms)"
+     << std::setw(12) << "mean(us)"
+     << std::setw(12) << "p50(us)"
+     << std::setw(12) << "p90(us)"
+     << std::setw(12) << "p99(us)"
+     << std::setw(12) << "max(us)" << std::endl;
+
+  os << std::fixed << std::setprecision(1);
+
+  for(std::map<std::string, std::vector<unsigned long long> >::iterator iter=zones.begin();
+      iter != zones.end(); iter++) {
+
+    std::vector<unsigned long long>& durs = iter->second;
+    std::sort(durs.begin(), durs.end());
+
+    unsigned n = durs.size();
+    double total = 0.0;
+    for(unsigned i=0; i < n; i++)
+      total += durs[i];
+
+    os << std::left << std::setw(48) << iter->first << std::right
+       << std::setw(10) << n
+       << std::setw(12) << total / 1e6
+       << std::setw(12) << total / n / 1e3
+       << std::setw(12) << durs[(n-1)/2] / 1e3
+       << std::setw(12) << durs[(unsigned)(0.9  * (n-1))] / 1e3
+       << std::setw(12) << durs[(unsigned)(0.99 * (n-1))] / 1e3
+       << std::setw(12) << durs[n-1] / 1e3 << std::endl;
+  }
+
+  //------------------------------------------------------------
+  // Now the histograms themselves.  Bin k holds latencies in
+  // [2^(k-1), 2^k) us, with bin 0 holding everything below 1 us
+  //------------------------------------------------------------
+
+  for(std::map<std::string, std::vector<unsigned long long> >::iterator iter=zones.begin();
+      iter != zones.end(); iter++) {
+
+    std::vector<unsigned long long>& durs = iter->second;
+    std::vector<unsigned> bins;
+
+    for(unsigned i=0; i < durs.size(); i++) {
+      unsigned long long us = durs[i] / 1000;
+      unsigned bin = 0;
+
+      while(us > 0) {
+	us >>= 1;
+	++bin;
+      }
+
+      if(bin >= bins.size())
+	bins.resize(bin+1, 0);
+
+      ++bins[bin];
+    }
+
+    unsigned maxCount = *std::max_element(bins.begin(), bins.end());
+
+    os << std::endl << iter->first << std::endl;
+
+    for(unsigned bin=0; bin < bins.size(); bin++) {
+
+      unsigned long long lo = bin == 0 ? 0 : (1ULL << (bin-1));
+      unsigned long long hi = 1ULL << bin;
+      unsigned nStar = maxCount > 0 ? (50 * bins[bin] + maxCount - 1) / maxCount : 0;
+
+      os << "  [" << std::setw(9) << lo << ", " << std::setw(9) << hi << ") us "
+	 << std::setw(10) << bins[bin] << " " << std::string(nStar, '*') << std::endl;
+    }
+  }
+}
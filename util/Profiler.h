@@ -0,0 +1,140 @@
+// $Id: $
+
+#ifndef GCP_UTIL_PROFILER_H
+#define GCP_UTIL_PROFILER_H
+
+/**
+ * @file Profiler.h
+ *
+ * Tagged: Mon Oct 19 16:02:41 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gcp/util/Directives.h"
+#include "gcp/util/Mutex.h"
+
+//-----------------------------------------------------------------------
+// Declare a scoped profiling zone.  The zone is timed from this point
+// to the end of the enclosing block.  Names and labels must outlive
+// the profiler: use string literals, or the c_str() of a long-lived
+// object name.  label may be 0
+//-----------------------------------------------------------------------
+
+#define PROFILE_ZONE(name, label) gcp::util::Profiler::Zone profileZone_(name, label)
+
+namespace gcp {
+  namespace util {
+
+    //-----------------------------------------------------------------------
+    // A process-wide, low-overhead profiler.
+    //
+    // When profiling is disabled (the default), a zone costs a single
+    // test of a global flag.  When enabled, each zone appends its
+    // start time and duration to a fixed-size ring buffer owned by
+    // the calling thread, so recording never takes a lock.  A
+    // thread's buffer is registered (under a mutex) the first time
+    // it records a zone.
+    //
+    // Buffers are only read by writeChromeTrace() and
+    // writeHistograms(), which should be called while no
+    // instrumented code is running.  If a buffer wraps, the oldest
+    // events are overwritten.
+    //-----------------------------------------------------------------------
+
+    class Profiler {
+    public:
+
+      struct Event {
+	const char* name_;
+	const char* label_;
+	unsigned long long start_;    // ns (monotonic clock)
+	unsigned long long duration_; // ns
+      };
+
+      class Zone {
+      public:
+
+	inline Zone(const char* name, const char* label=0) {
+	  if(enabled_) {
+	    name_  = name;
+	    label_ = label;
+	    start_ = now();
+	  } else {
+	    name_  = 0;
+	  }
+	}
+
+	inline ~Zone() {
+	  if(name_)
+	    record(name_, label_, start_, now());
+	}
+
+      private:
+
+	const char* name_;
+	const char* label_;
+	unsigned long long start_;
+      };
+
+      // Enable/disable recording.  nEventPerThread sets the size of
+      // each thread's ring buffer
+
+      static void enable(unsigned nEventPerThread=65536);
+      static void disable();
+
+      static inline bool enabled() {
+	return enabled_;
+      }
+
+      // Discard all recorded events
+
+      static void reset();
+
+      // Write recorded events as a Chrome/Perfetto trace (JSON
+      // 'traceEvents' format, loadable in chrome://tracing or
+      // ui.perfetto.dev)
+
+      static void writeChromeTrace(std::string fileName);
+
+      // Write per-zone latency statistics and log2-binned histograms
+
+      static void writeHistograms(std::string fileName);
+      static void writeHistograms(std::ostream& os);
+
+      // Return the current time, in ns, from a monotonic clock
+
+      static unsigned long long now();
+
+    private:
+
+      struct ThreadBuffer {
+	unsigned id_;
+	std::vector<Event> events_;
+	unsigned long long nWritten_;
+      };
+
+      static void record(const char* name, const char* label,
+			 unsigned long long start, unsigned long long stop);
+
+      static ThreadBuffer* registerThread();
+      static void collect(std::vector<Event>& events, std::vector<unsigned>& ids);
+
+      static volatile bool enabled_;
+      static unsigned nEventPerThread_;
+      static std::vector<ThreadBuffer*> buffers_;
+      static Mutex guard_;
+
+      static __thread ThreadBuffer* buffer_;
+
+    }; // End class Profiler
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_PROFILER_H
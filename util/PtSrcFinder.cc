@@ -88,43 +88,13 @@ void PtSrcFinder::findSources(PtSrcReader* reader,
 			      Flux& fMin, Flux& fMax,
 			      std::vector<HourAngle>& ras, std::vector<Declination>& decs)
 {
-  // First pass to determine how many sources
+  // Search the catalog, using its sky index if it has one
 
-  // Now find sources and return the found values
+  std::vector<PtSrcReader::Source> srcs = reader->findSources(ra, dec, radius, fMin, fMax, false);
 
-  PtSrcReader::Source src;
-
-  // Set the RA range to search
-
-  COUT("Setting raRange to " << radius << " about " << ra << " " << dec);
-  reader->setRaRange(ra, dec, radius);
-
-  // Make sure the catalog file is open
-
-  reader->openCatalogFile();
-
-  // Iterate, reading from the catalog file until the EOF is reached
-
-  while(!reader->eof()) {
-
-    src = reader->readNextEntry();
-
-    // If the source flux is within range, check the angle, but don't
-    // do otherwise, since this is expensive.
-
-    if(src.peak_ >= fMin && src.peak_ <= fMax) {
-      if(reader->checkAngle(src, ra, dec, radius)) {
-
-	reader->applyCorrections(src);
-
-	ras.push_back(src.ra_);
-	decs.push_back(src.dec_);
-      }
-    }
+  for(unsigned iSrc=0; iSrc < srcs.size(); iSrc++) {
+    ras.push_back(srcs[iSrc].ra_);
+    decs.push_back(srcs[iSrc].dec_);
   }
-
-  // And close the file
-
-  reader->closeCatalogFile();
 }
 
@@ -33,6 +33,11 @@ void PtSrcFitsReader::initialize()
   fitsFile_ = 0;
   initRange();
 
+  // Default to searching the whole catalog, if no RA range is set
+
+  rangeStartInd_[0] = 0;
+  rangeStopInd_[0]  = 24;
+
   for(unsigned i=0; i < chunkSize_; i++)
     sourceNames_[i] = 0;
 
@@ -200,6 +205,7 @@ void PtSrcFitsReader::readNextChunk()
   // Parse the data we just read
 
   readFitsData(startRow, nElement);
+  bufNRow_ = 0;
 
   // And increment which chunk we are on
 
@@ -215,6 +221,62 @@ bool PtSrcFitsReader::eof()
   return (status_ == END_OF_FILE) || nRow_ == 0 || (iRange_ == nRange_ && iRow_ == nRow_-1);
 }
 
+/**.......................................................................
+ * FITS catalogs can be read by row
+ */
+bool PtSrcFitsReader::canReadEntry()
+{
+  return true;
+}
+
+/**.......................................................................
+ * Return the number of rows in the catalog.  The catalog file must be
+ * open
+ */
+unsigned PtSrcFitsReader::nEntry()
+{
+  if(!fitsFile_)
+    ThrowError("The catalog file is not open");
+
+  return nRowTotal_;
+}
+
+/**.......................................................................
+ * Read the entry at the requested (1-based) row.  Rows are read a
+ * chunk at a time, so reading rows in ascending order costs little
+ * more than reading sequentially
+ */
+PtSrcReader::Source PtSrcFitsReader::readEntry(unsigned row)
+{
+  if(!fitsFile_)
+    ThrowError("The catalog file is not open");
+
+  if(row < 1 || row > nRowTotal_)
+    ThrowError("Row " << row << " is out of range (1-" << nRowTotal_ << ")");
+
+  if((long)row < bufStartRow_ || (long)row >= bufStartRow_ + bufNRow_) {
+
+    long nElement = nRowTotal_ - row + 1;
+
+    if(nElement > (long)chunkSize_)
+      nElement = chunkSize_;
+
+    readFitsData(row, nElement);
+
+    if(status_)
+      throwCfitsioError(status_);
+
+    bufStartRow_ = row;
+    bufNRow_     = nElement;
+  }
+
+  // parseData() reads the element at iRow_ % chunkSize_
+
+  iRow_ = row - bufStartRow_;
+
+  return parseData();
+}
+
 /**.......................................................................
  * Overload the base-class method to set up RA ranges to search
  */
@@ -257,6 +319,9 @@ void PtSrcFitsReader::initRange()
   iRow_     = 0;
   iRange_   = 0;
   nRange_   = 1;
+
+  bufStartRow_ = 0;
+  bufNRow_     = 0;
 }
 
 /**.......................................................................
@@ -58,6 +58,12 @@ namespace gcp {
 
       bool eof();
 
+      // Random access to catalog rows
+
+      bool canReadEntry();
+      unsigned nEntry();
+      PtSrcReader::Source readEntry(unsigned row);
+
       void setRaRange(HourAngle& ra, Declination& dec, Angle& radius);
       void initRange();
 
@@ -85,6 +91,12 @@ namespace gcp {
       long nRow_, nRowTotal_;
       unsigned iRow_;
 
+      // The first row and number of rows currently buffered by
+      // readEntry()
+
+      long bufStartRow_;
+      long bufNRow_;
+
       double ras_[chunkSize_];
       double decs_[chunkSize_];
       float peakFluxes_[chunkSize_];
@@ -3,8 +3,11 @@
 #include "gcp/util/PtSrcReader.h"
 #include "gcp/util/RegExpParser.h"
 
+#include <algorithm>
 #include <iomanip>
 
+#include <sys/stat.h>
+
 using namespace std;
 
 using namespace gcp::util;
@@ -40,12 +43,18 @@ void PtSrcReader::initialize()
 {
   raMin_.setHours(0.0); 
   raMax_.setHours(24.0); 
+
+  useIndex_ = true;
+  skyIndex_ = 0;
 }
 
 /**.......................................................................
  * Destructor.
  */
-PtSrcReader::~PtSrcReader() {}
+PtSrcReader::~PtSrcReader() 
+{
+  deleteSkyIndex();
+}
 
 /**.......................................................................
  * Set the catalog file
@@ -53,6 +62,117 @@ PtSrcReader::~PtSrcReader() {}
 void PtSrcReader::setCatalogFile(std::string catalogFile) 
 {
   catalogFile_ = catalogFile;
+  deleteSkyIndex();
+}
+
+/**.......................................................................
+ * Enable or disable use of a sky index for cone searches
+ */
+void PtSrcReader::setUseIndex(bool useIndex) 
+{
+  useIndex_ = useIndex;
+}
+
+/**.......................................................................
+ * Release any sky index we are holding
+ */
+void PtSrcReader::deleteSkyIndex() 
+{
+  if(skyIndex_) {
+    delete skyIndex_;
+    skyIndex_ = 0;
+  }
+}
+
+/**.......................................................................
+ * Return the sky index for the current catalog, loading it from the
+ * cached index file, or building it if the cache is missing or out of
+ * date
+ */
+SkyIndex* PtSrcReader::getSkyIndex() 
+{
+  if(!useIndex_ || !canReadEntry())
+    return 0;
+
+  if(skyIndex_)
+    return skyIndex_;
+
+  struct stat st;
+  if(stat(catalogFile_.c_str(), &st) < 0)
+    ThrowSysError("stat(" << catalogFile_ << ")");
+
+  std::string indexFile = catalogFile_ + ".skyidx";
+
+  skyIndex_ = new SkyIndex();
+
+  try {
+    if(!skyIndex_->load(indexFile, st.st_size, st.st_mtime))
+      buildSkyIndex(indexFile, st.st_size, st.st_mtime);
+  } catch(Exception& err) {
+    deleteSkyIndex();
+    throw err;
+  }
+
+  return skyIndex_;
+}
+
+/**.......................................................................
+ * Build a sky index by reading every entry of the catalog, and try to
+ * cache it for next time
+ */
+void PtSrcReader::buildSkyIndex(std::string indexFile, long long catalogSize, long long catalogMtime) 
+{
+  COUTCOLOR("Building sky index for " << catalogFile_ << " (this is only done once per catalog)", "green");
+
+  openCatalogFile();
+
+  unsigned n = nEntry();
+  std::vector<SkyIndex::Entry> entries(n);
+
+  for(unsigned row=1; row <= n; row++) {
+    Source src = readEntry(row);
+    entries[row-1] = SkyIndex::entry(src.ra_.radians(), src.dec_.radians(), src.peak_.Jy(), row);
+  }
+
+  closeCatalogFile();
+
+  skyIndex_->build(entries);
+
+  //------------------------------------------------------------
+  // Write the index out and map it back in.  If the catalog
+  // directory isn't writable, just keep the in-memory index
+  //------------------------------------------------------------
+
+  try {
+    skyIndex_->write(indexFile, catalogSize, catalogMtime);
+
+    if(!skyIndex_->load(indexFile, catalogSize, catalogMtime))
+      skyIndex_->build(entries);
+
+  } catch(Exception& err) {
+    COUTCOLOR("Unable to cache the sky index: " << err.what() << " -- using an in-memory index", "yellow");
+  }
+}
+
+/**.......................................................................
+ * Default random-access methods, for catalogs that can only be read
+ * sequentially
+ */
+bool PtSrcReader::canReadEntry() 
+{
+  return false;
+}
+
+unsigned PtSrcReader::nEntry() 
+{
+  ThrowError("This catalog does not support random access");
+  return 0;
+}
+
+PtSrcReader::Source PtSrcReader::readEntry(unsigned row) 
+{
+  ThrowError("This catalog does not support random access");
+  return Source();
 }
 
 /**.......................................................................
@@ -192,6 +312,17 @@ PtSrcReader::findSources(HourAngle ra, Declination dec, Angle radius, Flux fMin,
   std::vector<PtSrcReader::Source> srcs;
   bool first=true;
 
+  // If the catalog is indexed, read only the entries the index
+  // finds
+
+  SkyIndex* index = getSkyIndex();
+
+  if(index) {
+    std::vector<unsigned> rows;
+    index->query(ra.radians(), dec.radians(), radius.radians(), fMin.Jy(), fMax.Jy(), rows);
+    return readSources(rows, ra, dec, radius, fMin, fMax, doPrint);
+  }
+
   // Calculate the RA range we need to search
 
   setRaRange(ra, dec, radius);
@@ -241,6 +372,138 @@ PtSrcReader::findSources(HourAngle ra, Declination dec, Angle radius, Flux fMin,
   return srcs;
 }
 
+/**.......................................................................
+ * Read the listed rows from the catalog, and return those sources
+ * within radius of the requested position
+ */
+std::vector<PtSrcReader::Source> 
+PtSrcReader::readSources(std::vector<unsigned>& rows, HourAngle& ra, Declination& dec, Angle& radius, 
+			 Flux& fMin, Flux& fMax, bool doPrint)
+{
+  std::vector<PtSrcReader::Source> srcs;
+  bool first=true;
+
+  if(rows.size() == 0)
+    return srcs;
+
+  openCatalogFile();
+
+  for(unsigned iRow=0; iRow < rows.size(); iRow++) {
+    PtSrcReader::Source src = readEntry(rows[iRow]);
+
+    // The index selection is approximate, so recheck each source
+
+    if(src.peak_ >= fMin && src.peak_ <= fMax) {
+      if(checkAngle(src, ra, dec, radius)) {
+
+	applyCorrections(src);
+
+	if(first) {
+	  std::ostringstream os;
+
+	  if(doPrint) {
+	    printHeader(os);
+	    COUT(os.str());
+	  }
+
+	  first = false;
+	}
+
+	if(doPrint)
+	  COUT(src);
+
+	srcs.push_back(src);
+      }
+    }
+  }
+
+  closeCatalogFile();
+
+  return srcs;
+}
+
+/**.......................................................................
+ * Return lists of sources within radius of each of the requested
+ * positions
+ */
+std::vector<std::vector<PtSrcReader::Source> >
+PtSrcReader::findSources(std::vector<HourAngle>& ras, std::vector<Declination>& decs, 
+			 Angle radius, Flux fMin, Flux fMax, ThreadPool* pool)
+{
+  if(ras.size() != decs.size())
+    ThrowError("RA and DEC arrays must be the same size");
+
+  unsigned nField = ras.size();
+  std::vector<std::vector<PtSrcReader::Source> > srcs(nField);
+
+  SkyIndex* index = getSkyIndex();
+
+  if(!index) {
+    for(unsigned iField=0; iField < nField; iField++)
+      srcs[iField] = findSources(ras[iField], decs[iField], radius, fMin, fMax, false);
+    return srcs;
+  }
+
+  //------------------------------------------------------------
+  // Search the index for all fields
+  //------------------------------------------------------------
+
+  std::vector<double> raRads(nField), decRads(nField);
+
+  for(unsigned iField=0; iField < nField; iField++) {
+    raRads[iField]  = ras[iField].radians();
+    decRads[iField] = decs[iField].radians();
+  }
+
+  std::vector<std::vector<unsigned> > rows;
+  index->query(raRads, decRads, radius.radians(), fMin.Jy(), fMax.Jy(), rows, pool);
+
+  //------------------------------------------------------------
+  // Fields may overlap, so read the union of matching rows once, in
+  // catalog order
+  //------------------------------------------------------------
+
+  std::vector<unsigned> allRows;
+
+  for(unsigned iField=0; iField < nField; iField++)
+    allRows.insert(allRows.end(), rows[iField].begin(), rows[iField].end());
+
+  std::sort(allRows.begin(), allRows.end());
+  allRows.erase(std::unique(allRows.begin(), allRows.end()), allRows.end());
+
+  std::vector<PtSrcReader::Source> catSrcs(allRows.size());
+
+  if(allRows.size() > 0) {
+    openCatalogFile();
+
+    for(unsigned iRow=0; iRow < allRows.size(); iRow++)
+      catSrcs[iRow] = readEntry(allRows[iRow]);
+
+    closeCatalogFile();
+  }
+
+  //------------------------------------------------------------
+  // And distribute them to the fields they belong to
+  //------------------------------------------------------------
+
+  for(unsigned iField=0; iField < nField; iField++) {
+    for(unsigned iRow=0; iRow < rows[iField].size(); iRow++) {
+
+      unsigned iSrc = std::lower_bound(allRows.begin(), allRows.end(), rows[iField][iRow]) - allRows.begin();
+      PtSrcReader::Source src = catSrcs[iSrc];
+
+      if(src.peak_ >= fMin && src.peak_ <= fMax) {
+	if(checkAngle(src, ras[iField], decs[iField], radius)) {
+	  applyCorrections(src);
+	  srcs[iField].push_back(src);
+	}
+      }
+    }
+  }
+
+  return srcs;
+}
+
 /**.......................................................................
  * Return a list of sources that match the passed regexp string
  */
@@ -299,6 +562,9 @@ PtSrcReader::countSources(HourAngle ra, Declination dec, Angle radius, Flux fMin
   static PtSrcReader::Source src;
   unsigned nSrc = 0;
 
+  if(getSkyIndex())
+    return findSources(ra, dec, radius, fMin, fMax, true).size();
+
   // Calculate the RA range we need to search
 
   setRaRange(ra, dec, radius);
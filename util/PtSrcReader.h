@@ -17,7 +17,9 @@
 #include "gcp/util/Exception.h"
 #include "gcp/util/Flux.h"
 #include "gcp/util/HourAngle.h"
+#include "gcp/util/SkyIndex.h"
 #include "gcp/util/String.h"
+#include "gcp/util/ThreadPool.h"
 
 #include "fitsio.h"
 
@@ -256,6 +258,15 @@ namespace gcp {
       std::vector<PtSrcReader::Source> findSources(HourAngle ra, Declination dec, Angle radius, 
 						   Flux fMin=minFlux_, Flux fMax=maxFlux_, bool doPrint=true);
 
+      // Find sources within radius of each of a list of positions.
+      // With a sky index, the fields are searched in parallel if a
+      // thread pool is passed, and each catalog entry is read at
+      // most once, however many fields it falls in
+
+      std::vector<std::vector<PtSrcReader::Source> > findSources(std::vector<HourAngle>& ras, std::vector<Declination>& decs, 
+								  Angle radius, Flux fMin=minFlux_, Flux fMax=maxFlux_,
+								  ThreadPool* pool=0);
+
       // Return a list of sources that match the passed regexp string
       
       std::vector<PtSrcReader::Source> findSources(std::string regExpStr, bool exact=false, bool caseSensitive=true);
@@ -269,6 +280,19 @@ namespace gcp {
       
       void indexSources();
 
+      // If true (the default), cone searches use a sky index of the
+      // catalog, built on first use and cached alongside the catalog
+      // file as catalogFile.skyidx.  Otherwise, searches scan the
+      // catalog
+
+      void setUseIndex(bool useIndex);
+
+      // Return the sky index for the current catalog, loading or
+      // building it if necessary.  Returns NULL if indexing is
+      // disabled, or the catalog doesn't support random access
+
+      SkyIndex* getSkyIndex();
+
       // Check if a position if within a given radius of the passed ra and dec
 
       bool checkAngle(PtSrcReader::Source& src, HourAngle& ra, Declination& dec, Angle& radius);
@@ -292,6 +316,14 @@ namespace gcp {
 
       virtual bool eof() = 0;
 
+      // Catalog-specific functions for random access.  Readers that
+      // can return entries by (1-based) row number should override
+      // these, to make use of a sky index
+
+      virtual bool canReadEntry();
+      virtual unsigned nEntry();
+      virtual Source readEntry(unsigned row);
+
       // Apply any corrections to convert the catalog values
 
       virtual void applyCorrections(Source& src);
@@ -321,6 +353,20 @@ namespace gcp {
 
       unsigned nSrc_;
 
+      // The sky index of the catalog, if any
+
+      bool useIndex_;
+      SkyIndex* skyIndex_;
+
+      void deleteSkyIndex();
+      void buildSkyIndex(std::string indexFile, long long catalogSize, long long catalogMtime);
+
+      // Read the listed rows from the catalog, keeping those within
+      // radius of (ra, dec)
+
+      std::vector<PtSrcReader::Source> readSources(std::vector<unsigned>& rows, HourAngle& ra, Declination& dec, Angle& radius,
+						   Flux& fMin, Flux& fMax, bool doPrint);
+
       // Report an error generated by the cfitsio library
       
       void throwCfitsioError(int status);
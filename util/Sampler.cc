@@ -1162,12 +1162,23 @@ Sampler::generateMultiVariateGaussianSample(Vector<double>& val,
 					    Matrix<double>& invCov)
 {
   Vector<double> sample = val;
-  unsigned nParam = sample.size();
+  updateMultiVariateGaussianSample(sample, mean, invCov);
+  return sample;
+}
 
-  for(unsigned iParam=0; iParam < nParam; iParam++) 
-    multiVariateSampleIterator(iParam, sample, mean, invCov);
+/**.......................................................................
+ * Generate a sample from a multivariate normal distribution, updating
+ * the passed sample in place
+ */
+void
+Sampler::updateMultiVariateGaussianSample(Vector<double>& val, 
+					  Vector<double>& mean, 
+					  Matrix<double>& invCov)
+{
+  unsigned nParam = val.size();
 
-  return sample;
+  for(unsigned iParam=0; iParam < nParam; iParam++) 
+    multiVariateSampleIterator(iParam, val, mean, invCov);
 }
 
 /**.......................................................................
@@ -1180,25 +1191,20 @@ Sampler::multiVariateSampleIterator(unsigned k,
 				    Vector<double>& mean, 
 				    Matrix<double>& invCov)
 {
-  Vector<double> xm = val - mean;
-
-  double M   = xm * invCov * xm;
   double Ckk = invCov[k][k];
   double muk = mean[k];
   unsigned n = mean.size();
 
   //------------------------------------------------------------
-  // Now calculate A_k:
+  // Now calculate A_k.  The offsets from the mean are formed on the
+  // fly, since this is called once per parameter per sample
   //------------------------------------------------------------
 
   double Ak = 0.0;
 
-  //  COUT("xm = " << std::endl << xm);
-  //  COUT("val = " << std::endl << val);
-
   for(unsigned i=0; i < n; i++) {
     if(i != k)
-      Ak += xm[i] * invCov[i][k];
+      Ak += (val[i] - mean[i]) * invCov[i][k];
   }
 
   //  COUT("Ak = " << Ak << " muk = " << muk);
@@ -108,6 +108,13 @@ namespace gcp {
 					   Vector<double>& mean, 
 					   Matrix<double>& invCov);
 
+      // As above, but updates val in place, without allocating
+
+      static void 
+	updateMultiVariateGaussianSample(Vector<double>& val, 
+					 Vector<double>& mean, 
+					 Matrix<double>& invCov);
+
       static void 
 	multiVariateSampleIterator(unsigned k,
 				   Vector<double>& val, 
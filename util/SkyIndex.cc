@@ -0,0 +1,452 @@
+#include "gcp/util/SkyIndex.h"
+#include "gcp/util/Exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+using namespace gcp::util;
+
+#define SKY_INDEX_MAGIC   "CMXSKYIX"
+#define SKY_INDEX_VERSION 1
+
+/**.......................................................................
+ * Constructor.
+ */
+SkyIndex::SkyIndex()
+{
+  memset(&header_, 0, sizeof(Header));
+
+  map_         = 0;
+  mapSize_     = 0;
+
+  cellOffsets_ = 0;
+  entries_     = 0;
+}
+
+/**.......................................................................
+ * Destructor.
+ */
+SkyIndex::~SkyIndex()
+{
+  unload();
+}
+
+/**.......................................................................
+ * Return an entry for a source at (ra, dec)
+ */
+SkyIndex::Entry SkyIndex::entry(double ra, double dec, double peakJy, unsigned row)
+{
+  Entry entry;
+
+  entry.x_      = cos(dec) * cos(ra);
+  entry.y_      = cos(dec) * sin(ra);
+  entry.z_      = sin(dec);
+  entry.peakJy_ = peakJy;
+  entry.row_    = row;
+
+  return entry;
+}
+
+/**.......................................................................
+ * Compute the starting cell of each ring
+ */
+void SkyIndex::initializeRings(unsigned nRing)
+{
+  double dDec = M_PI / nRing;
+
+  ringStart_.resize(nRing+1);
+  ringStart_[0] = 0;
+
+  for(unsigned iRing=0; iRing < nRing; iRing++) {
+    double dec = -M_PI/2 + (iRing + 0.5) * dDec;
+    unsigned nCell = (unsigned)floor(2 * nRing * cos(dec) + 0.5);
+    ringStart_[iRing+1] = ringStart_[iRing] + (nCell > 0 ? nCell : 1);
+  }
+}
+
+/**.......................................................................
+ * Return the ring containing this declination
+ */
+unsigned SkyIndex::ringIndex(double dec)
+{
+  int iRing = (int)floor((dec + M_PI/2) / (M_PI / header_.nRing_));
+
+  if(iRing < 0)
+    return 0;
+
+  if(iRing >= (int)header_.nRing_)
+    return header_.nRing_-1;
+
+  return iRing;
+}
+
+/**.......................................................................
+ * Return the cell containing this position
+ */
+unsigned SkyIndex::cellIndex(double ra, double dec)
+{
+  unsigned iRing = ringIndex(dec);
+  unsigned nCell = ringStart_[iRing+1] - ringStart_[iRing];
+
+  ra = fmod(ra, 2*M_PI);
+  if(ra < 0.0)
+    ra += 2*M_PI;
+
+  unsigned iCell = (unsigned)(ra / (2*M_PI / nCell));
+
+  if(iCell >= nCell)
+    iCell = nCell-1;
+
+  return ringStart_[iRing] + iCell;
+}
+
+/**.......................................................................
+ * Build an index from a list of entries
+ */
+void SkyIndex::build(std::vector<Entry>& entries, unsigned nRing)
+{
+  unload();
+
+  if(nRing == 0)
+    ThrowError("An index must have at least one ring");
+
+  header_.nRing_ = nRing;
+  initializeRings(nRing);
+
+  unsigned nCell = ringStart_[nRing];
+
+  //------------------------------------------------------------
+  // Count entries per cell, then convert counts to offsets, and
+  // scatter the entries into place
+  //------------------------------------------------------------
+
+  std::vector<unsigned> cells(entries.size());
+  cellOffsetBuf_.assign(nCell+1, 0);
+
+  for(unsigned iEntry=0; iEntry < entries.size(); iEntry++) {
+    Entry& entry = entries[iEntry];
+    cells[iEntry] = cellIndex(atan2(entry.y_, entry.x_), asin(entry.z_ > 1.0 ? 1.0 : (entry.z_ < -1.0 ? -1.0 : entry.z_)));
+    ++cellOffsetBuf_[cells[iEntry]+1];
+  }
+
+  for(unsigned iCell=0; iCell < nCell; iCell++)
+    cellOffsetBuf_[iCell+1] += cellOffsetBuf_[iCell];
+
+  std::vector<unsigned> next(cellOffsetBuf_.begin(), cellOffsetBuf_.end()-1);
+  entryBuf_.resize(entries.size());
+
+  for(unsigned iEntry=0; iEntry < entries.size(); iEntry++)
+    entryBuf_[next[cells[iEntry]]++] = entries[iEntry];
+
+  header_.nCell_  = nCell;
+  header_.nEntry_ = entries.size();
+
+  cellOffsets_ = &cellOffsetBuf_[0];
+  entries_     = entryBuf_.size() > 0 ? &entryBuf_[0] : 0;
+}
+
+/**.......................................................................
+ * Return the byte offset of the entry array in an index file.  Entries
+ * contain doubles, so keep them 8-byte aligned
+ */
+size_t SkyIndex::entryOffset(unsigned nCell)
+{
+  size_t offset = sizeof(Header) + sizeof(unsigned) * (nCell+1);
+  return (offset + 7) & ~(size_t)7;
+}
+
+/**.......................................................................
+ * Write the index to a file
+ */
+void SkyIndex::write(std::string fileName, long long catalogSize, long long catalogMtime)
+{
+  if(!cellOffsets_)
+    ThrowError("No index has been built");
+
+  //------------------------------------------------------------
+  // Write to a temporary file and rename it into place, so that
+  // a concurrent reader never maps a partially written index
+  //------------------------------------------------------------
+
+  std::ostringstream tmpName;
+  tmpName << fileName << "." << getpid();
+
+  FILE* fp = fopen(tmpName.str().c_str(), "wb");
+
+  if(!fp) {
+    ThrowSysError("fopen(" << tmpName.str() << ")");
+  }
+
+  Header header = header_;
+  strncpy(header.magic_, SKY_INDEX_MAGIC, 8);
+  header.version_      = SKY_INDEX_VERSION;
+  header.catalogSize_  = catalogSize;
+  header.catalogMtime_ = catalogMtime;
+
+  size_t nOffset = header_.nCell_ + 1;
+  size_t nPad    = entryOffset(header_.nCell_) - (sizeof(Header) + sizeof(unsigned) * nOffset);
+  char pad[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+  bool ok = fwrite(&header, sizeof(Header), 1, fp) == 1;
+  ok = ok && (fwrite(cellOffsets_, sizeof(unsigned), nOffset, fp) == nOffset);
+  ok = ok && (nPad == 0 || fwrite(pad, 1, nPad, fp) == nPad);
+  ok = ok && (header_.nEntry_ == 0 || fwrite(entries_, sizeof(Entry), header_.nEntry_, fp) == header_.nEntry_);
+
+  ok = (fclose(fp) == 0) && ok;
+
+  if(!ok || rename(tmpName.str().c_str(), fileName.c_str()) != 0) {
+    unlink(tmpName.str().c_str());
+    ThrowError("Error writing index to " << fileName);
+  }
+
+  header_.catalogSize_  = catalogSize;
+  header_.catalogMtime_ = catalogMtime;
+}
+
+/**.......................................................................
+ * Memory-map an index from a file
+ */
+bool SkyIndex::load(std::string fileName, long long catalogSize, long long catalogMtime)
+{
+  unload();
+
+  int fd = open(fileName.c_str(), O_RDONLY);
+
+  if(fd < 0) {
+    if(errno == ENOENT)
+      return false;
+    ThrowSysError("open(" << fileName << ")");
+  }
+
+  struct stat st;
+  if(fstat(fd, &st) < 0) {
+    close(fd);
+    ThrowSysError("fstat(" << fileName << ")");
+  }
+
+  if((size_t)st.st_size < sizeof(Header)) {
+    close(fd);
+    return false;
+  }
+
+  mapSize_ = st.st_size;
+  map_     = mmap(0, mapSize_, PROT_READ, MAP_SHARED, fd, 0);
+
+  close(fd);
+
+  if(map_ == MAP_FAILED) {
+    map_ = 0;
+    ThrowSysError("mmap(" << fileName << ")");
+  }
+
+  memcpy(&header_, map_, sizeof(Header));
+
+  //------------------------------------------------------------
+  // Reject indices from another version, for another catalog, or
+  // whose ring layout doesn't match what we would compute here
+  //------------------------------------------------------------
+
+  bool valid = strncmp(header_.magic_, SKY_INDEX_MAGIC, 8) == 0 && header_.version_ == SKY_INDEX_VERSION;
+  valid = valid && header_.catalogSize_ == catalogSize && header_.catalogMtime_ == catalogMtime;
+  valid = valid && header_.nRing_ > 0;
+
+  if(valid) {
+    initializeRings(header_.nRing_);
+    valid = ringStart_[header_.nRing_] == header_.nCell_;
+  }
+
+  valid = valid && mapSize_ == entryOffset(header_.nCell_) + sizeof(Entry) * header_.nEntry_;
+
+  if(!valid) {
+    unload();
+    return false;
+  }
+
+  setPointers();
+
+  return true;
+}
+
+/**.......................................................................
+ * Set up pointers into the mapped file
+ */
+void SkyIndex::setPointers()
+{
+  cellOffsets_ = (const unsigned*)((char*)map_ + sizeof(Header));
+  entries_     = (const Entry*)((char*)map_ + entryOffset(header_.nCell_));
+}
+
+/**.......................................................................
+ * Release any resources associated with this index
+ */
+void SkyIndex::unload()
+{
+  if(map_) {
+    munmap(map_, mapSize_);
+    map_     = 0;
+    mapSize_ = 0;
+  }
+
+  cellOffsetBuf_.resize(0);
+  entryBuf_.resize(0);
+
+  memset(&header_, 0, sizeof(Header));
+
+  cellOffsets_ = 0;
+  entries_     = 0;
+}
+
+/**.......................................................................
+ * Return the rows of entries within radius of (ra, dec), with peak
+ * flux in range
+ */
+void SkyIndex::query(double ra, double dec, double radius, double fMinJy, double fMaxJy,
+		     std::vector<unsigned>& rows)
+{
+  rows.resize(0);
+
+  if(!cellOffsets_)
+    ThrowError("No index has been built or loaded");
+
+  Entry center = entry(ra, dec, 0.0, 0);
+
+  //------------------------------------------------------------
+  // Allow a little slack, so that we never reject an entry that an
+  // exact test would accept
+  //------------------------------------------------------------
+
+  double cosRad = cos(radius) - 1e-12;
+  double fMin   = fMinJy - 1e-6 * fabs(fMinJy);
+  double fMax   = fMaxJy + 1e-6 * fabs(fMaxJy);
+
+  //------------------------------------------------------------
+  // The cone spans rings between dec-radius and dec+radius.  Unless
+  // it contains a pole, its RA half-width is at most
+  // asin(sin(radius)/cos(dec)) in every ring
+  //------------------------------------------------------------
+
+  double decMin = dec - radius;
+  double decMax = dec + radius;
+
+  bool allRa = decMax >= M_PI/2 || decMin <= -M_PI/2 || sin(radius) >= cos(dec);
+  double dRa = allRa ? M_PI : asin(sin(radius)/cos(dec));
+
+  unsigned iRingMin = ringIndex(decMin);
+  unsigned iRingMax = ringIndex(decMax);
+
+  for(unsigned iRing=iRingMin; iRing <= iRingMax; iRing++) {
+
+    int nCell = ringStart_[iRing+1] - ringStart_[iRing];
+    double cellWidth = 2*M_PI / nCell;
+
+    int iCellMin = 0;
+    int iCellMax = nCell-1;
+
+    // Pad by a cell on either side, to guard against roundoff at
+    // cell boundaries
+
+    if(!allRa) {
+      iCellMin = (int)floor((ra - dRa) / cellWidth) - 1;
+      iCellMax = (int)floor((ra + dRa) / cellWidth) + 1;
+
+      if(iCellMax - iCellMin + 1 >= nCell) {
+	iCellMin = 0;
+	iCellMax = nCell-1;
+      }
+    }
+
+    for(int iCell=iCellMin; iCell <= iCellMax; iCell++) {
+
+      unsigned cell = ringStart_[iRing] + ((iCell % nCell) + nCell) % nCell;
+
+      const Entry* ent = entries_ + cellOffsets_[cell];
+      const Entry* end = entries_ + cellOffsets_[cell+1];
+
+      for(; ent < end; ent++) {
+
+	if(ent->peakJy_ < fMin || ent->peakJy_ > fMax)
+	  continue;
+
+	if(ent->x_ * center.x_ + ent->y_ * center.y_ + ent->z_ * center.z_ >= cosRad)
+	  rows.push_back(ent->row_);
+      }
+    }
+  }
+
+  std::sort(rows.begin(), rows.end());
+}
+
+/**.......................................................................
+ * Query many fields, in parallel if a thread pool was passed
+ */
+void SkyIndex::query(std::vector<double>& ras, std::vector<double>& decs, double radius,
+		     double fMinJy, double fMaxJy,
+		     std::vector<std::vector<unsigned> >& rows, ThreadPool* pool)
+{
+  if(ras.size() != decs.size())
+    ThrowError("RA and DEC arrays must be the same size");
+
+  unsigned nField = ras.size();
+  rows.resize(nField);
+
+  if(!pool || nField < 2) {
+    for(unsigned iField=0; iField < nField; iField++)
+      query(ras[iField], decs[iField], radius, fMinJy, fMaxJy, rows[iField]);
+    return;
+  }
+
+  std::vector<QueryExecData> execData(nField);
+  ThreadSynchronizer synchronizer;
+
+  synchronizer.resize(nField);
+  synchronizer.reset();
+  synchronizer.initWait();
+
+  for(unsigned iField=0; iField < nField; iField++) {
+    QueryExecData& qed = execData[iField];
+
+    qed.index_        = this;
+    qed.ra_           = ras[iField];
+    qed.dec_          = decs[iField];
+    qed.radius_       = radius;
+    qed.fMinJy_       = fMinJy;
+    qed.fMaxJy_       = fMaxJy;
+    qed.rows_         = &rows[iField];
+    qed.synchronizer_ = &synchronizer;
+    qed.iBit_         = iField;
+    qed.nBit_         = nField;
+
+    synchronizer.registerPending(iField);
+    pool->execute(&execQuery, &qed);
+  }
+
+  synchronizer.wait();
+}
+
+/**.......................................................................
+ * Static method which can be passed to a thread pool, to execute a
+ * single query
+ */
+EXECUTE_FN(SkyIndex::execQuery)
+{
+  QueryExecData* qed = (QueryExecData*)args;
+
+  try {
+    qed->index_->query(qed->ra_, qed->dec_, qed->radius_, qed->fMinJy_, qed->fMaxJy_, *qed->rows_);
+  } catch(...) {
+    qed->rows_->resize(0);
+  }
+
+  qed->synchronizer_->registerDone(qed->iBit_, qed->nBit_);
+}
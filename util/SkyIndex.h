@@ -0,0 +1,177 @@
+// $Id: $
+
+#ifndef GCP_UTIL_SKYINDEX_H
+#define GCP_UTIL_SKYINDEX_H
+
+/**
+ * @file SkyIndex.h
+ *
+ * Tagged: Mon Oct 19 19:20:14 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <string>
+#include <vector>
+
+#include "gcp/util/ThreadPool.h"
+#include "gcp/util/ThreadSynchronizer.h"
+
+namespace gcp {
+  namespace util {
+
+    //-----------------------------------------------------------------------
+    // A spatial index of catalog positions, for fast cone searches.
+    //
+    // The sphere is divided into nRing iso-latitude rings of equal
+    // height in declination, and each ring into a number of equal
+    // RA cells proportional to cos(dec), so that cells are roughly
+    // square and of roughly equal area (as for the HEALPix RING
+    // scheme).  Entries are stored sorted by cell, with a precomputed
+    // unit vector, peak flux and catalog row for each, so that a cone
+    // search visits only the cells that overlap the cone, and needs
+    // no trig per entry.
+    //
+    // Indices are built once per catalog file, and written to a
+    // binary file that is memory-mapped read-only when loaded.
+    //-----------------------------------------------------------------------
+
+    class SkyIndex {
+    public:
+
+      // A single indexed catalog entry
+
+      struct Entry {
+	double x_, y_, z_;
+	float peakJy_;
+	unsigned row_;
+      };
+
+      // The header written at the start of an index file.  The
+      // catalog size and modification time are stored so that a
+      // stale index can be detected
+
+      struct Header {
+	char      magic_[8];
+	unsigned  version_;
+	unsigned  nRing_;
+	unsigned  nCell_;
+	unsigned  nEntry_;
+	long long catalogSize_;
+	long long catalogMtime_;
+      };
+
+      static const unsigned defaultNRing_ = 512;
+
+      /**
+       * Constructor.
+       */
+      SkyIndex();
+
+      /**
+       * Destructor.
+       */
+      virtual ~SkyIndex();
+
+      // Return an entry for a source at (ra, dec), in radians
+
+      static Entry entry(double ra, double dec, double peakJy, unsigned row);
+
+      // Build an index from a list of entries
+
+      void build(std::vector<Entry>& entries, unsigned nRing=defaultNRing_);
+
+      // Write the index to a file, tagged with the size and
+      // modification time of the catalog it indexes
+
+      void write(std::string fileName, long long catalogSize, long long catalogMtime);
+
+      // Memory-map an index from a file.  Returns false if the file
+      // doesn't exist or doesn't match the passed catalog size and
+      // modification time
+
+      bool load(std::string fileName, long long catalogSize, long long catalogMtime);
+
+      // Release any resources associated with this index
+
+      void unload();
+
+      unsigned nEntry() {
+	return header_.nEntry_;
+      }
+
+      // Return, in ascending order, the catalog rows of entries
+      // within radius of (ra, dec) (all in radians), and with peak
+      // flux between fMinJy and fMaxJy.  The tests are made with a
+      // small tolerance, so callers should recheck the returned
+      // entries exactly
+
+      void query(double ra, double dec, double radius, double fMinJy, double fMaxJy,
+		 std::vector<unsigned>& rows);
+
+      // Batched version of the above, for many fields.  Fields are
+      // searched in parallel if a thread pool is passed
+
+      void query(std::vector<double>& ras, std::vector<double>& decs, double radius,
+		 double fMinJy, double fMaxJy,
+		 std::vector<std::vector<unsigned> >& rows, ThreadPool* pool=0);
+
+    private:
+
+      // Convenience struct for executing a single query on a thread
+      // pool
+
+      struct QueryExecData {
+	SkyIndex* index_;
+	double ra_;
+	double dec_;
+	double radius_;
+	double fMinJy_;
+	double fMaxJy_;
+	std::vector<unsigned>* rows_;
+	ThreadSynchronizer* synchronizer_;
+	unsigned iBit_;
+	unsigned nBit_;
+      };
+
+      static EXECUTE_FN(execQuery);
+
+      void initializeRings(unsigned nRing);
+      unsigned ringIndex(double dec);
+      unsigned cellIndex(double ra, double dec);
+
+      void setPointers();
+
+      Header header_;
+
+      // The first cell of each ring, with a trailing element for
+      // the total number of cells
+
+      std::vector<unsigned> ringStart_;
+
+      // Storage for built indices
+
+      std::vector<unsigned> cellOffsetBuf_;
+      std::vector<Entry>    entryBuf_;
+
+      // Storage for loaded indices
+
+      void*  map_;
+      size_t mapSize_;
+
+      // Pointers into either the build buffers or map_.  Entries in
+      // cell i are entries_[cellOffsets_[i]] to
+      // entries_[cellOffsets_[i+1]-1]
+
+      const unsigned* cellOffsets_;
+      const Entry*    entries_;
+
+      static size_t entryOffset(unsigned nCell);
+
+    }; // End class SkyIndex
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_SKYINDEX_H
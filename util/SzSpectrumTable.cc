@@ -0,0 +1,268 @@
+#include "gcp/util/SzSpectrumTable.h"
+#include "gcp/util/Constants.h"
+#include "gcp/util/Exception.h"
+#include "gcp/util/Scattering.h"
+#include "gcp/util/SzCalculator.h"
+
+using namespace std;
+
+using namespace gcp::util;
+
+/**.......................................................................
+ * Constructor.
+ */
+SzSpectrumTable::SzSpectrumTable()
+{
+  spectrumFn_   = &itohSpectrum;
+  spectrumArgs_ = 0;
+
+  // The Itoh expansion is valid to roughly 50 keV, so default to
+  // 0.1 keV steps over that range
+
+  teMinKeV_ = 0.0;
+  teMaxKeV_ = 50.0;
+  nTe_      = defaultNTe_;
+  dTeKeV_   = (teMaxKeV_ - teMinKeV_) / (nTe_ - 1);
+}
+
+/**.......................................................................
+ * Destructor.
+ */
+SzSpectrumTable::~SzSpectrumTable()
+{
+  clear();
+}
+
+/**.......................................................................
+ * Set the function used to fill the table
+ */
+void SzSpectrumTable::setSpectrum(SZ_SPEC_FN(*fn), void* args)
+{
+  if(fn == &scatteringSpectrum && args == 0)
+    ThrowError("A Scattering object must be passed to tabulate a scattering spectrum");
+
+  guard_.lock();
+
+  spectrumFn_   = fn;
+  spectrumArgs_ = args;
+  clear();
+
+  guard_.unlock();
+}
+
+/**.......................................................................
+ * Set the range of electron temperatures to tabulate
+ */
+void SzSpectrumTable::setTemperatureRange(Temperature& teMin, Temperature& teMax, unsigned nTe)
+{
+  if(nTe < 4)
+    ThrowError("At least 4 temperatures are needed for cubic interpolation");
+
+  if(!(teMax.keV() > teMin.keV()))
+    ThrowError("Invalid temperature range: " << teMin.keV() << " - " << teMax.keV() << " keV");
+
+  guard_.lock();
+
+  teMinKeV_ = teMin.keV();
+  teMaxKeV_ = teMax.keV();
+  nTe_      = nTe;
+  dTeKeV_   = (teMaxKeV_ - teMinKeV_) / (nTe_ - 1);
+  clear();
+
+  guard_.unlock();
+}
+
+/**.......................................................................
+ * Tabulate the spectrum at the requested frequency
+ */
+void SzSpectrumTable::addFrequency(Frequency& freq)
+{
+  guard_.lock();
+
+  try {
+    getTable(freq);
+  } catch(...) {
+    guard_.unlock();
+    throw;
+  }
+
+  guard_.unlock();
+}
+
+void SzSpectrumTable::addFrequencies(std::vector<Frequency>& freqs)
+{
+  for(unsigned iFreq=0; iFreq < freqs.size(); iFreq++)
+    addFrequency(freqs[iFreq]);
+}
+
+/**.......................................................................
+ * Return the factor by which comptonY should be multiplied to convert
+ * to CMB temperature decrement/increment
+ */
+void SzSpectrumTable::comptonYToDeltaT(Temperature& Te, Frequency& freq, Temperature& YtoT)
+{
+  double yToTK, dPlanck;
+  lookup(Te, freq, yToTK, dPlanck);
+  YtoT.setK(yToTK);
+}
+
+/**.......................................................................
+ * Return the factor by which comptonY should be multiplied to convert
+ * to intensity
+ */
+void SzSpectrumTable::comptonYToDeltaI(Temperature& Te, Frequency& freq, Temperature& YtoT, Intensity& YtoI)
+{
+  double yToTK, dPlanck;
+  lookup(Te, freq, yToTK, dPlanck);
+  YtoT.setK(yToTK);
+  YtoI.setJyPerSr(dPlanck * yToTK);
+}
+
+/**.......................................................................
+ * Look up the Compton-y to temperature conversion (K) and the
+ * derivative of the CMB Planck function (Jy/sr/K) at this frequency
+ */
+void SzSpectrumTable::lookup(Temperature& Te, Frequency& freq, double& yToTK, double& dPlanck)
+{
+  double teKeV = Te.keV();
+
+  guard_.lock();
+
+  try {
+
+    FreqTable* table = getTable(freq);
+
+    if(teKeV >= teMinKeV_ && teKeV <= teMaxKeV_)
+      yToTK = interpolate(table->yToTK_, teKeV);
+    else
+      yToTK = spectrumFn_(Te, freq, spectrumArgs_);
+
+    dPlanck = table->dPlanckJyPerSrPerK_;
+
+  } catch(...) {
+    guard_.unlock();
+    throw;
+  }
+
+  guard_.unlock();
+}
+
+/**.......................................................................
+ * Return the table for the requested frequency, tabulating it if
+ * this is the first time we have seen it.  Must be called with the
+ * guard locked
+ */
+SzSpectrumTable::FreqTable* SzSpectrumTable::getTable(Frequency& freq)
+{
+  std::map<double, FreqTable*>::iterator iter = tables_.find(freq.Hz());
+
+  if(iter != tables_.end())
+    return iter->second;
+
+  FreqTable* table = tabulate(freq);
+  tables_[freq.Hz()] = table;
+
+  return table;
+}
+
+/**.......................................................................
+ * Tabulate the spectrum at a single frequency
+ */
+SzSpectrumTable::FreqTable* SzSpectrumTable::tabulate(Frequency& freq)
+{
+  FreqTable* table = new FreqTable();
+
+  try {
+
+    Intensity dPlanck;
+    SzCalculator::dPlanck(freq, Constants::Tcmb_, dPlanck);
+    table->dPlanckJyPerSrPerK_ = dPlanck.JyPerSr();
+
+    table->yToTK_.resize(nTe_);
+
+    Temperature Te;
+    for(unsigned iTe=0; iTe < nTe_; iTe++) {
+      Te.setKeV(teMinKeV_ + iTe * dTeKeV_);
+      table->yToTK_[iTe] = spectrumFn_(Te, freq, spectrumArgs_);
+    }
+
+  } catch(...) {
+    delete table;
+    throw;
+  }
+
+  return table;
+}
+
+/**.......................................................................
+ * Four-point Lagrange interpolation in Te, using the stencil of
+ * points nearest to teKeV
+ */
+double SzSpectrumTable::interpolate(std::vector<double>& vals, double teKeV)
+{
+  double t = (teKeV - teMinKeV_) / dTeKeV_;
+  int i = (int)t - 1;
+
+  if(i < 0)
+    i = 0;
+
+  if(i > (int)nTe_ - 4)
+    i = nTe_ - 4;
+
+  double s = t - i;
+  double s1 = s - 1, s2 = s - 2, s3 = s - 3;
+
+  return
+    - vals[i]   * s1 * s2 * s3 / 6
+    + vals[i+1] * s  * s2 * s3 / 2
+    - vals[i+2] * s  * s1 * s3 / 2
+    + vals[i+3] * s  * s1 * s2 / 6;
+}
+
+/**.......................................................................
+ * Delete any tabulated frequencies.  Must be called with the guard
+ * locked
+ */
+void SzSpectrumTable::clear()
+{
+  for(std::map<double, FreqTable*>::iterator iter = tables_.begin(); iter != tables_.end(); iter++)
+    delete iter->second;
+
+  tables_.clear();
+}
+
+/**.......................................................................
+ * The Itoh relativistic expansion
+ */
+SZ_SPEC_FN(SzSpectrumTable::itohSpectrum)
+{
+  Temperature YtoT;
+  SzCalculator::comptonYToDeltaTItoh(Te, freq, YtoT);
+  return YtoT.K();
+}
+
+/**.......................................................................
+ * The non-relativistic (Kompaneets) spectrum, which is independent of
+ * Te
+ */
+SZ_SPEC_FN(SzSpectrumTable::kompaneetsSpectrum)
+{
+  Temperature YtoT;
+  SzCalculator::comptonYToDeltaT(freq, YtoT);
+  return YtoT.K();
+}
+
+/**.......................................................................
+ * The spectrum of a thermal electron distribution, computed from the
+ * full scattering kernel.  args should point to a Scattering object.
+ * Te must be > 0, so set a non-zero temperature range when using this
+ */
+SZ_SPEC_FN(SzSpectrumTable::scatteringSpectrum)
+{
+  Scattering* scattering = (Scattering*) args;
+
+  Temperature YtoT;
+  scattering->initializeThermalDistribution(Te);
+  scattering->comptonYToDeltaT(freq, YtoT);
+  return YtoT.K();
+}
@@ -0,0 +1,131 @@
+// $Id: $
+
+#ifndef GCP_UTIL_SZSPECTRUMTABLE_H
+#define GCP_UTIL_SZSPECTRUMTABLE_H
+
+/**
+ * @file SzSpectrumTable.h
+ *
+ * Tagged: Mon Oct 19 21:04:37 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <map>
+#include <vector>
+
+#include "gcp/util/Frequency.h"
+#include "gcp/util/Intensity.h"
+#include "gcp/util/Mutex.h"
+#include "gcp/util/Temperature.h"
+
+// A function returning the Compton-y to CMB temperature conversion,
+// in K, for electron temperature Te and frequency freq
+
+#define SZ_SPEC_FN(fn) double (fn)(gcp::util::Temperature& Te, gcp::util::Frequency& freq, void* args)
+
+namespace gcp {
+  namespace util {
+
+    class Scattering;
+
+    //-----------------------------------------------------------------------
+    // A (Te, frequency) lookup table of relativistic SZ spectra.
+    //
+    // The Compton-y to temperature conversion is tabulated on a
+    // uniform grid of electron temperatures, separately for each
+    // frequency at which it is requested.  A frequency is tabulated
+    // the first time it is seen, so the table only ever holds the
+    // frequencies present in the data, and subsequent calls cost a
+    // cubic interpolation in Te.
+    //
+    // By default the table is filled from the Itoh expansion, but any
+    // SZ_SPEC_FN can be used, for example scatteringSpectrum(), which
+    // computes the spectrum of a thermal distribution from the full
+    // scattering kernel.  Temperatures outside the tabulated range
+    // are evaluated directly.
+    //-----------------------------------------------------------------------
+
+    class SzSpectrumTable {
+    public:
+
+      static const unsigned defaultNTe_ = 501;
+
+      /**
+       * Constructor.
+       */
+      SzSpectrumTable();
+
+      /**
+       * Destructor.
+       */
+      virtual ~SzSpectrumTable();
+
+      // Set the function used to fill the table.  This clears any
+      // previously tabulated frequencies
+
+      void setSpectrum(SZ_SPEC_FN(*fn), void* args=0);
+
+      // Set the range and number of electron temperatures to
+      // tabulate.  This clears any previously tabulated frequencies
+
+      void setTemperatureRange(Temperature& teMin, Temperature& teMax, unsigned nTe=defaultNTe_);
+
+      // Tabulate the spectrum at the requested frequencies, if not
+      // already tabulated
+
+      void addFrequency(Frequency& freq);
+      void addFrequencies(std::vector<Frequency>& freqs);
+
+      // Return the factor by which comptonY should be multiplied to
+      // convert to CMB temperature decrement/increment, or to
+      // intensity
+
+      void comptonYToDeltaT(Temperature& Te, Frequency& freq, Temperature& YtoT);
+      void comptonYToDeltaI(Temperature& Te, Frequency& freq, Temperature& YtoT, Intensity& YtoI);
+
+      // Spectrum functions that can be tabulated
+
+      static SZ_SPEC_FN(itohSpectrum);
+      static SZ_SPEC_FN(kompaneetsSpectrum);
+      static SZ_SPEC_FN(scatteringSpectrum);
+
+    private:
+
+      // The tabulated spectrum at a single frequency
+
+      struct FreqTable {
+	double dPlanckJyPerSrPerK_;
+	std::vector<double> yToTK_;
+      };
+
+      SZ_SPEC_FN(*spectrumFn_);
+      void* spectrumArgs_;
+
+      double teMinKeV_;
+      double teMaxKeV_;
+      double dTeKeV_;
+      unsigned nTe_;
+
+      // Tables, keyed by frequency in Hz
+
+      std::map<double, FreqTable*> tables_;
+
+      // Guards the tables, and any (possibly stateful) direct
+      // evaluation of the spectrum
+
+      Mutex guard_;
+
+      void lookup(Temperature& Te, Frequency& freq, double& yToTK, double& dPlanck);
+      FreqTable* getTable(Frequency& freq);
+      FreqTable* tabulate(Frequency& freq);
+      double interpolate(std::vector<double>& vals, double teKeV);
+      void clear();
+
+    }; // End class SzSpectrumTable
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_SZSPECTRUMTABLE_H
@@ -0,0 +1,266 @@
+#include "gcp/util/TcpChannel.h"
+#include "gcp/util/Exception.h"
+
+#include <sstream>
+
+#include <errno.h>
+#include <netdb.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace std;
+
+using namespace gcp::util;
+
+/**.......................................................................
+ * Constructor.
+ */
+TcpChannel::TcpChannel()
+{
+  fd_ = -1;
+}
+
+/**.......................................................................
+ * Destructor.
+ */
+TcpChannel::~TcpChannel()
+{
+  close();
+}
+
+/**.......................................................................
+ * Close the connection
+ */
+void TcpChannel::close()
+{
+  if(fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+/**.......................................................................
+ * Connect to a host specified as host:port
+ */
+void TcpChannel::connect(std::string hostPort)
+{
+  std::string::size_type iColon = hostPort.rfind(':');
+
+  if(iColon == std::string::npos || iColon == hostPort.size()-1)
+    ThrowError("Address '" << hostPort << "' should be of the form host:port");
+
+  std::string host = hostPort.substr(0, iColon);
+  unsigned port = 0;
+
+  std::istringstream is(hostPort.substr(iColon+1));
+  is >> port;
+
+  if(is.fail() || port == 0 || port > 65535)
+    ThrowError("Invalid port in address: " << hostPort);
+
+  connect(host, (unsigned short)port);
+}
+
+/**.......................................................................
+ * Connect to a listening host
+ */
+void TcpChannel::connect(std::string host, unsigned short port)
+{
+  close();
+
+  struct addrinfo hints;
+  struct addrinfo* res = 0;
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  std::ostringstream portStr;
+  portStr << port;
+
+  int status = getaddrinfo(host.c_str(), portStr.str().c_str(), &hints, &res);
+
+  if(status != 0)
+    ThrowError("Unable to resolve host " << host << ": " << gai_strerror(status));
+
+  for(struct addrinfo* ai = res; ai != 0; ai = ai->ai_next) {
+
+    fd_ = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+    if(fd_ < 0)
+      continue;
+
+    if(::connect(fd_, ai->ai_addr, ai->ai_addrlen) == 0)
+      break;
+
+    ::close(fd_);
+    fd_ = -1;
+  }
+
+  freeaddrinfo(res);
+
+  if(fd_ < 0)
+    ThrowSysError("Unable to connect to " << host << ":" << port);
+
+  //------------------------------------------------------------
+  // Messages are small and latency-bound, so don't let Nagle's
+  // algorithm hold them back
+  //------------------------------------------------------------
+
+  int one = 1;
+  setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  std::ostringstream os;
+  os << host << ":" << port;
+  peer_ = os.str();
+}
+
+/**.......................................................................
+ * Listen on the requested port, and block until a single peer
+ * connects
+ */
+void TcpChannel::accept(unsigned short port)
+{
+  close();
+
+  int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+
+  if(listenFd < 0)
+    ThrowSysError("socket()");
+
+  int one = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port        = htons(port);
+
+  if(bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    ::close(listenFd);
+    ThrowSysError("Unable to bind to port " << port);
+  }
+
+  if(listen(listenFd, 1) < 0) {
+    ::close(listenFd);
+    ThrowSysError("listen()");
+  }
+
+  struct sockaddr_in peerAddr;
+  socklen_t peerLen = sizeof(peerAddr);
+
+  do {
+    fd_ = ::accept(listenFd, (struct sockaddr*)&peerAddr, &peerLen);
+  } while(fd_ < 0 && errno == EINTR);
+
+  ::close(listenFd);
+
+  if(fd_ < 0)
+    ThrowSysError("accept()");
+
+  setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  char host[NI_MAXHOST];
+  if(getnameinfo((struct sockaddr*)&peerAddr, peerLen, host, sizeof(host), 0, 0, NI_NUMERICHOST) == 0)
+    peer_ = host;
+  else
+    peer_ = "unknown";
+}
+
+/**.......................................................................
+ * Write exactly nByte bytes
+ */
+void TcpChannel::writeAll(const void* data, unsigned nByte)
+{
+  const char* cptr = (const char*)data;
+
+  while(nByte > 0) {
+    ssize_t nSent = ::send(fd_, cptr, nByte, MSG_NOSIGNAL);
+
+    if(nSent < 0) {
+      if(errno == EINTR)
+	continue;
+      ThrowSysError("Error sending to " << peer_);
+    }
+
+    cptr  += nSent;
+    nByte -= nSent;
+  }
+}
+
+/**.......................................................................
+ * Read exactly nByte bytes
+ */
+void TcpChannel::readAll(void* data, unsigned nByte)
+{
+  char* cptr = (char*)data;
+
+  while(nByte > 0) {
+    ssize_t nRead = ::recv(fd_, cptr, nByte, 0);
+
+    if(nRead < 0) {
+      if(errno == EINTR)
+	continue;
+      ThrowSysError("Error reading from " << peer_);
+    }
+
+    if(nRead == 0)
+      ThrowError("Connection closed by " << peer_);
+
+    cptr  += nRead;
+    nByte -= nRead;
+  }
+}
+
+/**.......................................................................
+ * Send a single message
+ */
+void TcpChannel::send(unsigned type, const void* data, unsigned nByte)
+{
+  if(fd_ < 0)
+    ThrowError("Channel is not connected");
+
+  unsigned header[2];
+  header[0] = type;
+  header[1] = nByte;
+
+  writeAll(header, sizeof(header));
+
+  if(nByte > 0)
+    writeAll(data, nByte);
+}
+
+void TcpChannel::send(unsigned type, std::vector<char>& payload)
+{
+  send(type, payload.size() > 0 ? &payload[0] : 0, payload.size());
+}
+
+/**.......................................................................
+ * Receive a single message
+ */
+void TcpChannel::recv(unsigned& type, std::vector<char>& payload)
+{
+  if(fd_ < 0)
+    ThrowError("Channel is not connected");
+
+  unsigned header[2];
+
+  readAll(header, sizeof(header));
+
+  type = header[0];
+  payload.resize(header[1]);
+
+  if(header[1] > 0)
+    readAll(&payload[0], header[1]);
+}
@@ -0,0 +1,82 @@
+// $Id: $
+
+#ifndef GCP_UTIL_TCPCHANNEL_H
+#define GCP_UTIL_TCPCHANNEL_H
+
+/**
+ * @file TcpChannel.h
+ *
+ * Tagged: Mon Oct 19 18:05:37 PDT 2026
+ *
+ * @version: $Revision: $, $Date: $
+ *
+ * @author
+ */
+#include <string>
+#include <vector>
+
+namespace gcp {
+  namespace util {
+
+    //-----------------------------------------------------------------------
+    // A blocking, message-framed TCP connection.
+    //
+    // Each message is a fixed header (a 32-bit type and a 32-bit
+    // payload length) followed by the payload.  Payloads are sent
+    // as raw bytes, so both ends are assumed to share the same
+    // architecture (as is the case for local processes, or nodes of
+    // a homogeneous cluster).
+    //-----------------------------------------------------------------------
+
+    class TcpChannel {
+    public:
+
+      /**
+       * Constructor.
+       */
+      TcpChannel();
+
+      /**
+       * Destructor.
+       */
+      virtual ~TcpChannel();
+
+      // Connect to a listening host.  hostPort is of the form host:port
+
+      void connect(std::string hostPort);
+      void connect(std::string host, unsigned short port);
+
+      // Listen on port, and block until a single peer connects
+
+      void accept(unsigned short port);
+
+      void close();
+
+      bool isConnected() {
+	return fd_ >= 0;
+      }
+
+      // Send/receive a single message
+
+      void send(unsigned type, const void* data=0, unsigned nByte=0);
+      void send(unsigned type, std::vector<char>& payload);
+      void recv(unsigned& type, std::vector<char>& payload);
+
+      std::string peer() {
+	return peer_;
+      }
+
+    private:
+
+      int fd_;
+      std::string peer_;
+
+      void writeAll(const void* data, unsigned nByte);
+      void readAll(void* data, unsigned nByte);
+
+    }; // End class TcpChannel
+
+  } // End namespace util
+} // End namespace gcp
+
+#endif // End #ifndef GCP_UTIL_TCPCHANNEL_H
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+#include "gcp/util/SkyIndex.h"
+
+using namespace std;
+using namespace gcp::util;
+using namespace gcp::program;
+
+KeyTabEntry Program::keywords[] = {
+  { "nsrc",     "200000", "i", "Number of random sources to index"},
+  { "nquery",      "300", "i", "Number of random cone searches"},
+  { "file", "/tmp/tSkyIndex.skyidx", "s", "Index file to write and map"},
+  { END_OF_KEYWORDS}
+};
+
+void Program::initializeUsage() {};
+
+static double uniform()
+{
+  return (double)rand() / RAND_MAX;
+}
+
+/**.......................................................................
+ * Index random sources, and check cone searches against a brute-force
+ * scan
+ */
+int Program::main()
+{
+  unsigned nSrc   = Program::getIntegerParameter("nsrc");
+  unsigned nQuery = Program::getIntegerParameter("nquery");
+  std::string file = Program::getStringParameter("file");
+
+  srand(3);
+
+  std::vector<SkyIndex::Entry> entries(nSrc);
+  std::vector<double> ras(nSrc), decs(nSrc);
+  std::vector<float> peaks(nSrc);
+
+  for(unsigned iSrc=0; iSrc < nSrc; iSrc++) {
+    ras[iSrc]   = 2*M_PI*uniform();
+    decs[iSrc]  = asin(2*uniform() - 1);
+    peaks[iSrc] = uniform();
+    entries[iSrc] = SkyIndex::entry(ras[iSrc], decs[iSrc], peaks[iSrc], iSrc+1);
+  }
+
+  unsigned nBad = 0;
+
+  try {
+
+    SkyIndex built;
+    built.build(entries, 128);
+    built.write(file, 123, 456);
+
+    SkyIndex index;
+
+    if(index.load(file, 124, 456)) {
+      COUT("A stale index was accepted");
+      return 1;
+    }
+
+    if(!index.load(file, 123, 456)) {
+      COUT("Unable to load the index we just wrote");
+      return 1;
+    }
+
+    for(unsigned iQuery=0; iQuery < nQuery; iQuery++) {
+
+      double ra  = 2*M_PI*uniform();
+      double dec = asin(2*uniform() - 1);
+
+      // Include some searches around the poles, and one very large
+      // one
+
+      if(iQuery < 10)
+	dec = (iQuery % 2 ? 1 : -1) * (M_PI/2 - 0.001*iQuery);
+
+      double radius = (iQuery % 3 == 0) ? 0.3 : ((iQuery % 3 == 1) ? 0.01 : 0.05);
+
+      if(iQuery == 5)
+	radius = 2.0;
+
+      std::vector<unsigned> rows;
+      index.query(ra, dec, radius, 0.2, 0.9, rows);
+
+      unsigned nMatch = 0;
+
+      for(unsigned iSrc=0; iSrc < nSrc; iSrc++) {
+
+	if(peaks[iSrc] < 0.2 || peaks[iSrc] > 0.9)
+	  continue;
+
+	double c = cos(dec)*cos(decs[iSrc])*cos(ra-ras[iSrc]) + sin(dec)*sin(decs[iSrc]);
+
+	if(acos(c > 1.0 ? 1.0 : c) <= radius) {
+	  ++nMatch;
+	  if(!std::binary_search(rows.begin(), rows.end(), iSrc+1))
+	    ++nBad;
+	}
+      }
+
+      // The index may return a few extra entries at the boundary,
+      // but no more
+
+      if(rows.size() > nMatch + 2)
+	++nBad;
+    }
+
+  } catch(Exception& err) {
+    COUT(err.what());
+    return 1;
+  }
+
+  COUT("Ran " << nQuery << " cone searches: " << nBad << " mismatches");
+
+  return nBad == 0 ? 0 : 1;
+}
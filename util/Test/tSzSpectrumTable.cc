@@ -0,0 +1,158 @@
+#include <iostream>
+#include <cmath>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Constants.h"
+#include "gcp/util/Exception.h"
+#include "gcp/util/Frequency.h"
+#include "gcp/util/Intensity.h"
+#include "gcp/util/SzCalculator.h"
+#include "gcp/util/SzSpectrumTable.h"
+#include "gcp/util/Temperature.h"
+
+using namespace std;
+using namespace gcp::util;
+using namespace gcp::program;
+
+KeyTabEntry Program::keywords[] = {
+  { "tedelta",  "0.37",             "d", "Step between tested electron temperatures (keV), off the table grid"},
+  { "tol",      "1e-6",             "d", "Tolerance, as a fraction of the largest conversion at each frequency"},
+  { END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS,END_OF_KEYWORDS},
+};
+
+void Program::initializeUsage() {};
+
+double compare(SzSpectrumTable& table, Temperature& Te, Frequency& freq, double norm);
+
+int Program::main()
+{
+  double teDelta = Program::getDoubleParameter("tedelta");
+  double tol     = Program::getDoubleParameter("tol");
+
+  //------------------------------------------------------------
+  // Frequencies spanning the decrement, the null and the increment
+  //------------------------------------------------------------
+
+  double freqsGHz[] = {15.0, 30.0, 90.0, 150.0, 217.0, 275.0, 353.0};
+  unsigned nFreq = sizeof(freqsGHz) / sizeof(double);
+
+  SzSpectrumTable table;
+  Temperature Te;
+  Frequency freq;
+
+  for(unsigned iFreq=0; iFreq < nFreq; iFreq++) {
+
+    freq.setGHz(freqsGHz[iFreq]);
+
+    //------------------------------------------------------------
+    // Normalize by the largest conversion over the table range,
+    // since relative errors are meaningless near the null
+    //------------------------------------------------------------
+
+    double norm = 0.0;
+    Temperature YtoT;
+
+    for(double teKeV=0.0; teKeV <= 50.0; teKeV += 1.0) {
+      Te.setKeV(teKeV);
+      SzCalculator::comptonYToDeltaTItoh(Te, freq, YtoT);
+      norm = fabs(YtoT.K()) > norm ? fabs(YtoT.K()) : norm;
+    }
+
+    //------------------------------------------------------------
+    // Interpolated values, between table points, and at both ends of
+    // the table
+    //------------------------------------------------------------
+
+    double maxDiff = 0.0;
+
+    for(double teKeV=0.0; teKeV <= 50.0; teKeV += teDelta) {
+      Te.setKeV(teKeV);
+      double diff = compare(table, Te, freq, norm);
+      maxDiff = diff > maxDiff ? diff : maxDiff;
+    }
+
+    Te.setKeV(50.0);
+    double diff = compare(table, Te, freq, norm);
+    maxDiff = diff > maxDiff ? diff : maxDiff;
+
+    COUT(freqsGHz[iFreq] << " GHz: max fractional difference from Itoh = " << maxDiff);
+
+    if(maxDiff > tol)
+      ThrowError("Tabulated spectrum at " << freqsGHz[iFreq] << " GHz differs from the Itoh expansion");
+
+    //------------------------------------------------------------
+    // Temperatures above the table range are evaluated directly, so
+    // should agree exactly
+    //------------------------------------------------------------
+
+    for(double teKeV=50.5; teKeV < 80.0; teKeV += 7.0) {
+      Te.setKeV(teKeV);
+
+      if(compare(table, Te, freq, norm) != 0.0)
+	ThrowError("Te = " << teKeV << " keV, outside the table, was not evaluated directly at " << freqsGHz[iFreq] << " GHz");
+    }
+  }
+
+  //------------------------------------------------------------
+  // A narrower table should evaluate directly on both sides of its
+  // range, and still interpolate within it
+  //------------------------------------------------------------
+
+  Temperature teMin, teMax;
+  teMin.setKeV(5.0);
+  teMax.setKeV(15.0);
+
+  table.setTemperatureRange(teMin, teMax, 101);
+
+  freq.setGHz(150.0);
+
+  double teKeVs[] = {1.0, 4.99, 15.01, 30.0};
+
+  for(unsigned i=0; i < sizeof(teKeVs) / sizeof(double); i++) {
+    Te.setKeV(teKeVs[i]);
+
+    if(compare(table, Te, freq, 1.0) != 0.0)
+      ThrowError("Te = " << teKeVs[i] << " keV, outside the table, was not evaluated directly");
+  }
+
+  Te.setKeV(10.03);
+
+  if(compare(table, Te, freq, 1.0) > tol)
+    ThrowError("Te = 10.03 keV was not interpolated correctly in a narrowed table");
+
+  COUT("SzSpectrumTable tests passed");
+
+  return 0;
+}
+
+/**.......................................................................
+ * Return the largest difference, as a fraction of norm, between the
+ * tabulated temperature and intensity conversions and the Itoh
+ * expansion
+ */
+double compare(SzSpectrumTable& table, Temperature& Te, Frequency& freq, double norm)
+{
+  Temperature tableT, itohT;
+  Intensity tableI, itohI;
+
+  table.comptonYToDeltaT(Te, freq, tableT);
+  SzCalculator::comptonYToDeltaTItoh(Te, freq, itohT);
+
+  double diffT = fabs(tableT.K() - itohT.K()) / norm;
+
+  table.comptonYToDeltaI(Te, freq, tableT, tableI);
+  SzCalculator::comptonYToDeltaIItoh(Te, freq, itohT, itohI);
+
+  //------------------------------------------------------------
+  // Intensities are normalized by the same factor, converted to
+  // intensity at this frequency
+  //------------------------------------------------------------
+
+  Intensity dPlanck;
+  SzCalculator::dPlanck(freq, Constants::Tcmb_, dPlanck);
+
+  double diffI = fabs(tableI.JyPerSr() - itohI.JyPerSr()) / (norm * dPlanck.JyPerSr());
+
+  return diffT > diffI ? diffT : diffI;
+}
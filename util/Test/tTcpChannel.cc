@@ -0,0 +1,118 @@
+#include <iostream>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "gcp/program/Program.h"
+
+#include "gcp/util/Exception.h"
+#include "gcp/util/TcpChannel.h"
+
+using namespace std;
+using namespace gcp::util;
+using namespace gcp::program;
+
+KeyTabEntry Program::keywords[] = {
+  { "port",       "5556", "i", "Port to test on"},
+  { "nmsg",       "1000", "i", "Number of messages to echo"},
+  { END_OF_KEYWORDS}
+};
+
+void Program::initializeUsage() {};
+
+/**.......................................................................
+ * Fork a child that echoes messages back, and check that what we get
+ * back is what we sent
+ */
+int Program::main()
+{
+  unsigned short port = Program::getIntegerParameter("port");
+  unsigned nMsg       = Program::getIntegerParameter("nmsg");
+
+  pid_t pid = fork();
+
+  if(pid < 0) {
+    COUT("Unable to fork");
+    return 1;
+  }
+
+  //------------------------------------------------------------
+  // Child: echo until told to quit
+  //------------------------------------------------------------
+
+  if(pid == 0) {
+    try {
+      TcpChannel channel;
+      channel.accept(port);
+
+      std::vector<char> payload;
+      unsigned type;
+
+      do {
+	channel.recv(type, payload);
+	channel.send(type, payload);
+      } while(type != 0);
+
+    } catch(Exception& err) {
+      COUT("Child: " << err.what());
+      _exit(1);
+    }
+
+    _exit(0);
+  }
+
+  //------------------------------------------------------------
+  // Parent: send messages of varying size, including empty ones
+  //------------------------------------------------------------
+
+  unsigned nBad = 0;
+
+  try {
+    TcpChannel channel;
+
+    for(unsigned iTry=0; ; iTry++) {
+      try {
+	channel.connect("localhost", port);
+	break;
+      } catch(Exception& err) {
+	if(iTry == 10)
+	  throw err;
+	sleep(1);
+      }
+    }
+
+    std::vector<double> sent;
+    std::vector<char> payload;
+    unsigned type;
+
+    for(unsigned iMsg=1; iMsg <= nMsg; iMsg++) {
+      sent.resize(iMsg % 100);
+      for(unsigned i=0; i < sent.size(); i++)
+	sent[i] = iMsg + 0.5*i;
+
+      channel.send(iMsg, sent.size() > 0 ? &sent[0] : 0, sent.size() * sizeof(double));
+      channel.recv(type, payload);
+
+      if(type != iMsg || payload.size() != sent.size() * sizeof(double) ||
+	 (sent.size() > 0 && memcmp(&payload[0], &sent[0], payload.size()) != 0)) {
+	++nBad;
+      }
+    }
+
+    channel.send(0);
+    channel.recv(type, payload);
+
+  } catch(Exception& err) {
+    COUT(err.what());
+    kill(pid, SIGKILL);
+    return 1;
+  }
+
+  int status;
+  waitpid(pid, &status, 0);
+
+  COUT("Echoed " << nMsg << " messages: " << nBad << " mismatches");
+
+  return (nBad == 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : 1;
+}